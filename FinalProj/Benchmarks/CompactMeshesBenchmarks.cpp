@@ -0,0 +1,61 @@
+///////////////////////////////////////////////////////////////////////////////
+// compactmeshesbenchmarks.cpp
+// ============
+// CPU steps of the compact meshes: cache order, quantization and meshlets
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "CompactMeshes.h"
+#include "TestGeometry.h"
+
+#include <benchmark/benchmark.h>
+
+// the argument is the sphere's slice count, with half as many stacks;
+// the scene's sphere and torus are around 64
+static void BM_OptimizeVertexCache(benchmark::State& state)
+{
+	std::vector<CompactMeshes::CAPTURED_VERTEX> vertices;
+	std::vector<uint32_t> sourceIndices;
+	MakeTestSphere((int)state.range(0), (int)state.range(0) / 2, vertices, sourceIndices);
+	std::vector<uint32_t> indices;
+	for (auto _ : state)
+	{
+		indices = sourceIndices;
+		CompactMeshes::OptimizeVertexCache(indices, vertices.size());
+		benchmark::DoNotOptimize(indices[0]);
+	}
+	state.SetItemsProcessed(state.iterations() * (int64_t)(sourceIndices.size() / 3));
+}
+BENCHMARK(BM_OptimizeVertexCache)->RangeMultiplier(2)->Range(16, 256)->Unit(benchmark::kMicrosecond);
+
+static void BM_Quantize(benchmark::State& state)
+{
+	std::vector<CompactMeshes::CAPTURED_VERTEX> vertices;
+	std::vector<uint32_t> indices;
+	MakeTestSphere((int)state.range(0), (int)state.range(0) / 2, vertices, indices);
+	CompactMeshes::COMPACT_MESH mesh;
+	for (auto _ : state)
+	{
+		CompactMeshes::Quantize(mesh, vertices);
+		benchmark::DoNotOptimize(mesh.vertices[0]);
+	}
+	state.SetItemsProcessed(state.iterations() * (int64_t)vertices.size());
+}
+BENCHMARK(BM_Quantize)->RangeMultiplier(2)->Range(16, 256)->Unit(benchmark::kMicrosecond);
+
+static void BM_BuildMeshlets(benchmark::State& state)
+{
+	std::vector<CompactMeshes::CAPTURED_VERTEX> vertices;
+	CompactMeshes::COMPACT_MESH mesh;
+	MakeTestSphere((int)state.range(0), (int)state.range(0) / 2, vertices, mesh.indices);
+	CompactMeshes::OptimizeVertexCache(mesh.indices, vertices.size());
+	for (auto _ : state)
+	{
+		CompactMeshes::BuildMeshlets(mesh, vertices);
+		benchmark::DoNotOptimize(mesh.meshlets[0]);
+	}
+	state.SetItemsProcessed(state.iterations() * (int64_t)(mesh.indices.size() / 3));
+}
+BENCHMARK(BM_BuildMeshlets)->RangeMultiplier(2)->Range(16, 256)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,70 @@
+///////////////////////////////////////////////////////////////////////////////
+// drawlistbenchmarks.cpp
+// ============
+// sorting one draw list and merging the workers' sorted lists
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "DrawList.h"
+#include "TestGeometry.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+
+namespace
+{
+	const size_t ARENA_SIZE = 64 * 1024 * 1024;
+
+	void FillList(DrawList& drawList, int packetCount, unsigned int seed)
+	{
+		srand(seed);
+		for (int i = 0; i < packetCount; i++)
+		{
+			drawList.Add(MakeTestPacket((SHAPE_MESH)(rand() % SHAPE_COUNT), rand() % 8 - 1, rand() % 16));
+		}
+	}
+}
+
+// record and sort a frame's packets, the way one worker does
+static void BM_DrawListSort(benchmark::State& state)
+{
+	FrameArena arena(ARENA_SIZE);
+	DrawList drawList;
+	for (auto _ : state)
+	{
+		arena.Reset();
+		drawList.Clear(&arena);
+		FillList(drawList, (int)state.range(0), 1);
+		drawList.Sort();
+		benchmark::DoNotOptimize(drawList[0].sortKey);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DrawListSort)->RangeMultiplier(4)->Range(256, 16384);
+
+// merge one sorted list per worker into the frame's draw order
+static void BM_DrawListMergeSorted(benchmark::State& state)
+{
+	FrameArena listArena(ARENA_SIZE);
+	FrameArena mergeArena(ARENA_SIZE);
+	std::vector<DrawList> lists((size_t)state.range(1));
+	for (size_t i = 0; i < lists.size(); i++)
+	{
+		lists[i].Clear(&listArena);
+		FillList(lists[i], (int)(state.range(0) / state.range(1)), (unsigned int)i + 1);
+		lists[i].Sort();
+	}
+	DrawList merged;
+	for (auto _ : state)
+	{
+		mergeArena.Reset();
+		merged.Clear(&mergeArena);
+		merged.MergeSorted(lists);
+		benchmark::DoNotOptimize(merged[0].sortKey);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DrawListMergeSorted)->ArgsProduct({ { 1024, 16384 }, { 2, 4, 8 } });
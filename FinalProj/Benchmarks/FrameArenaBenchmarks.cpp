@@ -0,0 +1,52 @@
+///////////////////////////////////////////////////////////////////////////////
+// framearenabenchmarks.cpp
+// ============
+// frame arena allocation against the heap it replaces
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameArena.h"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+// a frame's worth of small allocations, then the reset that frees them
+static void BM_FrameArenaAllocate(benchmark::State& state)
+{
+	FrameArena arena(16 * 1024 * 1024);
+	int count = (int)state.range(0);
+	for (auto _ : state)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			benchmark::DoNotOptimize(arena.Allocate(64 + (i & 7) * 16, 16));
+		}
+		arena.Reset();
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_FrameArenaAllocate)->Range(64, 8192);
+
+// the same allocations from the heap, freed one by one
+static void BM_HeapAllocate(benchmark::State& state)
+{
+	int count = (int)state.range(0);
+	std::vector<void*> blocks(count);
+	for (auto _ : state)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			blocks[i] = ::operator new(64 + (i & 7) * 16);
+			benchmark::DoNotOptimize(blocks[i]);
+		}
+		for (int i = 0; i < count; i++)
+		{
+			::operator delete(blocks[i]);
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_HeapAllocate)->Range(64, 8192);
@@ -0,0 +1,49 @@
+///////////////////////////////////////////////////////////////////////////////
+// jobsystembenchmarks.cpp
+// ============
+// dispatch cost and scaling of the job system's parallel ranges
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "JobSystem.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <vector>
+
+// a range of small, equal items like the scene objects recorded per frame,
+// with the chunk size as the second argument
+static void BM_ParallelFor(benchmark::State& state)
+{
+	JobSystem jobs;
+	int count = (int)state.range(0);
+	std::vector<float> values(count, 1.0f);
+	for (auto _ : state)
+	{
+		jobs.ParallelFor(count, (int)state.range(1), [&values](int first, int last, int)
+			{
+				for (int i = first; i < last; i++)
+				{
+					values[i] = std::sqrt(values[i] + (float)i);
+				}
+			});
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+	state.counters["workers"] = jobs.GetWorkerCount();
+}
+BENCHMARK(BM_ParallelFor)->ArgsProduct({ { 64, 4096, 262144 }, { 1, 16, 256 } })->UseRealTime();
+
+// the fixed cost of waking the workers for an empty range
+static void BM_ParallelForDispatch(benchmark::State& state)
+{
+	JobSystem jobs;
+	for (auto _ : state)
+	{
+		jobs.ParallelFor(jobs.GetWorkerCount(), 1, [](int, int, int) {});
+	}
+}
+BENCHMARK(BM_ParallelForDispatch)->UseRealTime();
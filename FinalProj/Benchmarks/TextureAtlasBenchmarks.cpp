@@ -0,0 +1,45 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureatlasbenchmarks.cpp
+// ============
+// packing small images into atlas pages
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureAtlas.h"
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+// pack as many images as the argument of random sizes up to 128 texels,
+// the copy into the atlas is part of the packing
+static void BM_TextureAtlasBuild(benchmark::State& state)
+{
+	std::mt19937 random(7);
+	std::uniform_int_distribution<int> size(8, 128);
+	std::vector<int> sizes;
+	for (int i = 0; i < state.range(0) * 2; i++)
+	{
+		sizes.push_back(size(random));
+	}
+	std::vector<unsigned char> pixels(128 * 128 * 4, 200);
+
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		TextureAtlas atlas(1024, 4);
+		for (size_t i = 0; i + 1 < sizes.size(); i += 2)
+		{
+			atlas.AddPixels(&pixels[0], sizes[i], sizes[i + 1]);
+		}
+		state.ResumeTiming();
+
+		atlas.Build();
+		benchmark::DoNotOptimize(atlas.GetPageCount());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TextureAtlasBuild)->RangeMultiplier(4)->Range(16, 256)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,119 @@
+///////////////////////////////////////////////////////////////////////////////
+// allocationtracker.cpp
+// ============
+// counts heap allocations made by the rendering threads
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "AllocationTracker.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+	std::atomic<unsigned long long> g_AllocationCount(0);
+	// only the render and job threads are counted, the update thread
+	// and the startup code may allocate freely
+	thread_local bool g_bTrackThread = false;
+
+	/***********************************************************
+	 *  TrackedAllocate()
+	 *
+	 *  This function allocates heap memory and counts it when
+	 *  the calling thread is tracked.
+	 ***********************************************************/
+	void* TrackedAllocate(size_t size)
+	{
+		if (g_bTrackThread)
+		{
+			g_AllocationCount.fetch_add(1, std::memory_order_relaxed);
+		}
+		return(malloc(size == 0 ? 1 : size));
+	}
+}
+
+/***********************************************************
+ *  TrackCurrentThread()
+ *
+ *  This method starts counting the calling thread.
+ ***********************************************************/
+void AllocationTracker::TrackCurrentThread()
+{
+	g_bTrackThread = true;
+}
+
+/***********************************************************
+ *  GetAllocationCount()
+ *
+ *  This method returns the allocations counted so far.
+ ***********************************************************/
+unsigned long long AllocationTracker::GetAllocationCount()
+{
+	return(g_AllocationCount.load(std::memory_order_relaxed));
+}
+
+// replacements of the global allocation functions, the aligned
+// versions are left to the standard library
+void* operator new(size_t size)
+{
+	void* pMemory = TrackedAllocate(size);
+	if (NULL == pMemory)
+	{
+		throw std::bad_alloc();
+	}
+	return(pMemory);
+}
+
+void* operator new[](size_t size)
+{
+	void* pMemory = TrackedAllocate(size);
+	if (NULL == pMemory)
+	{
+		throw std::bad_alloc();
+	}
+	return(pMemory);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return(TrackedAllocate(size));
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return(TrackedAllocate(size));
+}
+
+void operator delete(void* pMemory) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete[](void* pMemory) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete(void* pMemory, size_t) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete[](void* pMemory, size_t) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete(void* pMemory, const std::nothrow_t&) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete[](void* pMemory, const std::nothrow_t&) noexcept
+{
+	free(pMemory);
+}
@@ -0,0 +1,27 @@
+///////////////////////////////////////////////////////////////////////////////
+// allocationtracker.h
+// ============
+// counts heap allocations made by the rendering threads
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+/***********************************************************
+ *  AllocationTracker
+ *
+ *  The global operator new is replaced to count every heap
+ *  allocation made on a thread that asked to be tracked.
+ *  The render loop compares the count around a frame to
+ *  check that steady-state frames never allocate.
+ ***********************************************************/
+class AllocationTracker
+{
+public:
+	// count the allocations of the calling thread from now on
+	static void TrackCurrentThread();
+	// allocations made by all tracked threads so far
+	static unsigned long long GetAllocationCount();
+};
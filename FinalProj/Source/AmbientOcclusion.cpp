@@ -0,0 +1,259 @@
+///////////////////////////////////////////////////////////////////////////////
+// ambientocclusion.cpp
+// ============
+// screen space ambient occlusion at reduced resolution
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "AmbientOcclusion.h"
+#include "GLProgram.h"
+#include "GLStateCache.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <iostream>
+
+namespace
+{
+	// must match the work group size of ambientOcclusionCompute.glsl
+	const int TILE_SIZE = 16;
+	// most occlusion texels a frame computes, half of 1000x800 on
+	// each axis; larger render sizes divide by more than two
+	const int MAX_OCCLUSION_TEXELS = 500 * 400;
+	const int MIN_DIVISOR = 2;
+	// reach of the occlusion in world units and its strength
+	const float OCCLUSION_RADIUS = 0.5f;
+	const float OCCLUSION_INTENSITY = 0.6f;
+	// keeps flat surfaces from occluding themselves, per unit of depth
+	const float DEPTH_BIAS = 0.002f;
+	// how quickly the upsample drops texels at another depth
+	const float UPSAMPLE_SHARPNESS = 16.0f;
+	// the transparency targets use these units only later in the
+	// frame, must match the sampler bindings in both shaders
+	const int DEPTH_TEXTURE_UNIT = 12;
+	const int OCCLUSION_TEXTURE_UNIT = 13;
+	// image unit of the occlusion the compute pass writes
+	const int OCCLUSION_IMAGE_UNIT = 0;
+}
+
+/***********************************************************
+ *  AmbientOcclusion()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+AmbientOcclusion::AmbientOcclusion()
+{
+	m_renderWidth = 0;
+	m_renderHeight = 0;
+	m_divisor = MIN_DIVISOR;
+	m_occlusionWidth = 0;
+	m_occlusionHeight = 0;
+	m_occlusionTexture = 0;
+	m_framebuffer = 0;
+	m_depthTexture = 0;
+	m_sceneFramebuffer = 0;
+	m_occlusionProgram = 0;
+	m_upsampleProgram = 0;
+	m_emptyVertexArray = 0;
+	m_sourceSizeLocation = -1;
+	m_targetSizeLocation = -1;
+	m_divisorLocation = -1;
+	m_inverseProjectionLocation = -1;
+	m_projectionScaleLocation = -1;
+	m_upsampleTargetSizeLocation = -1;
+	m_upsampleDivisorLocation = -1;
+	m_upsampleInverseProjectionLocation = -1;
+}
+
+/***********************************************************
+ *  ~AmbientOcclusion()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+AmbientOcclusion::~AmbientOcclusion()
+{
+	DestroyTargets();
+	glDeleteVertexArrays(1, &m_emptyVertexArray);
+	glDeleteProgram(m_occlusionProgram);
+	glDeleteProgram(m_upsampleProgram);
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method loads the occlusion compute program and the
+ *  upsample program, which draws a full screen triangle
+ *  like the tone mapping, and sets their fixed uniforms.
+ ***********************************************************/
+bool AmbientOcclusion::Initialize()
+{
+	m_occlusionProgram = LoadGLComputeProgram("ambientOcclusionCompute.glsl");
+	m_upsampleProgram = LoadGLProgram("tonemapVertex.glsl", "ambientOcclusionUpsampleFragment.glsl");
+	if ((m_occlusionProgram == 0) || (m_upsampleProgram == 0))
+	{
+		glDeleteProgram(m_occlusionProgram);
+		glDeleteProgram(m_upsampleProgram);
+		m_occlusionProgram = 0;
+		m_upsampleProgram = 0;
+		return(false);
+	}
+
+	m_sourceSizeLocation = glGetUniformLocation(m_occlusionProgram, "sourceSize");
+	m_targetSizeLocation = glGetUniformLocation(m_occlusionProgram, "targetSize");
+	m_divisorLocation = glGetUniformLocation(m_occlusionProgram, "divisor");
+	m_inverseProjectionLocation = glGetUniformLocation(m_occlusionProgram, "inverseProjection");
+	m_projectionScaleLocation = glGetUniformLocation(m_occlusionProgram, "projectionScale");
+	m_upsampleTargetSizeLocation = glGetUniformLocation(m_upsampleProgram, "targetSize");
+	m_upsampleDivisorLocation = glGetUniformLocation(m_upsampleProgram, "divisor");
+	m_upsampleInverseProjectionLocation = glGetUniformLocation(m_upsampleProgram, "inverseProjection");
+
+	GLuint previousProgram = GLStateCache::GetProgram();
+	GLStateCache::UseProgram(m_occlusionProgram);
+	glUniform1f(glGetUniformLocation(m_occlusionProgram, "radius"), OCCLUSION_RADIUS);
+	glUniform1f(glGetUniformLocation(m_occlusionProgram, "intensity"), OCCLUSION_INTENSITY);
+	glUniform1f(glGetUniformLocation(m_occlusionProgram, "depthBias"), DEPTH_BIAS);
+	GLStateCache::UseProgram(m_upsampleProgram);
+	glUniform1f(glGetUniformLocation(m_upsampleProgram, "sharpness"), UPSAMPLE_SHARPNESS);
+	GLStateCache::UseProgram(previousProgram);
+
+	glGenVertexArrays(1, &m_emptyVertexArray);
+	return(true);
+}
+
+/***********************************************************
+ *  CreateTargets()
+ *
+ *  This method creates the occlusion texture, big enough
+ *  for the whole scene target at the smallest divisor, and
+ *  a framebuffer with only the scene color, so the upsample
+ *  can read the depth texture while it draws.
+ ***********************************************************/
+bool AmbientOcclusion::CreateTargets(int width, int height, GLuint depthTexture, GLuint colorTexture, GLuint sceneFramebuffer)
+{
+	DestroyTargets();
+	if (m_occlusionProgram == 0)
+	{
+		return(false);
+	}
+	m_depthTexture = depthTexture;
+	m_sceneFramebuffer = sceneFramebuffer;
+
+	glGenTextures(1, &m_occlusionTexture);
+	GLStateCache::BindTexture(0, GL_TEXTURE_2D, m_occlusionTexture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_RG16F,
+		(width + MIN_DIVISOR - 1) / MIN_DIVISOR,
+		(height + MIN_DIVISOR - 1) / MIN_DIVISOR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	GLStateCache::BindTexture(0, GL_TEXTURE_2D, 0);
+
+	glGenFramebuffers(1, &m_framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "ERROR: ambient occlusion framebuffer is incomplete" << std::endl;
+		DestroyTargets();
+		return(false);
+	}
+
+	SetRenderSize(width, height);
+	return(true);
+}
+
+/***********************************************************
+ *  DestroyTargets()
+ *
+ *  This method releases the occlusion texture and the
+ *  framebuffer, the depth and color textures belong to the
+ *  scene target.
+ ***********************************************************/
+void AmbientOcclusion::DestroyTargets()
+{
+	glDeleteFramebuffers(1, &m_framebuffer);
+	GLStateCache::DeleteTexture(m_occlusionTexture);
+	m_framebuffer = 0;
+	m_occlusionTexture = 0;
+	m_depthTexture = 0;
+	m_sceneFramebuffer = 0;
+}
+
+/***********************************************************
+ *  SetRenderSize()
+ *
+ *  This method sets the part of the scene target the pass
+ *  covers. The divisor grows until the occlusion texels fit
+ *  the budget, so the occlusion pass costs about the same
+ *  at any render size.
+ ***********************************************************/
+void AmbientOcclusion::SetRenderSize(int width, int height)
+{
+	m_renderWidth = width;
+	m_renderHeight = height;
+
+	m_divisor = MIN_DIVISOR;
+	while (((m_renderWidth / m_divisor) * (m_renderHeight / m_divisor)) > MAX_OCCLUSION_TEXELS)
+	{
+		m_divisor++;
+	}
+	m_occlusionWidth = (m_renderWidth + m_divisor - 1) / m_divisor;
+	m_occlusionHeight = (m_renderHeight + m_divisor - 1) / m_divisor;
+}
+
+/***********************************************************
+ *  Apply()
+ *
+ *  This method computes the occlusion of the opaque scene
+ *  from its depth and multiplies the upsampled occlusion
+ *  into the scene color. The depth test is off while the
+ *  upsample draws and blending is left off.
+ ***********************************************************/
+void AmbientOcclusion::Apply(const FRAME_STATE& frameState)
+{
+	// the views of a split frame have projections of their own
+	if (!IsReady() || (frameState.viewCount > 1) || (m_renderWidth <= 0) || (m_renderHeight <= 0))
+	{
+		return;
+	}
+
+	GLuint previousProgram = GLStateCache::GetProgram();
+	bool bDepthTest = GLStateCache::IsEnabled(GL_DEPTH_TEST);
+	glm::mat4 inverseProjection = glm::inverse(frameState.projection);
+
+	GLStateCache::BindTexture(DEPTH_TEXTURE_UNIT, GL_TEXTURE_2D, m_depthTexture);
+	glBindImageTexture(OCCLUSION_IMAGE_UNIT, m_occlusionTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RG16F);
+	GLStateCache::UseProgram(m_occlusionProgram);
+	glUniform2i(m_sourceSizeLocation, m_renderWidth, m_renderHeight);
+	glUniform2i(m_targetSizeLocation, m_occlusionWidth, m_occlusionHeight);
+	glUniform1i(m_divisorLocation, m_divisor);
+	glUniformMatrix4fv(m_inverseProjectionLocation, 1, GL_FALSE, glm::value_ptr(inverseProjection));
+	// occlusion texels a world unit covers at view depth 1
+	glUniform1f(m_projectionScaleLocation, frameState.projection[1][1] * 0.5f * (float)m_occlusionHeight);
+	glDispatchCompute(
+		(m_occlusionWidth + TILE_SIZE - 1) / TILE_SIZE,
+		(m_occlusionHeight + TILE_SIZE - 1) / TILE_SIZE,
+		1);
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+	// the viewport is left as the scene set it
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	GLStateCache::SetEnabled(GL_DEPTH_TEST, false);
+	GLStateCache::SetEnabled(GL_BLEND, true);
+	GLStateCache::BlendFunc(GL_ZERO, GL_SRC_COLOR);
+	GLStateCache::BindTexture(OCCLUSION_TEXTURE_UNIT, GL_TEXTURE_2D, m_occlusionTexture);
+	GLStateCache::UseProgram(m_upsampleProgram);
+	glUniform2i(m_upsampleTargetSizeLocation, m_occlusionWidth, m_occlusionHeight);
+	glUniform1i(m_upsampleDivisorLocation, m_divisor);
+	glUniformMatrix4fv(m_upsampleInverseProjectionLocation, 1, GL_FALSE, glm::value_ptr(inverseProjection));
+	GLStateCache::BindVertexArray(m_emptyVertexArray);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+
+	GLStateCache::SetEnabled(GL_BLEND, false);
+	GLStateCache::SetEnabled(GL_DEPTH_TEST, bDepthTest);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_sceneFramebuffer);
+	GLStateCache::UseProgram(previousProgram);
+}
@@ -0,0 +1,86 @@
+///////////////////////////////////////////////////////////////////////////////
+// ambientocclusion.h
+// ============
+// screen space ambient occlusion at reduced resolution
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "FrameState.h"
+
+#include <GL/glew.h>
+
+/***********************************************************
+ *  AmbientOcclusion
+ *
+ *  This class darkens the creases and contact points of the
+ *  opaque scene. A compute pass estimates the occlusion
+ *  from the scene's depth buffer at half resolution or
+ *  below, each work group rebuilding the view positions of
+ *  its tile once into shared memory. A full screen pass
+ *  then upsamples it, weighting the occlusion texels by how
+ *  close their depth is to the pixel's so it stays on its
+ *  own surface, and multiplies it into the lit scene.
+ *
+ *  The occlusion pass works on a fixed number of texels,
+ *  half of 1000x800 on each axis. A larger render size
+ *  divides by more instead, so the pass keeps its cost and
+ *  only the occlusion gets softer.
+ ***********************************************************/
+class AmbientOcclusion
+{
+public:
+	// constructor
+	AmbientOcclusion();
+	// destructor
+	~AmbientOcclusion();
+
+	// load the occlusion and upsample programs
+	bool Initialize();
+	// create the occlusion texture for a scene target of this size,
+	// reading its depth texture and multiplying into its color one
+	bool CreateTargets(int width, int height, GLuint depthTexture, GLuint colorTexture, GLuint sceneFramebuffer);
+	void DestroyTargets();
+	bool IsReady() const { return((m_framebuffer != 0) && (m_occlusionProgram != 0)); }
+
+	// set the part of the scene target rendered into, picks the
+	// divisor of the occlusion resolution
+	void SetRenderSize(int width, int height);
+	// darken the opaque draws of the frame, before the transparent
+	// ones are drawn over them; a split frame is left as it is
+	void Apply(const FRAME_STATE& frameState);
+
+private:
+	// rendered part of the scene target, and the occlusion texels
+	// covering it at the current divisor
+	int m_renderWidth;
+	int m_renderHeight;
+	int m_divisor;
+	int m_occlusionWidth;
+	int m_occlusionHeight;
+
+	// occlusion (r) and view depth (g) per texel
+	GLuint m_occlusionTexture;
+	// the scene color without its depth, which the upsample reads
+	GLuint m_framebuffer;
+	GLuint m_depthTexture;
+	GLuint m_sceneFramebuffer;
+
+	GLuint m_occlusionProgram;
+	GLuint m_upsampleProgram;
+	// core profile needs a bound vertex array even without attributes
+	GLuint m_emptyVertexArray;
+
+	// uniform locations in the programs
+	GLint m_sourceSizeLocation;
+	GLint m_targetSizeLocation;
+	GLint m_divisorLocation;
+	GLint m_inverseProjectionLocation;
+	GLint m_projectionScaleLocation;
+	GLint m_upsampleTargetSizeLocation;
+	GLint m_upsampleDivisorLocation;
+	GLint m_upsampleInverseProjectionLocation;
+};
@@ -0,0 +1,217 @@
+///////////////////////////////////////////////////////////////////////////////
+// camerapath.cpp
+// ============
+// recording and replay of the camera movement for repeatable benchmarks
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "CameraPath.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+	const char FILE_MAGIC[4] = { 'C', 'A', 'M', 'P' };
+
+	// orders a sample against a time for the binary search
+	bool SampleBefore(double time, const CAMERA_SAMPLE& sample)
+	{
+		return(time < sample.time);
+	}
+}
+
+/***********************************************************
+ *  CameraPath()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+CameraPath::CameraPath()
+{
+	m_maxSamples = 0;
+	m_bReportedFull = false;
+}
+
+/***********************************************************
+ *  BeginRecording()
+ *
+ *  This method drops any samples and reserves the room for
+ *  a new recording.
+ ***********************************************************/
+void CameraPath::BeginRecording(size_t maxSamples)
+{
+	m_samples.clear();
+	m_samples.reserve(maxSamples);
+	m_maxSamples = maxSamples;
+	m_bReportedFull = false;
+}
+
+/***********************************************************
+ *  Record()
+ *
+ *  This method appends a camera state to the recording. A
+ *  full recording keeps its samples and drops the new ones.
+ ***********************************************************/
+bool CameraPath::Record(const CAMERA_SAMPLE& sample)
+{
+	if (m_samples.size() >= m_maxSamples)
+	{
+		if (!m_bReportedFull)
+		{
+			std::cout << "ERROR: the camera recording is full, later camera moves are not recorded" << std::endl;
+			m_bReportedFull = true;
+		}
+		return(false);
+	}
+
+	m_samples.push_back(sample);
+	return(true);
+}
+
+/***********************************************************
+ *  Save()
+ *
+ *  This method writes the samples to a path file.
+ ***********************************************************/
+bool CameraPath::Save(const char* filename) const
+{
+	std::ofstream file(filename, std::ios::binary);
+	uint32_t version = FILE_VERSION;
+	uint32_t count = (uint32_t)m_samples.size();
+	file.write(FILE_MAGIC, sizeof(FILE_MAGIC));
+	file.write((const char*)&version, sizeof(version));
+	file.write((const char*)&count, sizeof(count));
+	if (count > 0)
+	{
+		file.write((const char*)&m_samples[0], count * sizeof(CAMERA_SAMPLE));
+	}
+
+	if (file.fail())
+	{
+		std::cout << "ERROR: could not write the camera path " << filename << std::endl;
+		return(false);
+	}
+	std::cout << "INFO: recorded " << count << " camera samples over "
+		<< GetDuration() << " seconds to " << filename << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  Load()
+ *
+ *  This method reads a path file. A file that is cut short,
+ *  of another version or whose times go backwards is
+ *  rejected and leaves the path empty. The sample count is
+ *  checked against the size of the file before anything is
+ *  allocated for it.
+ ***********************************************************/
+bool CameraPath::Load(const char* filename)
+{
+	m_samples.clear();
+
+	std::ifstream file(filename, std::ios::binary);
+	char magic[4] = { 0, 0, 0, 0 };
+	uint32_t version = 0;
+	uint32_t count = 0;
+	file.read(magic, sizeof(magic));
+	file.read((char*)&version, sizeof(version));
+	file.read((char*)&count, sizeof(count));
+	if (file.fail() || (memcmp(magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) ||
+		(version != FILE_VERSION) || (count == 0))
+	{
+		std::cout << "ERROR: " << filename << " is not a camera path" << std::endl;
+		return(false);
+	}
+
+	std::streampos samplesStart = file.tellg();
+	file.seekg(0, std::ios::end);
+	std::streamoff bytesLeft = file.tellg() - samplesStart;
+	file.seekg(samplesStart);
+	if (file.fail() || (bytesLeft < 0) || ((uint64_t)count * sizeof(CAMERA_SAMPLE) > (uint64_t)bytesLeft))
+	{
+		std::cout << "ERROR: the camera path " << filename << " is damaged" << std::endl;
+		return(false);
+	}
+
+	m_samples.resize(count);
+	file.read((char*)&m_samples[0], count * sizeof(CAMERA_SAMPLE));
+	bool bOrdered = true;
+	for (size_t i = 1; i < m_samples.size(); i++)
+	{
+		bOrdered = bOrdered && (m_samples[i].time >= m_samples[i - 1].time);
+	}
+	if (file.fail() || !bOrdered)
+	{
+		std::cout << "ERROR: the camera path " << filename << " is damaged" << std::endl;
+		m_samples.clear();
+		return(false);
+	}
+	m_maxSamples = m_samples.size();
+	return(true);
+}
+
+/***********************************************************
+ *  GetDuration()
+ *
+ *  This method returns how long the path lasts.
+ ***********************************************************/
+double CameraPath::GetDuration() const
+{
+	if (m_samples.empty())
+	{
+		return(0.0);
+	}
+	return(m_samples.back().time);
+}
+
+/***********************************************************
+ *  Sample()
+ *
+ *  This method finds the two samples around a time and
+ *  blends them. The front is blended and normalized, which
+ *  is close enough to a rotation between samples recorded
+ *  a few milliseconds apart.
+ ***********************************************************/
+CAMERA_SAMPLE CameraPath::Sample(double time) const
+{
+	CAMERA_SAMPLE sample;
+	if (m_samples.empty())
+	{
+		sample.time = 0.0;
+		sample.position = glm::vec3(0.0f);
+		sample.front = glm::vec3(0.0f, 0.0f, -1.0f);
+		sample.up = glm::vec3(0.0f, 1.0f, 0.0f);
+		sample.zoom = 45.0f;
+		return(sample);
+	}
+
+	std::vector<CAMERA_SAMPLE>::const_iterator next =
+		std::upper_bound(m_samples.begin(), m_samples.end(), time, SampleBefore);
+	if (next == m_samples.begin())
+	{
+		return(m_samples.front());
+	}
+	if (next == m_samples.end())
+	{
+		return(m_samples.back());
+	}
+
+	const CAMERA_SAMPLE& a = *(next - 1);
+	const CAMERA_SAMPLE& b = *next;
+	double span = b.time - a.time;
+	float t = (span > 0.0) ? (float)((time - a.time) / span) : 1.0f;
+
+	sample.time = time;
+	sample.position = glm::mix(a.position, b.position, t);
+	sample.up = glm::mix(a.up, b.up, t);
+	sample.zoom = a.zoom + (b.zoom - a.zoom) * t;
+	glm::vec3 front = glm::mix(a.front, b.front, t);
+	float length = glm::length(front);
+	sample.front = (length > 0.0f) ? (front / length) : b.front;
+	return(sample);
+}
@@ -0,0 +1,74 @@
+///////////////////////////////////////////////////////////////////////////////
+// camerapath.h
+// ============
+// recording and replay of the camera movement for repeatable benchmarks
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <vector>
+
+// camera state at a time since the recording started, stored as is
+// in the path file; the time is a double like the frame clock, so
+// long recordings keep their step precision
+struct CAMERA_SAMPLE
+{
+	double time;
+	glm::vec3 position;
+	glm::vec3 front;
+	glm::vec3 up;
+	float zoom;
+};
+
+/***********************************************************
+ *  CameraPath
+ *
+ *  This class keeps the camera states of a recorded flight
+ *  through the scene. Recording stores the camera after
+ *  every update, whatever input moved it, so a replay needs
+ *  neither the input nor its timing. A replay samples the
+ *  path at fixed time steps and interpolates between the
+ *  recorded states, so every run renders the same frames.
+ *
+ *  The file is a small header followed by the samples:
+ *
+ *    magic      4 bytes "CAMP"
+ *    version    32 bit, FILE_VERSION
+ *    count      32 bit number of samples
+ *    samples    count x CAMERA_SAMPLE, times never decrease
+ ***********************************************************/
+class CameraPath
+{
+public:
+	static const unsigned int FILE_VERSION = 2;
+
+	// constructor
+	CameraPath();
+
+	// start an empty recording with room for this many samples, the
+	// room is reserved now so recording never allocates in a frame
+	void BeginRecording(size_t maxSamples);
+	// append a sample, returns false once the recording is full
+	bool Record(const CAMERA_SAMPLE& sample);
+
+	bool Save(const char* filename) const;
+	bool Load(const char* filename);
+
+	size_t GetSampleCount() const { return(m_samples.size()); }
+	// time of the last sample in seconds
+	double GetDuration() const;
+	// camera state at a time, interpolated between the samples
+	// around it and held at the ends of the path
+	CAMERA_SAMPLE Sample(double time) const;
+
+private:
+	std::vector<CAMERA_SAMPLE> m_samples;
+	size_t m_maxSamples;
+	bool m_bReportedFull;
+};
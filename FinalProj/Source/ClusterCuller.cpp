@@ -0,0 +1,310 @@
+///////////////////////////////////////////////////////////////////////////////
+// clusterculler.cpp
+// ============
+// per-meshlet culling of the compact meshes on the GPU
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ClusterCuller.h"
+#include "GLProgram.h"
+#include "GLStateCache.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+	// work groups per dispatch row, the minimum every GL 4.3 driver allows
+	const GLuint MAX_GROUPS_PER_ROW = 65535;
+}
+
+/***********************************************************
+ *  ClusterCuller()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ClusterCuller::ClusterCuller()
+{
+	m_pMeshes = NULL;
+	for (int i = 0; i < SHAPE_COUNT; i++)
+	{
+		m_clusteredMeshes[i].firstMeshlet = 0;
+		m_clusteredMeshes[i].meshletCount = 0;
+		m_clusteredMeshes[i].indexCount = 0;
+		m_clusteredMeshes[i].baseVertex = 0;
+	}
+	m_vao = 0;
+
+	m_cullProgram = 0;
+	m_frustumPlanesLocation = -1;
+	m_viewPositionLocation = -1;
+	m_drawCountLocation = -1;
+
+	m_meshletBuffer = 0;
+	m_sourceIndexBuffer = 0;
+	m_drawBuffer = 0;
+	m_commandBuffer = 0;
+	m_culledIndexBuffer = 0;
+	m_drawCapacity = 0;
+	m_culledIndexCapacity = 0;
+}
+
+/***********************************************************
+ *  ~ClusterCuller()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ClusterCuller::~ClusterCuller()
+{
+	glDeleteVertexArrays(1, &m_vao);
+	glDeleteBuffers(1, &m_meshletBuffer);
+	glDeleteBuffers(1, &m_sourceIndexBuffer);
+	glDeleteBuffers(1, &m_drawBuffer);
+	glDeleteBuffers(1, &m_commandBuffer);
+	glDeleteBuffers(1, &m_culledIndexBuffer);
+	glDeleteProgram(m_cullProgram);
+	m_cullProgram = 0;
+	m_pMeshes = NULL;
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method loads the culling program and uploads the
+ *  meshlets and indices of the listed meshes into storage
+ *  buffers shared by all draws. One vertex array reads the
+ *  shared compact vertices through the culled indices.
+ ***********************************************************/
+bool ClusterCuller::Initialize(const CompactMeshes* pMeshes, const std::vector<int>& meshes)
+{
+	m_pMeshes = pMeshes;
+	m_cullProgram = LoadGLComputeProgram("clusterCullCompute.glsl");
+	if (m_cullProgram == 0)
+	{
+		return(false);
+	}
+	m_frustumPlanesLocation = glGetUniformLocation(m_cullProgram, "frustumPlanes");
+	m_viewPositionLocation = glGetUniformLocation(m_cullProgram, "viewPosition");
+	m_drawCountLocation = glGetUniformLocation(m_cullProgram, "drawCount");
+
+	std::vector<GPU_MESHLET> gpuMeshlets;
+	std::vector<uint32_t> sourceIndices;
+	for (size_t i = 0; i < meshes.size(); i++)
+	{
+		int mesh = meshes[i];
+		if ((mesh < 0) || (mesh >= SHAPE_COUNT) || !pMeshes->IsReady(mesh))
+		{
+			continue;
+		}
+
+		const std::vector<CompactMeshes::MESHLET>& meshlets = pMeshes->GetMeshlets(mesh);
+		const std::vector<uint32_t>& indices = pMeshes->GetIndices(mesh);
+		CLUSTERED_MESH& clusteredMesh = m_clusteredMeshes[mesh];
+		clusteredMesh.firstMeshlet = (uint32_t)gpuMeshlets.size();
+		clusteredMesh.meshletCount = (uint32_t)meshlets.size();
+		clusteredMesh.indexCount = (uint32_t)indices.size();
+		clusteredMesh.baseVertex = pMeshes->GetBaseVertex(mesh);
+
+		uint32_t indexBase = (uint32_t)sourceIndices.size();
+		for (size_t m = 0; m < meshlets.size(); m++)
+		{
+			GPU_MESHLET gpuMeshlet;
+			gpuMeshlet.sphere = meshlets[m].sphere;
+			gpuMeshlet.cone = meshlets[m].cone;
+			gpuMeshlet.firstIndex = indexBase + meshlets[m].firstIndex;
+			gpuMeshlet.indexCount = meshlets[m].indexCount;
+			gpuMeshlet.padding[0] = 0;
+			gpuMeshlet.padding[1] = 0;
+			gpuMeshlets.push_back(gpuMeshlet);
+		}
+		sourceIndices.insert(sourceIndices.end(), indices.begin(), indices.end());
+		std::cout << "INFO: mesh " << mesh << " split into " << meshlets.size() << " meshlets" << std::endl;
+	}
+	if (gpuMeshlets.empty())
+	{
+		glDeleteProgram(m_cullProgram);
+		m_cullProgram = 0;
+		return(false);
+	}
+
+	glGenBuffers(1, &m_meshletBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_meshletBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, gpuMeshlets.size() * sizeof(GPU_MESHLET), &gpuMeshlets[0], GL_STATIC_DRAW);
+	glGenBuffers(1, &m_sourceIndexBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_sourceIndexBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sourceIndices.size() * sizeof(uint32_t), &sourceIndices[0], GL_STATIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	// the per-frame buffers get their storage on first use, the vertex
+	// array keeps the culled index buffer's name across reallocations
+	glGenBuffers(1, &m_drawBuffer);
+	glGenBuffers(1, &m_commandBuffer);
+	glGenBuffers(1, &m_culledIndexBuffer);
+	m_vao = pMeshes->CreateVertexArray(m_culledIndexBuffer);
+
+	return(true);
+}
+
+/***********************************************************
+ *  IsClustered()
+ *
+ *  This method tells whether a draw goes through culling.
+ ***********************************************************/
+bool ClusterCuller::IsClustered(const DRAW_PACKET& packet) const
+{
+	return(packet.bVisible &&
+		(packet.meltParams.z <= 0.0f) &&
+		(m_clusteredMeshes[packet.mesh].meshletCount > 0));
+}
+
+/***********************************************************
+ *  ReserveFrameBuffers()
+ *
+ *  This method grows the per-frame buffers to hold the
+ *  passed in number of draws and culled indices.
+ ***********************************************************/
+void ClusterCuller::ReserveFrameBuffers(size_t drawCount, size_t culledIndexCount)
+{
+	if (drawCount > m_drawCapacity)
+	{
+		m_drawCapacity = drawCount + drawCount / 2;
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_drawBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, m_drawCapacity * sizeof(GPU_DRAW), NULL, GL_STREAM_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_commandBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, m_drawCapacity * sizeof(DRAW_COMMAND), NULL, GL_STREAM_DRAW);
+	}
+	if (culledIndexCount > m_culledIndexCapacity)
+	{
+		m_culledIndexCapacity = culledIndexCount + culledIndexCount / 2;
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_culledIndexBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, m_culledIndexCapacity * sizeof(uint32_t), NULL, GL_STREAM_COPY);
+	}
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+/***********************************************************
+ *  Cull()
+ *
+ *  This method writes the model matrix and an empty command
+ *  of every clustered draw straight into the mapped buffers,
+ *  giving each draw room for all of its mesh's indices, and
+ *  runs the culling pass. The draws must be made after this
+ *  and before the next Cull().
+ ***********************************************************/
+void ClusterCuller::Cull(
+	const DrawList& drawList,
+	const FRAME_STATE& frameState,
+	const FRUSTUM& frustum,
+	int* pCommandIndices)
+{
+	size_t drawCount = 0;
+	size_t culledIndexCount = 0;
+	for (size_t i = 0; i < drawList.Size(); i++)
+	{
+		pCommandIndices[i] = -1;
+		if (IsReady() && IsClustered(drawList[i]))
+		{
+			drawCount++;
+			culledIndexCount += m_clusteredMeshes[drawList[i].mesh].indexCount;
+		}
+	}
+	if (drawCount == 0)
+	{
+		return;
+	}
+	ReserveFrameBuffers(drawCount, culledIndexCount);
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_drawBuffer);
+	GPU_DRAW* pDraws = (GPU_DRAW*)glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, drawCount * sizeof(GPU_DRAW),
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_commandBuffer);
+	DRAW_COMMAND* pCommands = (DRAW_COMMAND*)glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, drawCount * sizeof(DRAW_COMMAND),
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	if ((NULL == pDraws) || (NULL == pCommands))
+	{
+		// nothing was culled, every draw stays whole this frame
+		if (NULL != pCommands)
+		{
+			glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+		}
+		if (NULL != pDraws)
+		{
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_drawBuffer);
+			glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+		}
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		return;
+	}
+
+	int commandIndex = 0;
+	uint32_t firstIndex = 0;
+	for (size_t i = 0; i < drawList.Size(); i++)
+	{
+		const DRAW_PACKET& packet = drawList[i];
+		if (!IsClustered(packet))
+		{
+			continue;
+		}
+		const CLUSTERED_MESH& clusteredMesh = m_clusteredMeshes[packet.mesh];
+
+		GPU_DRAW& draw = pDraws[commandIndex];
+		draw.model = packet.model;
+		draw.firstMeshlet = clusteredMesh.firstMeshlet;
+		draw.meshletCount = clusteredMesh.meshletCount;
+		draw.padding[0] = 0;
+		draw.padding[1] = 0;
+
+		DRAW_COMMAND& command = pCommands[commandIndex];
+		command.count = 0;
+		command.instanceCount = 1;
+		command.firstIndex = firstIndex;
+		command.baseVertex = clusteredMesh.baseVertex;
+		command.baseInstance = 0;
+
+		pCommandIndices[i] = commandIndex;
+		commandIndex++;
+		firstIndex += clusteredMesh.indexCount;
+	}
+	glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_drawBuffer);
+	glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	GLuint previousProgram = GLStateCache::GetProgram();
+	GLStateCache::UseProgram(m_cullProgram);
+	glUniform4fv(m_frustumPlanesLocation, 6, glm::value_ptr(frustum.planes[0]));
+	glUniform3fv(m_viewPositionLocation, 1, glm::value_ptr(frameState.viewPosition));
+	glUniform1ui(m_drawCountLocation, (GLuint)drawCount);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, MESHLET_BINDING, m_meshletBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SOURCE_INDEX_BINDING, m_sourceIndexBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_BINDING, m_drawBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COMMAND_BINDING, m_commandBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CULLED_INDEX_BINDING, m_culledIndexBuffer);
+
+	GLuint groupsX = (GLuint)std::min(drawCount, (size_t)MAX_GROUPS_PER_ROW);
+	GLuint groupsY = (GLuint)((drawCount + MAX_GROUPS_PER_ROW - 1) / MAX_GROUPS_PER_ROW);
+	glDispatchCompute(groupsX, groupsY, 1);
+	// the commands and indices are read by the indirect draws next
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_ELEMENT_ARRAY_BARRIER_BIT);
+
+	GLStateCache::UseProgram(previousProgram);
+}
+
+/***********************************************************
+ *  Draw()
+ *
+ *  This method draws the indices of a draw's visible
+ *  meshlets with the count the culling pass wrote.
+ ***********************************************************/
+void ClusterCuller::Draw(SHAPE_MESH mesh, int commandIndex) const
+{
+	m_pMeshes->SetDecode(mesh);
+	GLStateCache::BindVertexArray(m_vao);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+	glDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (const void*)(commandIndex * sizeof(DRAW_COMMAND)));
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
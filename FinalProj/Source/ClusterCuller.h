@@ -0,0 +1,124 @@
+///////////////////////////////////////////////////////////////////////////////
+// clusterculler.h
+// ============
+// per-meshlet culling of the compact meshes on the GPU
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "CompactMeshes.h"
+#include "DrawList.h"
+#include "FrameState.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  ClusterCuller
+ *
+ *  This class culls the meshlets of the compact meshes in a
+ *  compute pre-pass, so each draw of a finely tessellated
+ *  mesh only submits the triangles that can be seen. Every
+ *  frame, one work group per draw tests the draw's meshlets
+ *  against the view frustum and their normal cones against
+ *  the camera position, copies the indices of the meshlets
+ *  that pass into a compacted index buffer and counts them
+ *  into the draw's indirect command. It needs GL 4.3 compute
+ *  and storage buffers but no mesh shader extension.
+ *
+ *  Melting draws bend their vertices in the vertex shader,
+ *  so their meshlet bounds do not hold and they are drawn
+ *  whole, as are the shadow casters.
+ ***********************************************************/
+class ClusterCuller
+{
+public:
+	// constructor
+	ClusterCuller();
+	// destructor
+	~ClusterCuller();
+
+	// upload the meshlets of the listed meshes, false when compute is missing
+	bool Initialize(const CompactMeshes* pMeshes, const std::vector<int>& meshes);
+	bool IsReady() const { return(m_cullProgram != 0); }
+
+	// cull the meshlets of every draw that can use them and set its
+	// command index in pCommandIndices, -1 for the draws left whole
+	void Cull(
+		const DrawList& drawList,
+		const FRAME_STATE& frameState,
+		const FRUSTUM& frustum,
+		int* pCommandIndices);
+	// draw the culled indices of a draw
+	void Draw(SHAPE_MESH mesh, int commandIndex) const;
+
+private:
+	// storage buffer bindings, after the exposure buffers (0 and 1)
+	static const GLuint MESHLET_BINDING = 3;
+	static const GLuint SOURCE_INDEX_BINDING = 4;
+	static const GLuint DRAW_BINDING = 5;
+	static const GLuint COMMAND_BINDING = 6;
+	static const GLuint CULLED_INDEX_BINDING = 7;
+
+	// meshlets and indices of one mesh in the shared buffers
+	struct CLUSTERED_MESH
+	{
+		uint32_t firstMeshlet;
+		uint32_t meshletCount;
+		uint32_t indexCount;
+		GLint baseVertex;
+	};
+
+	// std430 layouts shared with clusterCullCompute.glsl
+	struct GPU_MESHLET
+	{
+		glm::vec4 sphere;
+		glm::vec4 cone;
+		uint32_t firstIndex;
+		uint32_t indexCount;
+		uint32_t padding[2];
+	};
+	struct GPU_DRAW
+	{
+		glm::mat4 model;
+		uint32_t firstMeshlet;
+		uint32_t meshletCount;
+		uint32_t padding[2];
+	};
+	struct DRAW_COMMAND
+	{
+		uint32_t count;
+		uint32_t instanceCount;
+		uint32_t firstIndex;
+		int32_t baseVertex;
+		uint32_t baseInstance;
+	};
+
+	const CompactMeshes* m_pMeshes;
+	CLUSTERED_MESH m_clusteredMeshes[SHAPE_COUNT];
+	// reads the compact meshes' shared vertices through the culled indices
+	GLuint m_vao;
+
+	GLuint m_cullProgram;
+	GLint m_frustumPlanesLocation;
+	GLint m_viewPositionLocation;
+	GLint m_drawCountLocation;
+
+	GLuint m_meshletBuffer;
+	GLuint m_sourceIndexBuffer;
+	GLuint m_drawBuffer;
+	GLuint m_commandBuffer;
+	GLuint m_culledIndexBuffer;
+	// allocated sizes of the per-frame buffers
+	size_t m_drawCapacity;
+	size_t m_culledIndexCapacity;
+
+	bool IsClustered(const DRAW_PACKET& packet) const;
+	void ReserveFrameBuffers(size_t drawCount, size_t culledIndexCount);
+};
@@ -0,0 +1,746 @@
+///////////////////////////////////////////////////////////////////////////////
+// compactmeshes.cpp
+// ============
+// quantized, cache ordered copies of the basic shape meshes, all kept in
+// one shared vertex and index buffer
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "CompactMeshes.h"
+#include "GLProgram.h"
+#include "GLStateCache.h"
+
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+namespace
+{
+	// vertices the reordering assumes the GPU keeps transformed
+	const int VERTEX_CACHE_SIZE = 32;
+
+	// outputs of captureVertex.glsl in the order of CAPTURED_VERTEX
+	const char* g_CapturedOutputs[] = { "capturedPosition", "capturedNormal", "capturedTexCoord" };
+
+	/***********************************************************
+	 *  VertexScore()
+	 *
+	 *  This function rates how much drawing a triangle through
+	 *  a vertex helps (Forsyth, "Linear-Speed Vertex Cache
+	 *  Optimisation"). Vertices high in the cache and vertices
+	 *  with few triangles left score highest, the last
+	 *  triangle's vertices get a fixed score so the order
+	 *  does not keep zig-zagging.
+	 ***********************************************************/
+	float VertexScore(int cachePosition, int remainingTriangles)
+	{
+		if (remainingTriangles == 0)
+		{
+			return(-1.0f);
+		}
+
+		float score = 0.0f;
+		if (cachePosition >= 0)
+		{
+			if (cachePosition < 3)
+			{
+				score = 0.75f;
+			}
+			else
+			{
+				float scaler = 1.0f - (float)(cachePosition - 3) / (VERTEX_CACHE_SIZE - 3);
+				score = std::pow(scaler, 1.5f);
+			}
+		}
+		score += 2.0f / std::sqrt((float)remainingTriangles);
+		return(score);
+	}
+
+	/***********************************************************
+	 *  AverageCacheMissRatio()
+	 *
+	 *  This function counts the vertex shader runs per triangle
+	 *  with a FIFO cache, 3.0 means no reuse at all.
+	 ***********************************************************/
+	float AverageCacheMissRatio(const std::vector<uint32_t>& indices)
+	{
+		if (indices.empty())
+		{
+			return(0.0f);
+		}
+
+		std::vector<uint32_t> cache;
+		size_t misses = 0;
+		for (size_t i = 0; i < indices.size(); i++)
+		{
+			if (std::find(cache.begin(), cache.end(), indices[i]) == cache.end())
+			{
+				misses++;
+				cache.push_back(indices[i]);
+				if ((int)cache.size() > VERTEX_CACHE_SIZE)
+				{
+					cache.erase(cache.begin());
+				}
+			}
+		}
+		return((float)misses / (indices.size() / 3));
+	}
+
+	/***********************************************************
+	 *  OctEncode()
+	 *
+	 *  This function folds a unit normal onto the octahedron
+	 *  and stores the two coordinates as signed 16 bit values.
+	 ***********************************************************/
+	uint32_t OctEncode(glm::vec3 normal)
+	{
+		float length = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+		if (length <= 0.0f)
+		{
+			return(glm::packSnorm2x16(glm::vec2(0.0f, 0.0f)));
+		}
+		normal /= length;
+
+		glm::vec2 encoded(normal.x, normal.y);
+		if (normal.z < 0.0f)
+		{
+			encoded.x = (1.0f - std::fabs(normal.y)) * ((normal.x >= 0.0f) ? 1.0f : -1.0f);
+			encoded.y = (1.0f - std::fabs(normal.x)) * ((normal.y >= 0.0f) ? 1.0f : -1.0f);
+		}
+		return(glm::packSnorm2x16(encoded));
+	}
+}
+
+/***********************************************************
+ *  CompactMeshes()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+CompactMeshes::CompactMeshes(int meshCount)
+{
+	COMPACT_MESH emptyMesh;
+	emptyMesh.baseVertex = 0;
+	emptyMesh.firstIndex = 0;
+	emptyMesh.indexCount = 0;
+	emptyMesh.positionScale = glm::vec3(1.0f);
+	emptyMesh.positionBias = glm::vec3(0.0f);
+	m_meshes.assign(meshCount, emptyMesh);
+
+	m_vao = 0;
+	m_vertexBuffer = 0;
+	m_indexBuffer = 0;
+	m_indexType = GL_UNSIGNED_SHORT;
+	m_captureProgram = 0;
+	m_bCaptureFailed = false;
+}
+
+/***********************************************************
+ *  ~CompactMeshes()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+CompactMeshes::~CompactMeshes()
+{
+	glDeleteVertexArrays(1, &m_vao);
+	glDeleteBuffers(1, &m_vertexBuffer);
+	glDeleteBuffers(1, &m_indexBuffer);
+	m_vao = 0;
+	m_meshes.clear();
+	glDeleteProgram(m_captureProgram);
+	m_captureProgram = 0;
+}
+
+/***********************************************************
+ *  LoadCaptureProgram()
+ *
+ *  This method builds the capture program on first use.
+ ***********************************************************/
+bool CompactMeshes::LoadCaptureProgram()
+{
+	if ((m_captureProgram == 0) && !m_bCaptureFailed)
+	{
+		m_captureProgram = LoadGLCaptureProgram("captureVertex.glsl", g_CapturedOutputs, 3);
+		m_bCaptureFailed = (m_captureProgram == 0);
+	}
+	return(m_captureProgram != 0);
+}
+
+/***********************************************************
+ *  CaptureMesh()
+ *
+ *  This method runs the draw callback twice with the
+ *  rasterizer off: once to count its triangles and once to
+ *  capture their vertices. The captured triangle soup is
+ *  welded on exact matches, reordered and quantized; it is
+ *  uploaded with the other meshes by Upload().
+ ***********************************************************/
+bool CompactMeshes::CaptureMesh(int mesh, const std::function<void()>& drawMesh)
+{
+	if ((mesh < 0) || (mesh >= (int)m_meshes.size()) || !LoadCaptureProgram())
+	{
+		return(false);
+	}
+
+	GLuint previousProgram = GLStateCache::GetProgram();
+	GLStateCache::UseProgram(m_captureProgram);
+	GLStateCache::SetEnabled(GL_RASTERIZER_DISCARD, true);
+
+	// count the triangles first so the capture buffer fits exactly
+	GLuint query = 0;
+	glGenQueries(1, &query);
+	glBeginQuery(GL_PRIMITIVES_GENERATED, query);
+	drawMesh();
+	glEndQuery(GL_PRIMITIVES_GENERATED);
+	GLuint triangleCount = 0;
+	glGetQueryObjectuiv(query, GL_QUERY_RESULT, &triangleCount);
+
+	std::vector<CAPTURED_VERTEX> captured((size_t)triangleCount * 3);
+	bool bCaptured = false;
+	if (triangleCount > 0)
+	{
+		GLuint captureBuffer = 0;
+		glGenBuffers(1, &captureBuffer);
+		glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, captureBuffer);
+		glBufferData(GL_TRANSFORM_FEEDBACK_BUFFER, captured.size() * sizeof(CAPTURED_VERTEX), NULL, GL_STATIC_READ);
+		glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, captureBuffer);
+
+		glBeginQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN, query);
+		glBeginTransformFeedback(GL_TRIANGLES);
+		drawMesh();
+		glEndTransformFeedback();
+		glEndQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN);
+		GLuint writtenCount = 0;
+		glGetQueryObjectuiv(query, GL_QUERY_RESULT, &writtenCount);
+
+		// line or point draws are rejected while capturing triangles
+		bCaptured = (writtenCount == triangleCount);
+		if (bCaptured)
+		{
+			glGetBufferSubData(GL_TRANSFORM_FEEDBACK_BUFFER, 0, captured.size() * sizeof(CAPTURED_VERTEX), &captured[0]);
+		}
+		glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+		glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, 0);
+		glDeleteBuffers(1, &captureBuffer);
+	}
+	glDeleteQueries(1, &query);
+	GLStateCache::SetEnabled(GL_RASTERIZER_DISCARD, false);
+	GLStateCache::UseProgram(previousProgram);
+
+	if (!bCaptured)
+	{
+		std::cout << "ERROR: could not capture mesh " << mesh << ", it keeps its float vertices" << std::endl;
+		return(false);
+	}
+
+	// weld identical vertices and drop the triangles strips degenerate into
+	std::vector<CAPTURED_VERTEX> vertices;
+	std::vector<uint32_t> indices;
+	std::unordered_map<std::string, uint32_t> welded;
+	for (size_t triangle = 0; triangle < triangleCount; triangle++)
+	{
+		uint32_t corners[3];
+		for (int corner = 0; corner < 3; corner++)
+		{
+			const CAPTURED_VERTEX& vertex = captured[triangle * 3 + corner];
+			std::string key((const char*)&vertex, sizeof(CAPTURED_VERTEX));
+			std::unordered_map<std::string, uint32_t>::iterator found = welded.find(key);
+			if (found == welded.end())
+			{
+				found = welded.insert(std::make_pair(key, (uint32_t)vertices.size())).first;
+				vertices.push_back(vertex);
+			}
+			corners[corner] = found->second;
+		}
+		if ((corners[0] != corners[1]) && (corners[1] != corners[2]) && (corners[0] != corners[2]))
+		{
+			indices.insert(indices.end(), corners, corners + 3);
+		}
+	}
+
+	float missRatioBefore = AverageCacheMissRatio(indices);
+	OptimizeVertexCache(indices, vertices.size());
+
+	// renumber the vertices in the order the triangles first use them
+	std::vector<uint32_t> remap(vertices.size(), UINT32_MAX);
+	std::vector<CAPTURED_VERTEX> ordered;
+	ordered.reserve(vertices.size());
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+		if (remap[indices[i]] == UINT32_MAX)
+		{
+			remap[indices[i]] = (uint32_t)ordered.size();
+			ordered.push_back(vertices[indices[i]]);
+		}
+		indices[i] = remap[indices[i]];
+	}
+
+	std::cout << "INFO: compact mesh " << mesh << ": " << ordered.size() << " vertices, "
+		<< indices.size() / 3 << " triangles, cache misses per triangle "
+		<< missRatioBefore << " -> " << AverageCacheMissRatio(indices) << std::endl;
+
+	Quantize(m_meshes[mesh], ordered);
+	m_meshes[mesh].indices.swap(indices);
+	BuildMeshlets(m_meshes[mesh], ordered);
+	return(true);
+}
+
+/***********************************************************
+ *  BuildMeshlets()
+ *
+ *  This method walks the cache ordered triangles and closes
+ *  a meshlet whenever the next triangle would go over the
+ *  vertex or triangle limit. Each meshlet gets a bounding
+ *  sphere and the cone holding its face normals, which are
+ *  taken from the positions and flipped to agree with the
+ *  vertex normals so the winding does not matter.
+ ***********************************************************/
+void CompactMeshes::BuildMeshlets(COMPACT_MESH& mesh, const std::vector<CAPTURED_VERTEX>& vertices)
+{
+	mesh.meshlets.clear();
+	const std::vector<uint32_t>& indices = mesh.indices;
+
+	std::vector<uint32_t> meshletVertices;
+	size_t firstIndex = 0;
+	for (size_t index = 0; index <= indices.size(); index += 3)
+	{
+		bool bLast = (index == indices.size());
+		if (!bLast)
+		{
+			int newVertices = 0;
+			for (int corner = 0; corner < 3; corner++)
+			{
+				if (std::find(meshletVertices.begin(), meshletVertices.end(), indices[index + corner]) == meshletVertices.end())
+				{
+					newVertices++;
+				}
+			}
+			bool bFull = ((int)meshletVertices.size() + newVertices > MESHLET_VERTICES) ||
+				((int)(index - firstIndex) / 3 >= MESHLET_TRIANGLES);
+			if (!bFull)
+			{
+				for (int corner = 0; corner < 3; corner++)
+				{
+					if (std::find(meshletVertices.begin(), meshletVertices.end(), indices[index + corner]) == meshletVertices.end())
+					{
+						meshletVertices.push_back(indices[index + corner]);
+					}
+				}
+				continue;
+			}
+		}
+		if (meshletVertices.empty())
+		{
+			break;
+		}
+
+		// close the meshlet holding the indices [firstIndex, index)
+		MESHLET meshlet;
+		meshlet.firstIndex = (uint32_t)firstIndex;
+		meshlet.indexCount = (uint32_t)(index - firstIndex);
+
+		glm::vec3 minimum = vertices[meshletVertices[0]].position;
+		glm::vec3 maximum = minimum;
+		for (size_t i = 1; i < meshletVertices.size(); i++)
+		{
+			minimum = glm::min(minimum, vertices[meshletVertices[i]].position);
+			maximum = glm::max(maximum, vertices[meshletVertices[i]].position);
+		}
+		glm::vec3 center = (minimum + maximum) * 0.5f;
+		float radius = 0.0f;
+		for (size_t i = 0; i < meshletVertices.size(); i++)
+		{
+			radius = std::max(radius, glm::length(vertices[meshletVertices[i]].position - center));
+		}
+		meshlet.sphere = glm::vec4(center, radius);
+
+		std::vector<glm::vec3> faceNormals;
+		glm::vec3 axis(0.0f);
+		for (size_t i = firstIndex; i < index; i += 3)
+		{
+			const CAPTURED_VERTEX& a = vertices[indices[i]];
+			const CAPTURED_VERTEX& b = vertices[indices[i + 1]];
+			const CAPTURED_VERTEX& c = vertices[indices[i + 2]];
+			glm::vec3 normal = glm::cross(b.position - a.position, c.position - a.position);
+			float length = glm::length(normal);
+			if (length <= 0.0f)
+			{
+				continue;
+			}
+			normal = normal / length;
+			if (glm::dot(normal, a.normal + b.normal + c.normal) < 0.0f)
+			{
+				normal = -normal;
+			}
+			faceNormals.push_back(normal);
+			axis += normal;
+		}
+
+		// the cone test culls when the view direction lies inside the
+		// cone widened by 90 degrees, sin of the half angle is its cutoff
+		meshlet.cone = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+		if (!faceNormals.empty() && (glm::length(axis) > 0.0f))
+		{
+			axis = glm::normalize(axis);
+			float minimumDot = 1.0f;
+			for (size_t i = 0; i < faceNormals.size(); i++)
+			{
+				minimumDot = std::min(minimumDot, glm::dot(axis, faceNormals[i]));
+			}
+			if (minimumDot > 0.0f)
+			{
+				meshlet.cone = glm::vec4(axis, std::sqrt(1.0f - minimumDot * minimumDot));
+			}
+		}
+		mesh.meshlets.push_back(meshlet);
+
+		firstIndex = index;
+		meshletVertices.clear();
+		if (!bLast)
+		{
+			// the triangle that did not fit starts the next meshlet
+			index -= 3;
+		}
+	}
+}
+
+/***********************************************************
+ *  OptimizeVertexCache()
+ *
+ *  This method reorders the triangles so consecutive ones
+ *  share vertices still in the post-transform cache. It
+ *  greedily emits the best scoring triangle next to the
+ *  simulated cache, and only scans all triangles when none
+ *  of the cached vertices has a triangle left.
+ ***********************************************************/
+void CompactMeshes::OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount)
+{
+	size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	// triangles of every vertex, the first remaining[v] are not yet drawn
+	std::vector<int> remaining(vertexCount, 0);
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+		remaining[indices[i]]++;
+	}
+	std::vector<int> firstTriangle(vertexCount + 1, 0);
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		firstTriangle[v + 1] = firstTriangle[v] + remaining[v];
+	}
+	std::vector<int> vertexTriangles(indices.size());
+	std::vector<int> fill(firstTriangle.begin(), firstTriangle.end() - 1);
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+		vertexTriangles[fill[indices[i]]++] = (int)(i / 3);
+	}
+
+	std::vector<int> cachePosition(vertexCount, -1);
+	std::vector<float> vertexScore(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		vertexScore[v] = VertexScore(-1, remaining[v]);
+	}
+	std::vector<float> triangleScore(triangleCount);
+	std::vector<bool> bEmitted(triangleCount, false);
+	for (size_t t = 0; t < triangleCount; t++)
+	{
+		triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+	}
+
+	std::vector<uint32_t> output;
+	output.reserve(indices.size());
+	std::vector<uint32_t> cache;
+	std::vector<uint32_t> newCache;
+	int bestTriangle = -1;
+
+	while (output.size() < indices.size())
+	{
+		if (bestTriangle < 0)
+		{
+			float bestScore = -1.0f;
+			for (size_t t = 0; t < triangleCount; t++)
+			{
+				if (!bEmitted[t] && (triangleScore[t] > bestScore))
+				{
+					bestScore = triangleScore[t];
+					bestTriangle = (int)t;
+				}
+			}
+		}
+
+		// draw the triangle and take it off its vertices' lists
+		bEmitted[bestTriangle] = true;
+		newCache.clear();
+		for (int corner = 0; corner < 3; corner++)
+		{
+			uint32_t vertex = indices[bestTriangle * 3 + corner];
+			output.push_back(vertex);
+			newCache.push_back(vertex);
+
+			int* pTriangles = &vertexTriangles[firstTriangle[vertex]];
+			for (int i = 0; i < remaining[vertex]; i++)
+			{
+				if (pTriangles[i] == bestTriangle)
+				{
+					std::swap(pTriangles[i], pTriangles[remaining[vertex] - 1]);
+					break;
+				}
+			}
+			remaining[vertex]--;
+		}
+
+		// the drawn vertices move to the front of the LRU cache
+		for (size_t i = 0; i < cache.size(); i++)
+		{
+			if (std::find(newCache.begin(), newCache.begin() + 3, cache[i]) == newCache.begin() + 3)
+			{
+				newCache.push_back(cache[i]);
+			}
+		}
+		for (size_t i = 0; i < newCache.size(); i++)
+		{
+			uint32_t vertex = newCache[i];
+			cachePosition[vertex] = ((int)i < VERTEX_CACHE_SIZE) ? (int)i : -1;
+			vertexScore[vertex] = VertexScore(cachePosition[vertex], remaining[vertex]);
+		}
+		if ((int)newCache.size() > VERTEX_CACHE_SIZE)
+		{
+			newCache.resize(VERTEX_CACHE_SIZE);
+		}
+		cache.swap(newCache);
+
+		// only triangles of the cached vertices changed their score
+		bestTriangle = -1;
+		float bestScore = -1.0f;
+		for (size_t i = 0; i < cache.size(); i++)
+		{
+			uint32_t vertex = cache[i];
+			const int* pTriangles = &vertexTriangles[firstTriangle[vertex]];
+			for (int j = 0; j < remaining[vertex]; j++)
+			{
+				int triangle = pTriangles[j];
+				triangleScore[triangle] = vertexScore[indices[triangle * 3]] +
+					vertexScore[indices[triangle * 3 + 1]] +
+					vertexScore[indices[triangle * 3 + 2]];
+				if (triangleScore[triangle] > bestScore)
+				{
+					bestScore = triangleScore[triangle];
+					bestTriangle = triangle;
+				}
+			}
+		}
+	}
+
+	indices.swap(output);
+}
+
+/***********************************************************
+ *  Quantize()
+ *
+ *  This method packs the vertices into compact vertices
+ *  against the mesh bounds.
+ ***********************************************************/
+void CompactMeshes::Quantize(COMPACT_MESH& mesh, const std::vector<CAPTURED_VERTEX>& vertices)
+{
+	glm::vec3 minimum = vertices[0].position;
+	glm::vec3 maximum = vertices[0].position;
+	for (size_t i = 1; i < vertices.size(); i++)
+	{
+		minimum = glm::min(minimum, vertices[i].position);
+		maximum = glm::max(maximum, vertices[i].position);
+	}
+	mesh.positionBias = minimum;
+	mesh.positionScale = maximum - minimum;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		// a flat mesh has no extent on one axis, any scale works there
+		if (mesh.positionScale[axis] <= 0.0f)
+		{
+			mesh.positionScale[axis] = 1.0f;
+		}
+	}
+
+	std::vector<COMPACT_VERTEX>& packed = mesh.vertices;
+	packed.resize(vertices.size());
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		glm::vec3 fraction = (vertices[i].position - mesh.positionBias) / mesh.positionScale;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			float clamped = std::min(std::max(fraction[axis], 0.0f), 1.0f);
+			packed[i].position[axis] = (uint16_t)(clamped * 65535.0f + 0.5f);
+		}
+		packed[i].padding = 0;
+		packed[i].normal = OctEncode(vertices[i].normal);
+		packed[i].texCoord = glm::packHalf2x16(vertices[i].texCoord);
+	}
+}
+
+/***********************************************************
+ *  Upload()
+ *
+ *  This method appends the vertices and indices of every
+ *  captured mesh to one vertex and one index buffer. The
+ *  indices stay relative to their mesh, which is drawn with
+ *  its first vertex as the base vertex, so they fit in 16
+ *  bits whenever no single mesh has more vertices than that.
+ ***********************************************************/
+bool CompactMeshes::Upload()
+{
+	std::vector<COMPACT_VERTEX> vertices;
+	std::vector<uint32_t> indices;
+	bool bShortIndices = true;
+	for (size_t i = 0; i < m_meshes.size(); i++)
+	{
+		COMPACT_MESH& mesh = m_meshes[i];
+		mesh.baseVertex = (GLint)vertices.size();
+		mesh.firstIndex = (GLsizei)indices.size();
+		mesh.indexCount = (GLsizei)mesh.indices.size();
+		vertices.insert(vertices.end(), mesh.vertices.begin(), mesh.vertices.end());
+		indices.insert(indices.end(), mesh.indices.begin(), mesh.indices.end());
+		bShortIndices = bShortIndices && (mesh.vertices.size() <= 0xFFFF);
+		std::vector<COMPACT_VERTEX>().swap(mesh.vertices);
+	}
+	if (indices.empty())
+	{
+		return(false);
+	}
+
+	glGenVertexArrays(1, &m_vao);
+	GLStateCache::BindVertexArray(m_vao);
+
+	glGenBuffers(1, &m_vertexBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(COMPACT_VERTEX), &vertices[0], GL_STATIC_DRAW);
+
+	glGenBuffers(1, &m_indexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+	if (bShortIndices)
+	{
+		std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, shortIndices.size() * sizeof(uint16_t), &shortIndices[0], GL_STATIC_DRAW);
+		m_indexType = GL_UNSIGNED_SHORT;
+	}
+	else
+	{
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), &indices[0], GL_STATIC_DRAW);
+		m_indexType = GL_UNSIGNED_INT;
+	}
+
+	SetVertexFormat(m_vertexBuffer);
+	GLStateCache::BindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	std::cout << "INFO: compact meshes share " << vertices.size() << " vertices and "
+		<< indices.size() << " indices" << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  SetVertexFormat()
+ *
+ *  This method points the attributes of the bound vertex
+ *  array at a buffer of compact vertices.
+ ***********************************************************/
+void CompactMeshes::SetVertexFormat(GLuint vertexBuffer)
+{
+	GLsizei stride = sizeof(COMPACT_VERTEX);
+	glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+	glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride, (void*)offsetof(COMPACT_VERTEX, position));
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, stride, (void*)offsetof(COMPACT_VERTEX, normal));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)offsetof(COMPACT_VERTEX, texCoord));
+	glEnableVertexAttribArray(2);
+}
+
+/***********************************************************
+ *  CreateVertexArray()
+ *
+ *  This method creates a vertex array that reads the shared
+ *  vertices through another index buffer. The caller owns
+ *  the returned vertex array.
+ ***********************************************************/
+GLuint CompactMeshes::CreateVertexArray(GLuint indexBuffer) const
+{
+	if (m_vao == 0)
+	{
+		return(0);
+	}
+
+	GLuint vao = 0;
+	glGenVertexArrays(1, &vao);
+	GLStateCache::BindVertexArray(vao);
+	SetVertexFormat(m_vertexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+	GLStateCache::BindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	return(vao);
+}
+
+/***********************************************************
+ *  IsReady()
+ *
+ *  This method tells whether a mesh has a compact copy.
+ ***********************************************************/
+bool CompactMeshes::IsReady(int mesh) const
+{
+	return((m_vao != 0) && (mesh >= 0) && (mesh < (int)m_meshes.size()) && (m_meshes[mesh].indexCount > 0));
+}
+
+/***********************************************************
+ *  Draw()
+ *
+ *  This method draws a compact mesh. The decode constants
+ *  are current vertex attribute values, which belong to the
+ *  context, so they reach whichever program is in use.
+ ***********************************************************/
+void CompactMeshes::Draw(int mesh, int instanceCount) const
+{
+	const COMPACT_MESH& compactMesh = m_meshes[mesh];
+	SetDecode(mesh);
+
+	// every mesh lives in the shared buffers, the vertex array is
+	// only bound by the first compact draw after other geometry
+	GLStateCache::BindVertexArray(m_vao);
+	size_t indexSize = (m_indexType == GL_UNSIGNED_SHORT) ? sizeof(uint16_t) : sizeof(uint32_t);
+	glDrawElementsInstancedBaseVertex(GL_TRIANGLES, compactMesh.indexCount, m_indexType,
+		(const void*)(compactMesh.firstIndex * indexSize), instanceCount, compactMesh.baseVertex);
+}
+
+/***********************************************************
+ *  SetDecode()
+ *
+ *  This method sets the decode constants of a compact mesh.
+ ***********************************************************/
+void CompactMeshes::SetDecode(int mesh) const
+{
+	const COMPACT_MESH& compactMesh = m_meshes[mesh];
+	glVertexAttrib4f(DECODE_SCALE_LOCATION,
+		compactMesh.positionScale.x, compactMesh.positionScale.y, compactMesh.positionScale.z, 1.0f);
+	glVertexAttrib3f(DECODE_BIAS_LOCATION,
+		compactMesh.positionBias.x, compactMesh.positionBias.y, compactMesh.positionBias.z);
+}
+
+/***********************************************************
+ *  SetFullFloatDecode()
+ *
+ *  This method sets the decode constants for a mesh drawn
+ *  with float positions and normals.
+ ***********************************************************/
+void CompactMeshes::SetFullFloatDecode()
+{
+	glVertexAttrib4f(DECODE_SCALE_LOCATION, 1.0f, 1.0f, 1.0f, 0.0f);
+	glVertexAttrib3f(DECODE_BIAS_LOCATION, 0.0f, 0.0f, 0.0f);
+}
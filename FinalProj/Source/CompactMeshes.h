@@ -0,0 +1,149 @@
+///////////////////////////////////////////////////////////////////////////////
+// compactmeshes.h
+// ============
+// quantized, cache ordered copies of the basic shape meshes, all kept in
+// one shared vertex and index buffer
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/***********************************************************
+ *  CompactMeshes
+ *
+ *  This class captures the triangles a mesh draw produces
+ *  with transform feedback, welds them back into indexed
+ *  vertices and stores them in a 16 byte vertex instead of
+ *  the 32 byte float one:
+ *
+ *    position   3 x 16 bit fractions of the mesh bounds
+ *    normal     2 x 16 bit octahedral encoding
+ *    texcoord   2 x 16 bit half floats
+ *
+ *  The triangles are reordered for the post-transform vertex
+ *  cache and the vertices for fetch locality, then split in
+ *  that order into meshlets with their own culling bounds
+ *  (see ClusterCuller). Once every mesh is captured, Upload()
+ *  packs them all into one vertex buffer and one index
+ *  buffer behind a single vertex array; each mesh is drawn
+ *  from its first index and base vertex, so moving between
+ *  meshes rebinds nothing. The decode
+ *  constants go to every program as constant values of the
+ *  attributes at DECODE_SCALE_LOCATION and
+ *  DECODE_BIAS_LOCATION, so the scene and shadow shaders
+ *  need no per-mesh uniforms. Meshes drawn with their float
+ *  vertices must call SetFullFloatDecode() first.
+ ***********************************************************/
+class CompactMeshes
+{
+public:
+	// generic attributes holding the decode constants of the drawn mesh
+	static const GLuint DECODE_SCALE_LOCATION = 3;
+	static const GLuint DECODE_BIAS_LOCATION = 4;
+	// meshlet size limits
+	static const int MESHLET_VERTICES = 64;
+	static const int MESHLET_TRIANGLES = 124;
+
+	// a contiguous run of a compact mesh's indices and its bounds
+	struct MESHLET
+	{
+		glm::vec4 sphere;  // object space center and radius
+		glm::vec4 cone;    // normal cone axis and cutoff, a cutoff of 1 never culls
+		uint32_t firstIndex;
+		uint32_t indexCount;
+	};
+
+	// constructor
+	CompactMeshes(int meshCount);
+	// destructor
+	~CompactMeshes();
+
+	// build a compact copy of whatever the draw callback draws with
+	// the position, normal and texcoord attributes at 0, 1 and 2
+	bool CaptureMesh(int mesh, const std::function<void()>& drawMesh);
+	// pack the captured meshes into the shared buffers
+	bool Upload();
+	bool IsReady(int mesh) const;
+	// set the decode constants of a compact mesh and draw it, as
+	// many instances as asked for
+	void Draw(int mesh, int instanceCount = 1) const;
+	// decode constants that pass float vertices through unchanged
+	static void SetFullFloatDecode();
+	// decode constants of a compact mesh, for draws made elsewhere
+	void SetDecode(int mesh) const;
+
+	const std::vector<MESHLET>& GetMeshlets(int mesh) const { return(m_meshes[mesh].meshlets); }
+	// indices of a mesh, relative to its base vertex
+	const std::vector<uint32_t>& GetIndices(int mesh) const { return(m_meshes[mesh].indices); }
+	GLint GetBaseVertex(int mesh) const { return(m_meshes[mesh].baseVertex); }
+	// vertex array with the shared vertices and another index buffer
+	GLuint CreateVertexArray(GLuint indexBuffer) const;
+	// the shared buffers and a mesh's part of them, for draws that
+	// read the vertices themselves
+	GLuint GetVertexBuffer() const { return(m_vertexBuffer); }
+	GLuint GetIndexBuffer() const { return(m_indexBuffer); }
+	GLenum GetIndexType() const { return(m_indexType); }
+	GLsizei GetFirstIndex(int mesh) const { return(m_meshes[mesh].firstIndex); }
+	GLsizei GetIndexCount(int mesh) const { return(m_meshes[mesh].indexCount); }
+	const glm::vec3& GetPositionScale(int mesh) const { return(m_meshes[mesh].positionScale); }
+	const glm::vec3& GetPositionBias(int mesh) const { return(m_meshes[mesh].positionBias); }
+
+	// the CPU steps of CaptureMesh() and what they work on, public
+	// so the tests and benchmarks can run them without a context
+	struct COMPACT_VERTEX
+	{
+		uint16_t position[3];
+		uint16_t padding;
+		uint32_t normal;
+		uint32_t texCoord;
+	};
+
+	// one mesh's part of the shared buffers
+	struct COMPACT_MESH
+	{
+		GLint baseVertex;
+		GLsizei firstIndex;
+		GLsizei indexCount;
+		glm::vec3 positionScale;
+		glm::vec3 positionBias;
+		// released once they are in the shared vertex buffer
+		std::vector<COMPACT_VERTEX> vertices;
+		// kept for the cluster culling, which reads them on the GPU
+		std::vector<uint32_t> indices;
+		std::vector<MESHLET> meshlets;
+	};
+
+	// one captured vertex, laid out like the capture shader outputs
+	struct CAPTURED_VERTEX
+	{
+		glm::vec3 position;
+		glm::vec3 normal;
+		glm::vec2 texCoord;
+	};
+
+	static void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount);
+	static void BuildMeshlets(COMPACT_MESH& mesh, const std::vector<CAPTURED_VERTEX>& vertices);
+	static void Quantize(COMPACT_MESH& mesh, const std::vector<CAPTURED_VERTEX>& vertices);
+
+private:
+	std::vector<COMPACT_MESH> m_meshes;
+	GLuint m_vao;
+	GLuint m_vertexBuffer;
+	GLuint m_indexBuffer;
+	// 16 bit when every mesh has few enough vertices
+	GLenum m_indexType;
+	GLuint m_captureProgram;
+	bool m_bCaptureFailed;
+
+	bool LoadCaptureProgram();
+	static void SetVertexFormat(GLuint vertexBuffer);
+};
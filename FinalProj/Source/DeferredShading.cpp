@@ -0,0 +1,354 @@
+///////////////////////////////////////////////////////////////////////////////
+// deferredshading.cpp
+// ============
+// G-buffer and tiled compute lighting of the opaque scene
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "DeferredShading.h"
+#include "GLProgram.h"
+#include "GLStateCache.h"
+#include "MaterialTable.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <iostream>
+
+namespace
+{
+	// must match the work group size of deferredLightingCompute.glsl
+	const int TILE_SIZE = 16;
+	// above the scene textures and below the transparency targets (12,
+	// 13), must match the sampler bindings in the lighting shader
+	const int ALBEDO_TEXTURE_UNIT = 8;
+	const int NORMAL_TEXTURE_UNIT = 9;
+	const int MATERIAL_TEXTURE_UNIT = 10;
+	const int DEPTH_TEXTURE_UNIT = 11;
+	const int SHADOW_TEXTURE_UNIT = 15;
+	// image unit of the scene color the pass writes
+	const int COLOR_IMAGE_UNIT = 0;
+}
+
+/***********************************************************
+ *  DeferredShading()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+DeferredShading::DeferredShading()
+{
+	m_renderWidth = 0;
+	m_renderHeight = 0;
+	m_framebuffer = 0;
+	m_albedoTexture = 0;
+	m_normalTexture = 0;
+	m_materialTexture = 0;
+	m_depthTexture = 0;
+	m_colorTexture = 0;
+	m_sceneFramebuffer = 0;
+	m_program = 0;
+	m_imageSizeLocation = -1;
+	m_viewCountLocation = -1;
+	m_inverseViewProjectionsLocation = -1;
+	m_viewRectanglesLocation = -1;
+	m_viewPositionsLocation = -1;
+	m_viewLocation = -1;
+	m_lightCountLocation = -1;
+	m_keyLightLocation = -1;
+	m_lightPositionsLocation = -1;
+	m_lightAmbientColorsLocation = -1;
+	m_lightDiffuseColorsLocation = -1;
+	m_lightSpecularColorsLocation = -1;
+	m_lightSpecularIntensitiesLocation = -1;
+	m_useShadowsLocation = -1;
+	m_lightSpaceMatricesLocation = -1;
+	m_cascadeSplitsLocation = -1;
+	m_cascadeCountLocation = -1;
+}
+
+/***********************************************************
+ *  ~DeferredShading()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+DeferredShading::~DeferredShading()
+{
+	DestroyTargets();
+	glDeleteProgram(m_program);
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method loads the lighting program and connects it
+ *  to the material table.
+ ***********************************************************/
+bool DeferredShading::Initialize()
+{
+	m_program = LoadGLComputeProgram("deferredLightingCompute.glsl");
+	if (m_program == 0)
+	{
+		return(false);
+	}
+	MaterialTable::BindProgram(m_program);
+
+	m_imageSizeLocation = glGetUniformLocation(m_program, "imageSize");
+	m_viewCountLocation = glGetUniformLocation(m_program, "viewCount");
+	m_inverseViewProjectionsLocation = glGetUniformLocation(m_program, "inverseViewProjections");
+	m_viewRectanglesLocation = glGetUniformLocation(m_program, "viewRectangles");
+	m_viewPositionsLocation = glGetUniformLocation(m_program, "viewPositions");
+	m_viewLocation = glGetUniformLocation(m_program, "view");
+	m_lightCountLocation = glGetUniformLocation(m_program, "lightCount");
+	m_keyLightLocation = glGetUniformLocation(m_program, "keyLight");
+	m_lightPositionsLocation = glGetUniformLocation(m_program, "lightPositions");
+	m_lightAmbientColorsLocation = glGetUniformLocation(m_program, "lightAmbientColors");
+	m_lightDiffuseColorsLocation = glGetUniformLocation(m_program, "lightDiffuseColors");
+	m_lightSpecularColorsLocation = glGetUniformLocation(m_program, "lightSpecularColors");
+	m_lightSpecularIntensitiesLocation = glGetUniformLocation(m_program, "lightSpecularIntensities");
+	m_useShadowsLocation = glGetUniformLocation(m_program, "bUseShadows");
+	m_lightSpaceMatricesLocation = glGetUniformLocation(m_program, "lightSpaceMatrices");
+	m_cascadeSplitsLocation = glGetUniformLocation(m_program, "cascadeSplits");
+	m_cascadeCountLocation = glGetUniformLocation(m_program, "cascadeCount");
+
+	// no lights until they are set
+	GLuint previousProgram = GLStateCache::GetProgram();
+	GLStateCache::UseProgram(m_program);
+	glUniform1i(m_lightCountLocation, 0);
+	glUniform1i(m_keyLightLocation, -1);
+	GLStateCache::UseProgram(previousProgram);
+	return(true);
+}
+
+/***********************************************************
+ *  CreateTargets()
+ *
+ *  This method creates the albedo, normal and material
+ *  textures and a framebuffer that draws into them with
+ *  the depth texture of the scene.
+ ***********************************************************/
+bool DeferredShading::CreateTargets(int width, int height, GLuint depthTexture, GLuint colorTexture, GLuint sceneFramebuffer)
+{
+	DestroyTargets();
+	if (m_program == 0)
+	{
+		return(false);
+	}
+	m_depthTexture = depthTexture;
+	m_colorTexture = colorTexture;
+	m_sceneFramebuffer = sceneFramebuffer;
+	m_renderWidth = width;
+	m_renderHeight = height;
+
+	glGenTextures(1, &m_albedoTexture);
+	GLStateCache::BindTexture(0, GL_TEXTURE_2D, m_albedoTexture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	glGenTextures(1, &m_normalTexture);
+	GLStateCache::BindTexture(0, GL_TEXTURE_2D, m_normalTexture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_RG16F, width, height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	// integer textures cannot be filtered
+	glGenTextures(1, &m_materialTexture);
+	GLStateCache::BindTexture(0, GL_TEXTURE_2D, m_materialTexture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8UI, width, height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	GLStateCache::BindTexture(0, GL_TEXTURE_2D, 0);
+
+	glGenFramebuffers(1, &m_framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_albedoTexture, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, m_normalTexture, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, m_materialTexture, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+	const GLenum drawBuffers[3] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+	glDrawBuffers(3, drawBuffers);
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "ERROR: G-buffer framebuffer is incomplete" << std::endl;
+		DestroyTargets();
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  DestroyTargets()
+ *
+ *  This method releases the G-buffer, the depth and color
+ *  textures belong to the scene target.
+ ***********************************************************/
+void DeferredShading::DestroyTargets()
+{
+	glDeleteFramebuffers(1, &m_framebuffer);
+	GLStateCache::DeleteTexture(m_albedoTexture);
+	GLStateCache::DeleteTexture(m_normalTexture);
+	GLStateCache::DeleteTexture(m_materialTexture);
+	m_framebuffer = 0;
+	m_albedoTexture = 0;
+	m_normalTexture = 0;
+	m_materialTexture = 0;
+	m_depthTexture = 0;
+	m_colorTexture = 0;
+	m_sceneFramebuffer = 0;
+}
+
+/***********************************************************
+ *  SetLights()
+ *
+ *  This method uploads the lights into the lighting
+ *  program. Lights without any color are dropped, the key
+ *  light keeps its shadows wherever it ends up.
+ ***********************************************************/
+void DeferredShading::SetLights(const LIGHT_SOURCE* pLights, int count)
+{
+	if (m_program == 0)
+	{
+		return;
+	}
+
+	glm::vec3 positions[MAX_LIGHTS];
+	glm::vec3 ambientColors[MAX_LIGHTS];
+	glm::vec3 diffuseColors[MAX_LIGHTS];
+	glm::vec3 specularColors[MAX_LIGHTS];
+	float specularIntensities[MAX_LIGHTS];
+	int lightCount = 0;
+	int keyLight = -1;
+	for (int i = 0; (i < count) && (lightCount < MAX_LIGHTS); i++)
+	{
+		const LIGHT_SOURCE& light = pLights[i];
+		glm::vec3 specular = light.specularColor * light.specularIntensity;
+		bool bDark = (light.ambientColor == glm::vec3(0.0f)) &&
+			(light.diffuseColor == glm::vec3(0.0f)) &&
+			(specular == glm::vec3(0.0f));
+		if (bDark)
+		{
+			continue;
+		}
+		if (i == 0)
+		{
+			keyLight = lightCount;
+		}
+		positions[lightCount] = light.position;
+		ambientColors[lightCount] = light.ambientColor;
+		diffuseColors[lightCount] = light.diffuseColor;
+		specularColors[lightCount] = light.specularColor;
+		specularIntensities[lightCount] = light.specularIntensity;
+		lightCount++;
+	}
+
+	GLuint previousProgram = GLStateCache::GetProgram();
+	GLStateCache::UseProgram(m_program);
+	glUniform1i(m_lightCountLocation, lightCount);
+	glUniform1i(m_keyLightLocation, keyLight);
+	if (lightCount > 0)
+	{
+		glUniform3fv(m_lightPositionsLocation, lightCount, glm::value_ptr(positions[0]));
+		glUniform3fv(m_lightAmbientColorsLocation, lightCount, glm::value_ptr(ambientColors[0]));
+		glUniform3fv(m_lightDiffuseColorsLocation, lightCount, glm::value_ptr(diffuseColors[0]));
+		glUniform3fv(m_lightSpecularColorsLocation, lightCount, glm::value_ptr(specularColors[0]));
+		glUniform1fv(m_lightSpecularIntensitiesLocation, lightCount, specularIntensities);
+	}
+	GLStateCache::UseProgram(previousProgram);
+}
+
+/***********************************************************
+ *  SetRenderSize()
+ *
+ *  This method sets the part of the targets the lighting
+ *  pass covers, it follows the render scale of the scene.
+ ***********************************************************/
+void DeferredShading::SetRenderSize(int width, int height)
+{
+	m_renderWidth = width;
+	m_renderHeight = height;
+}
+
+/***********************************************************
+ *  BeginGeometry()
+ *
+ *  This method binds the G-buffer. Its textures are never
+ *  cleared, the lighting pass skips every pixel the draws
+ *  left at the cleared depth. The viewport is left as the
+ *  scene set it.
+ ***********************************************************/
+void DeferredShading::BeginGeometry()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+}
+
+/***********************************************************
+ *  Light()
+ *
+ *  This method lights the G-buffer in one dispatch over the
+ *  rendered part of the targets, with the views and the
+ *  shadow cascades of the frame.
+ ***********************************************************/
+void DeferredShading::Light(const FRAME_STATE& frameState, const ShadowMaps* pShadowMaps)
+{
+	GLuint previousProgram = GLStateCache::GetProgram();
+	glBindFramebuffer(GL_FRAMEBUFFER, m_sceneFramebuffer);
+
+	GLStateCache::BindTexture(ALBEDO_TEXTURE_UNIT, GL_TEXTURE_2D, m_albedoTexture);
+	GLStateCache::BindTexture(NORMAL_TEXTURE_UNIT, GL_TEXTURE_2D, m_normalTexture);
+	GLStateCache::BindTexture(MATERIAL_TEXTURE_UNIT, GL_TEXTURE_2D, m_materialTexture);
+	GLStateCache::BindTexture(DEPTH_TEXTURE_UNIT, GL_TEXTURE_2D, m_depthTexture);
+	glBindImageTexture(COLOR_IMAGE_UNIT, m_colorTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+	GLStateCache::UseProgram(m_program);
+
+	// a frame with one view covers the whole target with the camera
+	glm::mat4 inverseViewProjections[MAX_FRAME_VIEWS];
+	glm::vec4 viewRectangles[MAX_FRAME_VIEWS];
+	glm::vec3 viewPositions[MAX_FRAME_VIEWS];
+	int viewCount = 1;
+	if (frameState.viewCount > 1)
+	{
+		viewCount = frameState.viewCount;
+		for (int view = 0; view < viewCount; view++)
+		{
+			inverseViewProjections[view] = glm::inverse(frameState.views[view].viewProjection);
+			viewRectangles[view] = frameState.views[view].rectangle;
+			viewPositions[view] = frameState.views[view].viewPosition;
+		}
+	}
+	else
+	{
+		inverseViewProjections[0] = glm::inverse(frameState.viewProjection);
+		viewRectangles[0] = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+		viewPositions[0] = frameState.viewPosition;
+	}
+	glUniform2i(m_imageSizeLocation, m_renderWidth, m_renderHeight);
+	glUniform1i(m_viewCountLocation, viewCount);
+	glUniformMatrix4fv(m_inverseViewProjectionsLocation, viewCount, GL_FALSE, glm::value_ptr(inverseViewProjections[0]));
+	glUniform4fv(m_viewRectanglesLocation, viewCount, glm::value_ptr(viewRectangles[0]));
+	glUniform3fv(m_viewPositionsLocation, viewCount, glm::value_ptr(viewPositions[0]));
+	glUniformMatrix4fv(m_viewLocation, 1, GL_FALSE, glm::value_ptr(frameState.view));
+
+	glUniform1i(m_useShadowsLocation, (NULL != pShadowMaps) ? 1 : 0);
+	if (NULL != pShadowMaps)
+	{
+		int cascadeCount = pShadowMaps->GetCascadeCount();
+		GLStateCache::BindTexture(SHADOW_TEXTURE_UNIT, GL_TEXTURE_2D_ARRAY, pShadowMaps->GetDepthTexture());
+		glUniform1i(m_cascadeCountLocation, cascadeCount);
+		glUniformMatrix4fv(m_lightSpaceMatricesLocation, cascadeCount, GL_FALSE, glm::value_ptr(pShadowMaps->GetLightSpaceMatrices()[0]));
+		glUniform1fv(m_cascadeSplitsLocation, cascadeCount, pShadowMaps->GetCascadeSplits());
+	}
+
+	glDispatchCompute(
+		(m_renderWidth + TILE_SIZE - 1) / TILE_SIZE,
+		(m_renderHeight + TILE_SIZE - 1) / TILE_SIZE,
+		1);
+	// the transparent draws blend over the lit pixels and the
+	// resolve samples them
+	glMemoryBarrier(GL_FRAMEBUFFER_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+
+	GLStateCache::UseProgram(previousProgram);
+}
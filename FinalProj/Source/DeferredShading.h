@@ -0,0 +1,116 @@
+///////////////////////////////////////////////////////////////////////////////
+// deferredshading.h
+// ============
+// G-buffer and tiled compute lighting of the opaque scene
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "FrameState.h"
+#include "ShadowMaps.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+// one light of the scene, the same values as an entry of the
+// lightSources array in the forward scene shader
+struct LIGHT_SOURCE
+{
+	glm::vec3 position;
+	glm::vec3 ambientColor;
+	glm::vec3 diffuseColor;
+	glm::vec3 specularColor;
+	float focalStrength;
+	float specularIntensity;
+};
+
+/***********************************************************
+ *  DeferredShading
+ *
+ *  This class is the deferred alternative to lighting every
+ *  fragment as it is drawn. The opaque draws only fill a
+ *  G-buffer that shares the scene's depth buffer:
+ *
+ *    albedo    RGBA8    unlit texture or object color
+ *    normal    RG16F    octahedral encoded world normal
+ *    material  R8UI     entry of the material table
+ *    depth              the scene target's depth texture
+ *
+ *  One compute dispatch then lights the frame in 16x16
+ *  tiles. A tile finds its nearest depth and returns at
+ *  once when it only sees the background, and loads the
+ *  lights into shared memory for its pixels. Each pixel
+ *  rebuilds its world position from the depth through the
+ *  inverse view projection of its view, reads its material
+ *  from the same table as the forward shader and writes the
+ *  lit color into the scene target. Lights that add no
+ *  color are left out when they are set, so overdraw and
+ *  dark lights cost nothing.
+ ***********************************************************/
+class DeferredShading
+{
+public:
+	// must match MAX_LIGHTS in the lighting shader
+	static const int MAX_LIGHTS = 4;
+
+	// constructor
+	DeferredShading();
+	// destructor
+	~DeferredShading();
+
+	// load the lighting program
+	bool Initialize();
+	// create the G-buffer at the scene target's size around its depth
+	// texture; the lit color is written into the color texture
+	bool CreateTargets(int width, int height, GLuint depthTexture, GLuint colorTexture, GLuint sceneFramebuffer);
+	void DestroyTargets();
+	bool IsReady() const { return((m_framebuffer != 0) && (m_program != 0)); }
+
+	// the lights the lighting pass evaluates, the first one is the
+	// key light that casts the shadows
+	void SetLights(const LIGHT_SOURCE* pLights, int count);
+	// part of the targets the scene is rendered into
+	void SetRenderSize(int width, int height);
+
+	// redirect the following opaque draws into the G-buffer
+	void BeginGeometry();
+	// light the G-buffer into the scene target and bind the scene
+	// framebuffer again; pShadowMaps is NULL without shadows
+	void Light(const FRAME_STATE& frameState, const ShadowMaps* pShadowMaps);
+
+private:
+	int m_renderWidth;
+	int m_renderHeight;
+
+	GLuint m_framebuffer;
+	GLuint m_albedoTexture;
+	GLuint m_normalTexture;
+	GLuint m_materialTexture;
+	GLuint m_depthTexture;
+	GLuint m_colorTexture;
+	GLuint m_sceneFramebuffer;
+
+	GLuint m_program;
+
+	// uniform locations in the lighting program
+	GLint m_imageSizeLocation;
+	GLint m_viewCountLocation;
+	GLint m_inverseViewProjectionsLocation;
+	GLint m_viewRectanglesLocation;
+	GLint m_viewPositionsLocation;
+	GLint m_viewLocation;
+	GLint m_lightCountLocation;
+	GLint m_keyLightLocation;
+	GLint m_lightPositionsLocation;
+	GLint m_lightAmbientColorsLocation;
+	GLint m_lightDiffuseColorsLocation;
+	GLint m_lightSpecularColorsLocation;
+	GLint m_lightSpecularIntensitiesLocation;
+	GLint m_useShadowsLocation;
+	GLint m_lightSpaceMatricesLocation;
+	GLint m_cascadeSplitsLocation;
+	GLint m_cascadeCountLocation;
+};
@@ -0,0 +1,252 @@
+///////////////////////////////////////////////////////////////////////////////
+// drawlist.cpp
+// ============
+// CPU-side draw packets recorded by the scene traversal and consumed by the
+// OpenGL thread
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "DrawList.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace
+{
+	// packets a list has room for after its first Add()
+	const size_t INITIAL_CAPACITY = 64;
+}
+
+/***********************************************************
+ *  DrawList()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+DrawList::DrawList()
+{
+	m_pArena = NULL;
+	m_pPackets = NULL;
+	m_pOrder = NULL;
+	m_size = 0;
+	m_capacity = 0;
+}
+
+/***********************************************************
+ *  FRUSTUM::Extract()
+ *
+ *  This method pulls the six clip planes out of the passed
+ *  in view-projection matrix (Gribb/Hartmann method).
+ ***********************************************************/
+void FRUSTUM::Extract(const glm::mat4& viewProjection)
+{
+	for (int i = 0; i < 3; i++)
+	{
+		for (int side = 0; side < 2; side++)
+		{
+			float sign = (side == 0) ? 1.0f : -1.0f;
+			glm::vec4 plane;
+			plane.x = viewProjection[0][3] + sign * viewProjection[0][i];
+			plane.y = viewProjection[1][3] + sign * viewProjection[1][i];
+			plane.z = viewProjection[2][3] + sign * viewProjection[2][i];
+			plane.w = viewProjection[3][3] + sign * viewProjection[3][i];
+
+			// normalize so the plane distance is in world units
+			float length = glm::length(glm::vec3(plane.x, plane.y, plane.z));
+			planes[i * 2 + side] = plane / length;
+		}
+	}
+}
+
+/***********************************************************
+ *  FRUSTUM::IntersectsSphere()
+ *
+ *  This method returns false only when the sphere is fully
+ *  outside one of the frustum planes.
+ ***********************************************************/
+bool FRUSTUM::IntersectsSphere(const glm::vec3& center, float radius) const
+{
+	for (int i = 0; i < 6; i++)
+	{
+		float distance = glm::dot(glm::vec3(planes[i].x, planes[i].y, planes[i].z), center) + planes[i].w;
+		if (distance < -radius)
+		{
+			return(false);
+		}
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  MakeSortKey()
+ *
+ *  This method builds the packet sort key. Mesh changes are
+ *  the most expensive (VAO switch) so they are in the top
+ *  bits, followed by the textures and the material. The
+ *  procedural textures have no slot and go in the low bits.
+ ***********************************************************/
+uint64_t DrawList::MakeSortKey(const DRAW_PACKET& packet)
+{
+	uint64_t key = 0;
+	key |= (uint64_t)(packet.mesh & 0xFF) << 56;
+	key |= (uint64_t)((packet.textureSlot + 1) & 0xFF) << 48;
+	key |= (uint64_t)((packet.textureSlot2 + 1) & 0xFF) << 40;
+	key |= (uint64_t)((packet.materialIndex + 1) & 0xFFFF) << 24;
+	// melted clocks change the vertex path, keep them together
+	key |= (uint64_t)(packet.meltParams.z > 0.0f ? 1 : 0) << 23;
+	key |= (uint64_t)((packet.proceduralTexture + 1) & 0xFF) << 15;
+	return(key);
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method empties the list. The old packets belong to
+ *  an arena that is reset along with the list.
+ ***********************************************************/
+void DrawList::Clear(FrameArena* pArena)
+{
+	m_pArena = pArena;
+	m_pPackets = NULL;
+	m_pOrder = NULL;
+	m_size = 0;
+	m_capacity = 0;
+}
+
+/***********************************************************
+ *  Reserve()
+ *
+ *  This method moves the packets into a larger arena array.
+ *  The old array stays in the arena until the next reset.
+ ***********************************************************/
+void DrawList::Reserve(size_t capacity)
+{
+	if (capacity <= m_capacity)
+	{
+		return;
+	}
+	DRAW_PACKET* pPackets = m_pArena->AllocateArray<DRAW_PACKET>(capacity);
+	if (m_size > 0)
+	{
+		memcpy(pPackets, m_pPackets, m_size * sizeof(DRAW_PACKET));
+	}
+	m_pPackets = pPackets;
+	m_capacity = capacity;
+}
+
+/***********************************************************
+ *  Add()
+ *
+ *  This method appends a packet and fills in its sort key.
+ *  The material uniform is set on every draw, so a packet
+ *  has to name its material; one that does not would pick
+ *  up whatever the draw before it used.
+ ***********************************************************/
+bool DrawList::Add(const DRAW_PACKET& packet)
+{
+	assert(packet.materialIndex >= 0);
+	if (packet.materialIndex < 0)
+	{
+		return(false);
+	}
+	if (m_size == m_capacity)
+	{
+		Reserve(std::max(m_capacity * 2, INITIAL_CAPACITY));
+	}
+	m_pPackets[m_size] = packet;
+	m_pPackets[m_size].sortKey = MakeSortKey(packet);
+	m_size++;
+	return(true);
+}
+
+/***********************************************************
+ *  Sort()
+ *
+ *  This method orders the packets by their sort keys. The
+ *  sort is stable so packets with equal keys keep the order
+ *  they were recorded in: the packet address is the tie
+ *  breaker, which avoids stable_sort's heap buffer. Only the
+ *  16 byte key entries move, never the packets.
+ ***********************************************************/
+void DrawList::Sort()
+{
+	m_pOrder = m_pArena->AllocateArray<SORT_ENTRY>(std::max(m_size, (size_t)1));
+	for (size_t i = 0; i < m_size; i++)
+	{
+		m_pOrder[i].key = m_pPackets[i].sortKey;
+		m_pOrder[i].pPacket = &m_pPackets[i];
+	}
+	std::sort(m_pOrder, m_pOrder + m_size,
+		[](const SORT_ENTRY& a, const SORT_ENTRY& b)
+		{
+			return (a.key < b.key) || ((a.key == b.key) && (a.pPacket < b.pPacket));
+		});
+}
+
+/***********************************************************
+ *  MergeSorted()
+ *
+ *  This method replaces the contents of this list with the
+ *  merge of the passed in sorted lists. Neighbouring runs
+ *  of key entries are merged in pairs until one run is
+ *  left, which is O(N log lists). std::merge takes equal
+ *  keys from the first run first, so the recording order
+ *  of the lists is kept.
+ ***********************************************************/
+void DrawList::MergeSorted(const std::vector<DrawList>& lists)
+{
+	size_t total = 0;
+	for (size_t i = 0; i < lists.size(); i++)
+	{
+		total += lists[i].Size();
+	}
+
+	m_pPackets = NULL;
+	m_capacity = 0;
+	m_size = total;
+	if (lists.empty())
+	{
+		m_pOrder = NULL;
+		return;
+	}
+
+	// every run starts where the one before it ends
+	size_t runCount = lists.size();
+	size_t* runStarts = m_pArena->AllocateArray<size_t>(runCount + 1);
+	SORT_ENTRY* pSource = m_pArena->AllocateArray<SORT_ENTRY>(std::max(total, (size_t)1));
+	SORT_ENTRY* pTarget = m_pArena->AllocateArray<SORT_ENTRY>(std::max(total, (size_t)1));
+	runStarts[0] = 0;
+	for (size_t i = 0; i < runCount; i++)
+	{
+		if (lists[i].Size() > 0)
+		{
+			memcpy(pSource + runStarts[i], lists[i].m_pOrder, lists[i].Size() * sizeof(SORT_ENTRY));
+		}
+		runStarts[i + 1] = runStarts[i] + lists[i].Size();
+	}
+
+	while (runCount > 1)
+	{
+		size_t mergedCount = 0;
+		for (size_t run = 0; run < runCount; run += 2)
+		{
+			size_t start = runStarts[run];
+			size_t middle = runStarts[std::min(run + 1, runCount)];
+			size_t end = runStarts[std::min(run + 2, runCount)];
+			std::merge(pSource + start, pSource + middle,
+				pSource + middle, pSource + end,
+				pTarget + start,
+				[](const SORT_ENTRY& a, const SORT_ENTRY& b)
+				{
+					return(a.key < b.key);
+				});
+			runStarts[mergedCount++] = start;
+		}
+		runStarts[mergedCount] = total;
+		runCount = mergedCount;
+		std::swap(pSource, pTarget);
+	}
+	m_pOrder = pSource;
+}
@@ -0,0 +1,127 @@
+///////////////////////////////////////////////////////////////////////////////
+// drawlist.h
+// ============
+// CPU-side draw packets recorded by the scene traversal and consumed by the
+// OpenGL thread
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "FrameArena.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// basic shape meshes that a draw packet can reference
+enum SHAPE_MESH
+{
+	SHAPE_PLANE = 0,
+	SHAPE_BOX,
+	SHAPE_CYLINDER,
+	SHAPE_TAPERED_CYLINDER,
+	SHAPE_CONE,
+	SHAPE_SPHERE,
+	SHAPE_TORUS,
+	SHAPE_COUNT
+};
+
+/***********************************************************
+ *  DRAW_PACKET
+ *
+ *  Everything the OpenGL thread needs to issue one draw
+ *  call. Packets are plain data so they can be recorded on
+ *  any thread.
+ ***********************************************************/
+struct DRAW_PACKET
+{
+	uint64_t sortKey;
+	SHAPE_MESH mesh;
+	glm::mat4 model;       // local matrix when melting, full model matrix otherwise
+	glm::mat4 meltGroup;   // clock group matrix, only used when melting
+	glm::vec4 meltParams;  // z (drape amount) is 0 for rigid objects
+	glm::vec4 bounds;      // world bounding sphere, center and radius
+	glm::vec4 color;
+	float opacity;         // below 1 goes through the transparency pass
+	glm::vec2 uvScale;
+	glm::vec2 uvOffset;    // place of the texture in its atlas page
+	glm::vec2 uvScale2;    // same two for textureSlot2
+	glm::vec2 uvOffset2;
+	int textureSlot;       // texture unit, -1 draws with the solid color
+	int textureSlot2;      // -1 unless the face is split over two textures
+	int proceduralTexture; // drawn instead of textureSlot, -1 for none
+	bool bDistanceField2;  // textureSlot2 holds the distance field of a dial
+	int materialIndex;     // entry of the material table, every packet needs one
+	float reflectivity;    // share of the planar reflection, 0 off the floor plane
+	unsigned int cascadeMask;  // shadow cascades the object casts into
+	bool bVisible;         // false for shadow casters outside the camera view
+	bool bReflected;       // seen by the mirrored camera of the planar reflection
+};
+
+/***********************************************************
+ *  FRUSTUM
+ *
+ *  View frustum planes extracted from a view-projection
+ *  matrix for bounding sphere culling.
+ ***********************************************************/
+struct FRUSTUM
+{
+	glm::vec4 planes[6];
+
+	void Extract(const glm::mat4& viewProjection);
+	bool IntersectsSphere(const glm::vec3& center, float radius) const;
+};
+
+/***********************************************************
+ *  DrawList
+ *
+ *  This class holds the draw packets recorded for one frame
+ *  (or one chunk of a frame) and sorts them to reduce the
+ *  state changes between consecutive draws. Only the sort
+ *  keys and packet pointers are sorted and merged, the
+ *  packets stay where they were recorded. The packets and
+ *  the sort memory come from a frame arena, so the list is
+ *  only valid until that arena is reset.
+ ***********************************************************/
+class DrawList
+{
+public:
+	// constructor
+	DrawList();
+
+	// build the key that orders packets by mesh, textures and material
+	static uint64_t MakeSortKey(const DRAW_PACKET& packet);
+
+	// empty the list and take its memory from the passed in arena
+	void Clear(FrameArena* pArena);
+	// packets without a material index are rejected
+	bool Add(const DRAW_PACKET& packet);
+	void Sort();
+	// merge several already sorted lists into this list, the packets
+	// stay in the lists they were recorded into
+	void MergeSorted(const std::vector<DrawList>& lists);
+
+	size_t Size() const { return m_size; }
+	// packets in draw order, valid after Sort() or MergeSorted()
+	const DRAW_PACKET& operator[](size_t index) const { return *m_pOrder[index].pPacket; }
+
+private:
+	// sort key and the packet it belongs to
+	struct SORT_ENTRY
+	{
+		uint64_t key;
+		const DRAW_PACKET* pPacket;
+	};
+
+	FrameArena* m_pArena;
+	DRAW_PACKET* m_pPackets;
+	SORT_ENTRY* m_pOrder;
+	size_t m_size;
+	size_t m_capacity;
+
+	void Reserve(size_t capacity);
+};
@@ -0,0 +1,80 @@
+///////////////////////////////////////////////////////////////////////////////
+// dynamicresolution.cpp
+// ============
+// picks the scene render scale that holds a target GPU frame time
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "DynamicResolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// shrink once the frame uses more than this share of the budget,
+	// grow once it uses less than the lower share
+	const double SHRINK_THRESHOLD = 0.95;
+	const double GROW_THRESHOLD = 0.75;
+	// the shrink aims a little under budget to leave some headroom
+	const double SHRINK_TARGET = 0.85;
+	const float GROW_STEP = 0.05f;
+	// scales are kept on a coarse grid so small changes do not resize
+	const float SCALE_GRID = 1.0f / 40.0f;
+	const int SETTLE_FRAMES = 12;
+}
+
+/***********************************************************
+ *  DynamicResolution()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+DynamicResolution::DynamicResolution(double targetFrameMs, float minScale, float maxScale)
+{
+	m_targetFrameMs = targetFrameMs;
+	m_minScale = minScale;
+	m_maxScale = maxScale;
+	m_scale = maxScale;
+	m_settleFrames = SETTLE_FRAMES;
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method adjusts the render scale from the latest
+ *  GPU frame time and returns it.
+ ***********************************************************/
+float DynamicResolution::Update(double gpuFrameMs)
+{
+	if (m_settleFrames > 0)
+	{
+		m_settleFrames--;
+		return(m_scale);
+	}
+	// no timings yet
+	if (gpuFrameMs <= 0.0)
+	{
+		return(m_scale);
+	}
+
+	float scale = m_scale;
+	if (gpuFrameMs > m_targetFrameMs * SHRINK_THRESHOLD)
+	{
+		scale = m_scale * (float)std::sqrt(m_targetFrameMs * SHRINK_TARGET / gpuFrameMs);
+	}
+	else if (gpuFrameMs < m_targetFrameMs * GROW_THRESHOLD)
+	{
+		scale = m_scale + GROW_STEP;
+	}
+	scale = std::floor(scale / SCALE_GRID + 0.5f) * SCALE_GRID;
+	scale = std::min(std::max(scale, m_minScale), m_maxScale);
+
+	if (scale != m_scale)
+	{
+		m_scale = scale;
+		m_settleFrames = SETTLE_FRAMES;
+	}
+	return(m_scale);
+}
@@ -0,0 +1,41 @@
+///////////////////////////////////////////////////////////////////////////////
+// dynamicresolution.h
+// ============
+// picks the scene render scale that holds a target GPU frame time
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+/***********************************************************
+ *  DynamicResolution
+ *
+ *  This class turns the measured GPU frame time into a
+ *  render scale for the scene target. The cost of the scene
+ *  grows with the pixel count, the square of the scale, so
+ *  an over budget frame shrinks the scale by the square root
+ *  of the overshoot at once, while spare time only grows it
+ *  in small steps to avoid bouncing between two sizes.
+ ***********************************************************/
+class DynamicResolution
+{
+public:
+	// constructor
+	DynamicResolution(double targetFrameMs, float minScale, float maxScale);
+
+	// feed the latest GPU frame time, returns the scale to render at
+	float Update(double gpuFrameMs);
+
+	float GetScale() const { return(m_scale); }
+
+private:
+	double m_targetFrameMs;
+	float m_minScale;
+	float m_maxScale;
+	float m_scale;
+	// frames left before the next change, the timings lag a few
+	// frames behind so a change needs time to show up in them
+	int m_settleFrames;
+};
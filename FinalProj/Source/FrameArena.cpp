@@ -0,0 +1,116 @@
+///////////////////////////////////////////////////////////////////////////////
+// framearena.cpp
+// ============
+// linear allocator for data that only lives until the next frame
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameArena.h"
+
+#include <iostream>
+
+namespace
+{
+	// every allocation is at least this aligned, enough for glm types
+	const size_t BLOCK_ALIGNMENT = 16;
+}
+
+/***********************************************************
+ *  FrameArena()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrameArena::FrameArena(size_t capacity)
+{
+	m_capacity = capacity;
+	m_pMemory = static_cast<unsigned char*>(::operator new(m_capacity));
+	m_offset = 0;
+	m_overflowBytes = 0;
+}
+
+/***********************************************************
+ *  ~FrameArena()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FrameArena::~FrameArena()
+{
+	Reset();
+	::operator delete(m_pMemory);
+	m_pMemory = NULL;
+}
+
+/***********************************************************
+ *  Allocate()
+ *
+ *  This method reserves aligned memory in the block with a
+ *  compare and swap on the offset, or borrows a heap block
+ *  when the main block is full.
+ ***********************************************************/
+void* FrameArena::Allocate(size_t size, size_t alignment)
+{
+	if (alignment < BLOCK_ALIGNMENT)
+	{
+		alignment = BLOCK_ALIGNMENT;
+	}
+	if (size == 0)
+	{
+		size = 1;
+	}
+
+	// aligned from the block's address, which operator new only
+	// aligns to BLOCK_ALIGNMENT
+	size_t base = reinterpret_cast<size_t>(m_pMemory);
+	size_t offset = m_offset.load(std::memory_order_relaxed);
+	while (true)
+	{
+		size_t aligned = ((base + offset + alignment - 1) & ~(alignment - 1)) - base;
+		if (aligned + size > m_capacity)
+		{
+			break;
+		}
+		if (m_offset.compare_exchange_weak(offset, aligned + size, std::memory_order_relaxed))
+		{
+			return(m_pMemory + aligned);
+		}
+	}
+
+	// the heap memory of operator new is aligned for any fundamental type
+	void* pBlock = ::operator new(size + alignment);
+	{
+		std::lock_guard<std::mutex> lock(m_overflowMutex);
+		m_overflowBlocks.push_back(pBlock);
+	}
+	m_overflowBytes += size + alignment;
+	size_t address = reinterpret_cast<size_t>(pBlock);
+	return(reinterpret_cast<void*>((address + alignment - 1) & ~(alignment - 1)));
+}
+
+/***********************************************************
+ *  Reset()
+ *
+ *  This method rewinds the block, frees the borrowed heap
+ *  blocks and grows the main block if the frame needed them.
+ ***********************************************************/
+void FrameArena::Reset()
+{
+	for (size_t i = 0; i < m_overflowBlocks.size(); i++)
+	{
+		::operator delete(m_overflowBlocks[i]);
+	}
+	m_overflowBlocks.clear();
+
+	size_t overflow = m_overflowBytes.exchange(0);
+	if (overflow > 0)
+	{
+		// room for the frame that overflowed, plus half again
+		size_t capacity = (m_capacity + overflow) * 3 / 2;
+		::operator delete(m_pMemory);
+		m_pMemory = static_cast<unsigned char*>(::operator new(capacity));
+		m_capacity = capacity;
+		std::cout << "INFO: frame arena grown to " << (m_capacity / 1024) << " KB" << std::endl;
+	}
+	m_offset = 0;
+}
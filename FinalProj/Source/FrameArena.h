@@ -0,0 +1,62 @@
+///////////////////////////////////////////////////////////////////////////////
+// framearena.h
+// ============
+// linear allocator for data that only lives until the next frame
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+/***********************************************************
+ *  FrameArena
+ *
+ *  This class hands out memory by bumping an offset into
+ *  one block and takes it all back at once with Reset(), so
+ *  per-frame data never goes through the heap. Allocating
+ *  is lock free and may happen on several threads at once.
+ *  A frame that runs out of room borrows heap blocks until
+ *  the next Reset(), which then grows the main block to fit
+ *  that frame, so the heap is only touched while warming up.
+ ***********************************************************/
+class FrameArena
+{
+public:
+	// constructor
+	FrameArena(size_t capacity);
+	// destructor
+	~FrameArena();
+
+	// raw memory, alignment must be a power of two
+	void* Allocate(size_t size, size_t alignment);
+	// uninitialized array of plain data
+	template <typename T>
+	T* AllocateArray(size_t count)
+	{
+		return(static_cast<T*>(Allocate(sizeof(T) * count, alignof(T))));
+	}
+
+	// release everything allocated since the last reset, no
+	// allocation may be in flight on another thread
+	void Reset();
+
+	size_t GetCapacity() const { return(m_capacity); }
+	size_t GetUsed() const { return(m_offset.load(std::memory_order_relaxed)); }
+
+private:
+	unsigned char* m_pMemory;
+	size_t m_capacity;
+	std::atomic<size_t> m_offset;
+	// bytes requested beyond the block this frame
+	std::atomic<size_t> m_overflowBytes;
+
+	// heap blocks borrowed when the main block was full
+	std::mutex m_overflowMutex;
+	std::vector<void*> m_overflowBlocks;
+};
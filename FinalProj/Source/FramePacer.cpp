@@ -0,0 +1,183 @@
+///////////////////////////////////////////////////////////////////////////////
+// framepacer.cpp
+// ============
+// frame deadlines, swap interval and smoothing of the frame delta time
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FramePacer.h"
+
+#include "GLFW/glfw3.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+namespace
+{
+	// the spin starts at least this long before a deadline, and the
+	// measured oversleep decays towards it again
+	const double MIN_SPIN_MARGIN = 0.001;
+	const double MAX_SPIN_MARGIN = 0.004;
+	const double SPIN_MARGIN_DECAY = 0.99;
+
+	// a delta this many times the median is a hitch, not a frame
+	const double OUTLIER_FACTOR = 3.0;
+	// longest delta the camera moves by in one step
+	const double MAX_DELTA = 0.1;
+	// share of a new delta taken into the average
+	const double SMOOTHING = 0.2;
+}
+
+/***********************************************************
+ *  FramePacer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FramePacer::FramePacer(double targetRate)
+{
+	m_interval = (targetRate > 0.0) ? (1.0 / targetRate) : 0.0;
+	m_nextDeadline = 0.0;
+	m_spinMargin = MIN_SPIN_MARGIN;
+}
+
+/***********************************************************
+ *  WaitForNextFrame()
+ *
+ *  This method waits for the next deadline of the schedule.
+ ***********************************************************/
+void FramePacer::WaitForNextFrame()
+{
+	if (m_interval <= 0.0)
+	{
+		return;
+	}
+
+	double now = glfwGetTime();
+	if ((m_nextDeadline <= 0.0) || (now > m_nextDeadline + m_interval))
+	{
+		m_nextDeadline = now + m_interval;
+		return;
+	}
+
+	SleepUntil(m_nextDeadline);
+	m_nextDeadline += m_interval;
+}
+
+/***********************************************************
+ *  SleepUntil()
+ *
+ *  This method sleeps until shortly before the deadline and
+ *  spins for the rest, learning how late the sleeps wake.
+ ***********************************************************/
+void FramePacer::SleepUntil(double deadline)
+{
+	double now = glfwGetTime();
+	double sleepTime = deadline - now - m_spinMargin;
+	if (sleepTime > 0.0)
+	{
+		double wakeTime = now + sleepTime;
+		std::this_thread::sleep_for(std::chrono::duration<double>(sleepTime));
+		now = glfwGetTime();
+
+		double oversleep = now - wakeTime;
+		m_spinMargin = std::max(m_spinMargin * SPIN_MARGIN_DECAY, oversleep);
+		m_spinMargin = std::min(std::max(m_spinMargin, MIN_SPIN_MARGIN), MAX_SPIN_MARGIN);
+	}
+
+	while (now < deadline)
+	{
+		std::this_thread::yield();
+		now = glfwGetTime();
+	}
+}
+
+/***********************************************************
+ *  ApplyVsync()
+ *
+ *  This method sets the swap interval of the context that
+ *  is current on the calling thread.
+ ***********************************************************/
+void FramePacer::ApplyVsync(bool bVsync)
+{
+	if (!bVsync)
+	{
+		glfwSwapInterval(0);
+		return;
+	}
+
+	if (glfwExtensionSupported("WGL_EXT_swap_control_tear") ||
+		glfwExtensionSupported("GLX_EXT_swap_control_tear"))
+	{
+		// a negative interval swaps at once when a refresh was missed
+		glfwSwapInterval(-1);
+		std::cout << "INFO: Using adaptive vsync" << std::endl;
+	}
+	else
+	{
+		glfwSwapInterval(1);
+	}
+}
+
+/***********************************************************
+ *  DeltaSmoother()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+DeltaSmoother::DeltaSmoother()
+{
+	for (int i = 0; i < HISTORY_SIZE; i++)
+	{
+		m_history[i] = 0.0;
+	}
+	m_count = 0;
+	m_next = 0;
+	m_smoothed = 0.0;
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method takes in the latest measured delta and
+ *  returns the smoothed one.
+ ***********************************************************/
+double DeltaSmoother::Update(double rawDelta)
+{
+	double delta = std::min(std::max(rawDelta, 0.0), MAX_DELTA);
+
+	double median = delta;
+	if (m_count > 0)
+	{
+		double sorted[HISTORY_SIZE];
+		std::copy(m_history, m_history + m_count, sorted);
+		std::nth_element(sorted, sorted + m_count / 2, sorted + m_count);
+		median = sorted[m_count / 2];
+	}
+
+	// hitches stay out of the history, a lasting change of the frame
+	// rate is below the limit and replaces the old deltas within a few
+	// frames
+	if (rawDelta < MAX_DELTA)
+	{
+		m_history[m_next] = delta;
+		m_next = (m_next + 1) % HISTORY_SIZE;
+		m_count = std::min(m_count + 1, (int)HISTORY_SIZE);
+	}
+	if ((median > 0.0) && (delta > median * OUTLIER_FACTOR))
+	{
+		delta = median;
+	}
+
+	if (m_smoothed <= 0.0)
+	{
+		m_smoothed = delta;
+	}
+	else
+	{
+		m_smoothed += (delta - m_smoothed) * SMOOTHING;
+	}
+	return(m_smoothed);
+}
@@ -0,0 +1,69 @@
+///////////////////////////////////////////////////////////////////////////////
+// framepacer.h
+// ============
+// frame deadlines, swap interval and smoothing of the frame delta time
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+/***********************************************************
+ *  FramePacer
+ *
+ *  This class holds a loop to a fixed rate. Each call waits
+ *  for the next deadline, sleeping while the deadline is
+ *  far and spinning for the last stretch, since a sleep can
+ *  wake up late by more than a millisecond. How late the
+ *  sleeps wake up is measured, so the spinning stays short
+ *  on systems with fine timers.
+ ***********************************************************/
+class FramePacer
+{
+public:
+	// constructor, a rate of 0 or less never waits
+	FramePacer(double targetRate);
+
+	// wait until the next deadline, falling a whole interval behind
+	// restarts the schedule instead of rushing to catch up
+	void WaitForNextFrame();
+
+	// set the swap interval of the current context: adaptive vsync
+	// (tearing only on missed refreshes) where the driver has it
+	static void ApplyVsync(bool bVsync);
+
+private:
+	double m_interval;
+	double m_nextDeadline;
+	// longest recent oversleep, the spin starts this early
+	double m_spinMargin;
+
+	void SleepUntil(double deadline);
+};
+
+/***********************************************************
+ *  DeltaSmoother
+ *
+ *  This class steadies the time between frames used to
+ *  move the camera. A delta far above the median of the
+ *  recent ones (a hitch, a dragged window) is replaced by
+ *  the median, and the result is averaged over a few
+ *  frames so scheduling jitter does not show as judder.
+ ***********************************************************/
+class DeltaSmoother
+{
+public:
+	// constructor
+	DeltaSmoother();
+
+	// feed the measured delta in seconds, returns the one to use
+	double Update(double rawDelta);
+
+private:
+	static const int HISTORY_SIZE = 15;
+	double m_history[HISTORY_SIZE];
+	int m_count;
+	int m_next;
+	double m_smoothed;
+};
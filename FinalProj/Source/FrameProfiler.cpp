@@ -0,0 +1,249 @@
+///////////////////////////////////////////////////////////////////////////////
+// frameprofiler.cpp
+// ============
+// CPU and GPU timing of the render passes
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameProfiler.h"
+#include "GLStateCache.h"
+
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+	// how often the averaged timings are printed
+	const double REPORT_INTERVAL_SECONDS = 2.0;
+	// weight of a new GPU sample in the recent moving average
+	const double RECENT_SAMPLE_WEIGHT = 0.2;
+}
+
+/***********************************************************
+ *  FrameProfiler()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrameProfiler::FrameProfiler()
+{
+	m_frameSlot = 0;
+	m_lastReport = std::chrono::high_resolution_clock::now();
+}
+
+/***********************************************************
+ *  ~FrameProfiler()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FrameProfiler::~FrameProfiler()
+{
+	for (size_t i = 0; i < m_scopes.size(); i++)
+	{
+		glDeleteQueries(FRAME_LATENCY * 2, &m_scopes[i].queries[0][0]);
+	}
+	m_scopes.clear();
+}
+
+/***********************************************************
+ *  RegisterScope()
+ *
+ *  This method adds a named scope and creates its queries.
+ *  It must be called with the OpenGL context current.
+ ***********************************************************/
+int FrameProfiler::RegisterScope(const char* name)
+{
+	PROFILE_SCOPE scope;
+	scope.name = name;
+	glGenQueries(FRAME_LATENCY * 2, &scope.queries[0][0]);
+	for (int i = 0; i < FRAME_LATENCY; i++)
+	{
+		scope.bIssued[i] = false;
+	}
+	scope.cpuSumMs = 0.0;
+	scope.gpuSumMs = 0.0;
+	scope.cpuSamples = 0;
+	scope.gpuSamples = 0;
+	scope.cpuAverageMs = 0.0;
+	scope.gpuAverageMs = 0.0;
+	scope.gpuRecentMs = 0.0;
+
+	m_scopes.push_back(scope);
+	return((int)m_scopes.size() - 1);
+}
+
+/***********************************************************
+ *  BeginScope()
+ *
+ *  This method records the start time of a scope.
+ ***********************************************************/
+void FrameProfiler::BeginScope(int scope)
+{
+	if ((scope < 0) || (scope >= (int)m_scopes.size()))
+	{
+		return;
+	}
+	PROFILE_SCOPE& profileScope = m_scopes[scope];
+	profileScope.cpuStart = std::chrono::high_resolution_clock::now();
+	glQueryCounter(profileScope.queries[m_frameSlot][0], GL_TIMESTAMP);
+}
+
+/***********************************************************
+ *  EndScope()
+ *
+ *  This method records the end time of a scope.
+ ***********************************************************/
+void FrameProfiler::EndScope(int scope)
+{
+	if ((scope < 0) || (scope >= (int)m_scopes.size()))
+	{
+		return;
+	}
+	PROFILE_SCOPE& profileScope = m_scopes[scope];
+	glQueryCounter(profileScope.queries[m_frameSlot][1], GL_TIMESTAMP);
+	profileScope.bIssued[m_frameSlot] = true;
+
+	std::chrono::duration<double, std::milli> elapsed =
+		std::chrono::high_resolution_clock::now() - profileScope.cpuStart;
+	profileScope.cpuSumMs += elapsed.count();
+	profileScope.cpuSamples++;
+}
+
+/***********************************************************
+ *  ReadQueries()
+ *
+ *  This method adds the GPU time of one frame slot to the
+ *  scope, if the GPU has finished with it.
+ ***********************************************************/
+void FrameProfiler::ReadQueries(PROFILE_SCOPE& scope, int slot)
+{
+	if (!scope.bIssued[slot])
+	{
+		return;
+	}
+
+	GLint bAvailable = 0;
+	glGetQueryObjectiv(scope.queries[slot][1], GL_QUERY_RESULT_AVAILABLE, &bAvailable);
+	if (!bAvailable)
+	{
+		return;
+	}
+
+	GLuint64 startTime = 0;
+	GLuint64 endTime = 0;
+	glGetQueryObjectui64v(scope.queries[slot][0], GL_QUERY_RESULT, &startTime);
+	glGetQueryObjectui64v(scope.queries[slot][1], GL_QUERY_RESULT, &endTime);
+	double gpuTimeMs = (double)(endTime - startTime) / 1000000.0;
+	scope.gpuSumMs += gpuTimeMs;
+	scope.gpuSamples++;
+	if (scope.gpuRecentMs == 0.0)
+	{
+		scope.gpuRecentMs = gpuTimeMs;
+	}
+	else
+	{
+		scope.gpuRecentMs += (gpuTimeMs - scope.gpuRecentMs) * RECENT_SAMPLE_WEIGHT;
+	}
+	scope.bIssued[slot] = false;
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method moves to the next frame slot, reading back
+ *  the oldest slot before its queries are reused.
+ ***********************************************************/
+void FrameProfiler::EndFrame()
+{
+	m_frameSlot = (m_frameSlot + 1) % FRAME_LATENCY;
+	for (size_t i = 0; i < m_scopes.size(); i++)
+	{
+		ReadQueries(m_scopes[i], m_frameSlot);
+		// a result that is still not ready is dropped rather than waited for
+		m_scopes[i].bIssued[m_frameSlot] = false;
+	}
+
+	std::chrono::duration<double> sinceReport =
+		std::chrono::high_resolution_clock::now() - m_lastReport;
+	if (sinceReport.count() >= REPORT_INTERVAL_SECONDS)
+	{
+		PrintReport();
+		m_lastReport = std::chrono::high_resolution_clock::now();
+	}
+}
+
+/***********************************************************
+ *  GetCpuTimeMs()
+ *
+ *  This method returns the CPU average of the last report.
+ ***********************************************************/
+double FrameProfiler::GetCpuTimeMs(int scope) const
+{
+	if ((scope < 0) || (scope >= (int)m_scopes.size()))
+	{
+		return(0.0);
+	}
+	return(m_scopes[scope].cpuAverageMs);
+}
+
+/***********************************************************
+ *  GetGpuTimeMs()
+ *
+ *  This method returns the GPU average of the last report.
+ ***********************************************************/
+double FrameProfiler::GetGpuTimeMs(int scope) const
+{
+	if ((scope < 0) || (scope >= (int)m_scopes.size()))
+	{
+		return(0.0);
+	}
+	return(m_scopes[scope].gpuAverageMs);
+}
+
+/***********************************************************
+ *  GetRecentGpuTimeMs()
+ *
+ *  This method returns the GPU moving average, which follows
+ *  the last few frames instead of the last report.
+ ***********************************************************/
+double FrameProfiler::GetRecentGpuTimeMs(int scope) const
+{
+	if ((scope < 0) || (scope >= (int)m_scopes.size()))
+	{
+		return(0.0);
+	}
+	return(m_scopes[scope].gpuRecentMs);
+}
+
+/***********************************************************
+ *  PrintReport()
+ *
+ *  This method averages the samples since the last report
+ *  and prints one line per scope.
+ ***********************************************************/
+void FrameProfiler::PrintReport()
+{
+	std::cout << "INFO: frame timings (cpu / gpu ms)" << std::endl;
+	for (size_t i = 0; i < m_scopes.size(); i++)
+	{
+		PROFILE_SCOPE& scope = m_scopes[i];
+		if (scope.cpuSamples > 0)
+		{
+			scope.cpuAverageMs = scope.cpuSumMs / scope.cpuSamples;
+		}
+		if (scope.gpuSamples > 0)
+		{
+			scope.gpuAverageMs = scope.gpuSumMs / scope.gpuSamples;
+		}
+		scope.cpuSumMs = 0.0;
+		scope.gpuSumMs = 0.0;
+		scope.cpuSamples = 0;
+		scope.gpuSamples = 0;
+
+		std::cout << "  " << std::left << std::setw(12) << scope.name << std::right << std::fixed << std::setprecision(3)
+			<< std::setw(8) << scope.cpuAverageMs << " / " << std::setw(8) << scope.gpuAverageMs << std::endl;
+	}
+	std::cout << "  GL state calls: " << GLStateCache::GetIssuedCalls() << " issued, "
+		<< GLStateCache::GetSuppressedCalls() << " suppressed" << std::endl;
+}
@@ -0,0 +1,77 @@
+///////////////////////////////////////////////////////////////////////////////
+// frameprofiler.h
+// ============
+// CPU and GPU timing of the render passes
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  FrameProfiler
+ *
+ *  This class times named scopes on the CPU and, through
+ *  timestamp queries, on the GPU. Query results are read a
+ *  few frames late so the CPU never waits for the GPU, and
+ *  the averages are printed to the console every couple of
+ *  seconds. Scopes may nest.
+ ***********************************************************/
+class FrameProfiler
+{
+public:
+	// constructor
+	FrameProfiler();
+	// destructor
+	~FrameProfiler();
+
+	// add a named scope, returns the id for Begin/EndScope()
+	int RegisterScope(const char* name);
+	void BeginScope(int scope);
+	void EndScope(int scope);
+	// collect finished queries and print the report when it is due
+	void EndFrame();
+
+	// latest averaged timings of a scope in milliseconds
+	double GetCpuTimeMs(int scope) const;
+	double GetGpuTimeMs(int scope) const;
+	// GPU time smoothed over the last few frames, for controllers
+	// that cannot wait for the next report
+	double GetRecentGpuTimeMs(int scope) const;
+
+private:
+	// frames in flight before a query result is read back
+	static const int FRAME_LATENCY = 4;
+
+	struct PROFILE_SCOPE
+	{
+		std::string name;
+		GLuint queries[FRAME_LATENCY][2];
+		bool bIssued[FRAME_LATENCY];
+		std::chrono::high_resolution_clock::time_point cpuStart;
+		// sums since the last report
+		double cpuSumMs;
+		double gpuSumMs;
+		int cpuSamples;
+		int gpuSamples;
+		// averages of the last report
+		double cpuAverageMs;
+		double gpuAverageMs;
+		// moving average updated with every result read back
+		double gpuRecentMs;
+	};
+
+	std::vector<PROFILE_SCOPE> m_scopes;
+	int m_frameSlot;
+	std::chrono::high_resolution_clock::time_point m_lastReport;
+
+	void ReadQueries(PROFILE_SCOPE& scope, int slot);
+	void PrintReport();
+};
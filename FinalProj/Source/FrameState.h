@@ -0,0 +1,50 @@
+///////////////////////////////////////////////////////////////////////////////
+// framestate.h
+// ============
+// snapshot of everything the renderer needs to draw one frame
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+// most cameras a frame can be drawn from at once, MAX_VIEWS in
+// vertex.glsl and fragment.glsl
+const int MAX_FRAME_VIEWS = 3;
+
+// one camera of a frame and the rectangle of the frame it fills, as
+// (x, y, width, height) fractions of the framebuffer from the bottom left
+struct FRAME_VIEW
+{
+	glm::mat4 viewProjection;
+	glm::vec3 viewPosition;
+	glm::vec4 rectangle;
+};
+
+// camera state for one frame, produced by the update thread and
+// read by the render thread, never changed once published
+struct FRAME_STATE
+{
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::mat4 viewProjection;
+	glm::vec3 viewPosition;
+	// clip planes of the projection, used to split the shadow cascades
+	float nearPlane;
+	float farPlane;
+	// the projection is parallel, there is no eye point to face
+	bool bOrthographic;
+	// size of the window's framebuffer, 0 while the window is minimized
+	int framebufferWidth;
+	int framebufferHeight;
+	// time the snapshot was taken, for animation
+	double time;
+	unsigned long long frameIndex;
+	// every camera the frame is drawn from, the first one is the
+	// camera above and the only one unless the frame is split
+	int viewCount;
+	FRAME_VIEW views[MAX_FRAME_VIEWS];
+};
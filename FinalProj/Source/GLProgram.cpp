@@ -0,0 +1,221 @@
+///////////////////////////////////////////////////////////////////////////////
+// glprogram.cpp
+// ============
+// loading of the extra shader programs used by the render passes
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GLProgram.h"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace
+{
+	// deepest nesting of included GLSL files, so a file that
+	// includes itself fails instead of recursing forever
+	const int MAX_INCLUDE_DEPTH = 8;
+
+	/***********************************************************
+	 *  ReadShaderSource()
+	 *
+	 *  This function reads a GLSL file into code, replacing
+	 *  every #include "file" line with the contents of that
+	 *  file, and returns false when a file can't be read. The
+	 *  version of the including file wins, the #version lines
+	 *  of included files are dropped.
+	 ***********************************************************/
+	bool ReadShaderSource(const char* filename, std::string& code, int depth)
+	{
+		std::ifstream file(filename);
+		if (!file.is_open())
+		{
+			std::cout << "Could not open shader file:" << filename << std::endl;
+			return(false);
+		}
+		if (depth > MAX_INCLUDE_DEPTH)
+		{
+			std::cout << "ERROR: shader includes are nested too deep at " << filename << std::endl;
+			return(false);
+		}
+
+		std::string line;
+		while (std::getline(file, line))
+		{
+			size_t start = line.find_first_not_of(" \t");
+			if ((start != std::string::npos) && (line.compare(start, 8, "#include") == 0))
+			{
+				size_t nameBegin = line.find('"', start + 8);
+				size_t nameEnd = (nameBegin == std::string::npos) ? nameBegin : line.find('"', nameBegin + 1);
+				if (nameEnd == std::string::npos)
+				{
+					std::cout << "ERROR: malformed include in shader " << filename << ": " << line << std::endl;
+					return(false);
+				}
+				std::string includeName = line.substr(nameBegin + 1, nameEnd - nameBegin - 1);
+				if (!ReadShaderSource(includeName.c_str(), code, depth + 1))
+				{
+					return(false);
+				}
+				continue;
+			}
+			if ((depth > 0) && (start != std::string::npos) && (line.compare(start, 8, "#version") == 0))
+			{
+				continue;
+			}
+			code += line;
+			code += '\n';
+		}
+		return(true);
+	}
+
+	/***********************************************************
+	 *  CompileShaderFile()
+	 *
+	 *  This function reads and compiles one GLSL file, and
+	 *  returns 0 after printing the log when it fails.
+	 ***********************************************************/
+	GLuint CompileShaderFile(GLenum shaderType, const char* filename)
+	{
+		std::string code;
+		if (!ReadShaderSource(filename, code, 0))
+		{
+			return(0);
+		}
+		const char* codeText = code.c_str();
+
+		GLuint shader = glCreateShader(shaderType);
+		glShaderSource(shader, 1, &codeText, NULL);
+		glCompileShader(shader);
+
+		GLint success = 0;
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+		if (!success)
+		{
+			char infoLog[1024];
+			glGetShaderInfoLog(shader, sizeof(infoLog), NULL, infoLog);
+			std::cout << "ERROR: could not compile shader " << filename << "\n" << infoLog << std::endl;
+			glDeleteShader(shader);
+			return(0);
+		}
+		return(shader);
+	}
+
+	/***********************************************************
+	 *  LinkShaders()
+	 *
+	 *  This function links the compiled shaders into a program
+	 *  and releases the shader objects. Outputs listed for
+	 *  transform feedback have to be named before the link.
+	 ***********************************************************/
+	GLuint LinkShaders(
+		const GLuint* shaders,
+		int shaderCount,
+		const char* const* capturedOutputs = NULL,
+		int capturedOutputCount = 0)
+	{
+		GLuint program = glCreateProgram();
+		for (int i = 0; i < shaderCount; i++)
+		{
+			glAttachShader(program, shaders[i]);
+		}
+		if (capturedOutputCount > 0)
+		{
+			glTransformFeedbackVaryings(program, capturedOutputCount, capturedOutputs, GL_INTERLEAVED_ATTRIBS);
+		}
+		glLinkProgram(program);
+		for (int i = 0; i < shaderCount; i++)
+		{
+			glDetachShader(program, shaders[i]);
+			glDeleteShader(shaders[i]);
+		}
+
+		GLint success = 0;
+		glGetProgramiv(program, GL_LINK_STATUS, &success);
+		if (!success)
+		{
+			char infoLog[1024];
+			glGetProgramInfoLog(program, sizeof(infoLog), NULL, infoLog);
+			std::cout << "ERROR: could not link shader program\n" << infoLog << std::endl;
+			glDeleteProgram(program);
+			return(0);
+		}
+		return(program);
+	}
+}
+
+/***********************************************************
+ *  LoadGLProgram()
+ *
+ *  This function builds a program from a vertex shader, a
+ *  fragment shader and an optional geometry shader.
+ ***********************************************************/
+GLuint LoadGLProgram(
+	const char* vertexShaderPath,
+	const char* fragmentShaderPath,
+	const char* geometryShaderPath)
+{
+	GLuint shaders[3];
+	int shaderCount = 0;
+
+	shaders[shaderCount++] = CompileShaderFile(GL_VERTEX_SHADER, vertexShaderPath);
+	shaders[shaderCount++] = CompileShaderFile(GL_FRAGMENT_SHADER, fragmentShaderPath);
+	if (NULL != geometryShaderPath)
+	{
+		shaders[shaderCount++] = CompileShaderFile(GL_GEOMETRY_SHADER, geometryShaderPath);
+	}
+
+	bool bCompiled = true;
+	for (int i = 0; i < shaderCount; i++)
+	{
+		bCompiled = bCompiled && (shaders[i] != 0);
+	}
+	if (!bCompiled)
+	{
+		for (int i = 0; i < shaderCount; i++)
+		{
+			glDeleteShader(shaders[i]);
+		}
+		return(0);
+	}
+
+	return(LinkShaders(shaders, shaderCount));
+}
+
+/***********************************************************
+ *  LoadGLComputeProgram()
+ *
+ *  This function builds a program from one compute shader.
+ ***********************************************************/
+GLuint LoadGLComputeProgram(const char* computeShaderPath)
+{
+	GLuint shader = CompileShaderFile(GL_COMPUTE_SHADER, computeShaderPath);
+	if (shader == 0)
+	{
+		return(0);
+	}
+	return(LinkShaders(&shader, 1));
+}
+
+/***********************************************************
+ *  LoadGLCaptureProgram()
+ *
+ *  This function builds a vertex only program for capturing
+ *  vertex outputs with transform feedback, to be used with
+ *  the rasterizer discarded.
+ ***********************************************************/
+GLuint LoadGLCaptureProgram(
+	const char* vertexShaderPath,
+	const char* const* capturedOutputs,
+	int capturedOutputCount)
+{
+	GLuint shader = CompileShaderFile(GL_VERTEX_SHADER, vertexShaderPath);
+	if (shader == 0)
+	{
+		return(0);
+	}
+	return(LinkShaders(&shader, 1, capturedOutputs, capturedOutputCount));
+}
@@ -0,0 +1,35 @@
+///////////////////////////////////////////////////////////////////////////////
+// glprogram.h
+// ============
+// loading of the extra shader programs used by the render passes
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+
+// compile and link a program from GLSL files, the geometry shader is
+// optional; returns 0 and prints the log when anything fails. A line
+// #include "file.glsl" in any of the files is replaced by that file,
+// which is opened relative to the working folder like the shaders;
+// an included file's own #version line is left out, so a variant can
+// include a whole shader under a newer version
+GLuint LoadGLProgram(
+	const char* vertexShaderPath,
+	const char* fragmentShaderPath,
+	const char* geometryShaderPath = NULL);
+
+// compile and link a compute program; returns 0 on failure
+GLuint LoadGLComputeProgram(const char* computeShaderPath);
+
+// compile and link a vertex shader alone whose listed outputs are
+// captured interleaved by transform feedback; returns 0 on failure
+GLuint LoadGLCaptureProgram(
+	const char* vertexShaderPath,
+	const char* const* capturedOutputs,
+	int capturedOutputCount);
@@ -0,0 +1,497 @@
+///////////////////////////////////////////////////////////////////////////////
+// glstatecache.cpp
+// ============
+// shadow copy of the OpenGL state that drops calls which change nothing
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GLStateCache.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstring>
+#include <vector>
+
+namespace
+{
+	// marks a binding whose value is not known
+	const GLuint UNKNOWN_NAME = 0xFFFFFFFFu;
+	const GLenum UNKNOWN_ENUM = 0xFFFFFFFFu;
+
+	// texture units and targets that are mirrored, binds to other
+	// targets are always issued
+	const int MAX_TEXTURE_UNITS = 32;
+	const GLenum g_TextureTargets[] = { GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY };
+	const int TEXTURE_TARGET_COUNT = sizeof(g_TextureTargets) / sizeof(g_TextureTargets[0]);
+
+	// flags that are mirrored, other flags are always issued
+	const GLenum g_Capabilities[] =
+	{
+		GL_DEPTH_TEST,
+		GL_BLEND,
+		GL_CULL_FACE,
+		GL_DEPTH_CLAMP,
+		GL_POLYGON_OFFSET_FILL,
+		GL_RASTERIZER_DISCARD,
+		GL_CLIP_DISTANCE0,
+		GL_CLIP_DISTANCE1,
+		GL_CLIP_DISTANCE2,
+		GL_CLIP_DISTANCE3
+	};
+	const int CAPABILITY_COUNT = sizeof(g_Capabilities) / sizeof(g_Capabilities[0]);
+
+	// last value written to one uniform location, ints are kept by
+	// their bits so every type compares the same way
+	struct UNIFORM_VALUE
+	{
+		int size;  // floats or ints stored, 0 while unknown
+		float values[16];
+	};
+
+	GLuint g_Program = UNKNOWN_NAME;
+	GLuint g_VertexArray = UNKNOWN_NAME;
+	int g_ActiveUnit = -1;
+	GLuint g_Textures[MAX_TEXTURE_UNITS][TEXTURE_TARGET_COUNT];
+	int g_CapabilityStates[CAPABILITY_COUNT];  // -1 unknown, 0 off, 1 on
+	GLenum g_BlendSource = UNKNOWN_ENUM;
+	GLenum g_BlendDestination = UNKNOWN_ENUM;
+	int g_DepthMask = -1;  // -1 unknown, 0 off, 1 on
+	// per program name, per location
+	std::vector<std::vector<UNIFORM_VALUE> > g_Uniforms;
+	bool g_bInitialized = false;
+
+	unsigned long long g_IssuedCalls = 0;
+	unsigned long long g_SuppressedCalls = 0;
+	unsigned long long g_LastIssuedCalls = 0;
+	unsigned long long g_LastSuppressedCalls = 0;
+
+	void ForgetTextures()
+	{
+		for (int unit = 0; unit < MAX_TEXTURE_UNITS; unit++)
+		{
+			for (int target = 0; target < TEXTURE_TARGET_COUNT; target++)
+			{
+				g_Textures[unit][target] = UNKNOWN_NAME;
+			}
+		}
+		g_ActiveUnit = -1;
+	}
+
+	void ForgetCapabilities()
+	{
+		for (int i = 0; i < CAPABILITY_COUNT; i++)
+		{
+			g_CapabilityStates[i] = -1;
+		}
+		g_BlendSource = UNKNOWN_ENUM;
+		g_BlendDestination = UNKNOWN_ENUM;
+		g_DepthMask = -1;
+	}
+
+	void Initialize()
+	{
+		if (!g_bInitialized)
+		{
+			ForgetTextures();
+			ForgetCapabilities();
+			g_bInitialized = true;
+		}
+	}
+
+	// returns the mirror of a location of the current program, or
+	// NULL when the program or location cannot be mirrored
+	UNIFORM_VALUE* FindUniform(GLint location)
+	{
+		if ((location < 0) || (g_Program == UNKNOWN_NAME) || (g_Program == 0))
+		{
+			return(NULL);
+		}
+		if (g_Uniforms.size() <= g_Program)
+		{
+			g_Uniforms.resize(g_Program + 1);
+		}
+		std::vector<UNIFORM_VALUE>& locations = g_Uniforms[g_Program];
+		if (locations.size() <= (size_t)location)
+		{
+			UNIFORM_VALUE unknown;
+			unknown.size = 0;
+			locations.resize(location + 1, unknown);
+		}
+		return(&locations[location]);
+	}
+
+	// true when the value differs from the mirror, which then takes it
+	bool UpdateUniform(GLint location, const void* pValues, int size)
+	{
+		UNIFORM_VALUE* pMirror = FindUniform(location);
+		if (NULL == pMirror)
+		{
+			g_IssuedCalls++;
+			return(true);
+		}
+		if ((pMirror->size == size) && (memcmp(pMirror->values, pValues, size * sizeof(float)) == 0))
+		{
+			g_SuppressedCalls++;
+			return(false);
+		}
+		pMirror->size = size;
+		memcpy(pMirror->values, pValues, size * sizeof(float));
+		g_IssuedCalls++;
+		return(true);
+	}
+}
+
+/***********************************************************
+ *  UseProgram()
+ *
+ *  This method makes a program current.
+ ***********************************************************/
+void GLStateCache::UseProgram(GLuint program)
+{
+	if (program == g_Program)
+	{
+		g_SuppressedCalls++;
+		return;
+	}
+	glUseProgram(program);
+	g_Program = program;
+	g_IssuedCalls++;
+}
+
+/***********************************************************
+ *  GetProgram()
+ *
+ *  This method returns the current program.
+ ***********************************************************/
+GLuint GLStateCache::GetProgram()
+{
+	if (g_Program == UNKNOWN_NAME)
+	{
+		GLint program = 0;
+		glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+		g_Program = (GLuint)program;
+	}
+	return(g_Program);
+}
+
+/***********************************************************
+ *  BindVertexArray()
+ *
+ *  This method binds a vertex array.
+ ***********************************************************/
+void GLStateCache::BindVertexArray(GLuint vertexArray)
+{
+	if (vertexArray == g_VertexArray)
+	{
+		g_SuppressedCalls++;
+		return;
+	}
+	glBindVertexArray(vertexArray);
+	g_VertexArray = vertexArray;
+	g_IssuedCalls++;
+}
+
+/***********************************************************
+ *  BindTexture()
+ *
+ *  This method binds a texture to a unit, selecting the
+ *  unit only when the texture changes.
+ ***********************************************************/
+void GLStateCache::BindTexture(int unit, GLenum target, GLuint texture)
+{
+	Initialize();
+
+	int targetIndex = -1;
+	for (int i = 0; i < TEXTURE_TARGET_COUNT; i++)
+	{
+		if (g_TextureTargets[i] == target)
+		{
+			targetIndex = i;
+		}
+	}
+	bool bMirrored = (unit >= 0) && (unit < MAX_TEXTURE_UNITS) && (targetIndex >= 0);
+	if (bMirrored && (g_Textures[unit][targetIndex] == texture))
+	{
+		g_SuppressedCalls++;
+		return;
+	}
+
+	if (unit != g_ActiveUnit)
+	{
+		glActiveTexture(GL_TEXTURE0 + unit);
+		g_ActiveUnit = unit;
+		g_IssuedCalls++;
+	}
+	glBindTexture(target, texture);
+	if (bMirrored)
+	{
+		g_Textures[unit][targetIndex] = texture;
+	}
+	g_IssuedCalls++;
+}
+
+/***********************************************************
+ *  ActiveTexture()
+ *
+ *  This method selects the texture unit the following
+ *  texture calls act on.
+ ***********************************************************/
+void GLStateCache::ActiveTexture(int unit)
+{
+	Initialize();
+
+	if (unit == g_ActiveUnit)
+	{
+		g_SuppressedCalls++;
+		return;
+	}
+	glActiveTexture(GL_TEXTURE0 + unit);
+	g_ActiveUnit = unit;
+	g_IssuedCalls++;
+}
+
+/***********************************************************
+ *  DeleteTexture()
+ *
+ *  This method deletes a texture and clears it from the
+ *  units it was bound to.
+ ***********************************************************/
+void GLStateCache::DeleteTexture(GLuint texture)
+{
+	Initialize();
+
+	glDeleteTextures(1, &texture);
+	for (int unit = 0; unit < MAX_TEXTURE_UNITS; unit++)
+	{
+		for (int target = 0; target < TEXTURE_TARGET_COUNT; target++)
+		{
+			if (g_Textures[unit][target] == texture)
+			{
+				g_Textures[unit][target] = 0;
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  SetEnabled()
+ *
+ *  This method turns a capability on or off.
+ ***********************************************************/
+void GLStateCache::SetEnabled(GLenum capability, bool bEnabled)
+{
+	Initialize();
+
+	int state = bEnabled ? 1 : 0;
+	int* pMirror = NULL;
+	for (int i = 0; i < CAPABILITY_COUNT; i++)
+	{
+		if (g_Capabilities[i] == capability)
+		{
+			pMirror = &g_CapabilityStates[i];
+		}
+	}
+	if ((NULL != pMirror) && (*pMirror == state))
+	{
+		g_SuppressedCalls++;
+		return;
+	}
+
+	if (bEnabled)
+	{
+		glEnable(capability);
+	}
+	else
+	{
+		glDisable(capability);
+	}
+	if (NULL != pMirror)
+	{
+		*pMirror = state;
+	}
+	g_IssuedCalls++;
+}
+
+/***********************************************************
+ *  IsEnabled()
+ *
+ *  This method tells whether a capability is on.
+ ***********************************************************/
+bool GLStateCache::IsEnabled(GLenum capability)
+{
+	Initialize();
+
+	for (int i = 0; i < CAPABILITY_COUNT; i++)
+	{
+		if (g_Capabilities[i] == capability)
+		{
+			if (g_CapabilityStates[i] < 0)
+			{
+				g_CapabilityStates[i] = (glIsEnabled(capability) == GL_TRUE) ? 1 : 0;
+			}
+			return(g_CapabilityStates[i] == 1);
+		}
+	}
+	return(glIsEnabled(capability) == GL_TRUE);
+}
+
+/***********************************************************
+ *  BlendFunc()
+ *
+ *  This method sets the blend factors.
+ ***********************************************************/
+void GLStateCache::BlendFunc(GLenum sourceFactor, GLenum destinationFactor)
+{
+	if ((sourceFactor == g_BlendSource) && (destinationFactor == g_BlendDestination))
+	{
+		g_SuppressedCalls++;
+		return;
+	}
+	glBlendFunc(sourceFactor, destinationFactor);
+	g_BlendSource = sourceFactor;
+	g_BlendDestination = destinationFactor;
+	g_IssuedCalls++;
+}
+
+/***********************************************************
+ *  BlendFunci()
+ *
+ *  This method sets the blend factors of one draw buffer.
+ *  The mirror only knows factors shared by every buffer,
+ *  so the next BlendFunc() is always issued.
+ ***********************************************************/
+void GLStateCache::BlendFunci(GLuint drawBuffer, GLenum sourceFactor, GLenum destinationFactor)
+{
+	glBlendFunci(drawBuffer, sourceFactor, destinationFactor);
+	g_BlendSource = UNKNOWN_ENUM;
+	g_BlendDestination = UNKNOWN_ENUM;
+	g_IssuedCalls++;
+}
+
+/***********************************************************
+ *  DepthMask()
+ *
+ *  This method turns writing to the depth buffer on or off.
+ ***********************************************************/
+void GLStateCache::DepthMask(bool bWriteDepth)
+{
+	Initialize();
+
+	int state = bWriteDepth ? 1 : 0;
+	if (g_DepthMask == state)
+	{
+		g_SuppressedCalls++;
+		return;
+	}
+	glDepthMask(bWriteDepth ? GL_TRUE : GL_FALSE);
+	g_DepthMask = state;
+	g_IssuedCalls++;
+}
+
+/***********************************************************
+ *  SetUniform()
+ *
+ *  These methods set a uniform of the current program.
+ ***********************************************************/
+void GLStateCache::SetUniform(GLint location, int value)
+{
+	float bits;
+	memcpy(&bits, &value, sizeof(bits));
+	if (UpdateUniform(location, &bits, 1))
+	{
+		glUniform1i(location, value);
+	}
+}
+
+void GLStateCache::SetUniform(GLint location, float value)
+{
+	if (UpdateUniform(location, &value, 1))
+	{
+		glUniform1f(location, value);
+	}
+}
+
+void GLStateCache::SetUniform(GLint location, const glm::vec2& value)
+{
+	if (UpdateUniform(location, glm::value_ptr(value), 2))
+	{
+		glUniform2fv(location, 1, glm::value_ptr(value));
+	}
+}
+
+void GLStateCache::SetUniform(GLint location, const glm::vec4& value)
+{
+	if (UpdateUniform(location, glm::value_ptr(value), 4))
+	{
+		glUniform4fv(location, 1, glm::value_ptr(value));
+	}
+}
+
+void GLStateCache::SetUniform(GLint location, const glm::mat4& value)
+{
+	if (UpdateUniform(location, glm::value_ptr(value), 16))
+	{
+		glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
+	}
+}
+
+/***********************************************************
+ *  Invalidate()
+ *
+ *  This method forgets the mirrored bindings and flags.
+ ***********************************************************/
+void GLStateCache::Invalidate()
+{
+	g_Program = UNKNOWN_NAME;
+	g_VertexArray = UNKNOWN_NAME;
+	ForgetTextures();
+	ForgetCapabilities();
+	g_bInitialized = true;
+}
+
+/***********************************************************
+ *  InvalidateVertexArray()
+ *
+ *  This method forgets the bound vertex array.
+ ***********************************************************/
+void GLStateCache::InvalidateVertexArray()
+{
+	g_VertexArray = UNKNOWN_NAME;
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method closes the counts of the frame.
+ ***********************************************************/
+void GLStateCache::EndFrame()
+{
+	g_LastIssuedCalls = g_IssuedCalls;
+	g_LastSuppressedCalls = g_SuppressedCalls;
+	g_IssuedCalls = 0;
+	g_SuppressedCalls = 0;
+}
+
+/***********************************************************
+ *  GetIssuedCalls()
+ *
+ *  This method returns the calls passed on to OpenGL in the
+ *  last closed frame.
+ ***********************************************************/
+unsigned long long GLStateCache::GetIssuedCalls()
+{
+	return(g_LastIssuedCalls);
+}
+
+/***********************************************************
+ *  GetSuppressedCalls()
+ *
+ *  This method returns the calls dropped in the last closed
+ *  frame.
+ ***********************************************************/
+unsigned long long GLStateCache::GetSuppressedCalls()
+{
+	return(g_LastSuppressedCalls);
+}
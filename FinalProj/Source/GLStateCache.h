@@ -0,0 +1,70 @@
+///////////////////////////////////////////////////////////////////////////////
+// glstatecache.h
+// ============
+// shadow copy of the OpenGL state that drops calls which change nothing
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+/***********************************************************
+ *  GLStateCache
+ *
+ *  This class mirrors the bound program, vertex array,
+ *  textures per unit, enable flags, blend function, depth
+ *  mask and the uniform values of every program, and only
+ *  passes a call on to OpenGL when it changes something.
+ *  There is one context, so the mirror is shared by all
+ *  the passes; it only stays true while they all go through
+ *  it, and code that changes state behind its back (the
+ *  shape meshes bind their own vertex arrays) has to invalidate
+ *  the part it touched. Unknown state is always issued.
+ *  The issued and suppressed calls are counted per frame.
+ ***********************************************************/
+class GLStateCache
+{
+public:
+	static void UseProgram(GLuint program);
+	// current program, only asks OpenGL while it is unknown
+	static GLuint GetProgram();
+	static void BindVertexArray(GLuint vertexArray);
+	static void BindTexture(int unit, GLenum target, GLuint texture);
+	// make a unit the active one, for calls that work on the
+	// texture bound to it such as generating mipmaps
+	static void ActiveTexture(int unit);
+	// delete a texture and forget the units it was bound to, since
+	// OpenGL unbinds it and its name may come back for a new one
+	static void DeleteTexture(GLuint texture);
+	static void SetEnabled(GLenum capability, bool bEnabled);
+	// only asks OpenGL for flags that are not mirrored or unknown
+	static bool IsEnabled(GLenum capability);
+	static void BlendFunc(GLenum sourceFactor, GLenum destinationFactor);
+	// blend factors of one draw buffer, always issued; the factors of
+	// all buffers are unknown afterwards
+	static void BlendFunci(GLuint drawBuffer, GLenum sourceFactor, GLenum destinationFactor);
+	// whether draws write the depth buffer
+	static void DepthMask(bool bWriteDepth);
+
+	// uniforms of the current program, by location
+	static void SetUniform(GLint location, int value);
+	static void SetUniform(GLint location, float value);
+	static void SetUniform(GLint location, const glm::vec2& value);
+	static void SetUniform(GLint location, const glm::vec4& value);
+	static void SetUniform(GLint location, const glm::mat4& value);
+
+	// forget the bindings and flags, after code outside the cache
+	// changed them; uniform values stay, they belong to the programs
+	static void Invalidate();
+	static void InvalidateVertexArray();
+
+	// close the frame's counts, Get*Calls() return the closed frame
+	static void EndFrame();
+	static unsigned long long GetIssuedCalls();
+	static unsigned long long GetSuppressedCalls();
+};
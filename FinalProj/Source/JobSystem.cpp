@@ -0,0 +1,170 @@
+///////////////////////////////////////////////////////////////////////////////
+// jobsystem.cpp
+// ============
+// small worker thread pool for splitting the scene traversal across cores
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "JobSystem.h"
+#include "AllocationTracker.h"
+
+#include <algorithm>
+
+/***********************************************************
+ *  JobSystem()
+ *
+ *  The constructor for the class. The calling thread counts
+ *  as worker 0, so workerCount - 1 threads are started.
+ ***********************************************************/
+JobSystem::JobSystem(int workerCount)
+{
+	if (workerCount <= 0)
+	{
+		workerCount = (int)std::thread::hardware_concurrency();
+	}
+	m_workerCount = std::max(workerCount, 1);
+	m_ranges.reset(new WORKER_RANGE[m_workerCount]);
+	for (int i = 0; i < m_workerCount; i++)
+	{
+		m_ranges[i].next = 0;
+		m_ranges[i].end = 0;
+	}
+
+	m_generation = 0;
+	m_busyWorkers = 0;
+	m_bQuit = false;
+	m_pJob = NULL;
+	m_chunkSize = 1;
+
+	for (int i = 1; i < m_workerCount; i++)
+	{
+		m_threads.push_back(std::thread(&JobSystem::WorkerLoop, this, i));
+	}
+}
+
+/***********************************************************
+ *  ~JobSystem()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bQuit = true;
+	}
+	m_wakeCondition.notify_all();
+
+	for (size_t i = 0; i < m_threads.size(); i++)
+	{
+		m_threads[i].join();
+	}
+	m_threads.clear();
+}
+
+/***********************************************************
+ *  ParallelFor()
+ *
+ *  This method splits [0, count) into one slice per worker,
+ *  wakes the workers and helps with the work on the calling
+ *  thread until every chunk is done.
+ ***********************************************************/
+void JobSystem::ParallelFor(int count, int chunkSize, const RANGE_JOB& job)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+	chunkSize = std::max(chunkSize, 1);
+
+	// not worth waking anybody for a single chunk
+	if ((m_workerCount == 1) || (count <= chunkSize))
+	{
+		job(0, count, 0);
+		return;
+	}
+
+	int sliceSize = (count + m_workerCount - 1) / m_workerCount;
+	for (int i = 0; i < m_workerCount; i++)
+	{
+		int begin = std::min(i * sliceSize, count);
+		m_ranges[i].next = begin;
+		m_ranges[i].end = std::min(begin + sliceSize, count);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_pJob = &job;
+		m_chunkSize = chunkSize;
+		m_busyWorkers = m_workerCount - 1;
+		m_generation++;
+	}
+	m_wakeCondition.notify_all();
+
+	RunChunks(0);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_doneCondition.wait(lock, [this]() { return(m_busyWorkers == 0); });
+	m_pJob = NULL;
+}
+
+/***********************************************************
+ *  WorkerLoop()
+ *
+ *  This method is the body of every worker thread. It sleeps
+ *  until a new range is published or the pool shuts down.
+ ***********************************************************/
+void JobSystem::WorkerLoop(int workerIndex)
+{
+	unsigned int seenGeneration = 0;
+	// the workers only ever run frame work
+	AllocationTracker::TrackCurrentThread();
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wakeCondition.wait(lock, [&]() { return(m_bQuit || (m_generation != seenGeneration)); });
+			if (m_bQuit)
+			{
+				return;
+			}
+			seenGeneration = m_generation;
+		}
+
+		RunChunks(workerIndex);
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_busyWorkers--;
+		}
+		m_doneCondition.notify_one();
+	}
+}
+
+/***********************************************************
+ *  RunChunks()
+ *
+ *  This method drains the worker's own slice and then steals
+ *  chunks from the other slices, starting with the next
+ *  worker so the thieves spread out over the victims.
+ ***********************************************************/
+void JobSystem::RunChunks(int workerIndex)
+{
+	for (int offset = 0; offset < m_workerCount; offset++)
+	{
+		WORKER_RANGE& range = m_ranges[(workerIndex + offset) % m_workerCount];
+
+		while (true)
+		{
+			int begin = range.next.fetch_add(m_chunkSize);
+			if (begin >= range.end)
+			{
+				break;
+			}
+			(*m_pJob)(begin, std::min(begin + m_chunkSize, range.end), workerIndex);
+		}
+	}
+}
@@ -0,0 +1,71 @@
+///////////////////////////////////////////////////////////////////////////////
+// jobsystem.h
+// ============
+// small worker thread pool for splitting the scene traversal across cores
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  JobSystem
+ *
+ *  This class keeps a set of worker threads parked until
+ *  ParallelFor() hands them a range of work. Every worker
+ *  starts on its own slice of the range and steals chunks
+ *  from the other slices once its own slice is empty, so an
+ *  uneven slice does not leave the other cores idle.
+ ***********************************************************/
+class JobSystem
+{
+public:
+	// job callback: first index, one past the last index, worker index
+	typedef std::function<void(int, int, int)> RANGE_JOB;
+
+	// constructor, 0 workers means one per hardware thread
+	JobSystem(int workerCount = 0);
+	// destructor
+	~JobSystem();
+
+	// number of workers including the calling thread (worker 0)
+	int GetWorkerCount() const { return(m_workerCount); }
+
+	// run the job over [0, count) in chunks and wait for it to finish
+	void ParallelFor(int count, int chunkSize, const RANGE_JOB& job);
+
+private:
+	// one worker's slice of the current range, on its own cache line
+	// since the other workers steal from it
+	struct alignas(64) WORKER_RANGE
+	{
+		std::atomic<int> next;
+		int end;
+	};
+
+	int m_workerCount;
+	std::vector<std::thread> m_threads;
+	std::unique_ptr<WORKER_RANGE[]> m_ranges;
+
+	std::mutex m_mutex;
+	std::condition_variable m_wakeCondition;
+	std::condition_variable m_doneCondition;
+	unsigned int m_generation;
+	int m_busyWorkers;
+	bool m_bQuit;
+
+	const RANGE_JOB* m_pJob;
+	int m_chunkSize;
+
+	void WorkerLoop(int workerIndex);
+	void RunChunks(int workerIndex);
+};
@@ -0,0 +1,179 @@
+///////////////////////////////////////////////////////////////////////////////
+// materialtable.cpp
+// ============
+// packed material table kept in a GPU buffer and indexed by material id
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MaterialTable.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+	// one std140 array of vec4 per material property
+	const GLsizeiptr ARRAY_BYTES = MaterialTable::MAX_MATERIALS * sizeof(glm::vec4);
+}
+
+/***********************************************************
+ *  MaterialTable()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MaterialTable::MaterialTable()
+{
+	m_buffer = 0;
+	m_dirtyBegin = 0;
+	m_dirtyEnd = 0;
+}
+
+/***********************************************************
+ *  ~MaterialTable()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MaterialTable::~MaterialTable()
+{
+	glDeleteBuffers(1, &m_buffer);
+	m_buffer = 0;
+}
+
+/***********************************************************
+ *  AddMaterial()
+ *
+ *  This method appends a material and registers its tag.
+ ***********************************************************/
+int MaterialTable::AddMaterial(
+	const char* tag,
+	glm::vec3 ambientColor,
+	float ambientStrength,
+	glm::vec3 diffuseColor,
+	glm::vec3 specularColor,
+	float shininess)
+{
+	if (GetCount() >= MAX_MATERIALS)
+	{
+		std::cout << "ERROR: material table is full, cannot add " << tag << std::endl;
+		return(-1);
+	}
+
+	int index = GetCount();
+	m_ambient.push_back(glm::vec4(0.0f));
+	m_diffuse.push_back(glm::vec4(0.0f));
+	m_specular.push_back(glm::vec4(0.0f));
+	m_indices[tag] = index;
+	SetMaterial(index, ambientColor, ambientStrength, diffuseColor, specularColor, shininess);
+	return(index);
+}
+
+/***********************************************************
+ *  SetMaterial()
+ *
+ *  This method changes the values of a material and marks
+ *  its entry for the next upload.
+ ***********************************************************/
+void MaterialTable::SetMaterial(
+	int index,
+	glm::vec3 ambientColor,
+	float ambientStrength,
+	glm::vec3 diffuseColor,
+	glm::vec3 specularColor,
+	float shininess)
+{
+	if ((index < 0) || (index >= GetCount()))
+	{
+		return;
+	}
+	m_ambient[index] = glm::vec4(ambientColor, ambientStrength);
+	m_diffuse[index] = glm::vec4(diffuseColor, shininess);
+	m_specular[index] = glm::vec4(specularColor, 0.0f);
+	MarkDirty(index);
+}
+
+/***********************************************************
+ *  FindMaterial()
+ *
+ *  This method looks up a material index by its tag.
+ ***********************************************************/
+int MaterialTable::FindMaterial(const char* tag) const
+{
+	std::unordered_map<std::string, int>::const_iterator found = m_indices.find(tag);
+	if (found == m_indices.end())
+	{
+		return(-1);
+	}
+	return(found->second);
+}
+
+/***********************************************************
+ *  MarkDirty()
+ *
+ *  This method grows the dirty range to include an entry.
+ ***********************************************************/
+void MaterialTable::MarkDirty(int index)
+{
+	if (m_dirtyBegin >= m_dirtyEnd)
+	{
+		m_dirtyBegin = index;
+		m_dirtyEnd = index + 1;
+	}
+	else
+	{
+		m_dirtyBegin = std::min(m_dirtyBegin, index);
+		m_dirtyEnd = std::max(m_dirtyEnd, index + 1);
+	}
+}
+
+/***********************************************************
+ *  BindProgram()
+ *
+ *  This method points a program's MaterialTable uniform
+ *  block at the table's binding point. GLSL 3.30 has no
+ *  binding layout qualifier for blocks, so it is done here.
+ ***********************************************************/
+void MaterialTable::BindProgram(GLuint program)
+{
+	GLuint blockIndex = glGetUniformBlockIndex(program, "MaterialTable");
+	if (blockIndex != GL_INVALID_INDEX)
+	{
+		glUniformBlockBinding(program, blockIndex, BLOCK_BINDING);
+	}
+}
+
+/***********************************************************
+ *  Upload()
+ *
+ *  This method sends the dirty range of each array into the
+ *  uniform buffer and binds it. Nothing is sent when no
+ *  material changed.
+ ***********************************************************/
+void MaterialTable::Upload()
+{
+	if (m_buffer == 0)
+	{
+		glGenBuffers(1, &m_buffer);
+		glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+		glBufferData(GL_UNIFORM_BUFFER, ARRAY_BYTES * 3, NULL, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		glBindBufferBase(GL_UNIFORM_BUFFER, BLOCK_BINDING, m_buffer);
+	}
+
+	if (m_dirtyBegin >= m_dirtyEnd)
+	{
+		return;
+	}
+
+	GLintptr entryOffset = m_dirtyBegin * sizeof(glm::vec4);
+	GLsizeiptr dirtyBytes = (m_dirtyEnd - m_dirtyBegin) * sizeof(glm::vec4);
+	glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+	glBufferSubData(GL_UNIFORM_BUFFER, entryOffset, dirtyBytes, &m_ambient[m_dirtyBegin]);
+	glBufferSubData(GL_UNIFORM_BUFFER, ARRAY_BYTES + entryOffset, dirtyBytes, &m_diffuse[m_dirtyBegin]);
+	glBufferSubData(GL_UNIFORM_BUFFER, ARRAY_BYTES * 2 + entryOffset, dirtyBytes, &m_specular[m_dirtyBegin]);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	m_dirtyBegin = 0;
+	m_dirtyEnd = 0;
+}
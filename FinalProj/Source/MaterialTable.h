@@ -0,0 +1,85 @@
+///////////////////////////////////////////////////////////////////////////////
+// materialtable.h
+// ============
+// packed material table kept in a GPU buffer and indexed by material id
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/***********************************************************
+ *  MaterialTable
+ *
+ *  This class stores the materials as three packed arrays,
+ *  the same layout as the MaterialTable uniform block in the
+ *  scene shader, and mirrors them into a uniform buffer. A
+ *  draw only passes its material index. Edited entries are
+ *  marked dirty and Upload() sends just the changed range.
+ *  The tags are only needed while setting up the scene, so
+ *  they live in a separate name to index map.
+ ***********************************************************/
+class MaterialTable
+{
+public:
+	// must match MAX_MATERIALS in the scene shader
+	static const int MAX_MATERIALS = 256;
+	// uniform buffer binding point of the table
+	static const int BLOCK_BINDING = 0;
+
+	// constructor
+	MaterialTable();
+	// destructor
+	~MaterialTable();
+
+	// add a material, returns its index or -1 when the table is full
+	int AddMaterial(
+		const char* tag,
+		glm::vec3 ambientColor,
+		float ambientStrength,
+		glm::vec3 diffuseColor,
+		glm::vec3 specularColor,
+		float shininess);
+	// change a material, only its entry is uploaded again
+	void SetMaterial(
+		int index,
+		glm::vec3 ambientColor,
+		float ambientStrength,
+		glm::vec3 diffuseColor,
+		glm::vec3 specularColor,
+		float shininess);
+	// index of the material with the tag, -1 if there is none
+	int FindMaterial(const char* tag) const;
+	int GetCount() const { return((int)m_ambient.size()); }
+
+	// connect a program's MaterialTable block to the table's binding
+	static void BindProgram(GLuint program);
+	// create the buffer on first use, then send the dirty entries
+	void Upload();
+
+private:
+	// rgb ambient color, a ambient strength
+	std::vector<glm::vec4> m_ambient;
+	// rgb diffuse color, a shininess
+	std::vector<glm::vec4> m_diffuse;
+	// rgb specular color, a unused
+	std::vector<glm::vec4> m_specular;
+
+	// cold data, only used when resolving tags
+	std::unordered_map<std::string, int> m_indices;
+
+	GLuint m_buffer;
+	// entries [m_dirtyBegin, m_dirtyEnd) changed since the last upload
+	int m_dirtyBegin;
+	int m_dirtyEnd;
+
+	void MarkDirty(int index);
+};
@@ -0,0 +1,192 @@
+///////////////////////////////////////////////////////////////////////////////
+// multidraw.cpp
+// ============
+// batches of compact mesh draws issued with one indirect multi-draw call
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MultiDraw.h"
+#include "GLStateCache.h"
+
+#include <algorithm>
+
+namespace
+{
+	// draws the buffers start with room for, about one scene's worth
+	const size_t INITIAL_CAPACITY = 256;
+}
+
+/***********************************************************
+ *  MultiDraw()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MultiDraw::MultiDraw()
+{
+	m_pMeshes = NULL;
+	m_vao = 0;
+	m_drawIndexBuffer = 0;
+	m_drawTableBuffer = 0;
+	m_commandBuffer = 0;
+	m_capacity = 0;
+	m_drawIndexDivisor = 1;
+}
+
+/***********************************************************
+ *  ~MultiDraw()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MultiDraw::~MultiDraw()
+{
+	glDeleteVertexArrays(1, &m_vao);
+	glDeleteBuffers(1, &m_drawIndexBuffer);
+	glDeleteBuffers(1, &m_drawTableBuffer);
+	glDeleteBuffers(1, &m_commandBuffer);
+	m_pMeshes = NULL;
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method creates the vertex array of the batches,
+ *  which holds only the shared index buffer and the draw
+ *  index attribute, since the vertices are read by the
+ *  shader, and the buffers of the draw table and commands.
+ ***********************************************************/
+bool MultiDraw::Initialize(const CompactMeshes* pMeshes)
+{
+	if (!(GLEW_VERSION_4_3 || (GLEW_ARB_shader_storage_buffer_object && GLEW_ARB_multi_draw_indirect)) ||
+		(NULL == pMeshes) || (pMeshes->GetVertexBuffer() == 0))
+	{
+		return(false);
+	}
+	m_pMeshes = pMeshes;
+
+	glGenBuffers(1, &m_drawTableBuffer);
+	glGenBuffers(1, &m_commandBuffer);
+	glGenBuffers(1, &m_drawIndexBuffer);
+	glGenVertexArrays(1, &m_vao);
+	GLStateCache::BindVertexArray(m_vao);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, pMeshes->GetIndexBuffer());
+	glEnableVertexAttribArray(DRAW_INDEX_LOCATION);
+	GLStateCache::BindVertexArray(0);
+
+	m_draws.reserve(INITIAL_CAPACITY);
+	m_commands.reserve(INITIAL_CAPACITY);
+	Reserve(INITIAL_CAPACITY);
+	return(true);
+}
+
+/***********************************************************
+ *  Reserve()
+ *
+ *  This method grows the draw table, the commands and the
+ *  draw index buffer to hold the passed in number of draws.
+ *  The draw index buffer counts up from 0 so each draw's
+ *  base instance picks its own entry of the table.
+ ***********************************************************/
+void MultiDraw::Reserve(size_t drawCount)
+{
+	if (drawCount <= m_capacity)
+	{
+		return;
+	}
+	m_capacity = drawCount + drawCount / 2;
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_drawTableBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, m_capacity * sizeof(GPU_DRAW), NULL, GL_STREAM_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, m_capacity * sizeof(DRAW_COMMAND), NULL, GL_STREAM_DRAW);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+	std::vector<uint32_t> drawIndices(m_capacity);
+	for (size_t i = 0; i < m_capacity; i++)
+	{
+		drawIndices[i] = (uint32_t)i;
+	}
+	GLStateCache::BindVertexArray(m_vao);
+	glBindBuffer(GL_ARRAY_BUFFER, m_drawIndexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, m_capacity * sizeof(uint32_t), &drawIndices[0], GL_STATIC_DRAW);
+	glVertexAttribIPointer(DRAW_INDEX_LOCATION, 1, GL_UNSIGNED_INT, sizeof(uint32_t), (void*)0);
+	glVertexAttribDivisor(DRAW_INDEX_LOCATION, m_drawIndexDivisor);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+/***********************************************************
+ *  Add()
+ *
+ *  This method adds a draw to the open batch: its entry of
+ *  the draw table and a command over its mesh's indices.
+ ***********************************************************/
+void MultiDraw::Add(const DRAW_PACKET& packet)
+{
+	const glm::vec3& scale = m_pMeshes->GetPositionScale(packet.mesh);
+	const glm::vec3& bias = m_pMeshes->GetPositionBias(packet.mesh);
+
+	GPU_DRAW draw;
+	draw.model = packet.model;
+	draw.meltGroup = packet.meltGroup;
+	draw.meltParams = packet.meltParams;
+	draw.decodeScale = glm::vec4(scale, 1.0f);
+	draw.decodeBias = glm::vec4(bias, 0.0f);
+	m_draws.push_back(draw);
+
+	DRAW_COMMAND command;
+	command.count = (uint32_t)m_pMeshes->GetIndexCount(packet.mesh);
+	command.instanceCount = 1;
+	command.firstIndex = (uint32_t)m_pMeshes->GetFirstIndex(packet.mesh);
+	command.baseVertex = m_pMeshes->GetBaseVertex(packet.mesh);
+	command.baseInstance = (uint32_t)(m_commands.size());
+	m_commands.push_back(command);
+}
+
+/***********************************************************
+ *  Flush()
+ *
+ *  This method uploads the open batch and draws it with one
+ *  glMultiDrawElementsIndirect. Every draw is instanced
+ *  once per view of a split frame, so the draw index steps
+ *  once every viewCount instances.
+ ***********************************************************/
+void MultiDraw::Flush(int viewCount)
+{
+	if (m_commands.empty())
+	{
+		return;
+	}
+	int instanceCount = std::max(viewCount, 1);
+	for (size_t i = 0; i < m_commands.size(); i++)
+	{
+		m_commands[i].instanceCount = (uint32_t)instanceCount;
+	}
+	Reserve(m_commands.size());
+
+	GLStateCache::BindVertexArray(m_vao);
+	if (instanceCount != m_drawIndexDivisor)
+	{
+		m_drawIndexDivisor = instanceCount;
+		glVertexAttribDivisor(DRAW_INDEX_LOCATION, m_drawIndexDivisor);
+	}
+
+	// orphan last batch's storage, the GPU may still be reading it
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_drawTableBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, m_capacity * sizeof(GPU_DRAW), NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, m_draws.size() * sizeof(GPU_DRAW), &m_draws[0]);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, m_capacity * sizeof(DRAW_COMMAND), NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, m_commands.size() * sizeof(DRAW_COMMAND), &m_commands[0]);
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, VERTEX_BINDING, m_pMeshes->GetVertexBuffer());
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_TABLE_BINDING, m_drawTableBuffer);
+	glMultiDrawElementsIndirect(GL_TRIANGLES, m_pMeshes->GetIndexType(), (const void*)0,
+		(GLsizei)m_commands.size(), 0);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+	m_draws.clear();
+	m_commands.clear();
+}
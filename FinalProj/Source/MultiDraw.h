@@ -0,0 +1,97 @@
+///////////////////////////////////////////////////////////////////////////////
+// multidraw.h
+// ============
+// batches of compact mesh draws issued with one indirect multi-draw call
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "CompactMeshes.h"
+#include "DrawList.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  MultiDraw
+ *
+ *  This class collects draws of the compact meshes that
+ *  share their surface (textures, material, color) and
+ *  issues them with one glMultiDrawElementsIndirect over
+ *  the compact meshes' shared index buffer, whatever mix of
+ *  meshes they are. The scene shader built from
+ *  vertexPulling.glsl reads the vertices from the shared
+ *  vertex buffer as a storage buffer, and the model matrix,
+ *  melt values and decode constants of each draw from a
+ *  table filled per batch, so nothing is rebound or set
+ *  between the draws of a batch. It needs GL 4.3 storage
+ *  buffers and indirect draws; without them the scene
+ *  draws one packet at a time as before.
+ ***********************************************************/
+class MultiDraw
+{
+public:
+	// storage buffer bindings of vertexPulling.glsl, after the
+	// cluster culling's (3 to 7)
+	static const GLuint VERTEX_BINDING = 8;
+	static const GLuint DRAW_TABLE_BINDING = 9;
+	// instanced attribute stepping through the draw table
+	static const GLuint DRAW_INDEX_LOCATION = 5;
+
+	// constructor
+	MultiDraw();
+	// destructor
+	~MultiDraw();
+
+	// false without GL 4.3 or compact meshes
+	bool Initialize(const CompactMeshes* pMeshes);
+	bool IsReady() const { return(m_vao != 0); }
+
+	// add a draw of a ready compact mesh to the open batch
+	void Add(const DRAW_PACKET& packet);
+	size_t GetBatchSize() const { return(m_commands.size()); }
+	// draw the open batch, each draw once per view, and empty it
+	void Flush(int viewCount);
+
+private:
+	// std430 layout of DrawData in vertex.glsl
+	struct GPU_DRAW
+	{
+		glm::mat4 model;
+		glm::mat4 meltGroup;
+		glm::vec4 meltParams;
+		glm::vec4 decodeScale;
+		glm::vec4 decodeBias;
+	};
+	struct DRAW_COMMAND
+	{
+		uint32_t count;
+		uint32_t instanceCount;
+		uint32_t firstIndex;
+		int32_t baseVertex;
+		uint32_t baseInstance;
+	};
+
+	const CompactMeshes* m_pMeshes;
+	// the shared index buffer and the draw index attribute
+	GLuint m_vao;
+	GLuint m_drawIndexBuffer;
+	GLuint m_drawTableBuffer;
+	GLuint m_commandBuffer;
+	// draws the buffers have room for
+	size_t m_capacity;
+	// divisor of the draw index, the view count of the last batch
+	int m_drawIndexDivisor;
+
+	// the open batch, reserved so steady frames never allocate
+	std::vector<GPU_DRAW> m_draws;
+	std::vector<DRAW_COMMAND> m_commands;
+
+	void Reserve(size_t drawCount);
+};
@@ -0,0 +1,366 @@
+///////////////////////////////////////////////////////////////////////////////
+// planarreflection.cpp
+// ============
+// reduced resolution planar reflection of the scene in the floor
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "PlanarReflection.h"
+#include "GLStateCache.h"
+
+#include <glm/gtx/transform.hpp>
+
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+	// height of the floor plane the scene is mirrored in
+	const float FLOOR_HEIGHT = 0.0f;
+	// the clip plane sits this far under the floor, so objects
+	// resting on it keep their contact with the reflection
+	const float CLIP_OFFSET = 0.01f;
+	// mip levels of the target, the last one is the blur of the
+	// roughest material
+	const int MAX_LEVELS = 5;
+	// step down once the pass uses more than this share of the
+	// budget, step up once four times the time would still fit
+	const double STEP_DOWN_THRESHOLD = 1.0;
+	const double STEP_UP_THRESHOLD = 0.8;
+	const int SETTLE_FRAMES = 30;
+
+	// pixels of the scene per pixel of the reflection, per axis
+	int GetDivisor(PlanarReflection::REFLECTION_QUALITY quality)
+	{
+		return((quality == PlanarReflection::REFLECTION_HALF) ? 2 : 4);
+	}
+}
+
+/***********************************************************
+ *  PlanarReflection()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+PlanarReflection::PlanarReflection()
+{
+	m_maxQuality = REFLECTION_HALF;
+	m_quality = REFLECTION_HALF;
+	m_budgetMs = 0.0;
+	m_settleFrames = SETTLE_FRAMES;
+	m_bActive = false;
+	m_viewProjection = glm::mat4(1.0f);
+	m_viewPosition = glm::vec3(0.0f);
+	m_frustum.Extract(m_viewProjection);
+	m_width = 0;
+	m_height = 0;
+	m_levels = 1;
+	m_framebuffer = 0;
+	m_colorTexture = 0;
+	m_depthBuffer = 0;
+	m_uvScale = glm::vec2(0.0f);
+	m_maxUV = glm::vec2(0.0f);
+	m_previousFramebuffer = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		m_previousViewport[i] = 0;
+	}
+}
+
+/***********************************************************
+ *  ~PlanarReflection()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+PlanarReflection::~PlanarReflection()
+{
+	DestroyTargets();
+}
+
+/***********************************************************
+ *  SetQuality()
+ *
+ *  This method sets the quality, and the highest one the
+ *  budget may return to.
+ ***********************************************************/
+void PlanarReflection::SetQuality(REFLECTION_QUALITY quality)
+{
+	m_maxQuality = quality;
+	m_quality = quality;
+	m_settleFrames = SETTLE_FRAMES;
+}
+
+/***********************************************************
+ *  SetBudget()
+ *
+ *  This method sets the GPU time the reflection pass may
+ *  take per frame.
+ ***********************************************************/
+void PlanarReflection::SetBudget(double budgetMs)
+{
+	m_budgetMs = std::max(budgetMs, 0.0);
+	m_settleFrames = SETTLE_FRAMES;
+}
+
+/***********************************************************
+ *  UpdateQuality()
+ *
+ *  This method steps the quality between quarter and the
+ *  chosen one from the measured time of the pass. The cost
+ *  follows the pixel count, so one step changes it about
+ *  four times.
+ ***********************************************************/
+void PlanarReflection::UpdateQuality(double reflectionGpuMs)
+{
+	if ((m_budgetMs <= 0.0) || (m_maxQuality == REFLECTION_OFF))
+	{
+		return;
+	}
+	if (m_settleFrames > 0)
+	{
+		m_settleFrames--;
+		return;
+	}
+	// no timings yet
+	if (reflectionGpuMs <= 0.0)
+	{
+		return;
+	}
+
+	REFLECTION_QUALITY quality = m_quality;
+	if ((reflectionGpuMs > m_budgetMs * STEP_DOWN_THRESHOLD) && (m_quality > REFLECTION_QUARTER))
+	{
+		quality = (REFLECTION_QUALITY)(m_quality - 1);
+	}
+	else if ((reflectionGpuMs * 4.0 < m_budgetMs * STEP_UP_THRESHOLD) && (m_quality < m_maxQuality))
+	{
+		quality = (REFLECTION_QUALITY)(m_quality + 1);
+	}
+
+	if (quality != m_quality)
+	{
+		m_quality = quality;
+		m_settleFrames = SETTLE_FRAMES;
+	}
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method mirrors the frame's camera in the floor and
+ *  swaps the near plane of its projection for the floor
+ *  plane (Lengyel's oblique near plane clipping). The target
+ *  follows the window size and the quality.
+ ***********************************************************/
+void PlanarReflection::Update(const FRAME_STATE& frameState)
+{
+	m_bActive = false;
+	if ((m_quality == REFLECTION_OFF) ||
+		(frameState.viewCount > 1) ||
+		(frameState.viewPosition.y <= FLOOR_HEIGHT) ||
+		(frameState.framebufferWidth <= 0) ||
+		(frameState.framebufferHeight <= 0))
+	{
+		return;
+	}
+
+	int divisor = GetDivisor(m_quality);
+	int width = std::max(frameState.framebufferWidth / divisor, 1);
+	int height = std::max(frameState.framebufferHeight / divisor, 1);
+	if ((width != m_width) || (height != m_height))
+	{
+		if (!CreateTargets(width, height))
+		{
+			return;
+		}
+	}
+
+	glm::mat4 mirror =
+		glm::translate(glm::vec3(0.0f, FLOOR_HEIGHT, 0.0f)) *
+		glm::scale(glm::vec3(1.0f, -1.0f, 1.0f)) *
+		glm::translate(glm::vec3(0.0f, -FLOOR_HEIGHT, 0.0f));
+	glm::mat4 view = frameState.view * mirror;
+	m_viewPosition = glm::vec3(frameState.viewPosition.x,
+		2.0f * FLOOR_HEIGHT - frameState.viewPosition.y,
+		frameState.viewPosition.z);
+
+	// the floor plane in the mirrored view space, keeping what is
+	// above it; the mirrored camera is below it, on its back side
+	glm::vec4 clipPlane = glm::transpose(glm::inverse(view)) *
+		glm::vec4(0.0f, 1.0f, 0.0f, -(FLOOR_HEIGHT - CLIP_OFFSET));
+
+	// the corner of the view volume opposite the plane, the near
+	// plane row is replaced so that corner keeps its far depth; the
+	// corner comes from the inverse so an orthographic projection
+	// works as well as a perspective one
+	glm::mat4 projection = frameState.projection;
+	glm::vec4 corner = glm::inverse(projection) * glm::vec4(
+		clipPlane.x > 0.0f ? 1.0f : (clipPlane.x < 0.0f ? -1.0f : 0.0f),
+		clipPlane.y > 0.0f ? 1.0f : (clipPlane.y < 0.0f ? -1.0f : 0.0f),
+		1.0f,
+		1.0f);
+	glm::vec4 scaledPlane = clipPlane * (2.0f / glm::dot(clipPlane, corner));
+	for (int column = 0; column < 4; column++)
+	{
+		projection[column][2] = scaledPlane[column] - projection[column][3];
+	}
+	m_viewProjection = projection * view;
+
+	// the oblique projection skews the far plane, the culling uses
+	// the regular frustum of the mirrored camera
+	m_frustum.Extract(frameState.projection * view);
+	m_bActive = true;
+}
+
+/***********************************************************
+ *  IsReflected()
+ *
+ *  This method tests whether a bounding sphere can show up
+ *  in the reflection.
+ ***********************************************************/
+bool PlanarReflection::IsReflected(const glm::vec3& center, float radius) const
+{
+	return(m_bActive &&
+		(center.y + radius > FLOOR_HEIGHT) &&
+		m_frustum.IntersectsSphere(center, radius));
+}
+
+/***********************************************************
+ *  CreateTargets()
+ *
+ *  This method creates the mipmapped color texture and the
+ *  depth buffer of the reflection.
+ ***********************************************************/
+bool PlanarReflection::CreateTargets(int width, int height)
+{
+	DestroyTargets();
+
+	m_levels = 1;
+	while ((m_levels < MAX_LEVELS) && (std::max(width, height) >> m_levels) > 0)
+	{
+		m_levels++;
+	}
+
+	glGenTextures(1, &m_colorTexture);
+	GLStateCache::BindTexture(0, GL_TEXTURE_2D, m_colorTexture);
+	if (GLEW_VERSION_4_2 || GLEW_ARB_texture_storage)
+	{
+		glTexStorage2D(GL_TEXTURE_2D, m_levels, GL_RGBA16F, width, height);
+	}
+	else
+	{
+		// mutable levels are only complete up to the max level
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, m_levels - 1);
+		for (int level = 0; level < m_levels; level++)
+		{
+			glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA16F,
+				std::max(width >> level, 1), std::max(height >> level, 1),
+				0, GL_RGBA, GL_HALF_FLOAT, NULL);
+		}
+	}
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	GLStateCache::BindTexture(0, GL_TEXTURE_2D, 0);
+
+	glGenRenderbuffers(1, &m_depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT32F, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	GLint previousFramebuffer = 0;
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+	glGenFramebuffers(1, &m_framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_colorTexture, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthBuffer);
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "ERROR: reflection framebuffer is incomplete" << std::endl;
+		DestroyTargets();
+		return(false);
+	}
+
+	m_width = width;
+	m_height = height;
+	return(true);
+}
+
+/***********************************************************
+ *  DestroyTargets()
+ *
+ *  This method releases the reflection target.
+ ***********************************************************/
+void PlanarReflection::DestroyTargets()
+{
+	glDeleteFramebuffers(1, &m_framebuffer);
+	glDeleteRenderbuffers(1, &m_depthBuffer);
+	GLStateCache::DeleteTexture(m_colorTexture);
+	m_framebuffer = 0;
+	m_depthBuffer = 0;
+	m_colorTexture = 0;
+	m_width = 0;
+	m_height = 0;
+	m_levels = 1;
+}
+
+/***********************************************************
+ *  BeginReflection()
+ *
+ *  This method binds and clears the target. The reflection
+ *  covers the same share of its target as the scene does of
+ *  the scene target, so it follows the render scale.
+ ***********************************************************/
+void PlanarReflection::BeginReflection()
+{
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &m_previousFramebuffer);
+	glGetIntegerv(GL_VIEWPORT, m_previousViewport);
+
+	int divisor = GetDivisor(m_quality);
+	int sceneWidth = std::max((int)m_previousViewport[2], 1);
+	int sceneHeight = std::max((int)m_previousViewport[3], 1);
+	int width = std::min(std::max(sceneWidth / divisor, 1), m_width);
+	int height = std::min(std::max(sceneHeight / divisor, 1), m_height);
+
+	// scene pixel to reflection texture coordinates, clamped half a
+	// texel inside the rendered part
+	m_uvScale = glm::vec2(
+		(float)width / ((float)sceneWidth * (float)m_width),
+		(float)height / ((float)sceneHeight * (float)m_height));
+	m_maxUV = glm::vec2(
+		((float)width - 0.5f) / (float)m_width,
+		((float)height - 0.5f) / (float)m_height);
+
+	const GLfloat clearColor[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+	const GLfloat clearDepth = 1.0f;
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glViewport(0, 0, width, height);
+	glClearBufferfv(GL_COLOR, 0, clearColor);
+	glClearBufferfv(GL_DEPTH, 0, &clearDepth);
+
+	// the mirror turns the triangles around
+	glFrontFace(GL_CW);
+}
+
+/***********************************************************
+ *  EndReflection()
+ *
+ *  This method restores the scene target, builds the blur
+ *  levels and leaves the reflection bound to the passed in
+ *  texture unit for the scene.
+ ***********************************************************/
+void PlanarReflection::EndReflection(int textureUnit)
+{
+	glFrontFace(GL_CCW);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_previousFramebuffer);
+	glViewport(m_previousViewport[0], m_previousViewport[1], m_previousViewport[2], m_previousViewport[3]);
+
+	GLStateCache::BindTexture(textureUnit, GL_TEXTURE_2D, m_colorTexture);
+	GLStateCache::ActiveTexture(textureUnit);
+	glGenerateMipmap(GL_TEXTURE_2D);
+}
@@ -0,0 +1,114 @@
+///////////////////////////////////////////////////////////////////////////////
+// planarreflection.h
+// ============
+// reduced resolution planar reflection of the scene in the floor
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "DrawList.h"
+#include "FrameState.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+/***********************************************************
+ *  PlanarReflection
+ *
+ *  This class renders the scene from the camera mirrored in
+ *  the floor plane into a target at a half or a quarter of
+ *  the scene resolution. The projection's near plane is
+ *  replaced by the floor plane (an oblique projection), so
+ *  nothing below the floor leaks into the reflection and
+ *  no clip distance is needed. The mirrored camera has its
+ *  own frustum, the scene culls against it separately.
+ *
+ *  The target is mipmapped after every frame. Reflective
+ *  surfaces pick the level from their material's roughness,
+ *  so a rough floor shows a blurred reflection for the cost
+ *  of one lookup.
+ *
+ *  The quality is the cost knob: off, quarter or half
+ *  resolution. With a GPU time budget set, the quality
+ *  steps down while the measured pass is over budget and
+ *  back up, never above the chosen quality, when there is
+ *  room for the four times larger target.
+ ***********************************************************/
+class PlanarReflection
+{
+public:
+	// resolution of the reflection, relative to the scene
+	enum REFLECTION_QUALITY
+	{
+		REFLECTION_OFF = 0,
+		REFLECTION_QUARTER,
+		REFLECTION_HALF
+	};
+
+	// constructor
+	PlanarReflection();
+	// destructor
+	~PlanarReflection();
+
+	// highest quality, the budget may lower it
+	void SetQuality(REFLECTION_QUALITY quality);
+	REFLECTION_QUALITY GetQuality() const { return(m_quality); }
+	// GPU time the pass may take, 0 keeps the quality fixed
+	void SetBudget(double budgetMs);
+	// feed the latest GPU time of the pass
+	void UpdateQuality(double reflectionGpuMs);
+
+	// mirror the camera of the frame in the floor, the reflection is
+	// inactive when it is off, the frame is split or the camera is
+	// below the floor
+	void Update(const FRAME_STATE& frameState);
+	bool IsActive() const { return(m_bActive); }
+	// the mirrored camera, its frustum culls in world space
+	const glm::mat4& GetViewProjection() const { return(m_viewProjection); }
+	const glm::vec3& GetViewPosition() const { return(m_viewPosition); }
+	const FRUSTUM& GetFrustum() const { return(m_frustum); }
+	// bounding sphere that reaches above the floor and into the mirrored view
+	bool IsReflected(const glm::vec3& center, float radius) const;
+
+	// reflection pass: bind the target, then restore the scene target,
+	// mipmap and bind the reflection to the unit the scene samples
+	void BeginReflection();
+	void EndReflection(int textureUnit);
+
+	// sampling of the finished reflection by the scene shader
+	GLuint GetTexture() const { return(m_colorTexture); }
+	// from gl_FragCoord of the scene to reflection texture coordinates
+	const glm::vec2& GetUVScale() const { return(m_uvScale); }
+	const glm::vec2& GetMaxUV() const { return(m_maxUV); }
+	float GetMaxLod() const { return((float)(m_levels - 1)); }
+
+private:
+	REFLECTION_QUALITY m_maxQuality;
+	REFLECTION_QUALITY m_quality;
+	double m_budgetMs;
+	int m_settleFrames;
+
+	bool m_bActive;
+	glm::mat4 m_viewProjection;
+	glm::vec3 m_viewPosition;
+	FRUSTUM m_frustum;
+
+	int m_width;
+	int m_height;
+	int m_levels;
+	GLuint m_framebuffer;
+	GLuint m_colorTexture;
+	GLuint m_depthBuffer;
+	glm::vec2 m_uvScale;
+	glm::vec2 m_maxUV;
+
+	// state restored by EndReflection()
+	GLint m_previousFramebuffer;
+	GLint m_previousViewport[4];
+
+	bool CreateTargets(int width, int height);
+	void DestroyTargets();
+};
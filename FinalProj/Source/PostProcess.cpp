@@ -0,0 +1,361 @@
+///////////////////////////////////////////////////////////////////////////////
+// postprocess.cpp
+// ============
+// HDR scene target with auto-exposure and tone mapping to the back buffer
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "PostProcess.h"
+#include "GLProgram.h"
+#include "GLStateCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+	// must match HISTOGRAM_BINS and the work group size in the compute shaders
+	const int HISTOGRAM_BINS = 256;
+	const int HISTOGRAM_GROUP_SIZE = 16;
+	// log2 luminance range covered by the histogram
+	const float MIN_LOG_LUMINANCE = -10.0f;
+	const float MAX_LOG_LUMINANCE = 4.0f;
+	// middle grey the adapted luminance is exposed to
+	const float EXPOSURE_KEY_VALUE = 0.18f;
+	// how quickly the exposure follows a brightness change, per second
+	const float ADAPTATION_RATE = 1.5f;
+	// the scene keeps its textures bound on the low units, and the
+	// shadow map sits on unit 15, must match the shader bindings
+	const int HDR_TEXTURE_UNIT = 14;
+}
+
+/***********************************************************
+ *  PostProcess()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+PostProcess::PostProcess()
+{
+	m_width = 0;
+	m_height = 0;
+	m_renderWidth = 0;
+	m_renderHeight = 0;
+	m_renderScale = 1.0f;
+	m_framebuffer = 0;
+	m_colorTexture = 0;
+	m_depthTexture = 0;
+	m_histogramProgram = 0;
+	m_averageProgram = 0;
+	m_tonemapProgram = 0;
+	m_emptyVertexArray = 0;
+	m_histogramBuffer = 0;
+	m_exposureBuffer = 0;
+	m_imageSizeLocation = -1;
+	m_histogramMinLocation = -1;
+	m_histogramInverseRangeLocation = -1;
+	m_pixelCountLocation = -1;
+	m_averageMinLocation = -1;
+	m_averageRangeLocation = -1;
+	m_adaptationLocation = -1;
+	m_keyValueLocation = -1;
+	m_sourceScaleLocation = -1;
+	m_maxTexCoordLocation = -1;
+	m_lastResolveTime = -1.0;
+	m_pTransparency = new WeightedTransparency();
+	m_pDeferredShading = new DeferredShading();
+	m_pAmbientOcclusion = new AmbientOcclusion();
+}
+
+/***********************************************************
+ *  ~PostProcess()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+PostProcess::~PostProcess()
+{
+	DestroyTargets();
+	if (NULL != m_pTransparency)
+	{
+		delete m_pTransparency;
+		m_pTransparency = NULL;
+	}
+	if (NULL != m_pDeferredShading)
+	{
+		delete m_pDeferredShading;
+		m_pDeferredShading = NULL;
+	}
+	if (NULL != m_pAmbientOcclusion)
+	{
+		delete m_pAmbientOcclusion;
+		m_pAmbientOcclusion = NULL;
+	}
+	glDeleteBuffers(1, &m_histogramBuffer);
+	glDeleteBuffers(1, &m_exposureBuffer);
+	glDeleteVertexArrays(1, &m_emptyVertexArray);
+	glDeleteProgram(m_histogramProgram);
+	glDeleteProgram(m_averageProgram);
+	glDeleteProgram(m_tonemapProgram);
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method creates the RGBA16F scene target with its
+ *  depth texture, the luminance buffers and the compute and
+ *  tone mapping programs. The deferred lighting program is
+ *  only loaded when the deferred path was picked, without
+ *  it the deferred pass never becomes ready.
+ ***********************************************************/
+bool PostProcess::Initialize(int width, int height, bool bDeferredShading)
+{
+	m_width = std::max(width, 1);
+	m_height = std::max(height, 1);
+	SetRenderScale(m_renderScale);
+
+	m_histogramProgram = LoadGLComputeProgram("luminanceHistogramCompute.glsl");
+	m_averageProgram = LoadGLComputeProgram("luminanceAverageCompute.glsl");
+	m_tonemapProgram = LoadGLProgram("tonemapVertex.glsl", "tonemapFragment.glsl");
+	if ((m_histogramProgram == 0) || (m_averageProgram == 0) || (m_tonemapProgram == 0))
+	{
+		return(false);
+	}
+	m_imageSizeLocation = glGetUniformLocation(m_histogramProgram, "imageSize");
+	m_histogramMinLocation = glGetUniformLocation(m_histogramProgram, "minLogLuminance");
+	m_histogramInverseRangeLocation = glGetUniformLocation(m_histogramProgram, "inverseLogLuminanceRange");
+	m_pixelCountLocation = glGetUniformLocation(m_averageProgram, "pixelCount");
+	m_averageMinLocation = glGetUniformLocation(m_averageProgram, "minLogLuminance");
+	m_averageRangeLocation = glGetUniformLocation(m_averageProgram, "logLuminanceRange");
+	m_adaptationLocation = glGetUniformLocation(m_averageProgram, "adaptation");
+	m_keyValueLocation = glGetUniformLocation(m_averageProgram, "keyValue");
+	m_sourceScaleLocation = glGetUniformLocation(m_tonemapProgram, "sourceScale");
+	m_maxTexCoordLocation = glGetUniformLocation(m_tonemapProgram, "maxTexCoord");
+
+	// the average pass clears the histogram after reading it,
+	// so it only has to start out zeroed
+	unsigned int emptyHistogram[HISTOGRAM_BINS] = { 0 };
+	glGenBuffers(1, &m_histogramBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_histogramBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(emptyHistogram), emptyHistogram, GL_DYNAMIC_COPY);
+
+	// adapted luminance 0 makes the first frame expose instantly
+	float initialExposure[2] = { 0.0f, 1.0f };
+	glGenBuffers(1, &m_exposureBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_exposureBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(initialExposure), initialExposure, GL_DYNAMIC_COPY);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	glGenVertexArrays(1, &m_emptyVertexArray);
+
+	if (m_pTransparency->Initialize() == false)
+	{
+		std::cout << "ERROR: transparency pass is unavailable, transparent objects blend in draw order" << std::endl;
+	}
+	if (bDeferredShading && (m_pDeferredShading->Initialize() == false))
+	{
+		std::cout << "ERROR: deferred shading is unavailable, the scene is lit forward" << std::endl;
+	}
+	if (m_pAmbientOcclusion->Initialize() == false)
+	{
+		std::cout << "ERROR: ambient occlusion is unavailable, the scene is drawn without it" << std::endl;
+	}
+
+	return(CreateTargets());
+}
+
+/***********************************************************
+ *  CreateTargets()
+ *
+ *  This method creates the HDR framebuffer and textures at
+ *  the window size.
+ ***********************************************************/
+bool PostProcess::CreateTargets()
+{
+	glGenTextures(1, &m_colorTexture);
+	GLStateCache::BindTexture(0, GL_TEXTURE_2D, m_colorTexture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA16F, m_width, m_height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	glGenTextures(1, &m_depthTexture);
+	GLStateCache::BindTexture(0, GL_TEXTURE_2D, m_depthTexture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT32F, m_width, m_height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	GLStateCache::BindTexture(0, GL_TEXTURE_2D, 0);
+
+	glGenFramebuffers(1, &m_framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_colorTexture, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_depthTexture, 0);
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "ERROR: HDR framebuffer is incomplete" << std::endl;
+		DestroyTargets();
+		return(false);
+	}
+
+	m_pTransparency->CreateTargets(m_width, m_height, m_depthTexture, m_framebuffer);
+	m_pDeferredShading->CreateTargets(m_width, m_height, m_depthTexture, m_colorTexture, m_framebuffer);
+	m_pAmbientOcclusion->CreateTargets(m_width, m_height, m_depthTexture, m_colorTexture, m_framebuffer);
+	return(true);
+}
+
+/***********************************************************
+ *  DestroyTargets()
+ *
+ *  This method releases the HDR framebuffer and textures.
+ ***********************************************************/
+void PostProcess::DestroyTargets()
+{
+	m_pTransparency->DestroyTargets();
+	m_pDeferredShading->DestroyTargets();
+	m_pAmbientOcclusion->DestroyTargets();
+	glDeleteFramebuffers(1, &m_framebuffer);
+	GLStateCache::DeleteTexture(m_colorTexture);
+	GLStateCache::DeleteTexture(m_depthTexture);
+	m_framebuffer = 0;
+	m_colorTexture = 0;
+	m_depthTexture = 0;
+}
+
+/***********************************************************
+ *  Resize()
+ *
+ *  This method recreates the HDR target when the window's
+ *  framebuffer changed size. An empty size (minimized
+ *  window) is ignored.
+ ***********************************************************/
+void PostProcess::Resize(int width, int height)
+{
+	if ((width <= 0) || (height <= 0) || ((width == m_width) && (height == m_height)))
+	{
+		return;
+	}
+	m_width = width;
+	m_height = height;
+	SetRenderScale(m_renderScale);
+
+	// only rebuild the targets if they existed, a failed
+	// Initialize() keeps rendering to the back buffer
+	if (IsReady())
+	{
+		DestroyTargets();
+		CreateTargets();
+	}
+}
+
+/***********************************************************
+ *  SetRenderScale()
+ *
+ *  This method sets the size of the scene's part of the
+ *  target relative to the window.
+ ***********************************************************/
+void PostProcess::SetRenderScale(float scale)
+{
+	m_renderScale = std::min(std::max(scale, 0.1f), 1.0f);
+	m_renderWidth = std::max((int)(m_width * m_renderScale + 0.5f), 1);
+	m_renderHeight = std::max((int)(m_height * m_renderScale + 0.5f), 1);
+}
+
+/***********************************************************
+ *  BeginScene()
+ *
+ *  This method binds the HDR target so the following clear
+ *  and scene passes write unclamped linear color into the
+ *  scaled part of it. The deferred lighting and the ambient
+ *  occlusion cover the same part.
+ ***********************************************************/
+void PostProcess::BeginScene()
+{
+	if (!IsReady())
+	{
+		// drawing straight into the back buffer at the window size
+		glViewport(0, 0, m_width, m_height);
+		return;
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glViewport(0, 0, m_renderWidth, m_renderHeight);
+	m_pDeferredShading->SetRenderSize(m_renderWidth, m_renderHeight);
+	m_pAmbientOcclusion->SetRenderSize(m_renderWidth, m_renderHeight);
+}
+
+/***********************************************************
+ *  Resolve()
+ *
+ *  This method measures the scene luminance, eases the
+ *  exposure towards it and draws the tone mapped result
+ *  into the default framebuffer, upscaled to the window.
+ ***********************************************************/
+void PostProcess::Resolve(double time)
+{
+	if (!IsReady())
+	{
+		return;
+	}
+
+	// frame rate independent easing towards the new luminance
+	float deltaTime = (m_lastResolveTime < 0.0) ? 0.0f : (float)(time - m_lastResolveTime);
+	m_lastResolveTime = time;
+	float adaptation = 1.0f - std::exp(-std::max(deltaTime, 0.0f) * ADAPTATION_RATE);
+
+	GLuint previousProgram = GLStateCache::GetProgram();
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLStateCache::BindTexture(HDR_TEXTURE_UNIT, GL_TEXTURE_2D, m_colorTexture);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_histogramBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_exposureBuffer);
+
+	// one dispatch over the whole target builds the histogram
+	float logRange = MAX_LOG_LUMINANCE - MIN_LOG_LUMINANCE;
+	GLStateCache::UseProgram(m_histogramProgram);
+	glUniform2i(m_imageSizeLocation, m_renderWidth, m_renderHeight);
+	glUniform1f(m_histogramMinLocation, MIN_LOG_LUMINANCE);
+	glUniform1f(m_histogramInverseRangeLocation, 1.0f / logRange);
+	glDispatchCompute(
+		(m_renderWidth + HISTOGRAM_GROUP_SIZE - 1) / HISTOGRAM_GROUP_SIZE,
+		(m_renderHeight + HISTOGRAM_GROUP_SIZE - 1) / HISTOGRAM_GROUP_SIZE,
+		1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	// a single work group reduces the 256 bins to the exposure
+	GLStateCache::UseProgram(m_averageProgram);
+	glUniform1ui(m_pixelCountLocation, (GLuint)(m_renderWidth * m_renderHeight));
+	glUniform1f(m_averageMinLocation, MIN_LOG_LUMINANCE);
+	glUniform1f(m_averageRangeLocation, logRange);
+	glUniform1f(m_adaptationLocation, adaptation);
+	glUniform1f(m_keyValueLocation, EXPOSURE_KEY_VALUE);
+	glDispatchCompute(1, 1, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	// full screen triangle, depth and blending would only get in the way
+	bool bDepthTest = GLStateCache::IsEnabled(GL_DEPTH_TEST);
+	bool bBlend = GLStateCache::IsEnabled(GL_BLEND);
+	GLStateCache::SetEnabled(GL_DEPTH_TEST, false);
+	GLStateCache::SetEnabled(GL_BLEND, false);
+
+	// bilinear upscale of the rendered corner, clamped half a texel
+	// inside it so the filter never reaches the unused part
+	glViewport(0, 0, m_width, m_height);
+	GLStateCache::UseProgram(m_tonemapProgram);
+	glUniform2f(m_sourceScaleLocation,
+		(float)m_renderWidth / (float)m_width,
+		(float)m_renderHeight / (float)m_height);
+	glUniform2f(m_maxTexCoordLocation,
+		((float)m_renderWidth - 0.5f) / (float)m_width,
+		((float)m_renderHeight - 0.5f) / (float)m_height);
+	GLStateCache::BindVertexArray(m_emptyVertexArray);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+
+	GLStateCache::SetEnabled(GL_DEPTH_TEST, bDepthTest);
+	GLStateCache::SetEnabled(GL_BLEND, bBlend);
+	GLStateCache::UseProgram(previousProgram);
+}
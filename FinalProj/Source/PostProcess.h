@@ -0,0 +1,109 @@
+///////////////////////////////////////////////////////////////////////////////
+// postprocess.h
+// ============
+// HDR scene target with auto-exposure and tone mapping to the back buffer
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "WeightedTransparency.h"
+#include "DeferredShading.h"
+#include "AmbientOcclusion.h"
+
+#include <GL/glew.h>
+
+/***********************************************************
+ *  PostProcess
+ *
+ *  This class owns the floating point target the scene is
+ *  lit into. Resolving the frame builds a log luminance
+ *  histogram of the target in one compute dispatch, reduces
+ *  it to an adapted exposure on the GPU and tone maps the
+ *  target into the default framebuffer, so the exposure
+ *  never has to be read back to the CPU.
+ *
+ *  The target is allocated at the window size, and the
+ *  scene may be drawn into a smaller corner of it picked by
+ *  the render scale. Resolving stretches that corner over
+ *  the whole window, so changing the scale never has to
+ *  reallocate the target. The transparency targets, the
+ *  G-buffer of the optional deferred path and the ambient
+ *  occlusion share its depth buffer and follow its size.
+ ***********************************************************/
+class PostProcess
+{
+public:
+	// constructor
+	PostProcess();
+	// destructor
+	~PostProcess();
+
+	// create the HDR target and the post-process programs, and the
+	// deferred lighting pass if asked for
+	bool Initialize(int width, int height, bool bDeferredShading = false);
+	// follow the window's framebuffer size
+	void Resize(int width, int height);
+	// share of the window size the scene is rendered at, 0-1
+	void SetRenderScale(float scale);
+
+	// redirect the scene rendering into the HDR target
+	void BeginScene();
+	// expose and tone map the HDR target into the back buffer
+	void Resolve(double time);
+
+	bool IsReady() const { return(m_framebuffer != 0); }
+	// transparency pass into the HDR target, ready only while the
+	// target and the composite program are
+	WeightedTransparency* GetTransparency() const { return(m_pTransparency); }
+	// deferred lighting into the HDR target, ready only when it was
+	// asked for and its G-buffer and program are
+	DeferredShading* GetDeferredShading() const { return(m_pDeferredShading); }
+	// ambient occlusion of the HDR target, ready only while its
+	// texture and programs are
+	AmbientOcclusion* GetAmbientOcclusion() const { return(m_pAmbientOcclusion); }
+
+private:
+	// window size, and the size of the target
+	int m_width;
+	int m_height;
+	// part of the target the scene is rendered into
+	int m_renderWidth;
+	int m_renderHeight;
+	float m_renderScale;
+
+	GLuint m_framebuffer;
+	GLuint m_colorTexture;
+	GLuint m_depthTexture;
+	WeightedTransparency* m_pTransparency;
+	DeferredShading* m_pDeferredShading;
+	AmbientOcclusion* m_pAmbientOcclusion;
+
+	GLuint m_histogramProgram;
+	GLuint m_averageProgram;
+	GLuint m_tonemapProgram;
+	// core profile needs a bound vertex array even without attributes
+	GLuint m_emptyVertexArray;
+
+	GLuint m_histogramBuffer;
+	GLuint m_exposureBuffer;
+
+	// uniform locations in the compute programs
+	GLint m_imageSizeLocation;
+	GLint m_histogramMinLocation;
+	GLint m_histogramInverseRangeLocation;
+	GLint m_pixelCountLocation;
+	GLint m_averageMinLocation;
+	GLint m_averageRangeLocation;
+	GLint m_adaptationLocation;
+	GLint m_keyValueLocation;
+	GLint m_sourceScaleLocation;
+	GLint m_maxTexCoordLocation;
+
+	double m_lastResolveTime;
+
+	bool CreateTargets();
+	void DestroyTargets();
+};
@@ -0,0 +1,33 @@
+///////////////////////////////////////////////////////////////////////////////
+// proceduraltexture.h
+// ============
+// patterns the scene shader evaluates instead of sampling an image
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+// patterns of the scene shader, must match the PATTERN_ values in
+// fragment.glsl; 0 samples the draw's image texture
+enum PROCEDURAL_PATTERN
+{
+	PATTERN_NONE = 0,
+	PATTERN_SCRATCHES   // thin light scratches and specks on a dark ground
+};
+
+// a texture made of a pattern and the few values it is evaluated
+// from, takes the place of an image file under the same tag
+struct PROCEDURAL_TEXTURE
+{
+	PROCEDURAL_PATTERN pattern;
+	glm::vec3 baseColor;
+	glm::vec3 detailColor;
+	// pattern repeats across the texture coordinates on each axis
+	glm::vec2 frequency;
+	// picks another variation of the same pattern
+	float seed;
+};
@@ -0,0 +1,360 @@
+///////////////////////////////////////////////////////////////////////////////
+// regressionrun.cpp
+// ============
+// compares rendered reference views and their costs with stored baselines
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RegressionRun.h"
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+	// a blurred pixel differs visibly once its luminance moves by more
+	// than this (0..1), chroma gets a looser limit since the eye is
+	// less sensitive to it
+	const float LUMA_TOLERANCE = 0.03f;
+	const float CHROMA_TOLERANCE = 0.06f;
+	// share of the pixels that may differ visibly before a view fails
+	const double MAX_CHANGED_PIXELS = 0.001;
+	// CPU frame time may grow by this share before a view fails, the
+	// draw, state change and OpenGL call counts may not grow at all
+	const double FRAME_TIME_TOLERANCE = 0.2;
+
+	// luminance and two chroma differences of an 8 bit RGB pixel
+	void ToLumaChroma(const unsigned char* pPixel, float* pOut)
+	{
+		float r = pPixel[0] / 255.0f;
+		float g = pPixel[1] / 255.0f;
+		float b = pPixel[2] / 255.0f;
+		pOut[0] = 0.2126f * r + 0.7152f * g + 0.0722f * b;
+		pOut[1] = b - pOut[0];
+		pOut[2] = r - pOut[0];
+	}
+
+	// luminance and chroma planes blurred over a 3x3 box
+	void BlurredLumaChroma(const unsigned char* pPixels, int width, int height, std::vector<float>& planes)
+	{
+		std::vector<float> sharp((size_t)width * height * 3);
+		for (size_t i = 0; i < (size_t)width * height; i++)
+		{
+			ToLumaChroma(pPixels + i * 3, &sharp[i * 3]);
+		}
+
+		planes.assign(sharp.size(), 0.0f);
+		for (int y = 0; y < height; y++)
+		{
+			for (int x = 0; x < width; x++)
+			{
+				float sum[3] = { 0.0f, 0.0f, 0.0f };
+				int samples = 0;
+				for (int dy = -1; dy <= 1; dy++)
+				{
+					for (int dx = -1; dx <= 1; dx++)
+					{
+						int sx = x + dx;
+						int sy = y + dy;
+						if ((sx < 0) || (sy < 0) || (sx >= width) || (sy >= height))
+						{
+							continue;
+						}
+						const float* pSample = &sharp[((size_t)sy * width + sx) * 3];
+						sum[0] += pSample[0];
+						sum[1] += pSample[1];
+						sum[2] += pSample[2];
+						samples++;
+					}
+				}
+				float* pOut = &planes[((size_t)y * width + x) * 3];
+				pOut[0] = sum[0] / samples;
+				pOut[1] = sum[1] / samples;
+				pOut[2] = sum[2] / samples;
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  RegressionRun()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+RegressionRun::RegressionRun(const char* baselineDirectory, bool bRecordBaselines)
+{
+	m_directory = baselineDirectory;
+	m_bRecordBaselines = bRecordBaselines;
+	m_bPassed = true;
+}
+
+/***********************************************************
+ *  CheckImage()
+ *
+ *  This method compares a rendered frame with the baseline
+ *  image of the view, or records the frame as the baseline
+ *  when the run records them. A failing frame is written
+ *  next to the baseline together with an image that marks
+ *  the changed pixels.
+ ***********************************************************/
+bool RegressionRun::CheckImage(const char* viewName, const unsigned char* pPixels, int width, int height)
+{
+	std::string baselinePath = MakePath(viewName, ".ppm");
+	if (m_bRecordBaselines)
+	{
+		if (!WriteImage(baselinePath, pPixels, width, height))
+		{
+			std::cout << "ERROR: could not record baseline image " << baselinePath << std::endl;
+			m_bPassed = false;
+			return(false);
+		}
+		std::cout << "INFO: recorded baseline image " << baselinePath << std::endl;
+		return(true);
+	}
+
+	std::vector<unsigned char> baseline;
+	int baselineWidth = 0;
+	int baselineHeight = 0;
+	if (!ReadImage(baselinePath, baseline, baselineWidth, baselineHeight))
+	{
+		std::cout << "ERROR: " << viewName << " has no baseline image " << baselinePath
+			<< ", record one with --record-baselines" << std::endl;
+		m_bPassed = false;
+		return(false);
+	}
+
+	if ((baselineWidth != width) || (baselineHeight != height))
+	{
+		std::cout << "ERROR: " << viewName << " rendered at " << width << "x" << height
+			<< ", the baseline is " << baselineWidth << "x" << baselineHeight << std::endl;
+		m_bPassed = false;
+		return(false);
+	}
+
+	std::vector<float> expected;
+	std::vector<float> actual;
+	BlurredLumaChroma(&baseline[0], width, height, expected);
+	BlurredLumaChroma(pPixels, width, height, actual);
+
+	// the changed pixels are marked red over a darkened copy of the frame
+	std::vector<unsigned char> marked(pPixels, pPixels + (size_t)width * height * 3);
+	size_t changedPixels = 0;
+	for (size_t i = 0; i < (size_t)width * height; i++)
+	{
+		const float* pExpected = &expected[i * 3];
+		const float* pActual = &actual[i * 3];
+		bool bChanged =
+			(std::fabs(pExpected[0] - pActual[0]) > LUMA_TOLERANCE) ||
+			(std::fabs(pExpected[1] - pActual[1]) > CHROMA_TOLERANCE) ||
+			(std::fabs(pExpected[2] - pActual[2]) > CHROMA_TOLERANCE);
+		unsigned char* pMarked = &marked[i * 3];
+		if (bChanged)
+		{
+			changedPixels++;
+			pMarked[0] = 255;
+			pMarked[1] = 0;
+			pMarked[2] = 0;
+		}
+		else
+		{
+			pMarked[0] /= 4;
+			pMarked[1] /= 4;
+			pMarked[2] /= 4;
+		}
+	}
+
+	double changedShare = (double)changedPixels / ((double)width * height);
+	if (changedShare > MAX_CHANGED_PIXELS)
+	{
+		std::cout << "ERROR: " << viewName << " differs from its baseline in "
+			<< changedPixels << " pixels (" << changedShare * 100.0 << "%)" << std::endl;
+		WriteImage(MakePath(viewName, ".actual.ppm"), pPixels, width, height);
+		WriteImage(MakePath(viewName, ".diff.ppm"), &marked[0], width, height);
+		m_bPassed = false;
+		return(false);
+	}
+
+	std::cout << "INFO: " << viewName << " matches its baseline image" << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  CheckStats()
+ *
+ *  This method compares the costs of a view with the ones
+ *  in its baseline, or records them when the run records
+ *  the baselines.
+ ***********************************************************/
+bool RegressionRun::CheckStats(const char* viewName, const REGRESSION_STATS& stats)
+{
+	std::string baselinePath = MakePath(viewName, ".txt");
+	if (m_bRecordBaselines)
+	{
+		if (!WriteStats(baselinePath, stats))
+		{
+			std::cout << "ERROR: could not record baseline stats " << baselinePath << std::endl;
+			m_bPassed = false;
+			return(false);
+		}
+		std::cout << "INFO: recorded baseline stats " << baselinePath << std::endl;
+		return(true);
+	}
+
+	REGRESSION_STATS baseline;
+	if (!ReadStats(baselinePath, baseline))
+	{
+		std::cout << "ERROR: " << viewName << " has no baseline stats " << baselinePath
+			<< ", record them with --record-baselines" << std::endl;
+		m_bPassed = false;
+		return(false);
+	}
+
+	bool bPassed = true;
+	if (stats.drawCalls > baseline.drawCalls)
+	{
+		std::cout << "ERROR: " << viewName << " issued " << stats.drawCalls
+			<< " draw calls, the baseline is " << baseline.drawCalls << std::endl;
+		bPassed = false;
+	}
+	if (stats.stateChanges > baseline.stateChanges)
+	{
+		std::cout << "ERROR: " << viewName << " made " << stats.stateChanges
+			<< " state changes, the baseline is " << baseline.stateChanges << std::endl;
+		bPassed = false;
+	}
+	if (stats.glCalls > baseline.glCalls)
+	{
+		std::cout << "ERROR: " << viewName << " made " << stats.glCalls
+			<< " OpenGL state calls, the baseline is " << baseline.glCalls << std::endl;
+		bPassed = false;
+	}
+	if (stats.cpuFrameMs > baseline.cpuFrameMs * (1.0 + FRAME_TIME_TOLERANCE))
+	{
+		std::cout << "ERROR: " << viewName << " took " << stats.cpuFrameMs
+			<< " ms of CPU time per frame, the baseline is " << baseline.cpuFrameMs << " ms" << std::endl;
+		bPassed = false;
+	}
+
+	if (bPassed)
+	{
+		std::cout << "INFO: " << viewName << " is within its baseline costs ("
+			<< stats.drawCalls << " draws, " << stats.stateChanges << " state changes, "
+			<< stats.glCalls << " OpenGL state calls, " << stats.cpuFrameMs << " ms)" << std::endl;
+	}
+	else
+	{
+		m_bPassed = false;
+	}
+	return(bPassed);
+}
+
+/***********************************************************
+ *  MakePath()
+ *
+ *  This method builds the path of a baseline file.
+ ***********************************************************/
+std::string RegressionRun::MakePath(const char* viewName, const char* extension) const
+{
+	return(m_directory + "/" + viewName + extension);
+}
+
+/***********************************************************
+ *  ReadImage()
+ *
+ *  This method loads a binary PPM image, rows bottom-up
+ *  like the OpenGL read back.
+ ***********************************************************/
+bool RegressionRun::ReadImage(const std::string& path, std::vector<unsigned char>& pixels, int& width, int& height)
+{
+	std::ifstream file(path.c_str(), std::ios::binary);
+	std::string magic;
+	int maxValue = 0;
+	if (!(file >> magic >> width >> height >> maxValue) || (magic != "P6") || (maxValue != 255) ||
+		(width <= 0) || (height <= 0))
+	{
+		return(false);
+	}
+	// a single whitespace byte separates the header from the pixels
+	file.get();
+
+	size_t rowBytes = (size_t)width * 3;
+	pixels.resize(rowBytes * height);
+	for (int y = height - 1; y >= 0; y--)
+	{
+		file.read((char*)&pixels[y * rowBytes], rowBytes);
+	}
+	return(!file.fail());
+}
+
+/***********************************************************
+ *  WriteImage()
+ *
+ *  This method saves bottom-up RGB pixels as a binary PPM
+ *  image, which any image viewer shows the right way up.
+ ***********************************************************/
+bool RegressionRun::WriteImage(const std::string& path, const unsigned char* pPixels, int width, int height)
+{
+	std::ofstream file(path.c_str(), std::ios::binary);
+	file << "P6\n" << width << " " << height << "\n255\n";
+
+	size_t rowBytes = (size_t)width * 3;
+	for (int y = height - 1; y >= 0; y--)
+	{
+		file.write((const char*)(pPixels + y * rowBytes), rowBytes);
+	}
+	return(!file.fail());
+}
+
+/***********************************************************
+ *  ReadStats()
+ *
+ *  This method loads the costs of a baseline stats file.
+ ***********************************************************/
+bool RegressionRun::ReadStats(const std::string& path, REGRESSION_STATS& stats)
+{
+	std::ifstream file(path.c_str());
+	std::string name;
+	int found = 0;
+	while (file >> name)
+	{
+		if (name == "drawCalls")
+		{
+			file >> stats.drawCalls;
+			found++;
+		}
+		else if (name == "stateChanges")
+		{
+			file >> stats.stateChanges;
+			found++;
+		}
+		else if (name == "glCalls")
+		{
+			file >> stats.glCalls;
+			found++;
+		}
+		else if (name == "cpuFrameMs")
+		{
+			file >> stats.cpuFrameMs;
+			found++;
+		}
+	}
+	return(found == 4);
+}
+
+/***********************************************************
+ *  WriteStats()
+ *
+ *  This method saves the costs of a view as a stats file.
+ ***********************************************************/
+bool RegressionRun::WriteStats(const std::string& path, const REGRESSION_STATS& stats)
+{
+	std::ofstream file(path.c_str());
+	file << "drawCalls " << stats.drawCalls << "\n";
+	file << "stateChanges " << stats.stateChanges << "\n";
+	file << "glCalls " << stats.glCalls << "\n";
+	file << "cpuFrameMs " << stats.cpuFrameMs << "\n";
+	return(!file.fail());
+}
@@ -0,0 +1,63 @@
+///////////////////////////////////////////////////////////////////////////////
+// regressionrun.h
+// ============
+// compares rendered reference views and their costs with stored baselines
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+// costs of one rendered reference view
+struct REGRESSION_STATS
+{
+	int drawCalls;
+	int stateChanges;
+	// OpenGL state calls the state cache let through
+	unsigned long long glCalls;
+	double cpuFrameMs;
+};
+
+/***********************************************************
+ *  RegressionRun
+ *
+ *  This class checks the frames rendered from the reference
+ *  views against the baselines kept in a directory, one
+ *  image (<view>.ppm) and one stats file (<view>.txt) per
+ *  view. Images are compared on blurred luminance and
+ *  chroma so that a one pixel shift of an edge does not
+ *  count as a change, and a view fails once too many pixels
+ *  differ visibly. A missing baseline fails the view, unless
+ *  the run records the baselines: then every view's image
+ *  and stats are written from the current frame instead of
+ *  being compared.
+ ***********************************************************/
+class RegressionRun
+{
+public:
+	// constructor
+	RegressionRun(const char* baselineDirectory, bool bRecordBaselines);
+
+	// compare a bottom-up RGB frame with the view's baseline image
+	bool CheckImage(const char* viewName, const unsigned char* pPixels, int width, int height);
+	// compare the view's draw counts and CPU frame time with its baseline
+	bool CheckStats(const char* viewName, const REGRESSION_STATS& stats);
+
+	// false once any check has failed
+	bool Passed() const { return(m_bPassed); }
+
+private:
+	std::string m_directory;
+	bool m_bRecordBaselines;
+	bool m_bPassed;
+
+	std::string MakePath(const char* viewName, const char* extension) const;
+	static bool ReadImage(const std::string& path, std::vector<unsigned char>& pixels, int& width, int& height);
+	static bool WriteImage(const std::string& path, const unsigned char* pPixels, int width, int height);
+	static bool ReadStats(const std::string& path, REGRESSION_STATS& stats);
+	static bool WriteStats(const std::string& path, const REGRESSION_STATS& stats);
+};
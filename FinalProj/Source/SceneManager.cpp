@@ -9,13 +9,13 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "SceneManager.h"
-
-#ifndef STB_IMAGE_IMPLEMENTATION
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
-#endif
+#include "GLStateCache.h"
 
 #include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cassert>
+#include <iostream>
 
 // declaration of global variables
 namespace
@@ -27,9 +27,34 @@ namespace
 	const char* g_UseTwoTexturesName = "bUseTwoTextures"; //added to allow multiple texture shading
 	const char* g_UseLightingName = "bUseLighting";
 
-	//add these to allow scaling texture to the object
-	const char* g_ObjectPositionName = "objectPosition";
-	const char* g_ObjectScaleName = "objectScale";
+	// key light, also the direction the cascaded shadows are cast in
+	const glm::vec3 g_KeyLightPosition = glm::vec3(3.0f, 10.0f, 4.0f);
+	// the streamed scene textures sit on units 0-6, the units past them
+	// belong to the passes: 7 the reflection, 8-11 the G-buffer, 12 and
+	// 13 the transparency and ambient occlusion, 14 the HDR target
+	const int g_SceneTextureUnits = 7;
+	// texture unit kept free of scene textures for the shadow map
+	const int g_ShadowTextureUnit = 15;
+	// unit of the floor reflection, after the scene textures and
+	// before the G-buffer of the deferred path (8-11)
+	const int g_ReflectionTextureUnit = 7;
+	// share of the reflection the glass floor shows when seen from
+	// straight above, it grows towards grazing angles
+	const float g_FloorReflectivity = 0.25f;
+	// video memory for the scene textures unless the caller sets another
+	const size_t g_DefaultTextureBudget = 256 * 1024 * 1024;
+	// small textures share pages of this size, with gutters that keep
+	// neighbouring images apart down to mip log2(gutter), the last mip
+	// the pages get
+	const int g_AtlasPageSize = 1024;
+	const int g_AtlasGutter = 8;
+	// starting size of the per-frame arena, it grows if a frame needs more
+	const size_t g_FrameArenaSize = 1024 * 1024;
+
+	//vertex shader melting of whole clocks (see RecordClock)
+	const char* g_UseMeltName = "bUseMelt";
+	const char* g_MeltGroupName = "meltGroup";
+	const char* g_MeltParamsName = "meltParams";
 
 	//set the torus major radius (inside the torus, set while declaring scale) 
 	// and outer radius (rim thickness, set here, for use in PrepareScene)
@@ -47,6 +72,47 @@ SceneManager::SceneManager(ShaderManager *pShaderManager)
 {
 	m_pShaderManager = pShaderManager;
 	m_basicMeshes = new ShapeMeshes();
+	m_pCompactMeshes = new CompactMeshes(SHAPE_COUNT);
+	m_bUseCompactMeshes = true;
+	m_pClusterCuller = new ClusterCuller();
+	m_pMultiDraw = new MultiDraw();
+	m_loadedTextures = 0;
+	m_pTextureStreamer = new TextureStreamer(g_DefaultTextureBudget, g_SceneTextureUnits);
+	m_pTextureAtlas = new TextureAtlas(g_AtlasPageSize, g_AtlasGutter);
+	m_pMaterialTable = new MaterialTable();
+
+	// one draw list per worker so recording never needs a lock
+	m_pJobSystem = new JobSystem();
+	m_pFrameArena = new FrameArena(g_FrameArenaSize);
+	m_workerDrawLists.resize(m_pJobSystem->GetWorkerCount());
+	m_frameState.viewProjection = glm::mat4(1.0f);
+	m_frameState.viewCount = 1;
+	m_frameState.views[0].viewProjection = m_frameState.viewProjection;
+	m_sceneProgram = 0;
+	m_directExposure = 0.0f;
+	m_bDirectGamma = false;
+	m_viewFrustums[0].Extract(m_frameState.viewProjection);
+
+	m_pShadowMaps = new ShadowMaps();
+	m_pReflection = new PlanarReflection();
+	m_pTransparency = NULL;
+	m_pDeferredShading = NULL;
+	m_pAmbientOcclusion = NULL;
+	for (int i = 0; i < DeferredShading::MAX_LIGHTS; i++)
+	{
+		m_lightSources[i].position = glm::vec3(0.0f);
+		m_lightSources[i].ambientColor = glm::vec3(0.0f);
+		m_lightSources[i].diffuseColor = glm::vec3(0.0f);
+		m_lightSources[i].specularColor = glm::vec3(0.0f);
+		m_lightSources[i].focalStrength = 0.0f;
+		m_lightSources[i].specularIntensity = 0.0f;
+	}
+	m_pProfiler = NULL;
+	m_shadowScope = -1;
+	m_reflectionScope = -1;
+	m_sceneScope = -1;
+	m_frameStats.drawCalls = 0;
+	m_frameStats.stateChanges = 0;
 }
 
 /***********************************************************
@@ -57,99 +123,203 @@ SceneManager::SceneManager(ShaderManager *pShaderManager)
 SceneManager::~SceneManager()
 {
 	m_pShaderManager = NULL;
+	// free the textures before the streamer that owns them
+	DestroyGLTextures();
+	delete m_pTextureStreamer;
+	m_pTextureStreamer = NULL;
+	delete m_pTextureAtlas;
+	m_pTextureAtlas = NULL;
 	delete m_basicMeshes;
 	m_basicMeshes = NULL;
-	m_objectMaterials.clear();
+	// the culler's and batches' vertex arrays use the compact meshes' buffers
+	delete m_pClusterCuller;
+	m_pClusterCuller = NULL;
+	delete m_pMultiDraw;
+	m_pMultiDraw = NULL;
+	delete m_pCompactMeshes;
+	m_pCompactMeshes = NULL;
+	delete m_pJobSystem;
+	m_pJobSystem = NULL;
+	delete m_pFrameArena;
+	m_pFrameArena = NULL;
+	delete m_pShadowMaps;
+	m_pShadowMaps = NULL;
+	delete m_pReflection;
+	m_pReflection = NULL;
+	m_pTransparency = NULL;
+	m_pDeferredShading = NULL;
+	m_pAmbientOcclusion = NULL;
+	m_pProfiler = NULL;
+	delete m_pMaterialTable;
+	m_pMaterialTable = NULL;
+	m_sceneClocks.clear();
 }
 
 
 /***********************************************************
  *  CreateGLTexture()
  *
- *  This method is used for loading textures from image files,
- *  configuring the texture mapping parameters in OpenGL,
- *  generating the mipmaps, and loading the read texture into
- *  the next available texture slot in memory.
+ *  This method is used for loading textures from image files
+ *  into the next available texture slot. The texture
+ *  streamer builds the mipmaps and only uploads the small
+ *  ones here, the rest follow once the scene needs them.
  ***********************************************************/
 bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
 {
-	int width = 0;
-	int height = 0;
-	int colorChannels = 0;
-	GLuint textureID = 0;
-
-	// indicate to always flip images vertically when loaded
-	stbi_set_flip_vertically_on_load(true);
-
-	// try to parse the image data from the specified image file
-	unsigned char* image = stbi_load(
-		filename,
-		&width,
-		&height,
-		&colorChannels,
-		0);
-
-	// if the image was successfully read from the image file
-	if (image)
-	{
-		std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
-
-		glGenTextures(1, &textureID);
-		glBindTexture(GL_TEXTURE_2D, textureID);
-
-		// set the texture wrapping parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		// set texture filtering parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		// if the loaded image is in RGB format
-		if (colorChannels == 3)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
-		// if the loaded image is in RGBA format - it supports transparency
-		else if (colorChannels == 4)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-		else
-		{
-			std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
-			return false;
-		}
+	// the streamer places texture i on texture unit i, so its
+	// index must stay in step with the slots
+	int textureSlot = m_pTextureStreamer->LoadTexture(filename);
+	if (textureSlot < 0)
+	{
+		return false;
+	}
 
-		// generate the texture mipmaps for mapping textures to lower resolutions
-		glGenerateMipmap(GL_TEXTURE_2D);
+	// register the loaded texture and associate it with the special tag string
+	m_textureIDs[m_loadedTextures].tag = tag;
+	m_textureIDs[m_loadedTextures].slot = textureSlot;
+	m_textureIDs[m_loadedTextures].atlasEntry = -1;
+	m_textureIDs[m_loadedTextures].procedural = -1;
+	m_textureIDs[m_loadedTextures].bDistanceField = false;
+	m_textureIDs[m_loadedTextures].uvScale = glm::vec2(1.0f, 1.0f);
+	m_textureIDs[m_loadedTextures].uvOffset = glm::vec2(0.0f, 0.0f);
+	m_loadedTextures++;
+
+	return true;
+}
 
-		// free the image data from local memory
-		stbi_image_free(image);
-		glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
+/***********************************************************
+ *  CreateAtlasTexture()
+ *
+ *  This method is used for loading a small image that will
+ *  share an atlas page with other small images, which saves
+ *  a texture slot and lets their draws batch together. The
+ *  image must not be tiled, since it only covers part of the
+ *  page. It gets its slot in BuildTextureAtlases().
+ ***********************************************************/
+bool SceneManager::CreateAtlasTexture(const char* filename, std::string tag)
+{
+	int atlasEntry = m_pTextureAtlas->AddImage(filename);
+	if (atlasEntry < 0)
+	{
+		return false;
+	}
+
+	m_textureIDs[m_loadedTextures].tag = tag;
+	m_textureIDs[m_loadedTextures].slot = -1;
+	m_textureIDs[m_loadedTextures].atlasEntry = atlasEntry;
+	m_textureIDs[m_loadedTextures].procedural = -1;
+	m_textureIDs[m_loadedTextures].bDistanceField = false;
+	m_textureIDs[m_loadedTextures].uvScale = glm::vec2(1.0f, 1.0f);
+	m_textureIDs[m_loadedTextures].uvOffset = glm::vec2(0.0f, 0.0f);
+	m_loadedTextures++;
 
-		// register the loaded texture and associate it with the special tag string
-		m_textureIDs[m_loadedTextures].ID = textureID;
-		m_textureIDs[m_loadedTextures].tag = tag;
-		m_loadedTextures++;
+	return true;
+}
 
-		return true;
+/***********************************************************
+ *  CreateDistanceFieldTexture()
+ *
+ *  This method is used for loading the multi-channel signed
+ *  distance field of a clock dial, written by the DialSdf
+ *  tool. It gets its own slot, since the distances are in
+ *  texels of the whole image, and is kept linear so the
+ *  distances are filtered as they are.
+ ***********************************************************/
+bool SceneManager::CreateDistanceFieldTexture(const char* filename, std::string tag)
+{
+	int textureSlot = m_pTextureStreamer->LoadTexture(filename, true);
+	if (textureSlot < 0)
+	{
+		return false;
 	}
 
-	std::cout << "Could not load image:" << filename << std::endl;
+	m_textureIDs[m_loadedTextures].tag = tag;
+	m_textureIDs[m_loadedTextures].slot = textureSlot;
+	m_textureIDs[m_loadedTextures].atlasEntry = -1;
+	m_textureIDs[m_loadedTextures].procedural = -1;
+	m_textureIDs[m_loadedTextures].bDistanceField = true;
+	m_textureIDs[m_loadedTextures].uvScale = glm::vec2(1.0f, 1.0f);
+	m_textureIDs[m_loadedTextures].uvOffset = glm::vec2(0.0f, 0.0f);
+	m_loadedTextures++;
 
-	// Error loading the image
-	return false;
+	return true;
+}
+
+/***********************************************************
+ *  CreateProceduralTexture()
+ *
+ *  This method is used for registering a pattern the scene
+ *  shader evaluates in place of an image. It takes no slot,
+ *  no decoding and no video memory, and the draws find it
+ *  by its tag like any loaded texture.
+ ***********************************************************/
+bool SceneManager::CreateProceduralTexture(const PROCEDURAL_TEXTURE& texture, std::string tag)
+{
+	if ((texture.pattern == PATTERN_NONE) || (m_loadedTextures >= 16))
+	{
+		return false;
+	}
+
+	m_proceduralTextures.push_back(texture);
+	m_textureIDs[m_loadedTextures].tag = tag;
+	m_textureIDs[m_loadedTextures].slot = -1;
+	m_textureIDs[m_loadedTextures].atlasEntry = -1;
+	m_textureIDs[m_loadedTextures].procedural = (int)m_proceduralTextures.size() - 1;
+	m_textureIDs[m_loadedTextures].bDistanceField = false;
+	m_textureIDs[m_loadedTextures].uvScale = glm::vec2(1.0f, 1.0f);
+	m_textureIDs[m_loadedTextures].uvOffset = glm::vec2(0.0f, 0.0f);
+	m_loadedTextures++;
+
+	return true;
+}
+
+/***********************************************************
+ *  BuildTextureAtlases()
+ *
+ *  This method packs the images added with CreateAtlasTexture(),
+ *  hands every page to the texture streamer as one texture and
+ *  sets the slot and UV transform of the packed textures.
+ ***********************************************************/
+void SceneManager::BuildTextureAtlases()
+{
+	m_pTextureAtlas->Build();
+
+	std::vector<int> pageSlots(m_pTextureAtlas->GetPageCount());
+	for (int page = 0; page < m_pTextureAtlas->GetPageCount(); page++)
+	{
+		const TextureAtlas::ATLAS_PAGE& atlasPage = m_pTextureAtlas->GetPage(page);
+		pageSlots[page] = m_pTextureStreamer->LoadTexture(&atlasPage.pixels[0], atlasPage.width, atlasPage.height, 4,
+			false, m_pTextureAtlas->GetMaxMipLevel());
+	}
+	m_pTextureAtlas->ReleasePages();
+
+	for (int i = 0; i < m_loadedTextures; i++)
+	{
+		if (m_textureIDs[i].atlasEntry < 0)
+		{
+			continue;
+		}
+		const TextureAtlas::ATLAS_ENTRY& entry = m_pTextureAtlas->GetEntry(m_textureIDs[i].atlasEntry);
+		m_textureIDs[i].slot = (entry.page >= 0) ? pageSlots[entry.page] : -1;
+		m_textureIDs[i].uvScale = entry.uvScale;
+		m_textureIDs[i].uvOffset = entry.uvOffset;
+	}
 }
 
 /***********************************************************
  *  BindGLTextures()
  *
  *  This method is used for binding the loaded textures to
- *  OpenGL texture memory slots.  There are up to 16 slots.
+ *  OpenGL texture memory slots. The scene textures have the
+ *  first g_SceneTextureUnits of the 16 slots.
  ***********************************************************/
 void SceneManager::BindGLTextures()
 {
-	for (int i = 0; i < m_loadedTextures; i++)
+	for (int i = 0; i < m_pTextureStreamer->GetTextureCount(); i++)
 	{
+		assert(i < g_SceneTextureUnits);
 		// bind textures on corresponding texture units
-		glActiveTexture(GL_TEXTURE0 + i);
-		glBindTexture(GL_TEXTURE_2D, m_textureIDs[i].ID);
+		GLStateCache::BindTexture(i, GL_TEXTURE_2D, m_pTextureStreamer->GetTextureID(i));
 	}
 }
 
@@ -161,47 +331,55 @@ void SceneManager::BindGLTextures()
  ***********************************************************/
 void SceneManager::DestroyGLTextures()
 {
-	for (int i = 0; i < m_loadedTextures; i++)
-	{
-		glGenTextures(1, &m_textureIDs[i].ID);
-	}
+	m_pTextureStreamer->Release();
+	m_proceduralTextures.clear();
+	m_loadedTextures = 0;
 }
 
 /***********************************************************
- *  FindTextureID()
+ *  UpdateTextureResidency()
  *
- *  This method is used for getting an ID for the previously
- *  loaded texture bitmap associated with the passed in tag.
+ *  This method reports the screen size of every visible
+ *  textured draw to the texture streamer, which then loads
+ *  or drops mips within its budget.
  ***********************************************************/
-int SceneManager::FindTextureID(std::string tag)
+void SceneManager::UpdateTextureResidency(const DrawList& drawList)
 {
-	int textureID = -1;
-	int index = 0;
-	bool bFound = false;
-
-	while ((index < m_loadedTextures) && (bFound == false))
+	m_pTextureStreamer->BeginFrame(m_frameState);
+	for (size_t i = 0; i < drawList.Size(); i++)
 	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
+		const DRAW_PACKET& packet = drawList[i];
+		if (!packet.bVisible && !packet.bReflected)
 		{
-			textureID = m_textureIDs[index].ID;
-			bFound = true;
+			continue;
 		}
-		else
-			index++;
+		m_pTextureStreamer->RequestTexture(packet.textureSlot, packet.bounds, packet.uvScale);
+		m_pTextureStreamer->RequestTexture(packet.textureSlot2, packet.bounds, packet.uvScale2);
 	}
+	m_pTextureStreamer->Update();
+}
 
-	return(textureID);
+/***********************************************************
+ *  SetTextureBudget()
+ *
+ *  This method sets the video memory the streamed textures
+ *  may use, the next frame evicts mips to meet it.
+ ***********************************************************/
+void SceneManager::SetTextureBudget(size_t budgetBytes)
+{
+	m_pTextureStreamer->SetBudget(budgetBytes);
 }
 
 /***********************************************************
- *  FindTextureSlot()
+ *  FindTextureIndex()
  *
- *  This method is used for getting a slot index for the previously
- *  loaded texture bitmap associated with the passed in tag.
+ *  This method is used for getting the index into the loaded
+ *  texture info for the texture associated with the passed
+ *  in tag.
  ***********************************************************/
-int SceneManager::FindTextureSlot(std::string tag)
+int SceneManager::FindTextureIndex(const char* tag)
 {
-	int textureSlot = -1;
+	int textureIndex = -1;
 	int index = 0;
 	bool bFound = false;
 
@@ -209,24 +387,61 @@ int SceneManager::FindTextureSlot(std::string tag)
 	{
 		if (m_textureIDs[index].tag.compare(tag) == 0)
 		{
-			textureSlot = index;
+			textureIndex = index;
 			bFound = true;
 		}
 		else
 			index++;
 	}
 
-	return(textureSlot);
+	return(textureIndex);
+}
+
+/***********************************************************
+ *  SetPacketTextures()
+ *
+ *  This method is used for setting the texture slots and UV
+ *  transforms of a draw packet from loaded texture indices.
+ *  Packed textures on the same atlas page get the same slot,
+ *  so the sorted draws using them follow each other. Only
+ *  the first texture may be procedural, and only the second
+ *  one a distance field.
+ ***********************************************************/
+void SceneManager::SetPacketTextures(DRAW_PACKET& packet, int textureIndex, int textureIndex2)
+{
+	packet.textureSlot = -1;
+	packet.proceduralTexture = -1;
+	packet.uvScale = glm::vec2(1.0f, 1.0f);
+	packet.uvOffset = glm::vec2(0.0f, 0.0f);
+	if (textureIndex >= 0)
+	{
+		packet.textureSlot = m_textureIDs[textureIndex].slot;
+		packet.proceduralTexture = m_textureIDs[textureIndex].procedural;
+		packet.uvScale = m_textureIDs[textureIndex].uvScale;
+		packet.uvOffset = m_textureIDs[textureIndex].uvOffset;
+	}
+
+	packet.textureSlot2 = -1;
+	packet.bDistanceField2 = false;
+	packet.uvScale2 = glm::vec2(1.0f, 1.0f);
+	packet.uvOffset2 = glm::vec2(0.0f, 0.0f);
+	if (textureIndex2 >= 0)
+	{
+		packet.textureSlot2 = m_textureIDs[textureIndex2].slot;
+		packet.bDistanceField2 = m_textureIDs[textureIndex2].bDistanceField;
+		packet.uvScale2 = m_textureIDs[textureIndex2].uvScale;
+		packet.uvOffset2 = m_textureIDs[textureIndex2].uvOffset;
+	}
 }
 
 
 /***********************************************************
- *  SetTransformations()
+ *  BuildModelMatrix()
  *
- *  This method is used for setting the transform buffer
- *  using the passed in transformation values.
+ *  This method is used for calculating a model matrix from
+ *  the passed in transformation values.
  ***********************************************************/
-void SceneManager::SetTransformations(
+glm::mat4 SceneManager::BuildModelMatrix(
 	glm::vec3 scaleXYZ,
 	float XrotationDegrees,
 	float YrotationDegrees,
@@ -234,7 +449,6 @@ void SceneManager::SetTransformations(
 	glm::vec3 positionXYZ)
 {
 	// variables for this method
-	glm::mat4 modelView;
 	glm::mat4 scale;
 	glm::mat4 rotationX;
 	glm::mat4 rotationY;
@@ -251,112 +465,61 @@ void SceneManager::SetTransformations(
 	translation = glm::translate(positionXYZ);
 
 	// matrix math for calculating the final model matrix
-	modelView = translation * rotationX * rotationY * rotationZ * scale;
-
-	if (NULL != m_pShaderManager)
-	{
-		// pass the model matrix into the shader
-		m_pShaderManager->setMat4Value(g_ModelName, modelView);
-
-		//new code to allow fitting to object
-		m_pShaderManager->setVec3Value("objectPosition", positionXYZ);
-		m_pShaderManager->setVec3Value("objectScale", scaleXYZ);
-
-	}
+	return(translation * rotationX * rotationY * rotationZ * scale);
 }
 
 /***********************************************************
- *  SetShaderColor()
+ *  FindMaterialIndex()
  *
- *  This method is used for setting the passed in color
- *  into the shader for the next draw command
+ *  This method is used for getting the index of a previously
+ *  defined material so draw packets can reference it without
+ *  carrying the tag string.
  ***********************************************************/
-void SceneManager::SetShaderColor(
-	float redColorValue,
-	float greenColorValue,
-	float blueColorValue,
-	float alphaValue)
+int SceneManager::FindMaterialIndex(const char* tag)
 {
-	// variables for this method
-	glm::vec4 currentColor;
-
-	currentColor.r = redColorValue;
-	currentColor.g = greenColorValue;
-	currentColor.b = blueColorValue;
-	currentColor.a = alphaValue;
-
-	if (NULL != m_pShaderManager)
-	{
-		// pass the color values into the shader
-		m_pShaderManager->setIntValue(g_UseTextureName, false);
-		m_pShaderManager->setVec4Value(g_ColorValueName, currentColor);
-	}
+	return(m_pMaterialTable->FindMaterial(tag));
 }
 
 /***********************************************************
- *  FindMaterial()
+ *  AddObjectMaterial()
  *
- *  This method is used for getting a material from the previously
- *  defined materials list that is associated with the passed in tag.
+ *  This method is used for adding a defined material to the
+ *  material table under its tag.
  ***********************************************************/
-bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
+void SceneManager::AddObjectMaterial(const OBJECT_MATERIAL& material)
 {
-	if (m_objectMaterials.size() == 0)
-	{
-		return(false);
-	}
-
-	int index = 0;
-	bool bFound = false;
-	while ((index < m_objectMaterials.size()) && (bFound == false))
-	{
-		if (m_objectMaterials[index].tag.compare(tag) == 0)
-		{
-			bFound = true;
-			material.ambientColor = m_objectMaterials[index].ambientColor;
-			material.ambientStrength = m_objectMaterials[index].ambientStrength;
-			material.diffuseColor = m_objectMaterials[index].diffuseColor;
-			material.specularColor = m_objectMaterials[index].specularColor;
-			material.shininess = m_objectMaterials[index].shininess;
-		}
-		else
-		{
-			index++;
-		}
-	}
-
-	return(true);
+	m_pMaterialTable->AddMaterial(
+		material.tag.c_str(),
+		material.ambientColor,
+		material.ambientStrength,
+		material.diffuseColor,
+		material.specularColor,
+		material.shininess);
 }
 
-
-
-//Add this in to allow shaders that reflect light
 /***********************************************************
- *  SetShaderMaterial()
+ *  UpdateMaterial()
  *
- *  This method is used for passing the material values
- *  into the shader.
+ *  This method is used for changing the values of the defined
+ *  material with the same tag. Only that entry of the table
+ *  is sent to the GPU before the next frame is drawn. It
+ *  returns false when no material has the tag.
  ***********************************************************/
-void SceneManager::SetShaderMaterial(
-	std::string materialTag)
+bool SceneManager::UpdateMaterial(const OBJECT_MATERIAL& material)
 {
-	if (m_objectMaterials.size() > 0)
+	int index = FindMaterialIndex(material.tag.c_str());
+	if (index < 0)
 	{
-		OBJECT_MATERIAL material;
-		bool bReturn = false;
-
-		// find the defined material that matches the tag
-		bReturn = FindMaterial(materialTag, material);
-		if (bReturn == true)
-		{
-			// pass the material properties into the shader
-			m_pShaderManager->setVec3Value("material.ambientColor", material.ambientColor);
-			m_pShaderManager->setFloatValue("material.ambientStrength", material.ambientStrength);
-			m_pShaderManager->setVec3Value("material.diffuseColor", material.diffuseColor);
-			m_pShaderManager->setVec3Value("material.specularColor", material.specularColor);
-			m_pShaderManager->setFloatValue("material.shininess", material.shininess);
-		}
+		return(false);
 	}
+	m_pMaterialTable->SetMaterial(
+		index,
+		material.ambientColor,
+		material.ambientStrength,
+		material.diffuseColor,
+		material.specularColor,
+		material.shininess);
+	return(true);
 }
 
 /**************************************************************/
@@ -380,7 +543,7 @@ void SceneManager::DefineObjectMaterials()
 	goldMaterial.specularColor = glm::vec3(0.6f, 0.5f, 0.4f);
 	goldMaterial.shininess = 22.0;
 	goldMaterial.tag = "gold";
-	m_objectMaterials.push_back(goldMaterial);
+	AddObjectMaterial(goldMaterial);
 	OBJECT_MATERIAL cementMaterial;
 	cementMaterial.ambientColor = glm::vec3(0.2f, 0.2f, 0.2f);
 	cementMaterial.ambientStrength = 0.2f;
@@ -388,7 +551,7 @@ void SceneManager::DefineObjectMaterials()
 	cementMaterial.specularColor = glm::vec3(0.4f, 0.4f, 0.4f);
 	cementMaterial.shininess = 0.5;
 	cementMaterial.tag = "cement";
-	m_objectMaterials.push_back(cementMaterial);
+	AddObjectMaterial(cementMaterial);
 	OBJECT_MATERIAL woodMaterial;
 	woodMaterial.ambientColor = glm::vec3(0.4f, 0.3f, 0.1f);
 	woodMaterial.ambientStrength = 0.2f;
@@ -396,7 +559,7 @@ void SceneManager::DefineObjectMaterials()
 	woodMaterial.specularColor = glm::vec3(0.1f, 0.1f, 0.1f);
 	woodMaterial.shininess = 0.3;
 	woodMaterial.tag = "wood";
-	m_objectMaterials.push_back(woodMaterial);
+	AddObjectMaterial(woodMaterial);
 	OBJECT_MATERIAL tileMaterial;
 	tileMaterial.ambientColor = glm::vec3(0.2f, 0.3f, 0.4f);
 	tileMaterial.ambientStrength = 0.3f;
@@ -404,7 +567,7 @@ void SceneManager::DefineObjectMaterials()
 	tileMaterial.specularColor = glm::vec3(0.4f, 0.5f, 0.6f);
 	tileMaterial.shininess = 25.0;
 	tileMaterial.tag = "tile";
-	m_objectMaterials.push_back(tileMaterial);
+	AddObjectMaterial(tileMaterial);
 	OBJECT_MATERIAL glassMaterial;
 	glassMaterial.ambientColor = glm::vec3(0.4f, 0.4f, 0.4f);
 	glassMaterial.ambientStrength = 0.3f;
@@ -412,7 +575,7 @@ void SceneManager::DefineObjectMaterials()
 	glassMaterial.specularColor = glm::vec3(0.6f, 0.6f, 0.6f);
 	glassMaterial.shininess = 85.0;
 	glassMaterial.tag = "glass";
-	m_objectMaterials.push_back(glassMaterial);
+	AddObjectMaterial(glassMaterial);
 	OBJECT_MATERIAL clayMaterial;
 	clayMaterial.ambientColor = glm::vec3(0.2f, 0.2f, 0.3f);
 	clayMaterial.ambientStrength = 0.3f;
@@ -420,45 +583,45 @@ void SceneManager::DefineObjectMaterials()
 	clayMaterial.specularColor = glm::vec3(0.2f, 0.2f, 0.4f);
 	clayMaterial.shininess = 0.5;
 	clayMaterial.tag = "clay";
-	m_objectMaterials.push_back(clayMaterial);
+	AddObjectMaterial(clayMaterial);
 
 
 	OBJECT_MATERIAL pinkMaterial;
 	pinkMaterial.ambientColor = glm::vec3(0.6f, 0.3f, 0.5f);   // Boosted pink ambient
-	pinkMaterial.ambientStrength = 0.3f / 4.0f;  // Divided by 4 to counter per-light addition
-	pinkMaterial.diffuseColor = glm::vec3(0.9f, 0.5f, 0.7f) / 2.0f;   // Boosted and divided by 2 bright lights
-	pinkMaterial.specularColor = glm::vec3(1.0f, 0.8f, 0.9f) / 2.0f;  // Divided by 2 bright lights
+	pinkMaterial.ambientStrength = 0.3f;
+	pinkMaterial.diffuseColor = glm::vec3(0.9f, 0.5f, 0.7f);   // Boosted pink diffuse
+	pinkMaterial.specularColor = glm::vec3(1.0f, 0.8f, 0.9f);
 	pinkMaterial.shininess = 16.0f;  // A bit less than the gold texture
 	pinkMaterial.tag = "pink";
-	m_objectMaterials.push_back(pinkMaterial);
+	AddObjectMaterial(pinkMaterial);
 
 	OBJECT_MATERIAL blueMaterial;
 	blueMaterial.ambientColor = glm::vec3(0.15f, 0.15f, 0.5f);
-	blueMaterial.ambientStrength = 0.4f / 4.0f; //Divided by 4 since 4 lights
-	blueMaterial.diffuseColor = glm::vec3(0.5f, 0.5f, 0.9f) / 2.0f; //Divided by 2 since 2 bright lights
-	blueMaterial.specularColor = glm::vec3(0.7f, 0.7f, 1.0f) / 2.0f; //Divided by 2 since 2 bright lights
+	blueMaterial.ambientStrength = 0.4f;
+	blueMaterial.diffuseColor = glm::vec3(0.5f, 0.5f, 0.9f);
+	blueMaterial.specularColor = glm::vec3(0.7f, 0.7f, 1.0f);
 	blueMaterial.shininess = 32.0f;  // Higher shine
 	blueMaterial.tag = "blue";
-	m_objectMaterials.push_back(blueMaterial);
+	AddObjectMaterial(blueMaterial);
 
 
 	OBJECT_MATERIAL brownMaterial;
 	brownMaterial.ambientColor = glm::vec3(0.4f, 0.2f, 0.15f);
-	brownMaterial.ambientStrength = 0.2f / 4.0f; //Divided by 4 since 4 lights
-	brownMaterial.diffuseColor = glm::vec3(0.6f, 0.4f, 0.3f) / 2.0f; //Divided by 2 since 2 bright lights
-	brownMaterial.specularColor = glm::vec3(0.7f, 0.5f, 0.4f) / 2.0f;//Divided by 2 since 2 bright lights
+	brownMaterial.ambientStrength = 0.2f;
+	brownMaterial.diffuseColor = glm::vec3(0.6f, 0.4f, 0.3f);
+	brownMaterial.specularColor = glm::vec3(0.7f, 0.5f, 0.4f);
 	brownMaterial.shininess = 8.0f;   // Low shine
 	brownMaterial.tag = "brown";
-	m_objectMaterials.push_back(brownMaterial);
+	AddObjectMaterial(brownMaterial);
 
 	OBJECT_MATERIAL redMaterial;
 	redMaterial.ambientColor = glm::vec3(0.5f, 0.15f, 0.15f);
-	redMaterial.ambientStrength = 0.4f / 4.0f; //Divided by 4 since 4 lights
-	redMaterial.diffuseColor = glm::vec3(0.9f, 0.3f, 0.3f) / 2.0f; //Divided by 2 since 2 bright lights
-	redMaterial.specularColor = glm::vec3(1.0f, 0.6f, 0.6f) / 2.0f; //Divided by 2 since 2 bright lights
+	redMaterial.ambientStrength = 0.4f;
+	redMaterial.diffuseColor = glm::vec3(0.9f, 0.3f, 0.3f);
+	redMaterial.specularColor = glm::vec3(1.0f, 0.6f, 0.6f);
 	redMaterial.shininess = 32.0f;  // Higher shine
 	redMaterial.tag = "red";
-	m_objectMaterials.push_back(redMaterial);
+	AddObjectMaterial(redMaterial);
 
 
 }
@@ -508,111 +671,97 @@ void SceneManager::SetupSceneLights()
 	float commonFocalStrength = 32.0f;  // Matches shiniest material shininess
 	float commonSpecularIntensity = 0.2f;  // Lowered from 0.3f to reduce base overexposure
 
-	// Light 0: Blue directional with lowered position 
-	m_pShaderManager->setVec3Value("lightSources[0].position", glm::vec3(3.0f, 10.0f, 4.0f));
-	m_pShaderManager->setVec3Value("lightSources[0].ambientColor", glm::vec3(0.0f, 0.0f, 0.0f));  // Zero because additive ambient was making everything white
-	m_pShaderManager->setVec3Value("lightSources[0].diffuseColor", glm::vec3(0.5f, 0.5f, 0.5f));  // white (set for consistency)
-	m_pShaderManager->setVec3Value("lightSources[0].specularColor", glm::vec3(0.3f, 0.2f, 0.9f));
-	m_pShaderManager->setFloatValue("lightSources[0].focalStrength", commonFocalStrength);
-	m_pShaderManager->setFloatValue("lightSources[0].specularIntensity", commonSpecularIntensity);
+	// Light 0: Blue directional with lowered position, casts the scene's shadows
+	LIGHT_SOURCE light;
+	light.position = g_KeyLightPosition;
+	light.ambientColor = glm::vec3(0.0f, 0.0f, 0.0f);  // Zero because additive ambient was making everything white
+	light.diffuseColor = glm::vec3(0.5f, 0.5f, 0.5f);  // white (set for consistency)
+	light.specularColor = glm::vec3(0.3f, 0.2f, 0.9f);
+	light.focalStrength = commonFocalStrength;
+	light.specularIntensity = commonSpecularIntensity;
+	SetLightSource(0, light);
 
 	// Light 1: blue/white light from raised position
-	m_pShaderManager->setVec3Value("lightSources[1].position", glm::vec3(-4.0f, 8.0f, 2.0f));  // Adjusted for sides
-	m_pShaderManager->setVec3Value("lightSources[1].ambientColor", glm::vec3(0.0f, 0.0f, 0.0f));  // zero to avoid whitewashing everything out
-	m_pShaderManager->setVec3Value("lightSources[1].diffuseColor", glm::vec3(0.2f, 0.2f, 0.8f));
-	m_pShaderManager->setVec3Value("lightSources[1].specularColor", glm::vec3(0.8f, 0.7f, 1.0f));
-	m_pShaderManager->setFloatValue("lightSources[1].focalStrength", commonFocalStrength);
-	m_pShaderManager->setFloatValue("lightSources[1].specularIntensity", commonSpecularIntensity);
+	light.position = glm::vec3(-4.0f, 8.0f, 2.0f);  // Adjusted for sides
+	light.ambientColor = glm::vec3(0.0f, 0.0f, 0.0f);  // zero to avoid whitewashing everything out
+	light.diffuseColor = glm::vec3(0.2f, 0.2f, 0.8f);
+	light.specularColor = glm::vec3(0.8f, 0.7f, 1.0f);
+	light.focalStrength = commonFocalStrength;
+	light.specularIntensity = commonSpecularIntensity;
+	SetLightSource(1, light);
 
 	// Far away dim light to ensure all sides are lit up
-	m_pShaderManager->setVec3Value("lightSources[2].position", glm::vec3(0.0f, -200.0f, 0.0f));  // Very far below
-	m_pShaderManager->setVec3Value("lightSources[2].ambientColor", glm::vec3(0.0f, 0.0f, 0.0f));
-	m_pShaderManager->setVec3Value("lightSources[2].diffuseColor", glm::vec3(0.0f, 0.0f, 0.0f));
-	m_pShaderManager->setVec3Value("lightSources[2].specularColor", glm::vec3(0.0f, 0.0f, 0.0f));
-	m_pShaderManager->setFloatValue("lightSources[2].focalStrength", 1.0f);  // Very weak
-	m_pShaderManager->setFloatValue("lightSources[2].specularIntensity", 0.0f);  // Zero to disable specular
+	light.position = glm::vec3(0.0f, -200.0f, 0.0f);  // Very far below
+	light.ambientColor = glm::vec3(0.0f, 0.0f, 0.0f);
+	light.diffuseColor = glm::vec3(0.0f, 0.0f, 0.0f);
+	light.specularColor = glm::vec3(0.0f, 0.0f, 0.0f);
+	light.focalStrength = 1.0f;  // Very weak
+	light.specularIntensity = 0.0f;  // Zero to disable specular
+	SetLightSource(2, light);
 
 	//  Light 3: Same purpose as Light 2
-	m_pShaderManager->setVec3Value("lightSources[3].position", glm::vec3(0.0f, -200.0f, 0.0f)); //very fr below
-	m_pShaderManager->setVec3Value("lightSources[3].ambientColor", glm::vec3(0.0f, 0.0f, 0.0f));
-	m_pShaderManager->setVec3Value("lightSources[3].diffuseColor", glm::vec3(0.0f, 0.0f, 0.0f));
-	m_pShaderManager->setVec3Value("lightSources[3].specularColor", glm::vec3(0.0f, 0.0f, 0.0f));
-	m_pShaderManager->setFloatValue("lightSources[3].focalStrength", 1.0f); //very weak
-	m_pShaderManager->setFloatValue("lightSources[3].specularIntensity", 0.0f);
+	light.position = glm::vec3(0.0f, -200.0f, 0.0f); //very fr below
+	light.focalStrength = 1.0f; //very weak
+	light.specularIntensity = 0.0f;
+	SetLightSource(3, light);
 
 }
 
+/***********************************************************
+ *  SetLightSource()
+ *
+ *  This method sets one entry of the lightSources array in
+ *  the scene shader and keeps a copy for the deferred
+ *  lighting pass.
+ ***********************************************************/
+void SceneManager::SetLightSource(int index, const LIGHT_SOURCE& light)
+{
+	m_lightSources[index] = light;
+
+	std::string name = "lightSources[" + std::to_string(index) + "].";
+	m_pShaderManager->setVec3Value(name + "position", light.position);
+	m_pShaderManager->setVec3Value(name + "ambientColor", light.ambientColor);
+	m_pShaderManager->setVec3Value(name + "diffuseColor", light.diffuseColor);
+	m_pShaderManager->setVec3Value(name + "specularColor", light.specularColor);
+	m_pShaderManager->setFloatValue(name + "focalStrength", light.focalStrength);
+	m_pShaderManager->setFloatValue(name + "specularIntensity", light.specularIntensity);
+}
+
 void SceneManager::LoadSceneTextures()
 {
 	/*** STUDENTS - add the code BELOW for loading the textures that ***/
 	/*** will be used for mapping to objects in the 3D scene. Up to  ***/
-	/*** 16 textures can be loaded per scene. Refer to the code in   ***/
+	/*** 7 textures can be loaded per scene (g_SceneTextureUnits),   ***/
+	/*** the render passes use the other units. Refer to the code in ***/
 	/*** the OpenGL Sample for help.                                 ***/
 
 	// Note: I have copied the "textures" folder from utilities to the solution directory,
 	// and I have applied the same textures as in the example picture
-	CreateGLTexture("textures/clockface.png", "clockface1"); //a regular clock for the bottom half
+	// numerals and ticks as a distance field, they stay sharp at any distance
+	CreateDistanceFieldTexture("textures/clockdial_sdf.tga", "clockface1"); //a regular clock for the bottom half
 	CreateGLTexture("textures/hypno.jpg", "clockface2");	//a hypnotic pattern for the top half
-	CreateGLTexture("textures/knobtexture.png", "goldTexture"); //a golden texture for the top bell
-	CreateGLTexture("textures/darkgrain.jpg", "handsTexture"); //a dark grained wood for the hands
-	CreateGLTexture("textures/rusticwood.jpg", "woodTexture");//added for floor, to match feel of painting
+	// the small images that are never tiled share one atlas page
+	CreateAtlasTexture("textures/knobtexture.png", "goldTexture"); //a golden texture for the top bell
+	// the grain of the hands is generated by the scene shader, which
+	// saves decoding the image and keeping its mips
+	PROCEDURAL_TEXTURE scratches;
+	scratches.pattern = PATTERN_SCRATCHES;
+	scratches.baseColor = glm::vec3(0.06f, 0.06f, 0.06f);
+	scratches.detailColor = glm::vec3(0.75f, 0.75f, 0.75f);
+	scratches.frequency = glm::vec2(6.0f, 4.0f);
+	scratches.seed = 1.0f;
+	CreateProceduralTexture(scratches, "handsTexture"); //a dark grained wood for the hands, was darkgrain.jpg
 	CreateGLTexture("textures/backdrop.jpg", "backdropTexture"); //Added for backdrop, since painting's sky background too complex
-	CreateGLTexture("textures/DisintegrationofPersistence.jpg", "disintegration"); //Added for floor to fit with theme
+	CreateAtlasTexture("textures/DisintegrationofPersistence.jpg", "disintegration"); //Added for floor to fit with theme
+	BuildTextureAtlases();
 
 
 	// after the texture image data is loaded into memory, the
 	// loaded textures need to be bound to texture slots - there
-	// are a total of 16 available slots for scene textures
+	// are a total of 7 available slots for scene textures
 	BindGLTextures();
 }
 
-/***********************************************************
- *  SetShaderTexture()
- *
- *  This method is used for setting the texture data
- *  associated with the passed in ID into the shader.
- ***********************************************************/
-void SceneManager::SetShaderTexture(
-	std::string textureTag)
-{
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setIntValue(g_UseTextureName, true);
-		m_pShaderManager->setIntValue(g_UseTwoTexturesName, 0);//to avoid using multiple textures
-
-
-
-		int textureID = -1;
-		textureID = FindTextureSlot(textureTag);
-		m_pShaderManager->setSampler2DValue(g_TextureValueName, textureID);
-	}
-}
-
-void SceneManager::SetShaderTwoTextures( //Allows using 2 textures on one shape, based on adding some changes to FragmentShader.glsl
-										//based on  https://stackoverflow.com/questions/27345340/how-do-i-render-multiple-textures-in-modern-opengl
-	std::string textureTag1,
-	std::string textureTag2)
-{
-	if (m_pShaderManager != NULL)
-	{
-		m_pShaderManager->setIntValue(g_UseTextureName, true);
-		m_pShaderManager->setIntValue(g_UseTwoTexturesName, 1);
-
-		int textureID1 = FindTextureSlot(textureTag1);
-		m_pShaderManager->setSampler2DValue(g_TextureValueName, textureID1);
-
-		int textureID2 = FindTextureSlot(textureTag2);
-		m_pShaderManager->setSampler2DValue("objectTexture2", textureID2);
-	}
-
-}
-
-
-
-
-
-
-
 /***********************************************************
  *  PrepareScene()
  *
@@ -646,12 +795,237 @@ void SceneManager::PrepareScene()
 	m_basicMeshes->LoadTaperedCylinderMesh();
 
 	m_basicMeshes->LoadTorusMesh(torusMinorRadius);
+	CaptureCompactMeshes();
 
+	// place the clocks that RenderScene() records every frame
+	DefineSceneObjects();
+	ResolveSceneSlots();
+	ResolveSceneUniforms();
+	// all materials are defined, send the whole table once
+	m_pMaterialTable->Upload();
+
+	// three cascades over the first 30 units cover the whole scene
+	if (!m_pShadowMaps->Initialize(2048, 3, 30.0f))
+	{
+		std::cout << "Shadows are disabled" << std::endl;
+	}
 
+	// the spheres and tori are finely tessellated and half of them
+	// faces away, they only draw the meshlets that can be seen
+	std::vector<int> clusteredMeshes;
+	clusteredMeshes.push_back(SHAPE_SPHERE);
+	clusteredMeshes.push_back(SHAPE_TORUS);
+	if (!m_pClusterCuller->Initialize(m_pCompactMeshes, clusteredMeshes))
+	{
+		std::cout << "Cluster culling is disabled" << std::endl;
+	}
+	// batches need the vertex pulling scene shader, which GL 3.3
+	// contexts do not get
+	if ((m_uniforms.pullVertices < 0) || !m_pMultiDraw->Initialize(m_pCompactMeshes))
+	{
+		std::cout << "Multi-draw batching is disabled" << std::endl;
+	}
+}
+
+/***********************************************************
+ *  ResolveSceneSlots()
+ *
+ *  This method looks up the textures and materials the
+ *  recorded objects use, once the tags are all defined.
+ ***********************************************************/
+void SceneManager::ResolveSceneSlots()
+{
+	m_slots.glassMaterial = FindMaterialIndex("glass");
+	m_slots.goldTexture = FindTextureIndex("goldTexture");
+	m_slots.clockFaceTopTexture = FindTextureIndex("clockface2");
+	m_slots.clockFaceBottomTexture = FindTextureIndex("clockface1");
+	m_slots.handsTexture = FindTextureIndex("handsTexture");
+	m_slots.floorTexture = FindTextureIndex("backdropTexture");
+	m_slots.wallTexture = FindTextureIndex("disintegration");
+}
+
+/***********************************************************
+ *  ResolveSceneUniforms()
+ *
+ *  This method looks up the uniform locations of the scene
+ *  shader, which must be the current program, so the draw
+ *  submission sets them without building name strings.
+ ***********************************************************/
+void SceneManager::ResolveSceneUniforms()
+{
+	m_sceneProgram = GLStateCache::GetProgram();
+
+	m_uniforms.model = glGetUniformLocation(m_sceneProgram, g_ModelName);
+	m_uniforms.uvScale = glGetUniformLocation(m_sceneProgram, "UVscale");
+	m_uniforms.uvOffset = glGetUniformLocation(m_sceneProgram, "UVoffset");
+	m_uniforms.uvScale2 = glGetUniformLocation(m_sceneProgram, "UVscale2");
+	m_uniforms.uvOffset2 = glGetUniformLocation(m_sceneProgram, "UVoffset2");
+	m_uniforms.color = glGetUniformLocation(m_sceneProgram, g_ColorValueName);
+	m_uniforms.useTexture = glGetUniformLocation(m_sceneProgram, g_UseTextureName);
+	m_uniforms.useTwoTextures = glGetUniformLocation(m_sceneProgram, g_UseTwoTexturesName);
+	m_uniforms.texture = glGetUniformLocation(m_sceneProgram, g_TextureValueName);
+	m_uniforms.texture2 = glGetUniformLocation(m_sceneProgram, "objectTexture2");
+	m_uniforms.useMelt = glGetUniformLocation(m_sceneProgram, g_UseMeltName);
+	m_uniforms.meltGroup = glGetUniformLocation(m_sceneProgram, g_MeltGroupName);
+	m_uniforms.meltParams = glGetUniformLocation(m_sceneProgram, g_MeltParamsName);
+	m_uniforms.materialIndex = glGetUniformLocation(m_sceneProgram, "materialIndex");
+	MaterialTable::BindProgram(m_sceneProgram);
+	m_uniforms.shadowMap = glGetUniformLocation(m_sceneProgram, "shadowMap");
+	m_uniforms.useShadows = glGetUniformLocation(m_sceneProgram, "bUseShadows");
+	m_uniforms.viewCount = glGetUniformLocation(m_sceneProgram, "viewCount");
+	m_uniforms.firstView = glGetUniformLocation(m_sceneProgram, "firstView");
+	m_uniforms.viewProjections = glGetUniformLocation(m_sceneProgram, "viewProjections");
+	m_uniforms.viewRectangles = glGetUniformLocation(m_sceneProgram, "viewRectangles");
+	m_uniforms.viewPositions = glGetUniformLocation(m_sceneProgram, "viewPositions");
+	m_uniforms.opacity = glGetUniformLocation(m_sceneProgram, "objectOpacity");
+	m_uniforms.weightedTransparency = glGetUniformLocation(m_sceneProgram, "bWeightedTransparency");
+	m_uniforms.deferredGeometry = glGetUniformLocation(m_sceneProgram, "bDeferredGeometry");
+	m_uniforms.useReflection = glGetUniformLocation(m_sceneProgram, "bUseReflection");
+	m_uniforms.reflectivity = glGetUniformLocation(m_sceneProgram, "reflectivity");
+	m_uniforms.reflectionTexture = glGetUniformLocation(m_sceneProgram, "reflectionTexture");
+	m_uniforms.reflectionUVScale = glGetUniformLocation(m_sceneProgram, "reflectionUVScale");
+	m_uniforms.reflectionMaxUV = glGetUniformLocation(m_sceneProgram, "reflectionMaxUV");
+	m_uniforms.reflectionMaxLod = glGetUniformLocation(m_sceneProgram, "reflectionMaxLod");
+	m_uniforms.proceduralPattern = glGetUniformLocation(m_sceneProgram, "proceduralPattern");
+	m_uniforms.proceduralBaseColor = glGetUniformLocation(m_sceneProgram, "proceduralBaseColor");
+	m_uniforms.proceduralDetailColor = glGetUniformLocation(m_sceneProgram, "proceduralDetailColor");
+	m_uniforms.proceduralParams = glGetUniformLocation(m_sceneProgram, "proceduralParams");
+	m_uniforms.distanceField2 = glGetUniformLocation(m_sceneProgram, "bDistanceField2");
+	m_uniforms.directExposure = glGetUniformLocation(m_sceneProgram, "directExposure");
+	m_uniforms.directGamma = glGetUniformLocation(m_sceneProgram, "bDirectGamma");
+	m_uniforms.pullVertices = glGetUniformLocation(m_sceneProgram, "bPullVertices");
+}
+
+/***********************************************************
+ *  DefineSceneObjects()
+ *
+ *  This method fills in the list of clocks in the scene.
+ *  RenderScene() walks this list every frame, so clocks can
+ *  be added here without touching the rendering code.
+ ***********************************************************/
+void SceneManager::DefineSceneObjects()
+{
+	SCENE_CLOCK clock;
+
+	// main clock
+	clock.position = glm::vec3(-1, 2, 0);
+	clock.scale = glm::vec3(1, 1, 1);
+	clock.rotationDegrees = glm::vec3(0, 0, 0);
+	clock.meltParams = glm::vec4(0.0f);
+	clock.opacity = 1.0f;
+	m_sceneClocks.push_back(clock);
+
+	// large clock, oblong shape to match painting
+	clock.position = glm::vec3(1, 3.5, 2);
+	clock.scale = glm::vec3(4, 2, 1);
+	clock.rotationDegrees = glm::vec3(0, -30, 0); //rotate -30 degrees to point slightly to main clock
+	clock.meltParams = glm::vec4(0.0f);
+	m_sceneClocks.push_back(clock);
+
+	// distorted clock, droops over an edge just above the center, like the clock draped over the branch
+	clock.position = glm::vec3(-4, 2, -2);
+	clock.scale = glm::vec3(1, 1, 1);
+	clock.rotationDegrees = glm::vec3(0, 20, 0);
+	clock.meltParams = glm::vec4(0.3f, 0.25f, 1.0f, 0.4f);
+	m_sceneClocks.push_back(clock);
+
+	// small clock, made of glass so the main clock shows through it
+	clock.position = glm::vec3(-1, 4, 0);
+	clock.scale = glm::vec3(.2, .2, .1);
+	clock.rotationDegrees = glm::vec3(0, 0, 0);
+	clock.meltParams = glm::vec4(0.0f);
+	clock.opacity = 0.5f;
+	m_sceneClocks.push_back(clock);
 }
 
 /***********************************************************
-*  drawClock()
+ *  SetFrameState()
+ *
+ *  This method receives the camera state for the frame so
+ *  the scene traversal can cull against the frustums of its
+ *  views, fits the shadow cascades to the camera and
+ *  mirrors the camera for the floor reflection.
+ ***********************************************************/
+void SceneManager::SetFrameState(const FRAME_STATE& frameState)
+{
+	m_frameState = frameState;
+	m_frameState.viewCount = glm::clamp(frameState.viewCount, 1, MAX_FRAME_VIEWS);
+	m_frameState.views[0].viewProjection = frameState.viewProjection;
+	for (int view = 0; view < m_frameState.viewCount; view++)
+	{
+		m_viewFrustums[view].Extract(m_frameState.views[view].viewProjection);
+	}
+
+	if (m_pShadowMaps->IsReady())
+	{
+		// the key light is treated as directional, shining at the origin
+		m_pShadowMaps->UpdateCascades(frameState, glm::normalize(-g_KeyLightPosition));
+	}
+
+	// the measured pass picks the reflection resolution of this frame
+	if (NULL != m_pProfiler)
+	{
+		m_pReflection->UpdateQuality(m_pProfiler->GetRecentGpuTimeMs(m_reflectionScope));
+	}
+	m_pReflection->Update(m_frameState);
+}
+
+/***********************************************************
+ *  SetProfiler()
+ *
+ *  This method registers the render pass timings with the
+ *  passed in profiler.
+ ***********************************************************/
+void SceneManager::SetProfiler(FrameProfiler* pProfiler)
+{
+	m_pProfiler = pProfiler;
+	if (NULL != m_pProfiler)
+	{
+		m_shadowScope = m_pProfiler->RegisterScope("shadows");
+		m_reflectionScope = m_pProfiler->RegisterScope("reflection");
+		m_sceneScope = m_pProfiler->RegisterScope("scene");
+	}
+}
+
+/***********************************************************
+ *  SetTransparency()
+ *
+ *  This method picks the pass the transparent draws of the
+ *  following frames go through.
+ ***********************************************************/
+void SceneManager::SetTransparency(WeightedTransparency* pTransparency)
+{
+	m_pTransparency = pTransparency;
+}
+
+/***********************************************************
+ *  SetDeferredShading()
+ *
+ *  This method picks the pass the opaque draws of the
+ *  following frames are lit by, and hands it the lights.
+ ***********************************************************/
+void SceneManager::SetDeferredShading(DeferredShading* pDeferredShading)
+{
+	m_pDeferredShading = pDeferredShading;
+	if (NULL != m_pDeferredShading)
+	{
+		m_pDeferredShading->SetLights(m_lightSources, DeferredShading::MAX_LIGHTS);
+	}
+}
+
+/***********************************************************
+ *  SetAmbientOcclusion()
+ *
+ *  This method picks the pass that darkens the lit opaque
+ *  draws of the following frames.
+ ***********************************************************/
+void SceneManager::SetAmbientOcclusion(AmbientOcclusion* pAmbientOcclusion)
+{
+	m_pAmbientOcclusion = pAmbientOcclusion;
+}
+
+/***********************************************************
+*  RecordClock()
 *
 *  This method uses combinations of simple 3d shapes to generate a comples shape
 * At an arbitrarily chosen point and with an arbitratily chosen rotation and scale
@@ -666,21 +1040,60 @@ void SceneManager::PrepareScene()
 * https://libguides.snhu.edu/c.php?g=92369&p=10173600
 * is as follows:
 * XAI. (2025). Grok 4 Expert [Large language model]. https://grok.com/
+* 
+* meltParams (edge height, edge radius, drape amount, side sag) bends the whole
+* clock over an edge in the vertex shader. A drape amount of 0 draws it rigid.
+* 
+* The parts are recorded as draw packets instead of being drawn, so this method
+* does no OpenGL calls and can run on any worker thread. Clocks outside the view
+* frustum are only recorded as shadow casters, and clocks that cast into no
+* shadow cascade either record nothing.
 ***********************************************************/
-void SceneManager::DrawClock(glm::vec3 groupPos, 
-						glm::vec3 groupScale, 
-						float groupRotX, float groupRotY, float groupRotZ ) {
+void SceneManager::RecordClock(const SCENE_CLOCK& clock, DrawList& drawList) {
 
+	glm::vec3 groupPos = clock.position;
 	groupPos.z = -1 * groupPos.z; //greater Z value should take it back into picture,
 								//but default computation takes it more forward
 								
 	// Compute the group transformation matrix
 	glm::mat4 groupMatrix = glm::mat4(1.0f);
 	groupMatrix = glm::translate(groupMatrix, groupPos);
-	groupMatrix = glm::rotate(groupMatrix, glm::radians(groupRotX), glm::vec3(1.0f, 0.0f, 0.0f));
-	groupMatrix = glm::rotate(groupMatrix, glm::radians(groupRotY), glm::vec3(0.0f, 1.0f, 0.0f));
-	groupMatrix = glm::rotate(groupMatrix, glm::radians(groupRotZ), glm::vec3(0.0f, 0.0f, 1.0f));
-	groupMatrix = glm::scale(groupMatrix, groupScale);// Local variables for the clock (relative to group origin)
+	groupMatrix = glm::rotate(groupMatrix, glm::radians(clock.rotationDegrees.x), glm::vec3(1.0f, 0.0f, 0.0f));
+	groupMatrix = glm::rotate(groupMatrix, glm::radians(clock.rotationDegrees.y), glm::vec3(0.0f, 1.0f, 0.0f));
+	groupMatrix = glm::rotate(groupMatrix, glm::radians(clock.rotationDegrees.z), glm::vec3(0.0f, 0.0f, 1.0f));
+	groupMatrix = glm::scale(groupMatrix, clock.scale);// Local variables for the clock (relative to group origin)
+
+	// the rim, bell and a fully draped face all fit in a sphere of
+	// radius 2 around the clock center, scaled by the largest axis
+	float maxScale = glm::max(clock.scale.x, glm::max(clock.scale.y, clock.scale.z));
+	bool bVisible = IsInAnyView(groupPos, 2.0f * maxScale);
+	bool bReflected = m_pReflection->IsReflected(groupPos, 2.0f * maxScale);
+	unsigned int cascadeMask = 0;
+	if (m_pShadowMaps->IsReady())
+	{
+		cascadeMask = m_pShadowMaps->GetCascadeMask(groupPos, 2.0f * maxScale);
+	}
+	if ((bVisible == false) && (bReflected == false) && (cascadeMask == 0))
+	{
+		return;
+	}
+
+	// When melting, the shader gets the group matrix and each part only
+	// gets its local matrix, so the parts bend together in clock space
+	bool bMelt = (clock.meltParams.z > 0.0f);
+
+	DRAW_PACKET packet;
+	packet.bVisible = bVisible;
+	packet.bReflected = bReflected;
+	packet.reflectivity = 0.0f;
+	packet.cascadeMask = cascadeMask;
+	packet.meltGroup = groupMatrix;
+	packet.meltParams = clock.meltParams;
+	packet.bounds = glm::vec4(groupPos, 2.0f * maxScale);
+	packet.opacity = clock.opacity;
+	// the clock parts never picked a material and used to inherit "glass"
+	// from the back wall, keep that look now that the draws are sorted
+	packet.materialIndex = m_slots.glassMaterial;
 
 	float PAINT_MAX = 255.0f; // To allow getting colors from Microsoft Paint's 0-255 RGB scale
 	// Achieve gold coloring
@@ -697,104 +1110,60 @@ void SceneManager::DrawClock(glm::vec3 groupPos,
 
 	// Draw clock rim
 	glm::vec3 scaleXYZ = glm::vec3(clockRimRadius, clockRimRadius, squished);
-	float XrotationDegrees = 0.0f;
-	float YrotationDegrees = 0.0f;
-	float ZrotationDegrees = 0.0f;
 	glm::vec3 positionXYZ = glm::vec3(clockCenterX, clockCenterY, 0.0f);
 
 	// Compute local model matrix
-	glm::mat4 localModel = glm::translate(glm::mat4(1.0f), positionXYZ);
-	localModel = glm::rotate(localModel, glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
-	localModel = glm::rotate(localModel, glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
-	localModel = glm::rotate(localModel, glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
-	localModel = glm::scale(localModel, scaleXYZ);
-
-	// Apply group matrix and set to shader
-	glm::mat4 fullModel = groupMatrix * localModel;
-	m_pShaderManager->setMat4Value(g_ModelName, fullModel);
+	glm::mat4 localModel = BuildModelMatrix(scaleXYZ, 0.0f, 0.0f, 0.0f, positionXYZ);
 
-	SetShaderColor(rimR, rimG, rimB, 1.0f);
-	SetShaderTexture("goldTexture");
-	m_basicMeshes->DrawTorusMesh();
+	// Apply group matrix
+	packet.mesh = SHAPE_TORUS;
+	packet.model = bMelt ? localModel : groupMatrix * localModel;
+	packet.color = glm::vec4(rimR, rimG, rimB, 1.0f);
+	SetPacketTextures(packet, m_slots.goldTexture, -1);
+	drawList.Add(packet);
 
 	// Clock face - Adjusted radius to better fill the rim (subtract minor radius for inner fit)
 	float clockFaceRadius = clockRimRadius - torusMinorRadius;
 	scaleXYZ = glm::vec3(clockFaceRadius, clockFaceRadius, squished);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
 	positionXYZ = glm::vec3(clockCenterX, clockCenterY, 0.0f);
 
-	// Local model
-	localModel = glm::translate(glm::mat4(1.0f), positionXYZ);
-	localModel = glm::rotate(localModel, glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
-	localModel = glm::rotate(localModel, glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
-	localModel = glm::rotate(localModel, glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
-	localModel = glm::scale(localModel, scaleXYZ);
+	localModel = BuildModelMatrix(scaleXYZ, 0.0f, 0.0f, 0.0f, positionXYZ);
 
-	fullModel = groupMatrix * localModel;
-	m_pShaderManager->setMat4Value(g_ModelName, fullModel);
-
-	// Set objectPosition and objectScale for UV calculation in shader (critical for two-texture split)
-	// objectPosition: full world position of the clock face center
-	glm::vec3 fullPosition = groupPos + positionXYZ;
-	m_pShaderManager->setVec3Value("objectPosition", fullPosition);
-
-	// objectScale: full effective scale (group * local; use xy for 2D UV, z not needed)
-	glm::vec3 fullScale = groupScale * glm::vec3(clockFaceRadius, clockFaceRadius, squished);
-	m_pShaderManager->setVec3Value("objectScale", fullScale);
-
-	// Set UVscale to 1.0 to avoid tiling (stretch to fit)
-	m_pShaderManager->setVec2Value("UVscale", glm::vec2(1.0f, 1.0f));  // Explicitly set to prevent tiling
-
-	SetShaderColor(1.0f, 1.0f, 1.0f, 1.0f);
-	SetShaderTwoTextures("clockface2", "clockface1");  // clockface2 for top, clockface1 for bottom
-	m_basicMeshes->DrawSphereMesh();
+	// UVscale stays 1.0 to avoid tiling (stretch to fit)
+	packet.mesh = SHAPE_SPHERE;
+	packet.model = bMelt ? localModel : groupMatrix * localModel;
+	packet.color = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+	SetPacketTextures(packet, m_slots.clockFaceTopTexture, m_slots.clockFaceBottomTexture);  // clockface2 for top, clockface1 for bottom
+	drawList.Add(packet);
 
 	// Clock hands
 	float clockHandLength = clockRimRadius; // Long hands going to the edge of the clock
 	float clockHandY = clockCenterY + 0.0f * clockHandLength; // Start bottom of hand at center of clockface
 	// (0.0 for cone; use 0.5 for box if switching)
 
-// First hand (minute)
+	// First hand (minute)
 	scaleXYZ = glm::vec3(squished, clockHandLength, squished);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = -330.0f; // The 55 minutes position
 	positionXYZ = glm::vec3(clockCenterX, clockHandY, squished); // Slightly positive Z so hand is in front
 
-	localModel = glm::translate(glm::mat4(1.0f), positionXYZ);
-	localModel = glm::rotate(localModel, glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
-	localModel = glm::rotate(localModel, glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
-	localModel = glm::rotate(localModel, glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
-	localModel = glm::scale(localModel, scaleXYZ);
+	localModel = BuildModelMatrix(scaleXYZ, 0.0f, 0.0f, -330.0f, positionXYZ); // The 55 minutes position
 
-	fullModel = groupMatrix * localModel;
-	m_pShaderManager->setMat4Value(g_ModelName, fullModel);
-
-	SetShaderColor(0.0f, 0.0f, 0.0f, 1.0f);
-	SetShaderTexture("handsTexture");
-	m_basicMeshes->DrawConeMesh();
+	packet.mesh = SHAPE_CONE;
+	packet.model = bMelt ? localModel : groupMatrix * localModel;
+	packet.color = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	SetPacketTextures(packet, m_slots.handsTexture, -1);
+	drawList.Add(packet);
 
 	// Second clock hand (shorter, hour hand)
 	scaleXYZ = glm::vec3(squished, 0.75f * clockHandLength, squished);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = -210.0f; // The 7 o'clock position
 	positionXYZ = glm::vec3(clockCenterX, clockHandY, squished);
 
-	localModel = glm::translate(glm::mat4(1.0f), positionXYZ);
-	localModel = glm::rotate(localModel, glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
-	localModel = glm::rotate(localModel, glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
-	localModel = glm::rotate(localModel, glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
-	localModel = glm::scale(localModel, scaleXYZ);
-
-	fullModel = groupMatrix * localModel;
-	m_pShaderManager->setMat4Value(g_ModelName, fullModel);
+	localModel = BuildModelMatrix(scaleXYZ, 0.0f, 0.0f, -210.0f, positionXYZ); // The 7 o'clock position
 
-	SetShaderColor(0.0f, 0.0f, 0.0f, 1.0f);
-	SetShaderTexture("handsTexture");
-	m_basicMeshes->DrawConeMesh();
+	packet.mesh = SHAPE_CONE;
+	packet.model = bMelt ? localModel : groupMatrix * localModel;
+	packet.color = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	SetPacketTextures(packet, m_slots.handsTexture, -1);
+	drawList.Add(packet);
 
 	// Bell at top
 	float bellHeight = 0.3f;
@@ -802,144 +1171,721 @@ void SceneManager::DrawClock(glm::vec3 groupPos,
 	float bellDepth = 0.25f; // The bell doesn't look as squished in the painting
 	float clockAndRimHeight = clockCenterY + clockRimRadius;
 	scaleXYZ = glm::vec3(bellWidth, bellHeight, bellDepth);
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
 	float bellPositionY = clockAndRimHeight + bellHeight / 2.0f;  // Adjusted to center the bell on top
 	positionXYZ = glm::vec3(clockCenterX, bellPositionY, 0.0f);
 
-	localModel = glm::translate(glm::mat4(1.0f), positionXYZ);
-	localModel = glm::rotate(localModel, glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
-	localModel = glm::rotate(localModel, glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
-	localModel = glm::rotate(localModel, glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
-	localModel = glm::scale(localModel, scaleXYZ);
+	localModel = BuildModelMatrix(scaleXYZ, 0.0f, 0.0f, 0.0f, positionXYZ);
 
-	fullModel = groupMatrix * localModel;
-	m_pShaderManager->setMat4Value(g_ModelName, fullModel);
+	packet.mesh = SHAPE_SPHERE;
+	packet.model = bMelt ? localModel : groupMatrix * localModel;
+	packet.color = glm::vec4(1.0f, 1.0f, 0.0f, 1.0f); // Yellow. While it's the same shade in the painting, this makes them easier to tell apart
+	SetPacketTextures(packet, m_slots.goldTexture, -1);
+	drawList.Add(packet);
+}
 
-	SetShaderColor(1.0f, 1.0f, 0.0f, 1.0f); // Yellow. While it's the same shade in the painting, this makes them easier to tell apart
-	SetShaderTexture("goldTexture");
-	m_basicMeshes->DrawSphereMesh();
+/***********************************************************
+ *  RecordScene()
+ *
+ *  This method records the draw packets for the whole scene.
+ *  The clocks are split into chunks over the job system and
+ *  every worker fills and sorts its own list, so there is no
+ *  locking on the hot path. The sorted lists are then merged
+ *  into the frame's draw list. All of it lives in the frame
+ *  arena, so recording does not touch the heap.
+ ***********************************************************/
+void SceneManager::RecordScene()
+{
+	// last frame's lists were fully submitted, their memory is free again
+	m_pFrameArena->Reset();
+	for (size_t i = 0; i < m_workerDrawLists.size(); i++)
+	{
+		m_workerDrawLists[i].Clear(m_pFrameArena);
+	}
+	m_drawList.Clear(m_pFrameArena);
 
+	// declare the variables for the transformations
+	glm::vec3 scaleXYZ;
+	glm::vec3 positionXYZ;
+	DRAW_PACKET packet;
+	packet.meltGroup = glm::mat4(1.0f);
+	packet.meltParams = glm::vec4(0.0f);
+	packet.color = glm::vec4(1.0f);
+	packet.opacity = 1.0f;
+	// the floor and back wall receive shadows but never cast any
+	packet.bVisible = true;
+	packet.cascadeMask = 0;
+	packet.reflectivity = 0.0f;
 
+	/*** Set needed transformations before drawing the basic mesh.  ***/
+	/*** This same ordering of code should be used for transforming ***/
+	/*** and drawing all the basic 3D shapes.						***/
+	/******************************************************************/
+	// set the XYZ scale and position for the mesh (the floor)
+	scaleXYZ = glm::vec3(20.0f, 1.0f, 10.0f);
+	positionXYZ = glm::vec3(0.0f, 0.0f, 0.0f);
 
+	packet.mesh = SHAPE_PLANE;
+	packet.model = BuildModelMatrix(scaleXYZ, 0.0f, 0.0f, 0.0f, positionXYZ);
+	packet.bounds = glm::vec4(positionXYZ, glm::length(scaleXYZ));
+	SetPacketTextures(packet, m_slots.floorTexture, -1); //Add interesting background on floor according to theme
+	packet.materialIndex = m_slots.glassMaterial; //Make floor unusually shiny, like glass, for artstic effect
+	// the floor is the mirror, so it is never in its own reflection
+	packet.reflectivity = g_FloorReflectivity;
+	packet.bReflected = false;
+	m_workerDrawLists[0].Add(packet);
+	packet.reflectivity = 0.0f;
+	/****************************************************************/
+
+	// set the XYZ scale and position for the mesh (the back wall)
+	scaleXYZ = glm::vec3(20.0f, 8.0f, 10.0f);
+	positionXYZ = glm::vec3(0.0f, 7.0f, -10.0f);
 
+	packet.mesh = SHAPE_PLANE;
+	packet.model = BuildModelMatrix(scaleXYZ, 90.0f, 0.0f, 0.0f, positionXYZ);
+	packet.bounds = glm::vec4(positionXYZ, glm::length(scaleXYZ));
+	SetPacketTextures(packet, m_slots.wallTexture, -1); //add artistic background instead of sky
+	packet.bReflected = m_pReflection->IsReflected(positionXYZ, glm::length(scaleXYZ));
+	packet.materialIndex = m_slots.glassMaterial; //create midnight blue color to reflect on clock
+	m_workerDrawLists[0].Add(packet);
+	/****************************************************************/
+	// ADDITION OF NEW SHAPES BEGINS HERE
+	/****************************************************************/
+
+	// 64 clocks per chunk keeps the stealing overhead small next to the work
+	m_pJobSystem->ParallelFor((int)m_sceneClocks.size(), 64,
+		[this](int begin, int end, int workerIndex)
+		{
+			for (int i = begin; i < end; i++)
+			{
+				RecordClock(m_sceneClocks[i], m_workerDrawLists[workerIndex]);
+			}
+		});
+
+	// each worker sorts its own list, then the sorted lists are merged
+	m_pJobSystem->ParallelFor((int)m_workerDrawLists.size(), 1,
+		[this](int begin, int end, int)
+		{
+			for (int i = begin; i < end; i++)
+			{
+				m_workerDrawLists[i].Sort();
+			}
+		});
+	m_drawList.MergeSorted(m_workerDrawLists);
 }
 
+/***********************************************************
+ *  IsInAnyView()
+ *
+ *  This method tests a bounding sphere against the frustum
+ *  of every view of the frame, so the views of a split
+ *  frame share one traversal and one draw list.
+ ***********************************************************/
+bool SceneManager::IsInAnyView(const glm::vec3& center, float radius) const
+{
+	for (int view = 0; view < m_frameState.viewCount; view++)
+	{
+		if (m_viewFrustums[view].IntersectsSphere(center, radius))
+		{
+			return(true);
+		}
+	}
+	return(false);
+}
 
+/***********************************************************
+ *  DrawShapeMesh()
+ *
+ *  This method draws the basic mesh referenced by a packet,
+ *  from its compact copy when there is one. A compact mesh
+ *  is drawn for every view at once, one instance per view;
+ *  the shape meshes make their own draw calls, so they are
+ *  repeated for each view.
+ ***********************************************************/
+void SceneManager::DrawShapeMesh(SHAPE_MESH mesh, int viewCount)
+{
+	if (m_bUseCompactMeshes && m_pCompactMeshes->IsReady(mesh))
+	{
+		m_pCompactMeshes->Draw(mesh, viewCount);
+		return;
+	}
+	CompactMeshes::SetFullFloatDecode();
+	if (viewCount <= 1)
+	{
+		DrawBasicMesh(mesh);
+		return;
+	}
+	for (int view = 0; view < viewCount; view++)
+	{
+		GLStateCache::SetUniform(m_uniforms.firstView, view);
+		DrawBasicMesh(mesh);
+	}
+	GLStateCache::SetUniform(m_uniforms.firstView, 0);
+}
 
+/***********************************************************
+ *  SetViewUniforms()
+ *
+ *  This method hands the views of a split frame to the
+ *  scene shader and turns on the clip distances that keep
+ *  each view inside its rectangle. A frame with one view
+ *  draws through the view and projection uniforms as ever.
+ ***********************************************************/
+void SceneManager::SetViewUniforms()
+{
+	int viewCount = m_frameState.viewCount;
+	bool bSplitFrame = (viewCount > 1);
+	GLStateCache::SetUniform(m_uniforms.viewCount, bSplitFrame ? viewCount : 0);
+	for (int plane = 0; plane < 4; plane++)
+	{
+		GLStateCache::SetEnabled(GL_CLIP_DISTANCE0 + plane, bSplitFrame);
+	}
+	if (!bSplitFrame)
+	{
+		return;
+	}
 
+	glm::mat4 viewProjections[MAX_FRAME_VIEWS];
+	glm::vec4 viewRectangles[MAX_FRAME_VIEWS];
+	glm::vec3 viewPositions[MAX_FRAME_VIEWS];
+	for (int view = 0; view < viewCount; view++)
+	{
+		viewProjections[view] = m_frameState.views[view].viewProjection;
+		viewRectangles[view] = m_frameState.views[view].rectangle;
+		viewPositions[view] = m_frameState.views[view].viewPosition;
+	}
+	glUniformMatrix4fv(m_uniforms.viewProjections, viewCount, GL_FALSE, glm::value_ptr(viewProjections[0]));
+	glUniform4fv(m_uniforms.viewRectangles, viewCount, glm::value_ptr(viewRectangles[0]));
+	glUniform3fv(m_uniforms.viewPositions, viewCount, glm::value_ptr(viewPositions[0]));
+}
 
 /***********************************************************
- *  RenderScene()
+ *  DrawBasicMesh()
  *
- *  This method is used for rendering the 3D scene by 
- *  transforming and drawing the basic 3D shapes
+ *  This method draws a mesh with its original float vertices.
  ***********************************************************/
-void SceneManager::RenderScene()
+void SceneManager::DrawBasicMesh(SHAPE_MESH mesh)
 {
-	// declare the variables for the transformations
-	glm::vec3 scaleXYZ;
-	float XrotationDegrees = 0.0f;
-	float YrotationDegrees = 0.0f;
-	float ZrotationDegrees = 0.0f;
-	glm::vec3 positionXYZ;
+	switch (mesh)
+	{
+	case SHAPE_PLANE:
+		m_basicMeshes->DrawPlaneMesh();
+		break;
+	case SHAPE_BOX:
+		m_basicMeshes->DrawBoxMesh();
+		break;
+	case SHAPE_CYLINDER:
+		m_basicMeshes->DrawCylinderMesh();
+		break;
+	case SHAPE_TAPERED_CYLINDER:
+		m_basicMeshes->DrawTaperedCylinderMesh();
+		break;
+	case SHAPE_CONE:
+		m_basicMeshes->DrawConeMesh();
+		break;
+	case SHAPE_SPHERE:
+		m_basicMeshes->DrawSphereMesh();
+		break;
+	case SHAPE_TORUS:
+		m_basicMeshes->DrawTorusMesh();
+		break;
+	default:
+		break;
+	}
+	// the shape meshes bind their own vertex arrays
+	GLStateCache::InvalidateVertexArray();
+}
 
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(20.0f, 1.0f, 10.0f);
+/***********************************************************
+ *  CaptureCompactMeshes()
+ *
+ *  This method builds the quantized copy of every loaded
+ *  basic mesh from what its draw call produces, a mesh that
+ *  cannot be captured keeps drawing with float vertices.
+ ***********************************************************/
+void SceneManager::CaptureCompactMeshes()
+{
+	for (int mesh = 0; mesh < SHAPE_COUNT; mesh++)
+	{
+		m_pCompactMeshes->CaptureMesh(mesh, [this, mesh]()
+			{
+				DrawBasicMesh((SHAPE_MESH)mesh);
+			});
+	}
+	if (!m_pCompactMeshes->Upload())
+	{
+		std::cout << "ERROR: no mesh could be captured, the basic meshes keep their float vertices" << std::endl;
+	}
+}
 
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
+/***********************************************************
+ *  SetCompactMeshes()
+ *
+ *  This method chooses between the quantized meshes and the
+ *  original float meshes for the following frames.
+ ***********************************************************/
+void SceneManager::SetCompactMeshes(bool bCompact)
+{
+	m_bUseCompactMeshes = bCompact;
+}
 
-	// set the XYZ position for the mesh (the floor)
-	//positionXYZ = glm::vec3(0.0f, 0.0f, 0.0f);
-	positionXYZ = glm::vec3(0.0f, 0.0f, 0.0f);
+/***********************************************************
+ *  SetDirectOutput()
+ *
+ *  This method sets the fixed exposure the scene shader
+ *  uses when the frame is drawn straight into the back
+ *  buffer, where nothing tone maps the linear lit color.
+ ***********************************************************/
+void SceneManager::SetDirectOutput(float exposure, bool bEncodeGamma)
+{
+	m_directExposure = exposure;
+	m_bDirectGamma = bEncodeGamma;
+}
 
+/***********************************************************
+ *  SetReflectionQuality()
+ *
+ *  This method sets the resolution of the floor reflection,
+ *  off leaves the floor with its specular highlights only.
+ ***********************************************************/
+void SceneManager::SetReflectionQuality(PlanarReflection::REFLECTION_QUALITY quality)
+{
+	m_pReflection->SetQuality(quality);
+}
 
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-	// set the color values into the shader
-	//Set color as fraction of 255 to allow compatability with Paint color dropper tool
-	//SetShaderColor(95. / 255., 124. / 255., 200. / 255., 1);; //Note to self: this is the floor color
-	SetShaderTexture("backdropTexture"); //Add interesting background on floor according to theme
-	SetShaderMaterial("glass"); //Make floor unusually shiny, like glass, for artstic effect
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawPlaneMesh();
-	/****************************************************************/
+/***********************************************************
+ *  SetReflectionBudget()
+ *
+ *  This method sets the GPU time the reflection pass may
+ *  take, it needs the profiler to measure the pass.
+ ***********************************************************/
+void SceneManager::SetReflectionBudget(double budgetMs)
+{
+	m_pReflection->SetBudget(budgetMs);
+}
 
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	//scaleXYZ = glm::vec3(20.0f, 1.0f, 10.0f);
-	scaleXYZ = glm::vec3(20.0f, 8.0f, 10.0f);
+/***********************************************************
+ *  SubmitDrawList()
+ *
+ *  This method issues the OpenGL calls for a finished draw
+ *  list. It must run on the thread that owns the context,
+ *  with the scene shader as the current program. Opaque
+ *  draws go first with blending off, lit as they are drawn
+ *  or through the G-buffer of the deferred pass, and are
+ *  darkened by the ambient occlusion. The transparent ones
+ *  follow in the weighted transparency pass, whose result
+ *  does not depend on their order.
+ ***********************************************************/
+void SceneManager::SubmitDrawList(const DrawList& drawList)
+{
+	SetViewUniforms();
+	GLStateCache::SetUniform(m_uniforms.directExposure, m_directExposure);
+	GLStateCache::SetUniform(m_uniforms.directGamma, (int)m_bDirectGamma);
+
+	// cull the meshlets of the clustered draws before any draw is made,
+	// the culling only knows the camera's eye point, so a split frame or
+	// a parallel projection draws them whole
+	int* pCommandIndices = m_pFrameArena->AllocateArray<int>(drawList.Size());
+	bool bCullClusters = m_bUseCompactMeshes && m_pClusterCuller->IsReady() &&
+		(m_frameState.viewCount == 1) && !m_frameState.bOrthographic;
+	if (bCullClusters)
+	{
+		m_pClusterCuller->Cull(drawList, m_frameState, m_viewFrustums[0], pCommandIndices);
+	}
+	else
+	{
+		for (size_t i = 0; i < drawList.Size(); i++)
+		{
+			pCommandIndices[i] = -1;
+		}
+	}
 
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 90.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
+	bool bTransparentDraws = false;
+	for (size_t i = 0; (i < drawList.Size()) && !bTransparentDraws; i++)
+	{
+		bTransparentDraws = drawList[i].bVisible && (drawList[i].opacity < 1.0f);
+	}
 
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.0f, 7.0f, -10.0f);
+	GLStateCache::SetEnabled(GL_BLEND, false);
+	if ((NULL != m_pDeferredShading) && m_pDeferredShading->IsReady())
+	{
+		// the opaque draws only fill the G-buffer, one compute
+		// dispatch lights every covered pixel once
+		m_pDeferredShading->BeginGeometry();
+		GLStateCache::SetUniform(m_uniforms.deferredGeometry, (int)true);
+		SubmitPackets(drawList, pCommandIndices, PACKETS_OPAQUE_MATTE);
+		GLStateCache::SetUniform(m_uniforms.deferredGeometry, (int)false);
+		m_pDeferredShading->Light(m_frameState, m_pShadowMaps->IsReady() ? m_pShadowMaps : NULL);
+		// the G-buffer has no room for the reflection, the surfaces
+		// showing it are lit forward over the lit pixels
+		SubmitPackets(drawList, pCommandIndices, PACKETS_OPAQUE_REFLECTIVE);
+	}
+	else
+	{
+		SubmitPackets(drawList, pCommandIndices, PACKETS_OPAQUE);
+	}
 
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
+	// the scene lights have no ambient term to scale, so the
+	// occlusion darkens the whole lit color of the opaque draws
+	if ((NULL != m_pAmbientOcclusion) && m_pAmbientOcclusion->IsReady())
+	{
+		m_pAmbientOcclusion->Apply(m_frameState);
+	}
 
-	// set the color values into the shader
-	//SetShaderColor(0, 0, 1, 1); //Note to self: this is the back wall color
-	SetShaderTexture("disintegration"); //add artistic background instead of sky
-	SetShaderMaterial("glass"); //create midnight blue color to reflect on clock
+	if (bTransparentDraws)
+	{
+		bool bWeighted = (NULL != m_pTransparency) && m_pTransparency->IsReady();
+		if (bWeighted)
+		{
+			m_pTransparency->BeginTransparency();
+			GLStateCache::SetUniform(m_uniforms.weightedTransparency, (int)true);
+		}
+		else
+		{
+			// without the targets the surfaces blend in draw order
+			GLStateCache::DepthMask(false);
+			GLStateCache::SetEnabled(GL_BLEND, true);
+			GLStateCache::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		}
 
+		SubmitPackets(drawList, pCommandIndices, PACKETS_TRANSPARENT);
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawPlaneMesh();
-	/****************************************************************/
-	// ADDITION OF NEW SHAPES BEGINS HERE
-	/****************************************************************/
+		if (bWeighted)
+		{
+			GLStateCache::SetUniform(m_uniforms.weightedTransparency, (int)false);
+			m_pTransparency->Composite();
+		}
+		else
+		{
+			GLStateCache::SetEnabled(GL_BLEND, false);
+			GLStateCache::DepthMask(true);
+		}
+	}
 
+	// leave the shader drawing rigid, opaque objects again
+	GLStateCache::SetUniform(m_uniforms.useMelt, (int)false);
+	GLStateCache::SetUniform(m_uniforms.opacity, 1.0f);
+	// the shaders of the other passes write no clip distances
+	for (int plane = 0; plane < 4; plane++)
+	{
+		GLStateCache::SetEnabled(GL_CLIP_DISTANCE0 + plane, false);
+	}
+}
 
+/***********************************************************
+ *  IsInFilter()
+ *
+ *  This method tells whether a packet is drawn by a
+ *  SubmitPackets() call with the filter. Without an active
+ *  reflection every opaque packet is matte.
+ ***********************************************************/
+bool SceneManager::IsInFilter(const DRAW_PACKET& packet, PACKET_FILTER filter) const
+{
+	bool bTransparent = (packet.opacity < 1.0f);
+	bool bReflective = (packet.reflectivity > 0.0f) && m_pReflection->IsActive();
+	switch (filter)
+	{
+	case PACKETS_OPAQUE:
+		return(packet.bVisible && !bTransparent);
+	case PACKETS_TRANSPARENT:
+		return(packet.bVisible && bTransparent);
+	case PACKETS_OPAQUE_MATTE:
+		return(packet.bVisible && !bTransparent && !bReflective);
+	case PACKETS_OPAQUE_REFLECTIVE:
+		return(packet.bVisible && !bTransparent && bReflective);
+	case PACKETS_REFLECTED_OPAQUE:
+		return(packet.bReflected && !bTransparent);
+	case PACKETS_REFLECTED_TRANSPARENT:
+		return(packet.bReflected && bTransparent);
+	}
+	return(false);
+}
 
-	glm::vec3 mainClockPosition = glm::vec3(-1, 2, 0);
+/***********************************************************
+ *  SubmitPackets()
+ *
+ *  This method draws the packets of a draw list picked by
+ *  the filter. Uniforms go through the locations looked up
+ *  at startup, the name based shader manager setters would
+ *  build strings per draw. With the vertex pulling shader,
+ *  runs of compact mesh draws that share their surface are
+ *  collected and drawn with one multi-draw call, whatever
+ *  their meshes, models and melt; the sort by state keeps
+ *  such draws next to each other.
+ ***********************************************************/
+void SceneManager::SubmitPackets(const DrawList& drawList, const int* pCommandIndices, PACKET_FILTER filter)
+{
+	int viewCount = m_frameState.viewCount;
+	bool bBatching = m_pMultiDraw->IsReady() && m_bUseCompactMeshes;
+	const DRAW_PACKET* pPrevious = NULL;
+	// surface of the open batch, NULL when there is none
+	const DRAW_PACKET* pBatchSurface = NULL;
+	for (size_t i = 0; i < drawList.Size(); i++)
+	{
+		const DRAW_PACKET& packet = drawList[i];
+		if (!IsInFilter(packet, filter))
+		{
+			continue;
+		}
 
-	glm::vec3 smallClockScale = glm::vec3(.2, .2, .1);
-	glm::vec3 smallClockPosition = glm::vec3(-1, 4, 0);
+		bool bMelt = (packet.meltParams.z > 0.0f);
+		if ((NULL == pPrevious) ||
+			(packet.mesh != pPrevious->mesh) ||
+			(packet.textureSlot != pPrevious->textureSlot) ||
+			(packet.textureSlot2 != pPrevious->textureSlot2) ||
+			(packet.proceduralTexture != pPrevious->proceduralTexture) ||
+			(packet.materialIndex != pPrevious->materialIndex) ||
+			(bMelt != (pPrevious->meltParams.z > 0.0f)))
+		{
+			m_frameStats.stateChanges++;
+		}
+		pPrevious = &packet;
 
+		bool bCulled = (NULL != pCommandIndices) && (pCommandIndices[i] >= 0);
+		bool bBatched = bBatching && !bCulled && m_pCompactMeshes->IsReady(packet.mesh);
+		if (bBatched && (NULL != pBatchSurface) && SharesSurface(packet, *pBatchSurface))
+		{
+			m_pMultiDraw->Add(packet);
+			continue;
+		}
+		// a new surface, draw what was collected with the old one
+		FlushMultiDraw(viewCount);
+		pBatchSurface = NULL;
+		SetSurfaceUniforms(packet);
+		if (bBatched)
+		{
+			m_pMultiDraw->Add(packet);
+			pBatchSurface = &packet;
+			continue;
+		}
 
-	glm::vec3 largelockPosition = glm::vec3(1, 3.5, 2);
-	glm::vec3 largeClockScale = glm::vec3(4, 2, 1); //oblong shape to match painting
+		m_frameStats.drawCalls++;
+		GLStateCache::SetUniform(m_uniforms.useMelt, (int)bMelt);
+		if (bMelt)
+		{
+			GLStateCache::SetUniform(m_uniforms.meltGroup, packet.meltGroup);
+			GLStateCache::SetUniform(m_uniforms.meltParams, packet.meltParams);
+		}
+		GLStateCache::SetUniform(m_uniforms.model, packet.model);
 
-	glm::vec3 distortedClockPosition = glm::vec3(-4, 2, -2);
-	glm::vec3 distortedClockScale = glm::vec3(1, 1, 2);
-	glm::vec3 distortedClockRotationDeg = glm::vec3(-50, 0, 90);
+		if (bCulled)
+		{
+			m_pClusterCuller->Draw(packet.mesh, pCommandIndices[i]);
+		}
+		else
+		{
+			DrawShapeMesh(packet.mesh, viewCount);
+		}
+	}
+	FlushMultiDraw(viewCount);
+}
 
-	DrawClock(mainClockPosition, glm::vec3(1, 1, 1), 0, 0, 0);
+/***********************************************************
+ *  SetSurfaceUniforms()
+ *
+ *  This method sets the uniforms of a packet's textures,
+ *  color and material.
+ ***********************************************************/
+void SceneManager::SetSurfaceUniforms(const DRAW_PACKET& packet)
+{
+	GLStateCache::SetUniform(m_uniforms.uvScale, packet.uvScale);
+	GLStateCache::SetUniform(m_uniforms.uvOffset, packet.uvOffset);
+
+	// solid color, one texture or the split clock face; the sorted
+	// draws share most of these, the cache drops the repeats
+	GLStateCache::SetUniform(m_uniforms.color, packet.color);
+	GLStateCache::SetUniform(m_uniforms.opacity, packet.opacity);
+	GLStateCache::SetUniform(m_uniforms.reflectivity, packet.reflectivity);
+	bool bProcedural = (packet.proceduralTexture >= 0);
+	GLStateCache::SetUniform(m_uniforms.useTexture, (int)((packet.textureSlot >= 0) || bProcedural));
+	GLStateCache::SetUniform(m_uniforms.useTwoTextures, (int)(packet.textureSlot2 >= 0));
+	if (packet.textureSlot >= 0)
+	{
+		GLStateCache::SetUniform(m_uniforms.texture, packet.textureSlot);
+	}
+	if (bProcedural)
+	{
+		const PROCEDURAL_TEXTURE& procedural = m_proceduralTextures[packet.proceduralTexture];
+		GLStateCache::SetUniform(m_uniforms.proceduralPattern, (int)procedural.pattern);
+		GLStateCache::SetUniform(m_uniforms.proceduralBaseColor, glm::vec4(procedural.baseColor, 1.0f));
+		GLStateCache::SetUniform(m_uniforms.proceduralDetailColor, glm::vec4(procedural.detailColor, 1.0f));
+		GLStateCache::SetUniform(m_uniforms.proceduralParams, glm::vec4(procedural.frequency, procedural.seed, 0.0f));
+	}
+	else
+	{
+		GLStateCache::SetUniform(m_uniforms.proceduralPattern, (int)PATTERN_NONE);
+	}
+	if (packet.textureSlot2 >= 0)
+	{
+		GLStateCache::SetUniform(m_uniforms.texture2, packet.textureSlot2);
+		GLStateCache::SetUniform(m_uniforms.distanceField2, (int)packet.bDistanceField2);
+		GLStateCache::SetUniform(m_uniforms.uvScale2, packet.uvScale2);
+		GLStateCache::SetUniform(m_uniforms.uvOffset2, packet.uvOffset2);
+	}
+
+	// the material values live in the table, a draw only picks an entry
+	GLStateCache::SetUniform(m_uniforms.materialIndex, packet.materialIndex);
+}
+
+/***********************************************************
+ *  SharesSurface()
+ *
+ *  This method tells whether two packets set the same
+ *  surface uniforms, so they can be drawn in one batch.
+ ***********************************************************/
+bool SceneManager::SharesSurface(const DRAW_PACKET& packet, const DRAW_PACKET& other)
+{
+	return((packet.textureSlot == other.textureSlot) &&
+		(packet.textureSlot2 == other.textureSlot2) &&
+		(packet.proceduralTexture == other.proceduralTexture) &&
+		(packet.bDistanceField2 == other.bDistanceField2) &&
+		(packet.materialIndex == other.materialIndex) &&
+		(packet.color == other.color) &&
+		(packet.opacity == other.opacity) &&
+		(packet.reflectivity == other.reflectivity) &&
+		(packet.uvScale == other.uvScale) &&
+		(packet.uvOffset == other.uvOffset) &&
+		(packet.uvScale2 == other.uvScale2) &&
+		(packet.uvOffset2 == other.uvOffset2));
+}
+
+/***********************************************************
+ *  FlushMultiDraw()
+ *
+ *  This method draws the open multi-draw batch, reading the
+ *  vertices and per-draw values from storage buffers only
+ *  for its one call.
+ ***********************************************************/
+void SceneManager::FlushMultiDraw(int viewCount)
+{
+	if (m_pMultiDraw->GetBatchSize() == 0)
+	{
+		return;
+	}
+	GLStateCache::SetUniform(m_uniforms.pullVertices, (int)true);
+	m_pMultiDraw->Flush(viewCount);
+	GLStateCache::SetUniform(m_uniforms.pullVertices, (int)false);
+	m_frameStats.drawCalls++;
+}
+
+/***********************************************************
+ *  RenderShadowPass()
+ *
+ *  This method draws every packet that casts into at least
+ *  one cascade into the shadow map, then hands the shadow
+ *  map to the scene shader.
+ ***********************************************************/
+void SceneManager::RenderShadowPass(const DrawList& drawList)
+{
+	if (!m_pShadowMaps->IsReady())
+	{
+		// the shadow sampler still needs its own unit, two sampler
+		// types on one unit make every draw fail
+		GLStateCache::SetUniform(m_uniforms.shadowMap, g_ShadowTextureUnit);
+		GLStateCache::SetUniform(m_uniforms.useShadows, (int)false);
+		return;
+	}
 
-	DrawClock(largelockPosition, largeClockScale, 0, -30, 0); //rotate -30 degrees to point slightly to main clock
+	m_pShadowMaps->BeginShadowPass();
+	for (size_t i = 0; i < drawList.Size(); i++)
+	{
+		const DRAW_PACKET& packet = drawList[i];
+		if (packet.cascadeMask != 0)
+		{
+			m_pShadowMaps->SetShadowDraw(packet);
+			DrawShapeMesh(packet.mesh);
+			m_frameStats.drawCalls++;
+		}
+	}
+	m_pShadowMaps->EndShadowPass();
 
-	DrawClock(distortedClockPosition, distortedClockScale,
-		distortedClockRotationDeg.x, distortedClockRotationDeg.y, distortedClockRotationDeg.z);
-	DrawClock(smallClockPosition, smallClockScale, 0, 0, 0);
+	m_pShadowMaps->BindForScene(m_sceneProgram, g_ShadowTextureUnit);
+}
 
+/***********************************************************
+ *  RenderReflectionPass()
+ *
+ *  This method draws the packets the mirrored camera sees
+ *  into the reflection target and hands the reflection to
+ *  the scene shader. The mirrored camera goes in as the one
+ *  view of a split frame whose rectangle is the whole
+ *  target. The transparent packets blend in draw order,
+ *  the reflection is too small and blurred for the
+ *  weighted pass to pay off.
+ ***********************************************************/
+void SceneManager::RenderReflectionPass(const DrawList& drawList)
+{
+	// nothing samples the target while it is drawn into, and it
+	// keeps the linear color whatever the back buffer needs
+	GLStateCache::SetUniform(m_uniforms.useReflection, (int)false);
+	GLStateCache::SetUniform(m_uniforms.directExposure, 0.0f);
+	if (!m_pReflection->IsActive())
+	{
+		return;
+	}
 
+	m_pReflection->BeginReflection();
+
+	glm::vec4 rectangle = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+	GLStateCache::SetUniform(m_uniforms.viewCount, 1);
+	glUniformMatrix4fv(m_uniforms.viewProjections, 1, GL_FALSE, glm::value_ptr(m_pReflection->GetViewProjection()));
+	glUniform4fv(m_uniforms.viewRectangles, 1, glm::value_ptr(rectangle));
+	glUniform3fv(m_uniforms.viewPositions, 1, glm::value_ptr(m_pReflection->GetViewPosition()));
+
+	GLStateCache::SetEnabled(GL_BLEND, false);
+	SubmitPackets(drawList, NULL, PACKETS_REFLECTED_OPAQUE);
+	GLStateCache::DepthMask(false);
+	GLStateCache::SetEnabled(GL_BLEND, true);
+	GLStateCache::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	SubmitPackets(drawList, NULL, PACKETS_REFLECTED_TRANSPARENT);
+	GLStateCache::SetEnabled(GL_BLEND, false);
+	GLStateCache::DepthMask(true);
+
+	m_pReflection->EndReflection(g_ReflectionTextureUnit);
+	GLStateCache::SetUniform(m_uniforms.reflectionTexture, g_ReflectionTextureUnit);
+	GLStateCache::SetUniform(m_uniforms.reflectionUVScale, m_pReflection->GetUVScale());
+	GLStateCache::SetUniform(m_uniforms.reflectionMaxUV, m_pReflection->GetMaxUV());
+	GLStateCache::SetUniform(m_uniforms.reflectionMaxLod, m_pReflection->GetMaxLod());
+	GLStateCache::SetUniform(m_uniforms.useReflection, (int)true);
+}
 
+/***********************************************************
+ *  RenderScene()
+ *
+ *  This method is used for rendering the 3D scene. The
+ *  scene is first recorded into a sorted draw list on the
+ *  worker threads and then submitted on this thread, the
+ *  shadow casters first, then the objects seen in the floor
+ *  reflection and then the visible objects.
+ ***********************************************************/
+void SceneManager::RenderScene()
+{
+	m_frameStats.drawCalls = 0;
+	m_frameStats.stateChanges = 0;
 
+	RecordScene();
+	UpdateTextureResidency(m_drawList);
+	// send the materials edited since the last frame, if any
+	m_pMaterialTable->Upload();
 
-}
\ No newline at end of file
+	if (NULL != m_pProfiler)
+	{
+		m_pProfiler->BeginScope(m_shadowScope);
+	}
+	RenderShadowPass(m_drawList);
+	if (NULL != m_pProfiler)
+	{
+		m_pProfiler->EndScope(m_shadowScope);
+		m_pProfiler->BeginScope(m_reflectionScope);
+	}
+	RenderReflectionPass(m_drawList);
+	if (NULL != m_pProfiler)
+	{
+		m_pProfiler->EndScope(m_reflectionScope);
+		m_pProfiler->BeginScope(m_sceneScope);
+	}
+	SubmitDrawList(m_drawList);
+	if (NULL != m_pProfiler)
+	{
+		m_pProfiler->EndScope(m_sceneScope);
+	}
+}
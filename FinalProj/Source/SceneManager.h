@@ -11,6 +11,23 @@
 
 #include "ShaderManager.h"
 #include "ShapeMeshes.h"
+#include "DrawList.h"
+#include "FrameArena.h"
+#include "JobSystem.h"
+#include "FrameState.h"
+#include "FrameProfiler.h"
+#include "ShadowMaps.h"
+#include "TextureStreamer.h"
+#include "TextureAtlas.h"
+#include "CompactMeshes.h"
+#include "ClusterCuller.h"
+#include "MultiDraw.h"
+#include "MaterialTable.h"
+#include "WeightedTransparency.h"
+#include "DeferredShading.h"
+#include "PlanarReflection.h"
+#include "AmbientOcclusion.h"
+#include "ProceduralTexture.h"
 
 #include <string>
 #include <vector>
@@ -29,14 +46,23 @@ public:
 	// destructor
 	~SceneManager();
 
-	// properties for loaded texture access
+	// properties for loaded texture access, the OpenGL name lives
+	// in the texture streamer since it changes with the residency.
+	// Atlas textures share the slot of their page and reach their
+	// image through the UV scale and offset. Procedural textures
+	// have no slot, the scene shader evaluates them.
 	struct TEXTURE_INFO
 	{
 		std::string tag;
-		uint32_t ID;
+		int slot;
+		int atlasEntry;  // -1 for a texture with its own slot
+		int procedural;  // entry of the procedural textures, -1 for an image
+		bool bDistanceField;  // distances to a dial's ink instead of color
+		glm::vec2 uvScale;
+		glm::vec2 uvOffset;
 	};
 
-	// properties for object materials
+	// properties for object materials, copied into the material table
 	struct OBJECT_MATERIAL
 	{
 		float ambientStrength;
@@ -47,54 +73,214 @@ public:
 		std::string tag;
 	};
 
+	// placement of one clock in the scene
+	struct SCENE_CLOCK
+	{
+		glm::vec3 position;
+		glm::vec3 scale;
+		glm::vec3 rotationDegrees;
+		glm::vec4 meltParams;  // (edge height, edge radius, drape amount, side sag)
+		float opacity;         // below 1 for a see-through glass clock
+	};
+
+	// textures and materials of the recorded objects, looked up
+	// by tag once so the per-frame recording never compares strings
+	struct SCENE_SLOTS
+	{
+		int glassMaterial;
+		int goldTexture;
+		int clockFaceTopTexture;
+		int clockFaceBottomTexture;
+		int handsTexture;
+		int floorTexture;
+		int wallTexture;
+	};
+
+	// scene shader uniform locations used by the draw submission
+	struct SCENE_UNIFORMS
+	{
+		GLint model;
+		GLint uvScale;
+		GLint uvOffset;
+		GLint uvScale2;
+		GLint uvOffset2;
+		GLint color;
+		GLint useTexture;
+		GLint useTwoTextures;
+		GLint texture;
+		GLint texture2;
+		GLint useMelt;
+		GLint meltGroup;
+		GLint meltParams;
+		GLint materialIndex;
+		GLint shadowMap;
+		GLint useShadows;
+		GLint viewCount;
+		GLint firstView;
+		GLint viewProjections;
+		GLint viewRectangles;
+		GLint viewPositions;
+		GLint opacity;
+		GLint weightedTransparency;
+		GLint deferredGeometry;
+		GLint useReflection;
+		GLint reflectivity;
+		GLint reflectionTexture;
+		GLint reflectionUVScale;
+		GLint reflectionMaxUV;
+		GLint reflectionMaxLod;
+		GLint proceduralPattern;
+		GLint proceduralBaseColor;
+		GLint proceduralDetailColor;
+		GLint proceduralParams;
+		GLint distanceField2;
+		GLint directExposure;
+		GLint directGamma;
+		// -1 unless the program was built from vertexPulling.glsl
+		GLint pullVertices;
+	};
+
+	// work done by the last RenderScene(), state changes count the
+	// draws whose mesh, textures, material or melt differ from the
+	// draw before them
+	struct SCENE_STATS
+	{
+		int drawCalls;
+		int stateChanges;
+	};
+
 private:
 	// pointer to shader manager object
 	ShaderManager* m_pShaderManager;
 	// pointer to basic shapes object
 	ShapeMeshes *m_basicMeshes;
+	// quantized copies of the basic meshes, used unless turned off
+	CompactMeshes* m_pCompactMeshes;
+	bool m_bUseCompactMeshes;
+	// GPU culling of the meshlets of the finely tessellated meshes
+	ClusterCuller* m_pClusterCuller;
+	// runs of compact draws that share a surface, drawn in one call
+	MultiDraw* m_pMultiDraw;
 	// total number of loaded textures
 	int m_loadedTextures;
 	// loaded textures info
 	TEXTURE_INFO m_textureIDs[16];
-	// defined object materials
-	std::vector<OBJECT_MATERIAL> m_objectMaterials;
+	// mip residency of the loaded textures within the memory budget
+	TextureStreamer* m_pTextureStreamer;
+	// small textures waiting to be packed into shared pages
+	TextureAtlas* m_pTextureAtlas;
+	// patterns drawn in place of image files
+	std::vector<PROCEDURAL_TEXTURE> m_proceduralTextures;
+	// defined object materials, kept on the GPU and indexed per draw
+	MaterialTable* m_pMaterialTable;
+	// clocks placed in the scene
+	std::vector<SCENE_CLOCK> m_sceneClocks;
+	SCENE_SLOTS m_slots;
+	// program of the scene shader and its uniforms
+	GLuint m_sceneProgram;
+	SCENE_UNIFORMS m_uniforms;
+	// exposure of the scene drawn straight into the back buffer
+	float m_directExposure;
+	bool m_bDirectGamma;
+
+	// worker threads for recording the scene
+	JobSystem* m_pJobSystem;
+	// memory of the draw lists, reset at the start of every frame
+	FrameArena* m_pFrameArena;
+	// per-worker packet lists and the merged list for the frame
+	std::vector<DrawList> m_workerDrawLists;
+	DrawList m_drawList;
+	// camera state and the frustum of each of its views, used for culling
+	FRAME_STATE m_frameState;
+	FRUSTUM m_viewFrustums[MAX_FRAME_VIEWS];
+
+	// cascaded shadows of the key light
+	ShadowMaps* m_pShadowMaps;
+	// the scene mirrored in the floor
+	PlanarReflection* m_pReflection;
+	// order independent pass of the transparent draws, owned by the caller
+	WeightedTransparency* m_pTransparency;
+	// deferred lighting of the opaque draws, owned by the caller
+	DeferredShading* m_pDeferredShading;
+	// darkening of the opaque draws' creases, owned by the caller
+	AmbientOcclusion* m_pAmbientOcclusion;
+	// lights of the scene shader, kept for the deferred lighting
+	LIGHT_SOURCE m_lightSources[DeferredShading::MAX_LIGHTS];
+	// timing of the render passes, owned by the caller
+	FrameProfiler* m_pProfiler;
+	int m_shadowScope;
+	int m_reflectionScope;
+	int m_sceneScope;
+	SCENE_STATS m_frameStats;
 
 
 	// methods for managing OpenGL textures
 	bool CreateGLTexture(const char* filename, std::string tag);
+	bool CreateAtlasTexture(const char* filename, std::string tag);
+	bool CreateProceduralTexture(const PROCEDURAL_TEXTURE& texture, std::string tag);
+	bool CreateDistanceFieldTexture(const char* filename, std::string tag);
+	void BuildTextureAtlases();
 	void BindGLTextures();
 	void DestroyGLTextures();
-	int FindTextureID(std::string tag);
-	int FindTextureSlot(std::string tag);
+	void UpdateTextureResidency(const DrawList& drawList);
+	int FindTextureIndex(const char* tag);
+	// point a packet at loaded textures, -1 for none
+	void SetPacketTextures(DRAW_PACKET& packet, int textureIndex, int textureIndex2);
 
-	// set the transformation values 
-	// into the transform buffer
-	void SetTransformations(
+	// calculate a model matrix from the transformation values
+	glm::mat4 BuildModelMatrix(
 		glm::vec3 scaleXYZ,
 		float XrotationDegrees,
 		float YrotationDegrees,
 		float ZrotationDegrees,
 		glm::vec3 positionXYZ);
 
-	// set the color values into the shader
-	void SetShaderColor(
-		float redColorValue,
-		float greenColorValue,
-		float blueColorValue,
-		float alphaValue);
-	void SetShaderTexture(std::string textureTag);
-	void SetShaderTwoTextures(
-		std::string textureTag1,
-		std::string textureTag2);
-	void SetShaderMaterial(
-		std::string materialTag);
 	void DefineObjectMaterials();
-	bool FindMaterial(std::string tag, OBJECT_MATERIAL& material);
+	void AddObjectMaterial(const OBJECT_MATERIAL& material);
+	void ResolveSceneSlots();
+	void ResolveSceneUniforms();
+	int FindMaterialIndex(const char* tag);
 	void SetupSceneLights();
+	void SetLightSource(int index, const LIGHT_SOURCE& light);
 
 
 	 //custom funciton to generate complex shape at desired point
-	void DrawClock(glm::vec3 groupPos, glm::vec3 groupScale, float groupRotX, float groupRotY, float groupRotZ);
+	void RecordClock(const SCENE_CLOCK& clock, DrawList& drawList);
+
+	// scene traversal on the worker threads and submission on the GL thread
+	void DefineSceneObjects();
+	void RecordScene();
+	// packets drawn by a SubmitPackets() call
+	enum PACKET_FILTER
+	{
+		PACKETS_OPAQUE,
+		PACKETS_TRANSPARENT,
+		// the opaque packets split by whether they show the reflection,
+		// the deferred path only lights the matte ones
+		PACKETS_OPAQUE_MATTE,
+		PACKETS_OPAQUE_REFLECTIVE,
+		// packets seen by the mirrored camera
+		PACKETS_REFLECTED_OPAQUE,
+		PACKETS_REFLECTED_TRANSPARENT
+	};
+	bool IsInFilter(const DRAW_PACKET& packet, PACKET_FILTER filter) const;
+	void SubmitDrawList(const DrawList& drawList);
+	// pCommandIndices may be NULL when no packet was cluster culled
+	void SubmitPackets(const DrawList& drawList, const int* pCommandIndices, PACKET_FILTER filter);
+	// the uniforms a multi-draw batch shares, everything but the
+	// model matrix and melt values
+	void SetSurfaceUniforms(const DRAW_PACKET& packet);
+	static bool SharesSurface(const DRAW_PACKET& packet, const DRAW_PACKET& other);
+	void FlushMultiDraw(int viewCount);
+	void RenderShadowPass(const DrawList& drawList);
+	void RenderReflectionPass(const DrawList& drawList);
+	// draw a mesh once for each of the first viewCount views
+	void DrawShapeMesh(SHAPE_MESH mesh, int viewCount = 1);
+	// a bounding sphere is seen by at least one view of the frame
+	bool IsInAnyView(const glm::vec3& center, float radius) const;
+	void SetViewUniforms();
+	void DrawBasicMesh(SHAPE_MESH mesh);
+	void CaptureCompactMeshes();
 
 public:
 
@@ -102,6 +288,32 @@ public:
 	/*** customize for their own 3D scene              ***/
 	void PrepareScene();
 	void RenderScene();
+	// camera state for culling and shadows in the next RenderScene()
+	void SetFrameState(const FRAME_STATE& frameState);
+	// profiler that receives the shadow and scene pass timings
+	void SetProfiler(FrameProfiler* pProfiler);
+	// pass the transparent draws go through, NULL blends them in order
+	void SetTransparency(WeightedTransparency* pTransparency);
+	// pass that lights the opaque draws, NULL lights them as they are drawn
+	void SetDeferredShading(DeferredShading* pDeferredShading);
+	// pass that darkens the lit opaque draws, NULL for none
+	void SetAmbientOcclusion(AmbientOcclusion* pAmbientOcclusion);
+	// draws and state changes of the last rendered frame
+	const SCENE_STATS& GetFrameStats() const { return(m_frameStats); }
+	// change a defined material, found by its tag, while the scene runs
+	bool UpdateMaterial(const OBJECT_MATERIAL& material);
+	// draw with the quantized meshes or the original float ones
+	void SetCompactMeshes(bool bCompact);
+	// expose the lit color in the scene shader when there is no HDR
+	// target to tone map it, 0 turns it off; the gamma is encoded too
+	// unless the back buffer does it
+	void SetDirectOutput(float exposure, bool bEncodeGamma);
+	// resolution of the floor reflection, and the GPU time its pass may
+	// take before the resolution steps down (0 for a fixed resolution)
+	void SetReflectionQuality(PlanarReflection::REFLECTION_QUALITY quality);
+	void SetReflectionBudget(double budgetMs);
+	// video memory the streamed scene textures may use
+	void SetTextureBudget(size_t budgetBytes);
 	// loads textures from image files
 	void LoadSceneTextures();
-};
\ No newline at end of file
+};
\ No newline at end of file
@@ -0,0 +1,173 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadermanager.cpp
+// ============
+// loading of the scene shader program and setting its uniforms by name, with
+// the same interface as the course utilities' ShaderManager
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ShaderManager.h"
+#include "GLProgram.h"
+#include "GLStateCache.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+/***********************************************************
+ *  ShaderManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ShaderManager::ShaderManager()
+{
+	m_programID = 0;
+}
+
+/***********************************************************
+ *  ~ShaderManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ShaderManager::~ShaderManager()
+{
+	if (m_programID != 0)
+	{
+		glDeleteProgram(m_programID);
+		m_programID = 0;
+	}
+}
+
+/***********************************************************
+ *  LoadShaders()
+ *
+ *  This method builds the program from a vertex and a
+ *  fragment shader file, replacing the previous program
+ *  only when the new one links.
+ ***********************************************************/
+GLuint ShaderManager::LoadShaders(const char* vertexShaderPath, const char* fragmentShaderPath)
+{
+	GLuint program = LoadGLProgram(vertexShaderPath, fragmentShaderPath);
+	if (program == 0)
+	{
+		return(0);
+	}
+	glDeleteProgram(m_programID);
+	m_programID = program;
+	return(m_programID);
+}
+
+/***********************************************************
+ *  use()
+ *
+ *  This method makes the program the current one.
+ ***********************************************************/
+void ShaderManager::use()
+{
+	GLStateCache::UseProgram(m_programID);
+}
+
+/***********************************************************
+ *  setBoolValue()
+ *
+ *  This method sets a bool uniform of the program.
+ ***********************************************************/
+void ShaderManager::setBoolValue(const std::string& name, bool value) const
+{
+	glUniform1i(glGetUniformLocation(m_programID, name.c_str()), (int)value);
+}
+
+/***********************************************************
+ *  setIntValue()
+ *
+ *  This method sets an int uniform of the program.
+ ***********************************************************/
+void ShaderManager::setIntValue(const std::string& name, int value) const
+{
+	glUniform1i(glGetUniformLocation(m_programID, name.c_str()), value);
+}
+
+/***********************************************************
+ *  setFloatValue()
+ *
+ *  This method sets a float uniform of the program.
+ ***********************************************************/
+void ShaderManager::setFloatValue(const std::string& name, float value) const
+{
+	glUniform1f(glGetUniformLocation(m_programID, name.c_str()), value);
+}
+
+/***********************************************************
+ *  setSampler2DValue()
+ *
+ *  This method sets the texture unit of a sampler uniform.
+ ***********************************************************/
+void ShaderManager::setSampler2DValue(const std::string& name, int value) const
+{
+	glUniform1i(glGetUniformLocation(m_programID, name.c_str()), value);
+}
+
+/***********************************************************
+ *  setVec2Value()
+ *
+ *  These methods set a vec2 uniform of the program.
+ ***********************************************************/
+void ShaderManager::setVec2Value(const std::string& name, const glm::vec2& value) const
+{
+	glUniform2fv(glGetUniformLocation(m_programID, name.c_str()), 1, glm::value_ptr(value));
+}
+
+void ShaderManager::setVec2Value(const std::string& name, float x, float y) const
+{
+	glUniform2f(glGetUniformLocation(m_programID, name.c_str()), x, y);
+}
+
+/***********************************************************
+ *  setVec3Value()
+ *
+ *  These methods set a vec3 uniform of the program.
+ ***********************************************************/
+void ShaderManager::setVec3Value(const std::string& name, const glm::vec3& value) const
+{
+	glUniform3fv(glGetUniformLocation(m_programID, name.c_str()), 1, glm::value_ptr(value));
+}
+
+void ShaderManager::setVec3Value(const std::string& name, float x, float y, float z) const
+{
+	glUniform3f(glGetUniformLocation(m_programID, name.c_str()), x, y, z);
+}
+
+/***********************************************************
+ *  setVec4Value()
+ *
+ *  These methods set a vec4 uniform of the program.
+ ***********************************************************/
+void ShaderManager::setVec4Value(const std::string& name, const glm::vec4& value) const
+{
+	glUniform4fv(glGetUniformLocation(m_programID, name.c_str()), 1, glm::value_ptr(value));
+}
+
+void ShaderManager::setVec4Value(const std::string& name, float x, float y, float z, float w) const
+{
+	glUniform4f(glGetUniformLocation(m_programID, name.c_str()), x, y, z, w);
+}
+
+/***********************************************************
+ *  setMat3Value()
+ *
+ *  This method sets a mat3 uniform of the program.
+ ***********************************************************/
+void ShaderManager::setMat3Value(const std::string& name, const glm::mat3& value) const
+{
+	glUniformMatrix3fv(glGetUniformLocation(m_programID, name.c_str()), 1, GL_FALSE, glm::value_ptr(value));
+}
+
+/***********************************************************
+ *  setMat4Value()
+ *
+ *  This method sets a mat4 uniform of the program.
+ ***********************************************************/
+void ShaderManager::setMat4Value(const std::string& name, const glm::mat4& value) const
+{
+	glUniformMatrix4fv(glGetUniformLocation(m_programID, name.c_str()), 1, GL_FALSE, glm::value_ptr(value));
+}
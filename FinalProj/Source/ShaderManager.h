@@ -0,0 +1,56 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadermanager.h
+// ============
+// loading of the scene shader program and setting its uniforms by name, with
+// the same interface as the course utilities' ShaderManager
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <string>
+
+/***********************************************************
+ *  ShaderManager
+ *
+ *  This class owns the scene shader program. The program is
+ *  built by GLProgram, and the setters look the uniform up
+ *  by name on every call, so they are only meant for values
+ *  that are set once; the per-draw uniforms go through the
+ *  locations the scene looks up at startup.
+ ***********************************************************/
+class ShaderManager
+{
+public:
+	// the program ID
+	unsigned int m_programID;
+
+	// constructor
+	ShaderManager();
+	// destructor
+	~ShaderManager();
+
+	// build the program from the two GLSL files, returns 0 on failure
+	GLuint LoadShaders(const char* vertexShaderPath, const char* fragmentShaderPath);
+	// make the program the current one
+	void use();
+
+	// uniform setters of the program, it must be the current one
+	void setBoolValue(const std::string& name, bool value) const;
+	void setIntValue(const std::string& name, int value) const;
+	void setFloatValue(const std::string& name, float value) const;
+	void setSampler2DValue(const std::string& name, int value) const;
+	void setVec2Value(const std::string& name, const glm::vec2& value) const;
+	void setVec2Value(const std::string& name, float x, float y) const;
+	void setVec3Value(const std::string& name, const glm::vec3& value) const;
+	void setVec3Value(const std::string& name, float x, float y, float z) const;
+	void setVec4Value(const std::string& name, const glm::vec4& value) const;
+	void setVec4Value(const std::string& name, float x, float y, float z, float w) const;
+	void setMat3Value(const std::string& name, const glm::mat3& value) const;
+	void setMat4Value(const std::string& name, const glm::mat4& value) const;
+};
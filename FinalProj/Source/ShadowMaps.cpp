@@ -0,0 +1,336 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadowmaps.cpp
+// ============
+// cascaded shadow maps for the directional key light
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ShadowMaps.h"
+#include "GLProgram.h"
+#include "GLStateCache.h"
+
+#include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+	// blend between uniform (0) and logarithmic (1) cascade splits
+	const float SPLIT_LAMBDA = 0.75f;
+	// extra depth behind the light's near plane for casters outside the view
+	const float CASTER_MARGIN = 20.0f;
+}
+
+/***********************************************************
+ *  ShadowMaps()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ShadowMaps::ShadowMaps()
+{
+	m_resolution = 0;
+	m_cascadeCount = 0;
+	m_shadowDistance = 0.0f;
+	m_depthTexture = 0;
+	m_framebuffer = 0;
+	m_program = 0;
+	m_lightSpaceLocation = -1;
+	m_cascadeCountLocation = -1;
+	m_cascadeMaskLocation = -1;
+	m_modelLocation = -1;
+	m_useMeltLocation = -1;
+	m_meltGroupLocation = -1;
+	m_meltParamsLocation = -1;
+	m_sceneProgram = 0;
+	m_sceneShadowMapLocation = -1;
+	m_sceneCascadeCountLocation = -1;
+	m_sceneLightSpaceLocation = -1;
+	m_sceneCascadeSplitsLocation = -1;
+	m_sceneUseShadowsLocation = -1;
+	m_previousProgram = 0;
+	m_previousFramebuffer = 0;
+	for (int i = 0; i < MAX_CASCADES; i++)
+	{
+		m_lightSpaceMatrices[i] = glm::mat4(1.0f);
+		m_cascadeSplits[i] = 0.0f;
+		m_cascadeRadii[i] = 1.0f;
+		m_cascadeDepthRanges[i] = 1.0f;
+	}
+}
+
+/***********************************************************
+ *  ~ShadowMaps()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ShadowMaps::~ShadowMaps()
+{
+	glDeleteFramebuffers(1, &m_framebuffer);
+	glDeleteTextures(1, &m_depthTexture);
+	glDeleteProgram(m_program);
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method creates the depth texture array with one
+ *  layer per cascade, the layered framebuffer and the
+ *  shadow depth program.
+ ***********************************************************/
+bool ShadowMaps::Initialize(int resolution, int cascadeCount, float shadowDistance)
+{
+	m_resolution = resolution;
+	m_cascadeCount = glm::clamp(cascadeCount, 1, (int)MAX_CASCADES);
+	m_shadowDistance = shadowDistance;
+
+	glGenTextures(1, &m_depthTexture);
+	GLStateCache::BindTexture(0, GL_TEXTURE_2D_ARRAY, m_depthTexture);
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT32F,
+		m_resolution, m_resolution, m_cascadeCount, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+	float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+	glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, borderColor);
+	// hardware depth comparison gives bilinear filtered shadow lookups
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+	GLStateCache::BindTexture(0, GL_TEXTURE_2D_ARRAY, 0);
+
+	glGenFramebuffers(1, &m_framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	// attaching the whole array makes the framebuffer layered
+	glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_depthTexture, 0);
+	glDrawBuffer(GL_NONE);
+	glReadBuffer(GL_NONE);
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "ERROR: shadow map framebuffer is incomplete" << std::endl;
+		return(false);
+	}
+
+	m_program = LoadGLProgram("shadowVertex.glsl", "shadowFragment.glsl", "shadowGeometry.glsl");
+	if (m_program == 0)
+	{
+		return(false);
+	}
+	m_lightSpaceLocation = glGetUniformLocation(m_program, "lightSpaceMatrices");
+	m_cascadeCountLocation = glGetUniformLocation(m_program, "cascadeCount");
+	m_cascadeMaskLocation = glGetUniformLocation(m_program, "cascadeMask");
+	m_modelLocation = glGetUniformLocation(m_program, "model");
+	m_useMeltLocation = glGetUniformLocation(m_program, "bUseMelt");
+	m_meltGroupLocation = glGetUniformLocation(m_program, "meltGroup");
+	m_meltParamsLocation = glGetUniformLocation(m_program, "meltParams");
+
+	return(true);
+}
+
+/***********************************************************
+ *  UpdateCascades()
+ *
+ *  This method splits the camera frustum into depth slices
+ *  and fits an orthographic light projection around each
+ *  slice's bounding sphere. Using a sphere and snapping the
+ *  projection to whole texels keeps the shadow edges from
+ *  shimmering while the camera moves.
+ ***********************************************************/
+void ShadowMaps::UpdateCascades(const FRAME_STATE& frameState, glm::vec3 lightDirection)
+{
+	// corners of the full camera frustum in world space
+	glm::mat4 inverseViewProjection = glm::inverse(frameState.viewProjection);
+	glm::vec3 nearCorners[4];
+	glm::vec3 farCorners[4];
+	for (int i = 0; i < 4; i++)
+	{
+		float x = (i & 1) ? 1.0f : -1.0f;
+		float y = (i & 2) ? 1.0f : -1.0f;
+		glm::vec4 nearCorner = inverseViewProjection * glm::vec4(x, y, -1.0f, 1.0f);
+		glm::vec4 farCorner = inverseViewProjection * glm::vec4(x, y, 1.0f, 1.0f);
+		nearCorners[i] = glm::vec3(nearCorner) / nearCorner.w;
+		farCorners[i] = glm::vec3(farCorner) / farCorner.w;
+	}
+
+	float nearPlane = frameState.nearPlane;
+	float farPlane = glm::min(frameState.farPlane, m_shadowDistance);
+	float depthRange = frameState.farPlane - frameState.nearPlane;
+
+	glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f);
+	if (std::fabs(glm::dot(up, lightDirection)) > 0.99f)
+	{
+		up = glm::vec3(0.0f, 0.0f, 1.0f);
+	}
+
+	float sliceStart = nearPlane;
+	for (int cascade = 0; cascade < m_cascadeCount; cascade++)
+	{
+		float fraction = (float)(cascade + 1) / (float)m_cascadeCount;
+		float logSplit = nearPlane * std::pow(farPlane / nearPlane, fraction);
+		float uniformSplit = nearPlane + (farPlane - nearPlane) * fraction;
+		float sliceEnd = glm::mix(uniformSplit, logSplit, SPLIT_LAMBDA);
+
+		// view depth is linear along each corner ray, so the slice
+		// corners are a plain interpolation between near and far
+		float startFraction = (sliceStart - frameState.nearPlane) / depthRange;
+		float endFraction = (sliceEnd - frameState.nearPlane) / depthRange;
+		glm::vec3 corners[8];
+		glm::vec3 center = glm::vec3(0.0f);
+		for (int i = 0; i < 4; i++)
+		{
+			corners[i] = glm::mix(nearCorners[i], farCorners[i], startFraction);
+			corners[i + 4] = glm::mix(nearCorners[i], farCorners[i], endFraction);
+			center += corners[i] + corners[i + 4];
+		}
+		center = center / 8.0f;
+
+		float radius = 0.0f;
+		for (int i = 0; i < 8; i++)
+		{
+			radius = glm::max(radius, glm::length(corners[i] - center));
+		}
+		// quantize the radius so the projection size does not change every frame
+		radius = std::ceil(radius * 16.0f) / 16.0f;
+
+		float projectionDepth = 2.0f * radius + CASTER_MARGIN;
+		glm::mat4 lightView = glm::lookAt(center - lightDirection * (radius + CASTER_MARGIN), center, up);
+		glm::mat4 lightProjection = glm::ortho(-radius, radius, -radius, radius, 0.0f, projectionDepth);
+
+		// snap the projection to whole shadow map texels
+		glm::mat4 lightSpace = lightProjection * lightView;
+		glm::vec4 origin = lightSpace * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+		float texelScale = m_resolution * 0.5f;
+		float offsetX = std::round(origin.x * texelScale) / texelScale - origin.x;
+		float offsetY = std::round(origin.y * texelScale) / texelScale - origin.y;
+		lightProjection[3][0] += offsetX;
+		lightProjection[3][1] += offsetY;
+
+		m_lightSpaceMatrices[cascade] = lightProjection * lightView;
+		m_cascadeSplits[cascade] = sliceEnd;
+		m_cascadeRadii[cascade] = radius;
+		m_cascadeDepthRanges[cascade] = projectionDepth;
+
+		sliceStart = sliceEnd;
+	}
+}
+
+/***********************************************************
+ *  GetCascadeMask()
+ *
+ *  This method returns a bit per cascade whose light volume
+ *  the sphere overlaps. Casters between the light and the
+ *  cascade still count, the depth clamp in the shadow pass
+ *  keeps them from being clipped.
+ ***********************************************************/
+unsigned int ShadowMaps::GetCascadeMask(glm::vec3 center, float radius) const
+{
+	unsigned int mask = 0;
+	for (int cascade = 0; cascade < m_cascadeCount; cascade++)
+	{
+		glm::vec4 lightPosition = m_lightSpaceMatrices[cascade] * glm::vec4(center, 1.0f);
+		float extent = 1.0f + radius / m_cascadeRadii[cascade];
+		float depthExtent = 2.0f * radius / m_cascadeDepthRanges[cascade];
+		if ((std::fabs(lightPosition.x) <= extent) &&
+			(std::fabs(lightPosition.y) <= extent) &&
+			(lightPosition.z - depthExtent <= 1.0f))
+		{
+			mask |= (1u << cascade);
+		}
+	}
+	return(mask);
+}
+
+/***********************************************************
+ *  BeginShadowPass()
+ *
+ *  This method binds the layered target and the shadow
+ *  program and clears all cascades at once.
+ ***********************************************************/
+void ShadowMaps::BeginShadowPass()
+{
+	m_previousProgram = GLStateCache::GetProgram();
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &m_previousFramebuffer);
+	glGetIntegerv(GL_VIEWPORT, m_previousViewport);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glViewport(0, 0, m_resolution, m_resolution);
+	GLStateCache::SetEnabled(GL_DEPTH_TEST, true);
+	glClear(GL_DEPTH_BUFFER_BIT);
+
+	// casters in front of a cascade's near plane are flattened onto it
+	GLStateCache::SetEnabled(GL_DEPTH_CLAMP, true);
+	// slope scaled bias against shadow acne
+	GLStateCache::SetEnabled(GL_POLYGON_OFFSET_FILL, true);
+	glPolygonOffset(2.0f, 4.0f);
+
+	GLStateCache::UseProgram(m_program);
+	glUniformMatrix4fv(m_lightSpaceLocation, m_cascadeCount, GL_FALSE, glm::value_ptr(m_lightSpaceMatrices[0]));
+	GLStateCache::SetUniform(m_cascadeCountLocation, m_cascadeCount);
+}
+
+/***********************************************************
+ *  SetShadowDraw()
+ *
+ *  This method passes one packet's transform and cascade
+ *  mask into the shadow program before its mesh is drawn.
+ ***********************************************************/
+void ShadowMaps::SetShadowDraw(const DRAW_PACKET& packet)
+{
+	bool bMelt = (packet.meltParams.z > 0.0f);
+	GLStateCache::SetUniform(m_useMeltLocation, (int)bMelt);
+	if (bMelt)
+	{
+		GLStateCache::SetUniform(m_meltGroupLocation, packet.meltGroup);
+		GLStateCache::SetUniform(m_meltParamsLocation, packet.meltParams);
+	}
+	GLStateCache::SetUniform(m_modelLocation, packet.model);
+	GLStateCache::SetUniform(m_cascadeMaskLocation, (int)packet.cascadeMask);
+}
+
+/***********************************************************
+ *  EndShadowPass()
+ *
+ *  This method restores the state that the scene pass
+ *  expects.
+ ***********************************************************/
+void ShadowMaps::EndShadowPass()
+{
+	GLStateCache::SetEnabled(GL_POLYGON_OFFSET_FILL, false);
+	GLStateCache::SetEnabled(GL_DEPTH_CLAMP, false);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_previousFramebuffer);
+	glViewport(m_previousViewport[0], m_previousViewport[1], m_previousViewport[2], m_previousViewport[3]);
+	GLStateCache::UseProgram(m_previousProgram);
+}
+
+/***********************************************************
+ *  BindForScene()
+ *
+ *  This method binds the shadow map to the passed in unit
+ *  and sets the cascade uniforms of the scene shader. The
+ *  arrays are set in one call each from their first element.
+ ***********************************************************/
+void ShadowMaps::BindForScene(GLuint sceneProgram, int textureUnit)
+{
+	if (sceneProgram != m_sceneProgram)
+	{
+		m_sceneProgram = sceneProgram;
+		m_sceneShadowMapLocation = glGetUniformLocation(sceneProgram, "shadowMap");
+		m_sceneCascadeCountLocation = glGetUniformLocation(sceneProgram, "cascadeCount");
+		m_sceneLightSpaceLocation = glGetUniformLocation(sceneProgram, "lightSpaceMatrices");
+		m_sceneCascadeSplitsLocation = glGetUniformLocation(sceneProgram, "cascadeSplits");
+		m_sceneUseShadowsLocation = glGetUniformLocation(sceneProgram, "bUseShadows");
+	}
+
+	GLStateCache::BindTexture(textureUnit, GL_TEXTURE_2D_ARRAY, m_depthTexture);
+
+	GLStateCache::SetUniform(m_sceneShadowMapLocation, textureUnit);
+	GLStateCache::SetUniform(m_sceneCascadeCountLocation, m_cascadeCount);
+	glUniformMatrix4fv(m_sceneLightSpaceLocation, m_cascadeCount, GL_FALSE, glm::value_ptr(m_lightSpaceMatrices[0]));
+	glUniform1fv(m_sceneCascadeSplitsLocation, m_cascadeCount, m_cascadeSplits);
+	GLStateCache::SetUniform(m_sceneUseShadowsLocation, (int)true);
+}
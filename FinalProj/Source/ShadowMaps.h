@@ -0,0 +1,96 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadowmaps.h
+// ============
+// cascaded shadow maps for the directional key light
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "DrawList.h"
+#include "FrameState.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+/***********************************************************
+ *  ShadowMaps
+ *
+ *  This class owns a layered depth texture with one layer
+ *  per cascade. All cascades are rendered in one pass: the
+ *  geometry shader runs one invocation per cascade and
+ *  routes each triangle to its layer, skipping cascades the
+ *  caster's bounding sphere does not touch.
+ ***********************************************************/
+class ShadowMaps
+{
+public:
+	static const int MAX_CASCADES = 4;
+
+	// constructor
+	ShadowMaps();
+	// destructor
+	~ShadowMaps();
+
+	// create the depth texture array, framebuffer and shaders
+	bool Initialize(int resolution, int cascadeCount, float shadowDistance);
+
+	// fit the cascades to the camera frustum for this frame
+	void UpdateCascades(const FRAME_STATE& frameState, glm::vec3 lightDirection);
+	// bit mask of the cascades a caster's bounding sphere can cast into
+	unsigned int GetCascadeMask(glm::vec3 center, float radius) const;
+
+	// shadow pass: bind the target and program, set up one draw, restore
+	void BeginShadowPass();
+	void SetShadowDraw(const DRAW_PACKET& packet);
+	void EndShadowPass();
+
+	// pass the cascades and the shadow map into the scene shader,
+	// which must be the current program
+	void BindForScene(GLuint sceneProgram, int textureUnit);
+	// the cascades for passes that set their own uniforms
+	GLuint GetDepthTexture() const { return(m_depthTexture); }
+	int GetCascadeCount() const { return(m_cascadeCount); }
+	const glm::mat4* GetLightSpaceMatrices() const { return(m_lightSpaceMatrices); }
+	const float* GetCascadeSplits() const { return(m_cascadeSplits); }
+
+	bool IsReady() const { return(m_program != 0); }
+
+private:
+	int m_resolution;
+	int m_cascadeCount;
+	float m_shadowDistance;
+
+	GLuint m_depthTexture;
+	GLuint m_framebuffer;
+	GLuint m_program;
+
+	// uniform locations in the shadow program
+	GLint m_lightSpaceLocation;
+	GLint m_cascadeCountLocation;
+	GLint m_cascadeMaskLocation;
+	GLint m_modelLocation;
+	GLint m_useMeltLocation;
+	GLint m_meltGroupLocation;
+	GLint m_meltParamsLocation;
+
+	// uniform locations in the scene program, looked up on first use
+	GLuint m_sceneProgram;
+	GLint m_sceneShadowMapLocation;
+	GLint m_sceneCascadeCountLocation;
+	GLint m_sceneLightSpaceLocation;
+	GLint m_sceneCascadeSplitsLocation;
+	GLint m_sceneUseShadowsLocation;
+
+	glm::mat4 m_lightSpaceMatrices[MAX_CASCADES];
+	float m_cascadeSplits[MAX_CASCADES];
+	float m_cascadeRadii[MAX_CASCADES];
+	float m_cascadeDepthRanges[MAX_CASCADES];
+
+	// state restored by EndShadowPass()
+	GLuint m_previousProgram;
+	GLint m_previousFramebuffer;
+	GLint m_previousViewport[4];
+};
@@ -0,0 +1,522 @@
+///////////////////////////////////////////////////////////////////////////////
+// shapemeshes.cpp
+// ============
+// the basic 3D shapes the scene is built from, with the same interface and
+// dimensions as the course 3DShapes ShapeMeshes
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ShapeMeshes.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+	// segments around the round shapes, rows of the sphere from
+	// pole to pole and segments around the torus tube
+	const int ROUND_SEGMENTS = 48;
+	const int SPHERE_ROWS = 24;
+	const int TUBE_SEGMENTS = 24;
+	const float PI = 3.14159265358979f;
+
+	// index ranges of the parts of a shape
+	const int PART_TOP = 0;
+	const int PART_BOTTOM = 1;
+	const int PART_SIDES = 2;
+	const int PART_COUNT = 3;
+
+	// the float vertex of the attributes 0, 1 and 2
+	struct SHAPE_VERTEX
+	{
+		glm::vec3 position;
+		glm::vec3 normal;
+		glm::vec2 texCoord;
+	};
+
+	struct SHAPE_GEOMETRY
+	{
+		std::vector<SHAPE_VERTEX> vertices;
+		std::vector<GLuint> indices;
+		GLsizei partFirst[PART_COUNT];
+		GLsizei partCount[PART_COUNT];
+	};
+
+	/***********************************************************
+	 *  AddVertex()
+	 *
+	 *  This function appends a vertex and returns its index.
+	 ***********************************************************/
+	GLuint AddVertex(SHAPE_GEOMETRY& geometry, glm::vec3 position, glm::vec3 normal, glm::vec2 texCoord)
+	{
+		SHAPE_VERTEX vertex;
+		vertex.position = position;
+		vertex.normal = normal;
+		vertex.texCoord = texCoord;
+		geometry.vertices.push_back(vertex);
+		return((GLuint)(geometry.vertices.size() - 1));
+	}
+
+	/***********************************************************
+	 *  AddTriangle()
+	 *
+	 *  This function appends a triangle wound counter clockwise
+	 *  when seen from the side its normals face. Triangles that
+	 *  collapse to a line, like the ones at the sphere's poles,
+	 *  are left out.
+	 ***********************************************************/
+	void AddTriangle(SHAPE_GEOMETRY& geometry, GLuint a, GLuint b, GLuint c)
+	{
+		const SHAPE_VERTEX& vertexA = geometry.vertices[a];
+		const SHAPE_VERTEX& vertexB = geometry.vertices[b];
+		const SHAPE_VERTEX& vertexC = geometry.vertices[c];
+		glm::vec3 faceNormal = glm::cross(
+			vertexB.position - vertexA.position,
+			vertexC.position - vertexA.position);
+		if (glm::dot(faceNormal, faceNormal) < 1.0e-12f)
+		{
+			return;
+		}
+
+		geometry.indices.push_back(a);
+		if (glm::dot(faceNormal, vertexA.normal + vertexB.normal + vertexC.normal) < 0.0f)
+		{
+			geometry.indices.push_back(c);
+			geometry.indices.push_back(b);
+		}
+		else
+		{
+			geometry.indices.push_back(b);
+			geometry.indices.push_back(c);
+		}
+	}
+
+	/***********************************************************
+	 *  AddGrid()
+	 *
+	 *  This function appends the triangles between the rows of
+	 *  a grid of columns + 1 vertices per row, starting at the
+	 *  given vertex.
+	 ***********************************************************/
+	void AddGrid(SHAPE_GEOMETRY& geometry, GLuint firstVertex, int rows, int columns)
+	{
+		for (int row = 0; row < rows; ++row)
+		{
+			for (int column = 0; column < columns; ++column)
+			{
+				GLuint corner = firstVertex + (GLuint)(row * (columns + 1) + column);
+				GLuint nextRow = corner + (GLuint)(columns + 1);
+				AddTriangle(geometry, corner, nextRow, corner + 1);
+				AddTriangle(geometry, corner + 1, nextRow, nextRow + 1);
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  AddDisc()
+	 *
+	 *  This function appends a cap of a round shape at the
+	 *  height y, facing up or down.
+	 ***********************************************************/
+	void AddDisc(SHAPE_GEOMETRY& geometry, float y, float radius, bool bFacingUp)
+	{
+		glm::vec3 normal = glm::vec3(0.0f, bFacingUp ? 1.0f : -1.0f, 0.0f);
+		GLuint center = AddVertex(geometry, glm::vec3(0.0f, y, 0.0f), normal, glm::vec2(0.5f, 0.5f));
+		for (int i = 0; i <= ROUND_SEGMENTS; ++i)
+		{
+			float angle = 2.0f * PI * (float)i / (float)ROUND_SEGMENTS;
+			float x = std::cos(angle);
+			float z = std::sin(angle);
+			GLuint edge = AddVertex(geometry, glm::vec3(x * radius, y, z * radius), normal,
+				glm::vec2(0.5f + 0.5f * x, 0.5f + 0.5f * z));
+			if (i > 0)
+			{
+				AddTriangle(geometry, center, edge - 1, edge);
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  AddRoundSide()
+	 *
+	 *  This function appends the side of a cylinder, tapered
+	 *  cylinder or cone from y 0 to 1. The side of a cone
+	 *  gets one tip vertex per segment so every segment keeps
+	 *  its own normal at the tip.
+	 ***********************************************************/
+	void AddRoundSide(SHAPE_GEOMETRY& geometry, float bottomRadius, float topRadius)
+	{
+		// the normals lean up by the slope of the side
+		float slope = bottomRadius - topRadius;
+		GLuint firstVertex = (GLuint)geometry.vertices.size();
+		for (int row = 0; row < 2; ++row)
+		{
+			float radius = (row == 0) ? bottomRadius : topRadius;
+			for (int i = 0; i <= ROUND_SEGMENTS; ++i)
+			{
+				// the tip of a cone sits between the segment's edges
+				float segment = ((row == 1) && (topRadius == 0.0f)) ? (float)i + 0.5f : (float)i;
+				float angle = 2.0f * PI * segment / (float)ROUND_SEGMENTS;
+				float x = std::cos(angle);
+				float z = std::sin(angle);
+				AddVertex(geometry, glm::vec3(x * radius, (float)row, z * radius),
+					glm::normalize(glm::vec3(x, slope, z)),
+					glm::vec2(segment / (float)ROUND_SEGMENTS, (float)row));
+			}
+		}
+		AddGrid(geometry, firstVertex, 1, ROUND_SEGMENTS);
+	}
+
+	/***********************************************************
+	 *  EndPart()
+	 *
+	 *  This function records the indices added since first as
+	 *  a part of the shape.
+	 ***********************************************************/
+	void EndPart(SHAPE_GEOMETRY& geometry, int part, size_t first)
+	{
+		geometry.partFirst[part] = (GLsizei)first;
+		geometry.partCount[part] = (GLsizei)(geometry.indices.size() - first);
+	}
+
+	/***********************************************************
+	 *  BeginGeometry()
+	 *
+	 *  This function starts a shape without any parts.
+	 ***********************************************************/
+	void BeginGeometry(SHAPE_GEOMETRY& geometry)
+	{
+		for (int part = 0; part < PART_COUNT; ++part)
+		{
+			geometry.partFirst[part] = 0;
+			geometry.partCount[part] = 0;
+		}
+	}
+
+	/***********************************************************
+	 *  UploadGeometry()
+	 *
+	 *  This function creates the vertex array and buffers of a
+	 *  shape, replacing the ones it was loaded with before.
+	 ***********************************************************/
+	void UploadGeometry(const SHAPE_GEOMETRY& geometry, SHAPE_GLMESH& mesh)
+	{
+		if (mesh.vao == 0)
+		{
+			glGenVertexArrays(1, &mesh.vao);
+			glGenBuffers(2, mesh.vbos);
+		}
+		glBindVertexArray(mesh.vao);
+
+		glBindBuffer(GL_ARRAY_BUFFER, mesh.vbos[0]);
+		glBufferData(GL_ARRAY_BUFFER, geometry.vertices.size() * sizeof(SHAPE_VERTEX),
+			geometry.vertices.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.vbos[1]);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, geometry.indices.size() * sizeof(GLuint),
+			geometry.indices.data(), GL_STATIC_DRAW);
+
+		GLsizei stride = (GLsizei)sizeof(SHAPE_VERTEX);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(SHAPE_VERTEX, position));
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(SHAPE_VERTEX, normal));
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(SHAPE_VERTEX, texCoord));
+
+		for (int part = 0; part < PART_COUNT; ++part)
+		{
+			mesh.partFirst[part] = geometry.partFirst[part];
+			mesh.partCount[part] = geometry.partCount[part];
+		}
+	}
+}
+
+/***********************************************************
+ *  ShapeMeshes()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ShapeMeshes::ShapeMeshes()
+{
+	memset(m_meshes, 0, sizeof(m_meshes));
+}
+
+/***********************************************************
+ *  ~ShapeMeshes()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ShapeMeshes::~ShapeMeshes()
+{
+	for (int i = 0; i < SHAPE_TYPE_COUNT; ++i)
+	{
+		if (m_meshes[i].vao != 0)
+		{
+			glDeleteVertexArrays(1, &m_meshes[i].vao);
+			glDeleteBuffers(2, m_meshes[i].vbos);
+		}
+	}
+	memset(m_meshes, 0, sizeof(m_meshes));
+}
+
+/***********************************************************
+ *  LoadBoxMesh()
+ *
+ *  This method builds the box from six faces, each with
+ *  its own normal and the whole texture.
+ ***********************************************************/
+void ShapeMeshes::LoadBoxMesh()
+{
+	// the outward normal and the directions of the texture's
+	// u and v on each face
+	const glm::vec3 faces[6][3] =
+	{
+		{ glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+		{ glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+		{ glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+		{ glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+		{ glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f) },
+		{ glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f) }
+	};
+
+	SHAPE_GEOMETRY geometry;
+	BeginGeometry(geometry);
+	for (int face = 0; face < 6; ++face)
+	{
+		const glm::vec3& normal = faces[face][0];
+		const glm::vec3& u = faces[face][1];
+		const glm::vec3& v = faces[face][2];
+		GLuint firstVertex = (GLuint)geometry.vertices.size();
+		for (int corner = 0; corner < 4; ++corner)
+		{
+			float s = (corner == 1 || corner == 3) ? 1.0f : 0.0f;
+			float t = (corner >= 2) ? 1.0f : 0.0f;
+			AddVertex(geometry, 0.5f * normal + (s - 0.5f) * u + (t - 0.5f) * v, normal, glm::vec2(s, t));
+		}
+		AddGrid(geometry, firstVertex, 1, 1);
+	}
+	EndPart(geometry, PART_SIDES, 0);
+	UploadGeometry(geometry, m_meshes[SHAPE_TYPE_BOX]);
+}
+
+/***********************************************************
+ *  LoadConeMesh()
+ *
+ *  This method builds the cone from its bottom cap and its
+ *  side.
+ ***********************************************************/
+void ShapeMeshes::LoadConeMesh()
+{
+	SHAPE_GEOMETRY geometry;
+	BeginGeometry(geometry);
+	AddDisc(geometry, 0.0f, 1.0f, false);
+	EndPart(geometry, PART_BOTTOM, 0);
+	size_t sidesFirst = geometry.indices.size();
+	AddRoundSide(geometry, 1.0f, 0.0f);
+	EndPart(geometry, PART_SIDES, sidesFirst);
+	UploadGeometry(geometry, m_meshes[SHAPE_TYPE_CONE]);
+}
+
+/***********************************************************
+ *  LoadCylinderMesh()
+ *
+ *  This method builds the cylinder from its caps and its
+ *  side.
+ ***********************************************************/
+void ShapeMeshes::LoadCylinderMesh()
+{
+	SHAPE_GEOMETRY geometry;
+	BeginGeometry(geometry);
+	AddDisc(geometry, 1.0f, 1.0f, true);
+	EndPart(geometry, PART_TOP, 0);
+	size_t bottomFirst = geometry.indices.size();
+	AddDisc(geometry, 0.0f, 1.0f, false);
+	EndPart(geometry, PART_BOTTOM, bottomFirst);
+	size_t sidesFirst = geometry.indices.size();
+	AddRoundSide(geometry, 1.0f, 1.0f);
+	EndPart(geometry, PART_SIDES, sidesFirst);
+	UploadGeometry(geometry, m_meshes[SHAPE_TYPE_CYLINDER]);
+}
+
+/***********************************************************
+ *  LoadPlaneMesh()
+ *
+ *  This method builds the plane from two triangles.
+ ***********************************************************/
+void ShapeMeshes::LoadPlaneMesh()
+{
+	SHAPE_GEOMETRY geometry;
+	BeginGeometry(geometry);
+	glm::vec3 normal = glm::vec3(0.0f, 1.0f, 0.0f);
+	for (int corner = 0; corner < 4; ++corner)
+	{
+		float s = (corner == 1 || corner == 3) ? 1.0f : 0.0f;
+		float t = (corner >= 2) ? 1.0f : 0.0f;
+		AddVertex(geometry, glm::vec3(2.0f * s - 1.0f, 0.0f, 1.0f - 2.0f * t), normal, glm::vec2(s, t));
+	}
+	AddGrid(geometry, 0, 1, 1);
+	EndPart(geometry, PART_SIDES, 0);
+	UploadGeometry(geometry, m_meshes[SHAPE_TYPE_PLANE]);
+}
+
+/***********************************************************
+ *  LoadSphereMesh()
+ *
+ *  This method builds the sphere from rows of vertices
+ *  running from the top pole to the bottom one.
+ ***********************************************************/
+void ShapeMeshes::LoadSphereMesh()
+{
+	SHAPE_GEOMETRY geometry;
+	BeginGeometry(geometry);
+	for (int row = 0; row <= SPHERE_ROWS; ++row)
+	{
+		float polar = PI * (float)row / (float)SPHERE_ROWS;
+		for (int i = 0; i <= ROUND_SEGMENTS; ++i)
+		{
+			float angle = 2.0f * PI * (float)i / (float)ROUND_SEGMENTS;
+			glm::vec3 normal = glm::vec3(
+				std::sin(polar) * std::cos(angle),
+				std::cos(polar),
+				std::sin(polar) * std::sin(angle));
+			AddVertex(geometry, normal, normal,
+				glm::vec2((float)i / (float)ROUND_SEGMENTS, 1.0f - (float)row / (float)SPHERE_ROWS));
+		}
+	}
+	AddGrid(geometry, 0, SPHERE_ROWS, ROUND_SEGMENTS);
+	EndPart(geometry, PART_SIDES, 0);
+	UploadGeometry(geometry, m_meshes[SHAPE_TYPE_SPHERE]);
+}
+
+/***********************************************************
+ *  LoadTaperedCylinderMesh()
+ *
+ *  This method builds the tapered cylinder from its caps
+ *  and its side.
+ ***********************************************************/
+void ShapeMeshes::LoadTaperedCylinderMesh()
+{
+	SHAPE_GEOMETRY geometry;
+	BeginGeometry(geometry);
+	AddDisc(geometry, 1.0f, 0.5f, true);
+	EndPart(geometry, PART_TOP, 0);
+	size_t bottomFirst = geometry.indices.size();
+	AddDisc(geometry, 0.0f, 1.0f, false);
+	EndPart(geometry, PART_BOTTOM, bottomFirst);
+	size_t sidesFirst = geometry.indices.size();
+	AddRoundSide(geometry, 1.0f, 0.5f);
+	EndPart(geometry, PART_SIDES, sidesFirst);
+	UploadGeometry(geometry, m_meshes[SHAPE_TYPE_TAPERED_CYLINDER]);
+}
+
+/***********************************************************
+ *  LoadTorusMesh()
+ *
+ *  This method builds the torus around the z axis, with a
+ *  tube of the given thickness.
+ ***********************************************************/
+void ShapeMeshes::LoadTorusMesh(float thickness)
+{
+	SHAPE_GEOMETRY geometry;
+	BeginGeometry(geometry);
+	for (int ring = 0; ring <= ROUND_SEGMENTS; ++ring)
+	{
+		float angle = 2.0f * PI * (float)ring / (float)ROUND_SEGMENTS;
+		glm::vec3 center = glm::vec3(std::cos(angle), std::sin(angle), 0.0f);
+		for (int i = 0; i <= TUBE_SEGMENTS; ++i)
+		{
+			float tubeAngle = 2.0f * PI * (float)i / (float)TUBE_SEGMENTS;
+			glm::vec3 normal = std::cos(tubeAngle) * center + glm::vec3(0.0f, 0.0f, std::sin(tubeAngle));
+			AddVertex(geometry, center + thickness * normal, normal,
+				glm::vec2((float)ring / (float)ROUND_SEGMENTS, (float)i / (float)TUBE_SEGMENTS));
+		}
+	}
+	AddGrid(geometry, 0, ROUND_SEGMENTS, TUBE_SEGMENTS);
+	EndPart(geometry, PART_SIDES, 0);
+	UploadGeometry(geometry, m_meshes[SHAPE_TYPE_TORUS]);
+}
+
+/***********************************************************
+ *  DrawParts()
+ *
+ *  This method draws the chosen parts of a shape. The parts
+ *  are stored one after the other, so neighbouring parts
+ *  are drawn with one call.
+ ***********************************************************/
+void ShapeMeshes::DrawParts(const SHAPE_GLMESH& mesh, bool bDrawTop, bool bDrawBottom, bool bDrawSides) const
+{
+	if (mesh.vao == 0)
+	{
+		return;
+	}
+	glBindVertexArray(mesh.vao);
+
+	const bool bDrawPart[PART_COUNT] = { bDrawTop, bDrawBottom, bDrawSides };
+	GLsizei first = 0;
+	GLsizei count = 0;
+	for (int part = 0; part < PART_COUNT; ++part)
+	{
+		if (!bDrawPart[part] || (mesh.partCount[part] == 0))
+		{
+			continue;
+		}
+		if ((count > 0) && (first + count != mesh.partFirst[part]))
+		{
+			glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, (void*)(first * sizeof(GLuint)));
+			count = 0;
+		}
+		if (count == 0)
+		{
+			first = mesh.partFirst[part];
+		}
+		count += mesh.partCount[part];
+	}
+	if (count > 0)
+	{
+		glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, (void*)(first * sizeof(GLuint)));
+	}
+}
+
+/***********************************************************
+ *  Draw...Mesh()
+ *
+ *  These methods draw the loaded shapes.
+ ***********************************************************/
+void ShapeMeshes::DrawBoxMesh()
+{
+	DrawParts(m_meshes[SHAPE_TYPE_BOX], false, false, true);
+}
+
+void ShapeMeshes::DrawConeMesh(bool bDrawBottom)
+{
+	DrawParts(m_meshes[SHAPE_TYPE_CONE], false, bDrawBottom, true);
+}
+
+void ShapeMeshes::DrawCylinderMesh(bool bDrawTop, bool bDrawBottom, bool bDrawSides)
+{
+	DrawParts(m_meshes[SHAPE_TYPE_CYLINDER], bDrawTop, bDrawBottom, bDrawSides);
+}
+
+void ShapeMeshes::DrawPlaneMesh()
+{
+	DrawParts(m_meshes[SHAPE_TYPE_PLANE], false, false, true);
+}
+
+void ShapeMeshes::DrawSphereMesh()
+{
+	DrawParts(m_meshes[SHAPE_TYPE_SPHERE], false, false, true);
+}
+
+void ShapeMeshes::DrawTaperedCylinderMesh(bool bDrawTop, bool bDrawBottom, bool bDrawSides)
+{
+	DrawParts(m_meshes[SHAPE_TYPE_TAPERED_CYLINDER], bDrawTop, bDrawBottom, bDrawSides);
+}
+
+void ShapeMeshes::DrawTorusMesh()
+{
+	DrawParts(m_meshes[SHAPE_TYPE_TORUS], false, false, true);
+}
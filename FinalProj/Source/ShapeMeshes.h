@@ -0,0 +1,85 @@
+///////////////////////////////////////////////////////////////////////////////
+// shapemeshes.h
+// ============
+// the basic 3D shapes the scene is built from, with the same interface and
+// dimensions as the course 3DShapes ShapeMeshes
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+// GL objects of one loaded shape and the index ranges of its
+// top, bottom and side parts
+struct SHAPE_GLMESH
+{
+	GLuint vao;
+	GLuint vbos[2];
+	GLsizei partFirst[3];
+	GLsizei partCount[3];
+};
+
+/***********************************************************
+ *  ShapeMeshes
+ *
+ *  This class builds the basic shapes as indexed triangle
+ *  lists with float positions, normals and texture
+ *  coordinates in attributes 0, 1 and 2. The shapes are:
+ *
+ *    plane             -1 to 1 in x and z, facing up
+ *    box               -0.5 to 0.5 on every axis
+ *    cylinder, cone    radius 1, from y 0 to 1
+ *    tapered cylinder  radius 1 at y 0 and 0.5 at y 1
+ *    sphere            radius 1
+ *    torus             radius 1 around z, tube radius of
+ *                      the thickness it is loaded with
+ ***********************************************************/
+class ShapeMeshes
+{
+public:
+	// constructor
+	ShapeMeshes();
+	// destructor
+	~ShapeMeshes();
+
+	// build the shapes, only the loaded ones can be drawn
+	void LoadBoxMesh();
+	void LoadConeMesh();
+	void LoadCylinderMesh();
+	void LoadPlaneMesh();
+	void LoadSphereMesh();
+	void LoadTaperedCylinderMesh();
+	void LoadTorusMesh(float thickness = 0.1f);
+
+	// draw the shapes, the round ones can leave out their
+	// top and bottom caps or their sides
+	void DrawBoxMesh();
+	void DrawConeMesh(bool bDrawBottom = true);
+	void DrawCylinderMesh(bool bDrawTop = true, bool bDrawBottom = true, bool bDrawSides = true);
+	void DrawPlaneMesh();
+	void DrawSphereMesh();
+	void DrawTaperedCylinderMesh(bool bDrawTop = true, bool bDrawBottom = true, bool bDrawSides = true);
+	void DrawTorusMesh();
+
+private:
+	enum SHAPE_TYPE
+	{
+		SHAPE_TYPE_BOX = 0,
+		SHAPE_TYPE_CONE,
+		SHAPE_TYPE_CYLINDER,
+		SHAPE_TYPE_PLANE,
+		SHAPE_TYPE_SPHERE,
+		SHAPE_TYPE_TAPERED_CYLINDER,
+		SHAPE_TYPE_TORUS,
+		SHAPE_TYPE_COUNT
+	};
+
+	SHAPE_GLMESH m_meshes[SHAPE_TYPE_COUNT];
+
+	// draw the chosen parts of a loaded shape
+	void DrawParts(const SHAPE_GLMESH& mesh, bool bDrawTop, bool bDrawBottom, bool bDrawSides) const;
+};
@@ -0,0 +1,225 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureatlas.cpp
+// ============
+// packs small images into shared atlas pages
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureAtlas.h"
+
+#include "stb_image.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+	// pages are always RGBA so images with and without alpha can share one
+	const int PAGE_CHANNELS = 4;
+
+	int AlignUp(int value, int alignment)
+	{
+		return(((value + alignment - 1) / alignment) * alignment);
+	}
+}
+
+/***********************************************************
+ *  TextureAtlas()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureAtlas::TextureAtlas(int pageSize, int gutter)
+{
+	m_pageSize = pageSize;
+	m_gutter = std::max(gutter, 1);
+}
+
+/***********************************************************
+ *  AddImage()
+ *
+ *  This method decodes an image into RGBA and keeps it until
+ *  the atlas is built.
+ ***********************************************************/
+int TextureAtlas::AddImage(const char* filename)
+{
+	int width = 0;
+	int height = 0;
+	int colorChannels = 0;
+
+	// match the orientation of the textures loaded by the streamer
+	stbi_set_flip_vertically_on_load(true);
+
+	unsigned char* image = stbi_load(filename, &width, &height, &colorChannels, PAGE_CHANNELS);
+	if (!image)
+	{
+		std::cout << "Could not load image:" << filename << std::endl;
+		return(-1);
+	}
+	int entry = AddPixels(image, width, height);
+	stbi_image_free(image);
+	if (entry < 0)
+	{
+		std::cout << "ERROR: image " << filename << " is too large for a " << m_pageSize << " atlas page" << std::endl;
+		return(-1);
+	}
+	std::cout << "Successfully loaded atlas image:" << filename << ", width:" << width << ", height:" << height << std::endl;
+	return(entry);
+}
+
+/***********************************************************
+ *  AddPixels()
+ *
+ *  This method copies a decoded RGBA image and keeps it
+ *  until the atlas is built.
+ ***********************************************************/
+int TextureAtlas::AddPixels(const unsigned char* pPixels, int width, int height)
+{
+	if ((width <= 0) || (height <= 0) ||
+		(AlignUp(width, m_gutter) + m_gutter * 2 > m_pageSize) ||
+		(AlignUp(height, m_gutter) + m_gutter * 2 > m_pageSize))
+	{
+		return(-1);
+	}
+
+	SOURCE_IMAGE source;
+	source.width = width;
+	source.height = height;
+	source.pixels.assign(pPixels, pPixels + (size_t)width * height * PAGE_CHANNELS);
+	m_images.push_back(source);
+
+	ATLAS_ENTRY entry;
+	entry.page = -1;
+	entry.uvOffset = glm::vec2(0.0f);
+	entry.uvScale = glm::vec2(1.0f);
+	m_entries.push_back(entry);
+
+	return((int)m_entries.size() - 1);
+}
+
+/***********************************************************
+ *  Build()
+ *
+ *  This method packs the images tallest first into rows,
+ *  starting a new row when one is full and a new page when
+ *  a row no longer fits. Every image takes its size plus a
+ *  gutter on each side, rounded up to the gutter size, so
+ *  the images always start on a gutter boundary.
+ ***********************************************************/
+void TextureAtlas::Build()
+{
+	m_pages.clear();
+
+	std::vector<int> order(m_images.size());
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		order[i] = (int)i;
+	}
+	std::sort(order.begin(), order.end(), [this](int a, int b)
+		{
+			return(m_images[a].height > m_images[b].height);
+		});
+
+	int rowX = 0;
+	int rowY = 0;
+	int rowHeight = 0;
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		const SOURCE_IMAGE& image = m_images[order[i]];
+		int cellWidth = AlignUp(image.width, m_gutter) + m_gutter * 2;
+		int cellHeight = AlignUp(image.height, m_gutter) + m_gutter * 2;
+
+		if (rowX + cellWidth > m_pageSize)
+		{
+			rowX = 0;
+			rowY += rowHeight;
+			rowHeight = 0;
+		}
+		if (m_pages.empty() || (rowY + cellHeight > m_pageSize))
+		{
+			ATLAS_PAGE page;
+			page.width = m_pageSize;
+			page.height = m_pageSize;
+			page.pixels.assign((size_t)m_pageSize * m_pageSize * PAGE_CHANNELS, 0);
+			m_pages.push_back(page);
+			rowX = 0;
+			rowY = 0;
+			rowHeight = 0;
+		}
+
+		int x = rowX + m_gutter;
+		int y = rowY + m_gutter;
+		CopyWithGutter(image, m_pages.back(), x, y);
+
+		ATLAS_ENTRY& entry = m_entries[order[i]];
+		entry.page = (int)m_pages.size() - 1;
+		entry.uvOffset = glm::vec2((float)x / m_pageSize, (float)y / m_pageSize);
+		entry.uvScale = glm::vec2((float)image.width / m_pageSize, (float)image.height / m_pageSize);
+
+		rowX += cellWidth;
+		rowHeight = std::max(rowHeight, cellHeight);
+	}
+
+	std::cout << "INFO: packed " << m_images.size() << " images into " << m_pages.size() << " atlas pages" << std::endl;
+	m_images.clear();
+}
+
+/***********************************************************
+ *  CopyWithGutter()
+ *
+ *  This method copies an image onto a page at (x, y) and
+ *  fills the gutter around it with its clamped edge texels,
+ *  so filtering at the border sees the edge and not the
+ *  neighbouring image.
+ ***********************************************************/
+void TextureAtlas::CopyWithGutter(const SOURCE_IMAGE& image, ATLAS_PAGE& page, int x, int y) const
+{
+	for (int row = -m_gutter; row < image.height + m_gutter; row++)
+	{
+		int sourceRow = std::min(std::max(row, 0), image.height - 1);
+		unsigned char* destination = &page.pixels[((size_t)(y + row) * page.width + x - m_gutter) * PAGE_CHANNELS];
+		const unsigned char* source = &image.pixels[(size_t)sourceRow * image.width * PAGE_CHANNELS];
+
+		for (int column = -m_gutter; column < 0; column++)
+		{
+			std::copy(source, source + PAGE_CHANNELS, destination);
+			destination += PAGE_CHANNELS;
+		}
+		std::copy(source, source + (size_t)image.width * PAGE_CHANNELS, destination);
+		destination += (size_t)image.width * PAGE_CHANNELS;
+		const unsigned char* lastTexel = source + (size_t)(image.width - 1) * PAGE_CHANNELS;
+		for (int column = 0; column < m_gutter; column++)
+		{
+			std::copy(lastTexel, lastTexel + PAGE_CHANNELS, destination);
+			destination += PAGE_CHANNELS;
+		}
+	}
+}
+
+/***********************************************************
+ *  ReleasePages()
+ *
+ *  This method frees the page pixels after the upload.
+ ***********************************************************/
+void TextureAtlas::ReleasePages()
+{
+	m_pages.clear();
+}
+
+/***********************************************************
+ *  GetMaxMipLevel()
+ *
+ *  This method returns the last mip level of a page. The
+ *  gutter halves with every level, and past this one the
+ *  filtering would reach into the neighbouring images.
+ ***********************************************************/
+int TextureAtlas::GetMaxMipLevel() const
+{
+	int level = 0;
+	while ((m_gutter >> (level + 1)) > 0)
+	{
+		level++;
+	}
+	return(level);
+}
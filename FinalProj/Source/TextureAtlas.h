@@ -0,0 +1,82 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureatlas.h
+// ============
+// packs small images into shared atlas pages
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  TextureAtlas
+ *
+ *  This class collects small images and packs them in rows
+ *  onto RGBA pages, so textures that would each need their
+ *  own texture object and unit share one. Each image gets a
+ *  gutter of repeated edge texels, and placements snap to
+ *  the gutter size, so mips down to the gutter size never
+ *  blend in a neighbour; the pages must not get any mips
+ *  past GetMaxMipLevel(). A draw reaches its image through a
+ *  UV offset and scale into the page, which means atlas
+ *  images cannot repeat over a surface.
+ ***********************************************************/
+class TextureAtlas
+{
+public:
+	// one packed page, rows from the bottom like the flipped images
+	struct ATLAS_PAGE
+	{
+		int width;
+		int height;
+		std::vector<unsigned char> pixels;
+	};
+
+	// where an added image ended up
+	struct ATLAS_ENTRY
+	{
+		int page;
+		glm::vec2 uvOffset;
+		glm::vec2 uvScale;
+	};
+
+	// constructor
+	TextureAtlas(int pageSize, int gutter);
+
+	// decode an image for the next Build(), returns its entry index,
+	// -1 when it cannot be read or does not fit on a page
+	int AddImage(const char* filename);
+	// same for an already decoded RGBA image, rows from the bottom
+	int AddPixels(const unsigned char* pPixels, int width, int height);
+	// pack every added image, the decoded images are freed afterwards
+	void Build();
+
+	int GetPageCount() const { return((int)m_pages.size()); }
+	const ATLAS_PAGE& GetPage(int index) const { return(m_pages[index]); }
+	const ATLAS_ENTRY& GetEntry(int index) const { return(m_entries[index]); }
+	// free the pages once they are uploaded, the entries stay valid
+	void ReleasePages();
+	// coarsest page mip whose gutter still covers a texel, log2(gutter)
+	int GetMaxMipLevel() const;
+
+private:
+	struct SOURCE_IMAGE
+	{
+		int width;
+		int height;
+		std::vector<unsigned char> pixels;
+	};
+
+	int m_pageSize;
+	int m_gutter;
+	std::vector<SOURCE_IMAGE> m_images;
+	std::vector<ATLAS_ENTRY> m_entries;
+	std::vector<ATLAS_PAGE> m_pages;
+
+	void CopyWithGutter(const SOURCE_IMAGE& image, ATLAS_PAGE& page, int x, int y) const;
+};
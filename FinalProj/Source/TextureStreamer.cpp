@@ -0,0 +1,516 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturestreamer.cpp
+// ============
+// keeps the scene textures resident within a video memory budget
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureStreamer.h"
+#include "GLStateCache.h"
+
+#ifndef STB_IMAGE_IMPLEMENTATION
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#endif
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+	// mips up to this size are loaded up front and never dropped
+	const int TAIL_MIP_SIZE = 64;
+	// drivers pad RGB textures to four bytes per texel
+	const size_t BYTES_PER_TEXEL = 4;
+
+	// sRGB to linear lookup, so the mips are averaged in linear light
+	float g_SrgbToLinear[256];
+	bool g_bSrgbTableReady = false;
+
+	void BuildSrgbTable()
+	{
+		if (g_bSrgbTableReady)
+		{
+			return;
+		}
+		for (int i = 0; i < 256; i++)
+		{
+			g_SrgbToLinear[i] = std::pow(i / 255.0f, 2.2f);
+		}
+		g_bSrgbTableReady = true;
+	}
+
+	unsigned char LinearToSrgb(float value)
+	{
+		float encoded = std::pow(std::min(std::max(value, 0.0f), 1.0f), 1.0f / 2.2f);
+		return((unsigned char)(encoded * 255.0f + 0.5f));
+	}
+}
+
+/***********************************************************
+ *  TextureStreamer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureStreamer::TextureStreamer(size_t budgetBytes, int maxTextures)
+{
+	m_maxTextures = maxTextures;
+	m_budgetBytes = budgetBytes;
+	m_residentBytes = 0;
+	m_frame = 0;
+	m_pixelsPerUnit = 1.0f;
+	m_viewPosition = glm::vec3(0.0f);
+	m_nearPlane = 0.1f;
+	BuildSrgbTable();
+}
+
+/***********************************************************
+ *  ~TextureStreamer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TextureStreamer::~TextureStreamer()
+{
+	Release();
+}
+
+/***********************************************************
+ *  SetBudget()
+ *
+ *  This method changes the budget, the next Update() drops
+ *  mips until the resident textures fit again.
+ ***********************************************************/
+void TextureStreamer::SetBudget(size_t budgetBytes)
+{
+	m_budgetBytes = budgetBytes;
+}
+
+/***********************************************************
+ *  Release()
+ *
+ *  This method deletes the textures and their system memory
+ *  copies.
+ ***********************************************************/
+void TextureStreamer::Release()
+{
+	for (size_t i = 0; i < m_textures.size(); i++)
+	{
+		GLStateCache::DeleteTexture(m_textures[i].texture);
+	}
+	m_textures.clear();
+	m_residentBytes = 0;
+}
+
+/***********************************************************
+ *  GetTextureID()
+ *
+ *  This method returns the current OpenGL name of a
+ *  texture. The name changes when the residency changes.
+ ***********************************************************/
+GLuint TextureStreamer::GetTextureID(int index) const
+{
+	if ((index < 0) || (index >= (int)m_textures.size()))
+	{
+		return(0);
+	}
+	return(m_textures[index].texture);
+}
+
+/***********************************************************
+ *  GetLevelBytes()
+ *
+ *  This method returns the video memory used by one mip.
+ ***********************************************************/
+size_t TextureStreamer::GetLevelBytes(const STREAMED_TEXTURE& texture, int level)
+{
+	const MIP_LEVEL& mip = texture.mips[level];
+	return((size_t)mip.width * (size_t)mip.height * BYTES_PER_TEXEL);
+}
+
+/***********************************************************
+ *  GetResidentBytes()
+ *
+ *  This method returns the video memory used by a texture
+ *  with the passed in finest resident mip.
+ ***********************************************************/
+size_t TextureStreamer::GetResidentBytes(const STREAMED_TEXTURE& texture, int residentLevel)
+{
+	size_t bytes = 0;
+	for (int level = residentLevel; level < (int)texture.mips.size(); level++)
+	{
+		bytes += GetLevelBytes(texture, level);
+	}
+	return(bytes);
+}
+
+/***********************************************************
+ *  BuildMipChain()
+ *
+ *  This method box filters mip 0 down to 1x1, or to the
+ *  passed in level, in system memory. Color is averaged in
+ *  linear light, alpha and the channels of linear images
+ *  as they are.
+ ***********************************************************/
+void TextureStreamer::BuildMipChain(STREAMED_TEXTURE& texture, int maxLevel)
+{
+	int channels = texture.channels;
+	int colorChannels = texture.bLinear ? 0 : 3;
+	while (((texture.mips.back().width > 1) || (texture.mips.back().height > 1)) &&
+		((maxLevel < 0) || ((int)texture.mips.size() <= maxLevel)))
+	{
+		const MIP_LEVEL& source = texture.mips.back();
+		MIP_LEVEL mip;
+		mip.width = std::max(source.width / 2, 1);
+		mip.height = std::max(source.height / 2, 1);
+		mip.pixels.resize((size_t)mip.width * mip.height * channels);
+
+		for (int y = 0; y < mip.height; y++)
+		{
+			// odd sizes: the last row and column are clamped
+			int y0 = std::min(y * 2, source.height - 1);
+			int y1 = std::min(y * 2 + 1, source.height - 1);
+			for (int x = 0; x < mip.width; x++)
+			{
+				int x0 = std::min(x * 2, source.width - 1);
+				int x1 = std::min(x * 2 + 1, source.width - 1);
+				const unsigned char* samples[4] = {
+					&source.pixels[((size_t)y0 * source.width + x0) * channels],
+					&source.pixels[((size_t)y0 * source.width + x1) * channels],
+					&source.pixels[((size_t)y1 * source.width + x0) * channels],
+					&source.pixels[((size_t)y1 * source.width + x1) * channels] };
+				unsigned char* target = &mip.pixels[((size_t)y * mip.width + x) * channels];
+
+				for (int c = 0; c < channels; c++)
+				{
+					if (c < colorChannels)
+					{
+						float sum = 0.0f;
+						for (int s = 0; s < 4; s++)
+						{
+							sum += g_SrgbToLinear[samples[s][c]];
+						}
+						target[c] = LinearToSrgb(sum * 0.25f);
+					}
+					else
+					{
+						int sum = 0;
+						for (int s = 0; s < 4; s++)
+						{
+							sum += samples[s][c];
+						}
+						target[c] = (unsigned char)((sum + 2) / 4);
+					}
+				}
+			}
+		}
+		texture.mips.push_back(mip);
+	}
+}
+
+/***********************************************************
+ *  LoadTexture()
+ *
+ *  This method decodes an image file, builds its mip chain
+ *  and uploads only the tail mips. The texture is bound to
+ *  the texture unit matching the returned index.
+ ***********************************************************/
+int TextureStreamer::LoadTexture(const char* filename, bool bLinear)
+{
+	int width = 0;
+	int height = 0;
+	int colorChannels = 0;
+
+	// indicate to always flip images vertically when loaded
+	stbi_set_flip_vertically_on_load(true);
+
+	unsigned char* image = stbi_load(filename, &width, &height, &colorChannels, 0);
+	if (!image)
+	{
+		std::cout << "Could not load image:" << filename << std::endl;
+		return(-1);
+	}
+	if ((colorChannels != 3) && (colorChannels != 4))
+	{
+		std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
+		stbi_image_free(image);
+		return(-1);
+	}
+	std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
+
+	int index = LoadTexture(image, width, height, colorChannels, bLinear);
+	stbi_image_free(image);
+	return(index);
+}
+
+/***********************************************************
+ *  LoadTexture()
+ *
+ *  This method takes a copy of decoded RGB or RGBA pixels,
+ *  builds their mip chain and uploads only the tail mips.
+ *  A shortened chain keeps its last mip resident, however
+ *  large it is.
+ ***********************************************************/
+int TextureStreamer::LoadTexture(const unsigned char* pixels, int width, int height, int channels, bool bLinear, int maxLevel)
+{
+	// the units past the streamed textures belong to the render passes
+	if ((int)m_textures.size() >= m_maxTextures)
+	{
+		std::cout << "ERROR: no texture unit left for another scene texture, " << m_maxTextures << " are in use" << std::endl;
+		return(-1);
+	}
+
+	STREAMED_TEXTURE texture;
+	texture.channels = channels;
+	texture.bLinear = bLinear;
+	texture.texture = 0;
+	texture.lastUsedFrame = 0;
+
+	MIP_LEVEL baseLevel;
+	baseLevel.width = width;
+	baseLevel.height = height;
+	baseLevel.pixels.assign(pixels, pixels + (size_t)width * height * channels);
+	texture.mips.push_back(baseLevel);
+	BuildMipChain(texture, maxLevel);
+
+	int mipCount = (int)texture.mips.size();
+	texture.tailLevel = mipCount - 1;
+	while ((texture.tailLevel > 0) &&
+		(std::max(texture.mips[texture.tailLevel - 1].width, texture.mips[texture.tailLevel - 1].height) <= TAIL_MIP_SIZE))
+	{
+		texture.tailLevel--;
+	}
+	texture.residentLevel = mipCount;
+	texture.requestedLevel = mipCount;
+
+	m_textures.push_back(texture);
+	int index = (int)m_textures.size() - 1;
+	MakeResident(index, m_textures[index].tailLevel);
+
+	return(index);
+}
+
+/***********************************************************
+ *  MakeResident()
+ *
+ *  This method moves a texture into new storage holding the
+ *  mips from the passed in level down to 1x1. Mips that were
+ *  already resident are copied on the GPU when the context
+ *  can copy images, the others are uploaded from system
+ *  memory.
+ ***********************************************************/
+void TextureStreamer::MakeResident(int index, int level)
+{
+	STREAMED_TEXTURE& texture = m_textures[index];
+	int mipCount = (int)texture.mips.size();
+	if ((level == texture.residentLevel) || (level < 0) || (level >= mipCount))
+	{
+		return;
+	}
+
+	// the images are stored with display gamma, the sRGB formats convert
+	// them to linear color on sampling since the scene is lit in HDR
+	GLenum internalFormat = (texture.channels == 4) ? GL_SRGB8_ALPHA8 : GL_SRGB8;
+	if (texture.bLinear)
+	{
+		internalFormat = (texture.channels == 4) ? GL_RGBA8 : GL_RGB8;
+	}
+	GLenum format = (texture.channels == 4) ? GL_RGBA : GL_RGB;
+
+	bool bImmutable = GLEW_VERSION_4_2 || GLEW_ARB_texture_storage;
+	bool bCopyImages = GLEW_VERSION_4_3 || GLEW_ARB_copy_image;
+
+	GLuint newTexture = 0;
+	glGenTextures(1, &newTexture);
+	GLStateCache::BindTexture(index, GL_TEXTURE_2D, newTexture);
+	if (bImmutable)
+	{
+		glTexStorage2D(GL_TEXTURE_2D, mipCount - level, internalFormat, texture.mips[level].width, texture.mips[level].height);
+	}
+	else
+	{
+		// mutable levels are only complete up to the max level
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, mipCount - level - 1);
+	}
+
+	// set the texture wrapping parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	// set texture filtering parameters, the streamed mips are only
+	// useful with mipmapped minification
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	for (int mip = level; mip < mipCount; mip++)
+	{
+		const MIP_LEVEL& source = texture.mips[mip];
+		bool bCopy = bCopyImages && (texture.texture != 0) && (mip >= texture.residentLevel);
+		if (!bImmutable)
+		{
+			glTexImage2D(GL_TEXTURE_2D, mip - level, internalFormat, source.width, source.height, 0,
+				format, GL_UNSIGNED_BYTE, bCopy ? NULL : &source.pixels[0]);
+		}
+		if (bCopy)
+		{
+			glCopyImageSubData(
+				texture.texture, GL_TEXTURE_2D, mip - texture.residentLevel, 0, 0, 0,
+				newTexture, GL_TEXTURE_2D, mip - level, 0, 0, 0,
+				source.width, source.height, 1);
+		}
+		else if (bImmutable)
+		{
+			glTexSubImage2D(GL_TEXTURE_2D, mip - level, 0, 0, source.width, source.height,
+				format, GL_UNSIGNED_BYTE, &source.pixels[0]);
+		}
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	// the scene samples texture unit i for texture i
+	GLStateCache::DeleteTexture(texture.texture);
+	texture.texture = newTexture;
+
+	if (texture.residentLevel < mipCount)
+	{
+		m_residentBytes -= GetResidentBytes(texture, texture.residentLevel);
+	}
+	m_residentBytes += GetResidentBytes(texture, level);
+	texture.residentLevel = level;
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method clears the feedback of the previous frame
+ *  and keeps the camera values for the screen-space sizes.
+ ***********************************************************/
+void TextureStreamer::BeginFrame(const FRAME_STATE& frameState)
+{
+	m_frame++;
+	for (size_t i = 0; i < m_textures.size(); i++)
+	{
+		m_textures[i].requestedLevel = (int)m_textures[i].mips.size();
+	}
+
+	// projection[1][1] is 1 / tan(fov / 2), half the screen height
+	// covers that many world units at distance 1
+	m_pixelsPerUnit = frameState.projection[1][1] * frameState.framebufferHeight * 0.5f;
+	m_viewPosition = frameState.viewPosition;
+	m_nearPlane = frameState.nearPlane;
+}
+
+/***********************************************************
+ *  RequestTexture()
+ *
+ *  This method estimates the mip a draw needs from the size
+ *  of its bounding sphere on the screen.
+ ***********************************************************/
+void TextureStreamer::RequestTexture(int index, const glm::vec4& bounds, const glm::vec2& uvScale)
+{
+	if ((index < 0) || (index >= (int)m_textures.size()))
+	{
+		return;
+	}
+	STREAMED_TEXTURE& texture = m_textures[index];
+
+	float distance = glm::length(glm::vec3(bounds) - m_viewPosition) - bounds.w;
+	distance = std::max(distance, m_nearPlane);
+	float screenPixels = 2.0f * bounds.w * m_pixelsPerUnit / distance;
+
+	// texels stretched across the object against pixels it covers
+	float texels = (float)std::max(texture.mips[0].width, texture.mips[0].height) * std::max(uvScale.x, uvScale.y);
+	int level = 0;
+	if (texels > screenPixels)
+	{
+		level = (int)std::floor(std::log2(texels / std::max(screenPixels, 1.0f)));
+	}
+
+	texture.requestedLevel = std::min(texture.requestedLevel, level);
+	texture.lastUsedFrame = m_frame;
+}
+
+/***********************************************************
+ *  EvictLeastRecentlyUsed()
+ *
+ *  This method drops the finest mip of the texture used the
+ *  longest time ago, or one holding finer mips than it was
+ *  asked for. Returns false when nothing can be dropped.
+ ***********************************************************/
+bool TextureStreamer::EvictLeastRecentlyUsed(int keepIndex)
+{
+	int victim = -1;
+	for (int i = 0; i < (int)m_textures.size(); i++)
+	{
+		const STREAMED_TEXTURE& texture = m_textures[i];
+		if ((i == keepIndex) || (texture.residentLevel >= texture.tailLevel))
+		{
+			continue;
+		}
+		// mips the current frame needs are never dropped
+		bool bNeeded = (texture.lastUsedFrame == m_frame) && (texture.residentLevel >= texture.requestedLevel);
+		if (bNeeded)
+		{
+			continue;
+		}
+		if ((victim < 0) || (texture.lastUsedFrame < m_textures[victim].lastUsedFrame))
+		{
+			victim = i;
+		}
+	}
+	if (victim < 0)
+	{
+		return(false);
+	}
+	MakeResident(victim, m_textures[victim].residentLevel + 1);
+	return(true);
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method brings the residency closer to this frame's
+ *  feedback: each texture that needs finer mips gets one
+ *  more mip, as long as the budget allows it after evicting
+ *  the least recently used mips.
+ ***********************************************************/
+void TextureStreamer::Update()
+{
+	// a lowered budget is met before anything new is uploaded
+	while (m_residentBytes > m_budgetBytes)
+	{
+		if (!EvictLeastRecentlyUsed(-1))
+		{
+			break;
+		}
+	}
+
+	for (int i = 0; i < (int)m_textures.size(); i++)
+	{
+		STREAMED_TEXTURE& texture = m_textures[i];
+		int wanted = std::min(texture.requestedLevel, texture.tailLevel);
+		if (wanted >= texture.residentLevel)
+		{
+			continue;
+		}
+
+		int level = texture.residentLevel - 1;
+		size_t extraBytes = GetLevelBytes(texture, level);
+		bool bFits = true;
+		while (m_residentBytes + extraBytes > m_budgetBytes)
+		{
+			if (!EvictLeastRecentlyUsed(i))
+			{
+				bFits = false;
+				break;
+			}
+		}
+		if (bFits)
+		{
+			MakeResident(i, level);
+		}
+	}
+}
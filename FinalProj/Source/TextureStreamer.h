@@ -0,0 +1,114 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturestreamer.h
+// ============
+// keeps the scene textures resident within a video memory budget
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "FrameState.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <vector>
+
+/***********************************************************
+ *  TextureStreamer
+ *
+ *  This class keeps the full mip chain of every texture in
+ *  system memory and only the mips the frame needs on the
+ *  GPU. A texture starts out with just its small tail mips,
+ *  the draws report how large their textures appear on the
+ *  screen, and each frame the streamer uploads one finer
+ *  mip per texture that needs it. When an upload would go
+ *  over the budget, the finest mip of the least recently
+ *  used texture is dropped first.
+ *
+ *  Plain OpenGL cannot release single mips of a texture, so
+ *  a residency change moves the texture into new storage
+ *  with the wanted number of mips, copying the mips that
+ *  stay resident on the GPU. Contexts without immutable
+ *  storage (GL 4.2) or image copies (GL 4.3), such as the
+ *  3.3 one on macOS, get mutable levels limited by the max
+ *  level and upload every mip from system memory.
+ *
+ *  Texture i stays bound to texture unit i, so the streamer
+ *  only takes as many textures as it was given units for.
+ ***********************************************************/
+class TextureStreamer
+{
+public:
+	// constructor, the textures use texture units 0 to maxTextures - 1
+	TextureStreamer(size_t budgetBytes, int maxTextures);
+	// destructor
+	~TextureStreamer();
+
+	// video memory the resident mips may use
+	void SetBudget(size_t budgetBytes);
+	size_t GetBudget() const { return(m_budgetBytes); }
+	size_t GetResidentBytes() const { return(m_residentBytes); }
+
+	// decode an image and upload its low mips, the texture stays
+	// bound to the texture unit with the returned index, -1 on error;
+	// a linear image holds data such as distances instead of color
+	int LoadTexture(const char* filename, bool bLinear = false);
+	// same for an image already in memory, such as an atlas page; the
+	// mip chain stops at maxLevel, -1 builds it down to 1x1
+	int LoadTexture(const unsigned char* pixels, int width, int height, int channels, bool bLinear = false, int maxLevel = -1);
+	// delete all textures and their system memory copies
+	void Release();
+
+	int GetTextureCount() const { return((int)m_textures.size()); }
+	GLuint GetTextureID(int index) const;
+
+	// screen-space feedback: start a frame, report every visible
+	// draw's texture, then update the residency
+	void BeginFrame(const FRAME_STATE& frameState);
+	void RequestTexture(int index, const glm::vec4& bounds, const glm::vec2& uvScale);
+	void Update();
+
+private:
+	struct MIP_LEVEL
+	{
+		int width;
+		int height;
+		std::vector<unsigned char> pixels;
+	};
+
+	struct STREAMED_TEXTURE
+	{
+		std::vector<MIP_LEVEL> mips;
+		int channels;
+		// stored and filtered as is, without the sRGB conversion
+		bool bLinear;
+		GLuint texture;
+		// finest mip on the GPU, and the finest one that is never dropped
+		int residentLevel;
+		int tailLevel;
+		// finest mip asked for this frame, mip count when not drawn
+		int requestedLevel;
+		unsigned long long lastUsedFrame;
+	};
+
+	std::vector<STREAMED_TEXTURE> m_textures;
+	int m_maxTextures;
+	size_t m_budgetBytes;
+	size_t m_residentBytes;
+	unsigned long long m_frame;
+
+	// pixels per world unit at distance 1, and the camera position
+	float m_pixelsPerUnit;
+	glm::vec3 m_viewPosition;
+	float m_nearPlane;
+
+	static size_t GetLevelBytes(const STREAMED_TEXTURE& texture, int level);
+	static size_t GetResidentBytes(const STREAMED_TEXTURE& texture, int residentLevel);
+	void BuildMipChain(STREAMED_TEXTURE& texture, int maxLevel);
+	void MakeResident(int index, int level);
+	bool EvictLeastRecentlyUsed(int keepIndex);
+};
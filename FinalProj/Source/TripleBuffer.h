@@ -0,0 +1,79 @@
+///////////////////////////////////////////////////////////////////////////////
+// triplebuffer.h
+// ============
+// lock-free hand off of frame snapshots from one writer thread to one
+// reader thread
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+
+/***********************************************************
+ *  TripleBuffer
+ *
+ *  The writer fills one slot while the reader uses another,
+ *  and the third slot holds the most recently published
+ *  value. Publishing and acquiring swap a slot index with
+ *  the middle slot in one atomic exchange, so neither side
+ *  ever waits for the other and the reader always gets the
+ *  newest complete snapshot.
+ ***********************************************************/
+template <typename T>
+class TripleBuffer
+{
+public:
+	TripleBuffer()
+	{
+		m_writeIndex = 0;
+		m_middle = 1;
+		m_readIndex = 2;
+	}
+
+	// writer side: the slot to fill before calling Publish()
+	T& GetWriteBuffer()
+	{
+		return(m_buffers[m_writeIndex]);
+	}
+
+	// writer side: make the filled slot the latest snapshot
+	void Publish()
+	{
+		unsigned int previous = m_middle.exchange(m_writeIndex | FRESH_BIT, std::memory_order_acq_rel);
+		m_writeIndex = previous & INDEX_MASK;
+	}
+
+	// reader side: switch to the latest snapshot, returns false
+	// when nothing was published since the last call
+	bool AcquireLatest()
+	{
+		if ((m_middle.load(std::memory_order_relaxed) & FRESH_BIT) == 0)
+		{
+			return(false);
+		}
+		unsigned int previous = m_middle.exchange(m_readIndex, std::memory_order_acq_rel);
+		m_readIndex = previous & INDEX_MASK;
+		return(true);
+	}
+
+	// reader side: the snapshot acquired by AcquireLatest()
+	const T& GetReadBuffer() const
+	{
+		return(m_buffers[m_readIndex]);
+	}
+
+private:
+	static const unsigned int INDEX_MASK = 3;
+	static const unsigned int FRESH_BIT = 4;
+
+	T m_buffers[3];
+	// index of the middle slot, plus FRESH_BIT when it is unread
+	std::atomic<unsigned int> m_middle;
+	// only touched by the writer
+	unsigned int m_writeIndex;
+	// only touched by the reader
+	unsigned int m_readIndex;
+};
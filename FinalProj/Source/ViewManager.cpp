@@ -9,16 +9,21 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "ViewManager.h"
+#include "FramePacer.h"
+#include "GLStateCache.h"
 
 // GLM Math Header inclusions
 #include <glm/glm.hpp>
 #include <glm/gtx/transform.hpp>
 #include <glm/gtc/type_ptr.hpp>    
 
+#include <iostream>
+
 // declarations for global variables and defines
 namespace
 {
-	// Variables for window width and height
+	// Variables for the initial window width and height, the
+	// projection follows the window when it is resized
 	const int WINDOW_WIDTH = 1000;
 	const int WINDOW_HEIGHT = 800;
 	const char* g_ViewName = "view";
@@ -33,9 +38,14 @@ namespace
 	float gLastY = WINDOW_HEIGHT / 2.0f;
 	bool gFirstMouse = true;
 
-	// time between current frame and last frame
+	// time between current frame and last frame, smoothed so the
+	// camera speed does not follow the scheduling jitter
 	float gDeltaTime = 0.0f; 
-	float gLastFrame = 0.0f;
+	double gLastFrame = 0.0;
+	DeltaSmoother gDeltaSmoother;
+
+	// set while a camera path drives the camera, the input is ignored
+	bool gbCameraReplay = false;
 
 	// the following variable is false when orthographic projection
 	// is off and true when it is on
@@ -52,6 +62,46 @@ namespace
 	glm::vec3 defaultCameraFront = glm::normalize(glm::vec3(0.0f, -0.1f, -1.0f));
 	glm::vec3 orthographicCameraPosition = glm::vec3(0.0f, 0.0f, 10.0f); // very head-on view
 	glm::vec3 orthographicCameraFront = glm::vec3(0.0f, 0.0f, -1.0f); // Direct front view with floor plane hidden
+	float orthographicHalfHeight = 6.75f; // what the default zoom shows at the scene's center from there
+
+	// camera placements compared against baselines by the regression
+	// run, the first two match the P and O keys
+	struct REFERENCE_VIEW
+	{
+		const char* name;
+		glm::vec3 position;
+		glm::vec3 front;
+		float zoom;
+		bool bOrthographic;
+	};
+	const REFERENCE_VIEW g_ReferenceViews[] =
+	{
+		{ "perspective", default3dCameraPosition, defaultCameraFront, (float)defaultCameraZoom, false },
+		{ "orthographic", orthographicCameraPosition, orthographicCameraFront, (float)defaultCameraZoom, true },
+		// the original overview camera, sees the whole floor
+		{ "overview", glm::vec3(0.0f, 9.0f, 18.0f), glm::normalize(glm::vec3(0.0f, -0.8f, -3.0f)), 80.0f, false },
+	};
+	const int REFERENCE_VIEW_COUNT = sizeof(g_ReferenceViews) / sizeof(g_ReferenceViews[0]);
+
+	// the split frame keeps the camera on the left and stacks two fixed
+	// orthographic views on the right, front above top
+	const float MULTI_VIEW_SPLIT = 0.7f;
+	struct ORTHOGRAPHIC_VIEW
+	{
+		glm::vec3 position;
+		glm::vec3 front;
+		glm::vec3 up;
+		float halfHeight;
+		glm::vec4 rectangle;
+	};
+	const ORTHOGRAPHIC_VIEW g_OrthographicViews[] =
+	{
+		{ glm::vec3(0.0f, 3.0f, 12.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f), 6.0f,
+			glm::vec4(MULTI_VIEW_SPLIT, 0.5f, 1.0f - MULTI_VIEW_SPLIT, 0.5f) },
+		{ glm::vec3(0.0f, 20.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f), 10.0f,
+			glm::vec4(MULTI_VIEW_SPLIT, 0.0f, 1.0f - MULTI_VIEW_SPLIT, 0.5f) },
+	};
+	const int ORTHOGRAPHIC_VIEW_COUNT = sizeof(g_OrthographicViews) / sizeof(g_OrthographicViews[0]);
 }
 
 /***********************************************************
@@ -65,6 +115,18 @@ ViewManager::ViewManager(
 	// initialize the member variables
 	m_pShaderManager = pShaderManager;
 	m_pWindow = NULL;
+	m_frameState.viewProjection = glm::mat4(1.0f);
+	m_frameIndex = 0;
+	m_aspectRatio = (float)WINDOW_WIDTH / (float)WINDOW_HEIGHT;
+	m_windowlessWidth = 0;
+	m_windowlessHeight = 0;
+	m_pRecording = NULL;
+	m_recordingStart = -1.0;
+	m_pReplay = NULL;
+	m_replayStep = 0.0;
+	m_replayFrame = 0;
+	m_bMultiView = false;
+	m_bMultiViewKeyDown = false;
 	g_pCamera = new Camera();
 
 	// default camera view parameters
@@ -93,6 +155,9 @@ ViewManager::~ViewManager()
 	// free up allocated memory
 	m_pShaderManager = NULL;
 	m_pWindow = NULL;
+	m_pRecording = NULL;
+	m_pReplay = NULL;
+	gbCameraReplay = false;
 	if (NULL != g_pCamera)
 	{
 		delete g_pCamera;
@@ -123,9 +188,9 @@ GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
 	}
 	glfwMakeContextCurrent(window);
 
-	// enable blending for supporting tranparent rendering
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	// blending stays off, the scene turns it on for its transparent
+	// draws only (see WeightedTransparency)
+	GLStateCache::SetEnabled(GL_BLEND, false);
 
 	//Addition for scroll callback
 	glfwSetScrollCallback(window, &ViewManager::Scroll_Callback);
@@ -149,10 +214,16 @@ GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
  *  This method is automatically called from GLFW whenever
  *  the mouse is moved within the active GLFW display window.
  ***********************************************************/
-void ViewManager::Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos)
+void ViewManager::Mouse_Position_Callback(GLFWwindow*, double xMousePos, double yMousePos)
 {
 	//std::cout << "aa11" << std::endl; //debug code
 
+	// a replayed camera does not follow the mouse
+	if (gbCameraReplay)
+	{
+		return;
+	}
+
 	// when the first mouse move event is received, this needs to be recorded so that
 	// all subsequent mouse moves can correctly calculate the X position offset and Y
 	// position offset for proper operation
@@ -183,15 +254,19 @@ void ViewManager::Mouse_Position_Callback(GLFWwindow* window, double xMousePos,
  *  This method is automatically called from GLFW whenever
  *  the mouse is scrolled within the active GLFW display window.
  ***********************************************************/
-void ViewManager::Scroll_Callback(GLFWwindow* window, double xoffset, double yoffset)
+void ViewManager::Scroll_Callback(GLFWwindow*, double, double yoffset)
 {
 	float sensitivity = 0.5f; //to choose how much it adjusts by. Picked through testing different values
 	float speedUpperBound = 20.0;  //to avoid getting uncontrollably fast
 	float speedLowerBound = 0.1; //to avoid negative numbers
+	if (gbCameraReplay)
+	{
+		return;
+	}
 	//printf("the speed was %f", cameraSpeed); //line dor debugging
 	// Adjust camera speed based on scroll (yoffset >0 (scrolling up) causes faster zoom <0 (slowing down) causes slower zoom)
 
-	gCameraSpeed += (float)yoffset * 0.5f;
+	gCameraSpeed += (float)yoffset * sensitivity;
 	//printf("the speed is %f", cameraSpeed);//line for debugging
 
 	if (gCameraSpeed < speedLowerBound)
@@ -222,6 +297,14 @@ void ViewManager::ProcessKeyboardEvents()
 	{
 		glfwSetWindowShouldClose(m_pWindow, true);
 	}
+
+	// split or unsplit the frame once per press of V
+	bool bMultiViewKeyDown = (glfwGetKey(m_pWindow, GLFW_KEY_V) == GLFW_PRESS);
+	if (bMultiViewKeyDown && !m_bMultiViewKeyDown)
+	{
+		m_bMultiView = !m_bMultiView;
+	}
+	m_bMultiViewKeyDown = bMultiViewKeyDown;
 	
 
 	// if the camera object is null, then exit this method
@@ -230,6 +313,12 @@ void ViewManager::ProcessKeyboardEvents()
 		return;
 	}
 
+	// a replayed camera only listens to the escape key
+	if (gbCameraReplay)
+	{
+		return;
+	}
+
 	// process camera zooming in and out
 	if (glfwGetKey(m_pWindow, GLFW_KEY_W) == GLFW_PRESS)
 	{
@@ -311,40 +400,264 @@ void ViewManager::ProcessKeyboardEvents()
 
 
 /***********************************************************
- *  PrepareSceneView()
+ *  SetFramebufferSize()
  *
- *  This method is used for preparing the 3D scene by loading
- *  the shapes, textures in memory to support the 3D scene 
- *  rendering
+ *  This method is used for setting the size of the frames
+ *  when they are drawn without a window.
  ***********************************************************/
-void ViewManager::PrepareSceneView()
+void ViewManager::SetFramebufferSize(int width, int height)
 {
-	glm::mat4 view;
-	glm::mat4 projection;
+	m_windowlessWidth = width;
+	m_windowlessHeight = height;
+}
 
-	// per-frame timing
-	float currentFrame = glfwGetTime();
-	gDeltaTime = currentFrame - gLastFrame;
-	gLastFrame = currentFrame;
+/***********************************************************
+ *  UpdateSceneView()
+ *
+ *  This method is used for advancing the camera from the
+ *  queued input and writing the resulting view into the
+ *  passed in snapshot. It makes no OpenGL calls, so it can
+ *  run on the thread that polls the window events while
+ *  another thread renders.
+ ***********************************************************/
+void ViewManager::UpdateSceneView(FRAME_STATE& frameState)
+{
+	// per-frame timing, a replay advances by its fixed step whatever
+	// the time between updates was
+	double currentFrame = 0.0;
+	if (NULL != m_pReplay)
+	{
+		currentFrame = (double)m_replayFrame * m_replayStep;
+		gDeltaTime = (float)m_replayStep;
+		m_replayFrame++;
+	}
+	else if (NULL != m_pWindow)
+	{
+		currentFrame = glfwGetTime();
+		gDeltaTime = (float)gDeltaSmoother.Update(currentFrame - gLastFrame);
+		gLastFrame = currentFrame;
+	}
 
 	// process any keyboard events that may be waiting in the 
 	// event queue
-	ProcessKeyboardEvents();
+	if (NULL != m_pWindow)
+	{
+		ProcessKeyboardEvents();
+	}
+
+	if (NULL != m_pReplay)
+	{
+		CAMERA_SAMPLE sample = m_pReplay->Sample(currentFrame);
+		g_pCamera->Position = sample.position;
+		g_pCamera->Front = sample.front;
+		g_pCamera->Up = sample.up;
+		g_pCamera->Zoom = sample.zoom;
+	}
+	else if (NULL != m_pRecording)
+	{
+		if (m_recordingStart < 0.0)
+		{
+			m_recordingStart = currentFrame;
+		}
+		CAMERA_SAMPLE sample;
+		sample.time = currentFrame - m_recordingStart;
+		sample.position = g_pCamera->Position;
+		sample.front = g_pCamera->Front;
+		sample.up = g_pCamera->Up;
+		sample.zoom = g_pCamera->Zoom;
+		m_pRecording->Record(sample);
+	}
 
 	// get the current view matrix from the camera
-	view = g_pCamera->GetViewMatrix();
+	frameState.view = g_pCamera->GetViewMatrix();
+
+	// pick up window resizes, a minimized window reports an empty
+	// framebuffer and keeps the previous aspect ratio
+	int framebufferWidth = m_windowlessWidth;
+	int framebufferHeight = m_windowlessHeight;
+	if (NULL != m_pWindow)
+	{
+		glfwGetFramebufferSize(m_pWindow, &framebufferWidth, &framebufferHeight);
+	}
+	if ((framebufferWidth > 0) && (framebufferHeight > 0))
+	{
+		m_aspectRatio = (float)framebufferWidth / (float)framebufferHeight;
+	}
+	frameState.framebufferWidth = framebufferWidth;
+	frameState.framebufferHeight = framebufferHeight;
+
+	// define the current projection matrix, the camera only gets its
+	// part of the width when the frame is split
+	float cameraWidth = m_bMultiView ? MULTI_VIEW_SPLIT : 1.0f;
+	frameState.nearPlane = 0.1f;
+	frameState.farPlane = 100.0f;
+	if (bOrthographicProjection)
+	{
+		float halfWidth = orthographicHalfHeight * m_aspectRatio * cameraWidth;
+		frameState.projection = glm::ortho(-halfWidth, halfWidth, -orthographicHalfHeight, orthographicHalfHeight,
+			frameState.nearPlane, frameState.farPlane);
+	}
+	else
+	{
+		frameState.projection = glm::perspective(glm::radians(g_pCamera->Zoom), m_aspectRatio * cameraWidth, frameState.nearPlane, frameState.farPlane);
+	}
+	frameState.bOrthographic = bOrthographicProjection;
+	frameState.viewProjection = frameState.projection * frameState.view;
+	frameState.viewPosition = g_pCamera->Position;
+	frameState.time = currentFrame;
+	frameState.frameIndex = m_frameIndex++;
+	UpdateFrameViews(frameState);
+}
+
+/***********************************************************
+ *  UpdateFrameViews()
+ *
+ *  This method is used for listing the views a snapshot is
+ *  drawn from: the camera alone, or the camera next to the
+ *  orthographic views when the frame is split.
+ ***********************************************************/
+void ViewManager::UpdateFrameViews(FRAME_STATE& frameState) const
+{
+	FRAME_VIEW& cameraView = frameState.views[0];
+	cameraView.viewProjection = frameState.viewProjection;
+	cameraView.viewPosition = frameState.viewPosition;
+	cameraView.rectangle = glm::vec4(0.0f, 0.0f, m_bMultiView ? MULTI_VIEW_SPLIT : 1.0f, 1.0f);
+	frameState.viewCount = 1;
+	if (!m_bMultiView)
+	{
+		return;
+	}
 
-	// define the current projection matrix
-	projection = glm::perspective(glm::radians(g_pCamera->Zoom), (GLfloat)WINDOW_WIDTH / (GLfloat)WINDOW_HEIGHT, 0.1f, 100.0f);
+	for (int i = 0; (i < ORTHOGRAPHIC_VIEW_COUNT) && (frameState.viewCount < MAX_FRAME_VIEWS); i++)
+	{
+		const ORTHOGRAPHIC_VIEW& orthographic = g_OrthographicViews[i];
+		float aspectRatio = m_aspectRatio * orthographic.rectangle.z / orthographic.rectangle.w;
+		float halfWidth = orthographic.halfHeight * aspectRatio;
+		glm::mat4 view = glm::lookAt(orthographic.position, orthographic.position + orthographic.front, orthographic.up);
+		glm::mat4 projection = glm::ortho(-halfWidth, halfWidth, -orthographic.halfHeight, orthographic.halfHeight,
+			frameState.nearPlane, frameState.farPlane);
+
+		FRAME_VIEW& frameView = frameState.views[frameState.viewCount++];
+		frameView.viewProjection = projection * view;
+		frameView.viewPosition = orthographic.position;
+		frameView.rectangle = orthographic.rectangle;
+	}
+}
 
+/***********************************************************
+ *  ApplySceneView()
+ *
+ *  This method is used for passing a view snapshot into the
+ *  shader. It must run on the thread that owns the context.
+ ***********************************************************/
+void ViewManager::ApplySceneView(const FRAME_STATE& frameState)
+{
 	// if the shader manager object is valid
 	if (NULL != m_pShaderManager)
 	{
 		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ViewName, view);
+		m_pShaderManager->setMat4Value(g_ViewName, frameState.view);
 		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ProjectionName, projection);
+		m_pShaderManager->setMat4Value(g_ProjectionName, frameState.projection);
 		// set the view position of the camera into the shader for proper rendering
-		m_pShaderManager->setVec3Value("viewPosition", g_pCamera->Position);
+		m_pShaderManager->setVec3Value("viewPosition", frameState.viewPosition);
 	}
-}
\ No newline at end of file
+}
+
+/***********************************************************
+ *  GetReferenceViewCount()
+ *
+ *  This method returns the number of reference views.
+ ***********************************************************/
+int ViewManager::GetReferenceViewCount() const
+{
+	return(REFERENCE_VIEW_COUNT);
+}
+
+/***********************************************************
+ *  SetReferenceView()
+ *
+ *  This method is used for placing the camera at one of the
+ *  reference views, so later snapshots are taken from it.
+ ***********************************************************/
+const char* ViewManager::SetReferenceView(int index)
+{
+	if ((index < 0) || (index >= REFERENCE_VIEW_COUNT) || (NULL == g_pCamera))
+	{
+		return(NULL);
+	}
+
+	const REFERENCE_VIEW& view = g_ReferenceViews[index];
+	g_pCamera->Position = view.position;
+	g_pCamera->Front = view.front;
+	g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
+	g_pCamera->Zoom = view.zoom;
+	bOrthographicProjection = view.bOrthographic;
+	return(view.name);
+}
+
+/***********************************************************
+ *  SetCameraRecording()
+ *
+ *  This method is used for recording the camera into a path
+ *  from the next update on, the path's first sample is at
+ *  time 0.
+ ***********************************************************/
+void ViewManager::SetCameraRecording(CameraPath* pPath)
+{
+	m_pRecording = pPath;
+	m_recordingStart = -1.0;
+}
+
+/***********************************************************
+ *  SetCameraReplay()
+ *
+ *  This method is used for replaying a camera path from its
+ *  start. The snapshot times follow the replay as well, so
+ *  the scene animation comes out the same on every run.
+ ***********************************************************/
+void ViewManager::SetCameraReplay(const CameraPath* pPath, double timeStep)
+{
+	m_pReplay = pPath;
+	m_replayStep = timeStep;
+	m_replayFrame = 0;
+	gbCameraReplay = (NULL != pPath);
+}
+
+/***********************************************************
+ *  IsReplayFinished()
+ *
+ *  This method tells whether the replayed path has ended.
+ ***********************************************************/
+bool ViewManager::IsReplayFinished() const
+{
+	if (NULL == m_pReplay)
+	{
+		return(true);
+	}
+	return((double)m_replayFrame * m_replayStep > m_pReplay->GetDuration());
+}
+
+/***********************************************************
+ *  SetMultiView()
+ *
+ *  This method is used for splitting the frame between the
+ *  camera and the orthographic views, from the next update.
+ ***********************************************************/
+void ViewManager::SetMultiView(bool bMultiView)
+{
+	m_bMultiView = bMultiView;
+}
+
+/***********************************************************
+ *  PrepareSceneView()
+ *
+ *  This method is used for preparing the 3D scene by loading
+ *  the shapes, textures in memory to support the 3D scene 
+ *  rendering
+ ***********************************************************/
+void ViewManager::PrepareSceneView()
+{
+	UpdateSceneView(m_frameState);
+	ApplySceneView(m_frameState);
+}
\ No newline at end of file
@@ -10,6 +10,8 @@
 #pragma once
 
 #include "ShaderManager.h"
+#include "FrameState.h"
+#include "CameraPath.h"
 #include "camera.h"
 
 // GLFW library
@@ -40,7 +42,56 @@ private:
 public:
 	// create the initial OpenGL display window
 	GLFWwindow* CreateDisplayWindow(const char* windowTitle);
+	// framebuffer size of a headless run, which has no window to ask
+	// and no input to process
+	void SetFramebufferSize(int width, int height);
 	
 	// prepare the conversion from 3D object display to 2D scene display
 	void PrepareSceneView();
-};
\ No newline at end of file
+
+	// update thread: process input, move the camera and fill a snapshot
+	void UpdateSceneView(FRAME_STATE& frameState);
+	// render thread: pass a snapshot into the shader
+	void ApplySceneView(const FRAME_STATE& frameState);
+
+	// fixed camera placements rendered by the regression run
+	int GetReferenceViewCount() const;
+	// move the camera to a reference view, returns the view's name
+	const char* SetReferenceView(int index);
+
+	// store the camera after every update into a path, NULL stops
+	void SetCameraRecording(CameraPath* pPath);
+	// drive the camera from a path instead of the input, one fixed
+	// time step per update; NULL goes back to the input
+	void SetCameraReplay(const CameraPath* pPath, double timeStep);
+	// the replay has passed the end of its path
+	bool IsReplayFinished() const;
+
+	// split the frame between the camera and orthographic front and
+	// top views, the V key toggles it as well
+	void SetMultiView(bool bMultiView);
+
+private:
+	// snapshot used by the single threaded PrepareSceneView()
+	FRAME_STATE m_frameState;
+	// number of snapshots produced so far
+	unsigned long long m_frameIndex;
+	// aspect ratio of the last framebuffer size that was not empty
+	float m_aspectRatio;
+	// framebuffer size used while there is no window
+	int m_windowlessWidth;
+	int m_windowlessHeight;
+	// camera path being recorded and the time its recording started
+	CameraPath* m_pRecording;
+	double m_recordingStart;
+	// camera path being replayed, its step and the updates made so far
+	const CameraPath* m_pReplay;
+	double m_replayStep;
+	unsigned long long m_replayFrame;
+	// frame split between several views, and the toggle key's last state
+	bool m_bMultiView;
+	bool m_bMultiViewKeyDown;
+
+	// fill the views of a snapshot whose camera is already set
+	void UpdateFrameViews(FRAME_STATE& frameState) const;
+};
\ No newline at end of file
@@ -0,0 +1,182 @@
+///////////////////////////////////////////////////////////////////////////////
+// weightedtransparency.cpp
+// ============
+// order independent transparency by weighted blended accumulation
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "WeightedTransparency.h"
+#include "GLProgram.h"
+#include "GLStateCache.h"
+
+#include <iostream>
+
+namespace
+{
+	// below the HDR target (14) and the shadow map (15), must match the
+	// sampler bindings in transparencyCompositeFragment.glsl
+	const int ACCUMULATION_TEXTURE_UNIT = 12;
+	const int REVEALAGE_TEXTURE_UNIT = 13;
+}
+
+/***********************************************************
+ *  WeightedTransparency()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+WeightedTransparency::WeightedTransparency()
+{
+	m_framebuffer = 0;
+	m_accumulationTexture = 0;
+	m_revealageTexture = 0;
+	m_sceneFramebuffer = 0;
+	m_compositeProgram = 0;
+	m_emptyVertexArray = 0;
+}
+
+/***********************************************************
+ *  ~WeightedTransparency()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+WeightedTransparency::~WeightedTransparency()
+{
+	DestroyTargets();
+	glDeleteVertexArrays(1, &m_emptyVertexArray);
+	glDeleteProgram(m_compositeProgram);
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method loads the composite program, which draws a
+ *  full screen triangle like the tone mapping.
+ ***********************************************************/
+bool WeightedTransparency::Initialize()
+{
+	m_compositeProgram = LoadGLProgram("tonemapVertex.glsl", "transparencyCompositeFragment.glsl");
+	if (m_compositeProgram == 0)
+	{
+		return(false);
+	}
+	glGenVertexArrays(1, &m_emptyVertexArray);
+	return(true);
+}
+
+/***********************************************************
+ *  CreateTargets()
+ *
+ *  This method creates the accumulation and revealage
+ *  textures and a framebuffer that draws into them with
+ *  the depth texture of the scene.
+ ***********************************************************/
+bool WeightedTransparency::CreateTargets(int width, int height, GLuint depthTexture, GLuint sceneFramebuffer)
+{
+	DestroyTargets();
+	if (m_compositeProgram == 0)
+	{
+		return(false);
+	}
+	m_sceneFramebuffer = sceneFramebuffer;
+
+	glGenTextures(1, &m_accumulationTexture);
+	GLStateCache::BindTexture(0, GL_TEXTURE_2D, m_accumulationTexture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA16F, width, height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	glGenTextures(1, &m_revealageTexture);
+	GLStateCache::BindTexture(0, GL_TEXTURE_2D, m_revealageTexture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8, width, height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	GLStateCache::BindTexture(0, GL_TEXTURE_2D, 0);
+
+	glGenFramebuffers(1, &m_framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_accumulationTexture, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, m_revealageTexture, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+	const GLenum drawBuffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+	glDrawBuffers(2, drawBuffers);
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "ERROR: transparency framebuffer is incomplete" << std::endl;
+		DestroyTargets();
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  DestroyTargets()
+ *
+ *  This method releases the targets, the depth texture
+ *  belongs to the scene target.
+ ***********************************************************/
+void WeightedTransparency::DestroyTargets()
+{
+	glDeleteFramebuffers(1, &m_framebuffer);
+	GLStateCache::DeleteTexture(m_accumulationTexture);
+	GLStateCache::DeleteTexture(m_revealageTexture);
+	m_framebuffer = 0;
+	m_accumulationTexture = 0;
+	m_revealageTexture = 0;
+	m_sceneFramebuffer = 0;
+}
+
+/***********************************************************
+ *  BeginTransparency()
+ *
+ *  This method clears the accumulation to nothing and the
+ *  revealage to fully revealed, then sets up additive
+ *  accumulation and multiplicative revealage. The viewport
+ *  is left as the scene set it.
+ ***********************************************************/
+void WeightedTransparency::BeginTransparency()
+{
+	const GLfloat clearAccumulation[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	const GLfloat clearRevealage[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glClearBufferfv(GL_COLOR, 0, clearAccumulation);
+	glClearBufferfv(GL_COLOR, 1, clearRevealage);
+
+	// surfaces behind the opaque ones are still rejected, but no
+	// transparent surface may hide another
+	GLStateCache::DepthMask(false);
+	GLStateCache::SetEnabled(GL_BLEND, true);
+	GLStateCache::BlendFunci(0, GL_ONE, GL_ONE);
+	GLStateCache::BlendFunci(1, GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
+}
+
+/***********************************************************
+ *  Composite()
+ *
+ *  This method blends the average transparent color over
+ *  the scene target, weighted by how much of the scene the
+ *  transparent surfaces cover.
+ ***********************************************************/
+void WeightedTransparency::Composite()
+{
+	GLuint previousProgram = GLStateCache::GetProgram();
+	bool bDepthTest = GLStateCache::IsEnabled(GL_DEPTH_TEST);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, m_sceneFramebuffer);
+	GLStateCache::SetEnabled(GL_DEPTH_TEST, false);
+	GLStateCache::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GLStateCache::BindTexture(ACCUMULATION_TEXTURE_UNIT, GL_TEXTURE_2D, m_accumulationTexture);
+	GLStateCache::BindTexture(REVEALAGE_TEXTURE_UNIT, GL_TEXTURE_2D, m_revealageTexture);
+	GLStateCache::UseProgram(m_compositeProgram);
+	GLStateCache::BindVertexArray(m_emptyVertexArray);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+
+	GLStateCache::SetEnabled(GL_BLEND, false);
+	GLStateCache::SetEnabled(GL_DEPTH_TEST, bDepthTest);
+	GLStateCache::DepthMask(true);
+	GLStateCache::UseProgram(previousProgram);
+}
@@ -0,0 +1,65 @@
+///////////////////////////////////////////////////////////////////////////////
+// weightedtransparency.h
+// ============
+// order independent transparency by weighted blended accumulation
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+/***********************************************************
+ *  WeightedTransparency
+ *
+ *  This class draws the transparent surfaces of the scene
+ *  in any order. They are blended into two targets that
+ *  share the scene's depth buffer, with depth writes off:
+ *
+ *    accumulation  RGBA16F  sum of weighted premultiplied
+ *                           color (rgb) and weighted alpha (a)
+ *    revealage     R8       product of (1 - alpha), the share
+ *                           of the background still visible
+ *
+ *  The weight falls off with depth, so nearer surfaces win
+ *  where several overlap. One full screen composite then
+ *  blends the weighted average color over the lit scene by
+ *  the coverage. The cost is the same whatever the order
+ *  and number of transparent surfaces, the price is that
+ *  overlapping colors are averaged instead of layered.
+ ***********************************************************/
+class WeightedTransparency
+{
+public:
+	// constructor
+	WeightedTransparency();
+	// destructor
+	~WeightedTransparency();
+
+	// load the composite program
+	bool Initialize();
+	// create the targets at the scene target's size around its depth
+	// texture; the scene framebuffer receives the composite
+	bool CreateTargets(int width, int height, GLuint depthTexture, GLuint sceneFramebuffer);
+	void DestroyTargets();
+	bool IsReady() const { return((m_framebuffer != 0) && (m_compositeProgram != 0)); }
+
+	// redirect the following draws into the cleared targets, with
+	// the blending they need and depth writes off
+	void BeginTransparency();
+	// blend the accumulated surfaces over the scene target and
+	// leave blending off and depth writes on again
+	void Composite();
+
+private:
+	GLuint m_framebuffer;
+	GLuint m_accumulationTexture;
+	GLuint m_revealageTexture;
+	GLuint m_sceneFramebuffer;
+
+	GLuint m_compositeProgram;
+	// core profile needs a bound vertex array even without attributes
+	GLuint m_emptyVertexArray;
+};
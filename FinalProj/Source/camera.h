@@ -0,0 +1,161 @@
+///////////////////////////////////////////////////////////////////////////////
+// camera.h
+// ============
+// the fly camera of the scene, with the same interface as the course
+// utilities' camera.h
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+
+// directions the keyboard moves the camera in
+enum Camera_Movement
+{
+	FORWARD,
+	BACKWARD,
+	LEFT,
+	RIGHT,
+	UP,
+	DOWN
+};
+
+/***********************************************************
+ *  Camera
+ *
+ *  This class keeps the camera's position and orientation.
+ *  The orientation comes from the yaw and pitch angles in
+ *  degrees, but the vectors are public and can be set
+ *  directly; the next mouse movement turns the camera from
+ *  the angles again. Zoom is the vertical field of view in
+ *  degrees.
+ ***********************************************************/
+class Camera
+{
+public:
+	glm::vec3 Position;
+	glm::vec3 Front;
+	glm::vec3 Up;
+	glm::vec3 Right;
+	glm::vec3 WorldUp;
+	float Yaw;
+	float Pitch;
+	float MovementSpeed;
+	float MouseSensitivity;
+	float Zoom;
+
+	/***********************************************************
+	 *  Camera()
+	 *
+	 *  The constructor for the class
+	 ***********************************************************/
+	Camera(
+		glm::vec3 position = glm::vec3(0.0f, 0.0f, 0.0f),
+		glm::vec3 worldUp = glm::vec3(0.0f, 1.0f, 0.0f),
+		float yaw = -90.0f,
+		float pitch = 0.0f)
+	{
+		Position = position;
+		WorldUp = worldUp;
+		Yaw = yaw;
+		Pitch = pitch;
+		MovementSpeed = 2.5f;
+		MouseSensitivity = 0.1f;
+		Zoom = 45.0f;
+		UpdateCameraVectors();
+	}
+
+	/***********************************************************
+	 *  GetViewMatrix()
+	 *
+	 *  This method returns the view matrix of the camera.
+	 ***********************************************************/
+	glm::mat4 GetViewMatrix() const
+	{
+		return(glm::lookAt(Position, Position + Front, Up));
+	}
+
+	/***********************************************************
+	 *  ProcessKeyboard()
+	 *
+	 *  This method moves the camera along its own axes at its
+	 *  movement speed for the given time.
+	 ***********************************************************/
+	void ProcessKeyboard(Camera_Movement direction, float deltaTime)
+	{
+		float distance = MovementSpeed * deltaTime;
+		switch (direction)
+		{
+		case FORWARD:
+			Position += Front * distance;
+			break;
+		case BACKWARD:
+			Position -= Front * distance;
+			break;
+		case LEFT:
+			Position -= Right * distance;
+			break;
+		case RIGHT:
+			Position += Right * distance;
+			break;
+		case UP:
+			Position += Up * distance;
+			break;
+		case DOWN:
+			Position -= Up * distance;
+			break;
+		}
+	}
+
+	/***********************************************************
+	 *  ProcessMouseMovement()
+	 *
+	 *  This method turns the camera by the mouse movement,
+	 *  keeping the pitch short of straight up or down when
+	 *  constrained.
+	 ***********************************************************/
+	void ProcessMouseMovement(float xOffset, float yOffset, bool bConstrainPitch = true)
+	{
+		Yaw += xOffset * MouseSensitivity;
+		Pitch += yOffset * MouseSensitivity;
+		if (bConstrainPitch)
+		{
+			Pitch = glm::clamp(Pitch, -89.0f, 89.0f);
+		}
+		UpdateCameraVectors();
+	}
+
+	/***********************************************************
+	 *  ProcessMouseScroll()
+	 *
+	 *  This method narrows or widens the field of view.
+	 ***********************************************************/
+	void ProcessMouseScroll(float yOffset)
+	{
+		Zoom = glm::clamp(Zoom - yOffset, 1.0f, 45.0f);
+	}
+
+private:
+	/***********************************************************
+	 *  UpdateCameraVectors()
+	 *
+	 *  This method derives the front, right and up vectors
+	 *  from the yaw and pitch.
+	 ***********************************************************/
+	void UpdateCameraVectors()
+	{
+		glm::vec3 front;
+		front.x = std::cos(glm::radians(Yaw)) * std::cos(glm::radians(Pitch));
+		front.y = std::sin(glm::radians(Pitch));
+		front.z = std::sin(glm::radians(Yaw)) * std::cos(glm::radians(Pitch));
+		Front = glm::normalize(front);
+		Right = glm::normalize(glm::cross(Front, WorldUp));
+		Up = glm::normalize(glm::cross(Right, Front));
+	}
+};
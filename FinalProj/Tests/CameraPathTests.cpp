@@ -0,0 +1,79 @@
+///////////////////////////////////////////////////////////////////////////////
+// camerapathtests.cpp
+// ============
+// recording, file round trip and sampling of camera paths
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "CameraPath.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+
+namespace
+{
+	CAMERA_SAMPLE MakeSample(double time, float x)
+	{
+		CAMERA_SAMPLE sample;
+		sample.time = time;
+		sample.position = glm::vec3(x, 1.0f, 2.0f);
+		sample.front = glm::vec3(0.0f, 0.0f, -1.0f);
+		sample.up = glm::vec3(0.0f, 1.0f, 0.0f);
+		sample.zoom = 45.0f;
+		return(sample);
+	}
+}
+
+TEST(CameraPathTests, SaveAndLoadKeepTheSamples)
+{
+	CameraPath path;
+	path.BeginRecording(100);
+	for (int i = 0; i < 100; i++)
+	{
+		EXPECT_TRUE(path.Record(MakeSample(i * 0.25, (float)i)));
+	}
+	// the recording is full, later samples are dropped
+	EXPECT_FALSE(path.Record(MakeSample(100.0, 0.0f)));
+
+	const char* filename = "camerapath_roundtrip.camp";
+	ASSERT_TRUE(path.Save(filename));
+	CameraPath loaded;
+	ASSERT_TRUE(loaded.Load(filename));
+	std::remove(filename);
+
+	ASSERT_EQ(loaded.GetSampleCount(), 100u);
+	EXPECT_DOUBLE_EQ(loaded.GetDuration(), 99 * 0.25);
+	EXPECT_FLOAT_EQ(loaded.Sample(10.0).position.x, 40.0f);
+	// halfway between two samples, and held at both ends
+	EXPECT_FLOAT_EQ(loaded.Sample(10.125).position.x, 40.5f);
+	EXPECT_FLOAT_EQ(loaded.Sample(-1.0).position.x, 0.0f);
+	EXPECT_FLOAT_EQ(loaded.Sample(1000.0).position.x, 99.0f);
+}
+
+TEST(CameraPathTests, CountBeyondTheFileIsRejected)
+{
+	CameraPath path;
+	path.BeginRecording(4);
+	for (int i = 0; i < 4; i++)
+	{
+		path.Record(MakeSample(i, (float)i));
+	}
+	const char* filename = "camerapath_damaged.camp";
+	ASSERT_TRUE(path.Save(filename));
+
+	// claim far more samples than the file holds
+	std::fstream file(filename, std::ios::in | std::ios::out | std::ios::binary);
+	file.seekp(8);
+	uint32_t count = 0x7FFFFFFF;
+	file.write((const char*)&count, sizeof(count));
+	file.close();
+
+	CameraPath loaded;
+	EXPECT_FALSE(loaded.Load(filename));
+	std::remove(filename);
+}
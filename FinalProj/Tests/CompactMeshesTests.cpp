@@ -0,0 +1,141 @@
+///////////////////////////////////////////////////////////////////////////////
+// compactmeshestests.cpp
+// ============
+// CPU steps of the compact meshes: cache order, quantization and meshlets
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "CompactMeshes.h"
+#include "TestGeometry.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <set>
+
+namespace
+{
+	typedef std::array<uint32_t, 3> TRIANGLE;
+
+	std::vector<TRIANGLE> SortedTriangles(const std::vector<uint32_t>& indices)
+	{
+		std::vector<TRIANGLE> triangles;
+		for (size_t i = 0; i + 2 < indices.size(); i += 3)
+		{
+			TRIANGLE triangle = { { indices[i], indices[i + 1], indices[i + 2] } };
+			triangles.push_back(triangle);
+		}
+		std::sort(triangles.begin(), triangles.end());
+		return(triangles);
+	}
+
+	// vertices transformed again by a 32 entry LRU post-transform cache
+	int CacheMisses(const std::vector<uint32_t>& indices)
+	{
+		std::vector<uint32_t> cache;
+		int misses = 0;
+		for (size_t i = 0; i < indices.size(); i++)
+		{
+			std::vector<uint32_t>::iterator found = std::find(cache.begin(), cache.end(), indices[i]);
+			if (found == cache.end())
+			{
+				misses++;
+			}
+			else
+			{
+				cache.erase(found);
+			}
+			cache.insert(cache.begin(), indices[i]);
+			if (cache.size() > 32)
+			{
+				cache.pop_back();
+			}
+		}
+		return(misses);
+	}
+}
+
+TEST(CompactMeshesTests, CacheOrderKeepsTheTrianglesAndMissesLess)
+{
+	std::vector<CompactMeshes::CAPTURED_VERTEX> vertices;
+	std::vector<uint32_t> indices;
+	MakeTestSphere(64, 32, vertices, indices);
+	std::vector<uint32_t> optimized = indices;
+	CompactMeshes::OptimizeVertexCache(optimized, vertices.size());
+
+	// the same triangles with the same winding, only in another order
+	EXPECT_EQ(SortedTriangles(optimized), SortedTriangles(indices));
+	EXPECT_LT(CacheMisses(optimized), CacheMisses(indices));
+}
+
+TEST(CompactMeshesTests, QuantizedPositionsDecodeWithinOneStep)
+{
+	std::vector<CompactMeshes::CAPTURED_VERTEX> vertices;
+	std::vector<uint32_t> indices;
+	MakeTestSphere(24, 12, vertices, indices);
+	CompactMeshes::COMPACT_MESH mesh;
+	CompactMeshes::Quantize(mesh, vertices);
+
+	ASSERT_EQ(mesh.vertices.size(), vertices.size());
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		for (int axis = 0; axis < 3; axis++)
+		{
+			float decoded = (float)mesh.vertices[i].position[axis] / 65535.0f * mesh.positionScale[axis] + mesh.positionBias[axis];
+			EXPECT_NEAR(decoded, vertices[i].position[axis], mesh.positionScale[axis] / 65535.0f);
+		}
+		EXPECT_EQ(mesh.vertices[i].padding, 0);
+	}
+}
+
+TEST(CompactMeshesTests, FlatMeshKeepsAUsableScale)
+{
+	std::vector<CompactMeshes::CAPTURED_VERTEX> vertices(3);
+	for (int i = 0; i < 3; i++)
+	{
+		vertices[i].position = glm::vec3((float)i, 0.5f, (float)(i * i));
+		vertices[i].normal = glm::vec3(0.0f, 1.0f, 0.0f);
+		vertices[i].texCoord = glm::vec2(0.0f);
+	}
+	CompactMeshes::COMPACT_MESH mesh;
+	CompactMeshes::Quantize(mesh, vertices);
+	EXPECT_EQ(mesh.positionScale.y, 1.0f);
+	EXPECT_EQ(mesh.positionBias.y, 0.5f);
+}
+
+TEST(CompactMeshesTests, MeshletsCoverTheIndicesWithinTheLimits)
+{
+	std::vector<CompactMeshes::CAPTURED_VERTEX> vertices;
+	CompactMeshes::COMPACT_MESH mesh;
+	MakeTestSphere(64, 32, vertices, mesh.indices);
+	CompactMeshes::OptimizeVertexCache(mesh.indices, vertices.size());
+	CompactMeshes::BuildMeshlets(mesh, vertices);
+
+	ASSERT_FALSE(mesh.meshlets.empty());
+	uint32_t nextIndex = 0;
+	for (size_t m = 0; m < mesh.meshlets.size(); m++)
+	{
+		const CompactMeshes::MESHLET& meshlet = mesh.meshlets[m];
+		EXPECT_EQ(meshlet.firstIndex, nextIndex);
+		EXPECT_EQ(meshlet.indexCount % 3, 0u);
+		EXPECT_LE((int)meshlet.indexCount / 3, (int)CompactMeshes::MESHLET_TRIANGLES);
+		nextIndex = meshlet.firstIndex + meshlet.indexCount;
+
+		std::set<uint32_t> meshletVertices(mesh.indices.begin() + meshlet.firstIndex,
+			mesh.indices.begin() + meshlet.firstIndex + meshlet.indexCount);
+		EXPECT_LE((int)meshletVertices.size(), (int)CompactMeshes::MESHLET_VERTICES);
+
+		// the bounds hold every vertex and the cone cutoff is a sine
+		glm::vec3 center(meshlet.sphere);
+		for (std::set<uint32_t>::const_iterator it = meshletVertices.begin(); it != meshletVertices.end(); ++it)
+		{
+			EXPECT_LE(glm::length(vertices[*it].position - center), meshlet.sphere.w * 1.0001f);
+		}
+		EXPECT_GE(meshlet.cone.w, 0.0f);
+		EXPECT_LE(meshlet.cone.w, 1.0f);
+	}
+	EXPECT_EQ(nextIndex, (uint32_t)mesh.indices.size());
+}
@@ -0,0 +1,103 @@
+///////////////////////////////////////////////////////////////////////////////
+// drawlisttests.cpp
+// ============
+// sort and merge order of the draw lists
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "DrawList.h"
+#include "TestGeometry.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+
+namespace
+{
+	const size_t ARENA_SIZE = 4 * 1024 * 1024;
+
+	// a spread of meshes, textures and materials from a fixed seed,
+	// the model translation records the order the packets were added
+	void FillList(DrawList& drawList, int packetCount, unsigned int seed, float listTag)
+	{
+		srand(seed);
+		for (int i = 0; i < packetCount; i++)
+		{
+			DRAW_PACKET packet = MakeTestPacket((SHAPE_MESH)(rand() % SHAPE_COUNT), rand() % 4 - 1, rand() % 3);
+			packet.model[3] = glm::vec4(listTag, (float)i, 0.0f, 1.0f);
+			drawList.Add(packet);
+		}
+	}
+}
+
+TEST(DrawListTests, SortOrdersByKeyAndKeepsRecordingOrder)
+{
+	FrameArena arena(ARENA_SIZE);
+	DrawList drawList;
+	drawList.Clear(&arena);
+	FillList(drawList, 500, 1, 0.0f);
+	drawList.Sort();
+
+	ASSERT_EQ(drawList.Size(), 500u);
+	for (size_t i = 1; i < drawList.Size(); i++)
+	{
+		const DRAW_PACKET& previous = drawList[i - 1];
+		const DRAW_PACKET& packet = drawList[i];
+		ASSERT_LE(previous.sortKey, packet.sortKey);
+		if (previous.sortKey == packet.sortKey)
+		{
+			EXPECT_LT(previous.model[3].y, packet.model[3].y);
+		}
+	}
+}
+
+TEST(DrawListTests, MergeSortedMatchesOneSortedList)
+{
+	FrameArena arena(ARENA_SIZE);
+	std::vector<DrawList> lists(5);
+	for (size_t i = 0; i < lists.size(); i++)
+	{
+		lists[i].Clear(&arena);
+		FillList(lists[i], 100 + (int)i * 37, 10 + (unsigned int)i, (float)i);
+		lists[i].Sort();
+	}
+	// one list stays empty, as a worker without objects would
+	lists.push_back(DrawList());
+	lists.back().Clear(&arena);
+	lists.back().Sort();
+
+	DrawList merged;
+	merged.Clear(&arena);
+	merged.MergeSorted(lists);
+
+	size_t total = 0;
+	for (size_t i = 0; i < lists.size(); i++)
+	{
+		total += lists[i].Size();
+	}
+	ASSERT_EQ(merged.Size(), total);
+	for (size_t i = 1; i < merged.Size(); i++)
+	{
+		const DRAW_PACKET& previous = merged[i - 1];
+		const DRAW_PACKET& packet = merged[i];
+		ASSERT_LE(previous.sortKey, packet.sortKey);
+		// equal keys come list by list, each in its recording order
+		if (previous.sortKey == packet.sortKey)
+		{
+			bool bSameList = (previous.model[3].x == packet.model[3].x);
+			EXPECT_TRUE((previous.model[3].x < packet.model[3].x) ||
+				(bSameList && (previous.model[3].y < packet.model[3].y)));
+		}
+	}
+}
+
+TEST(DrawListTests, SortKeyPutsMeshAboveTextureAboveMaterial)
+{
+	uint64_t base = DrawList::MakeSortKey(MakeTestPacket(SHAPE_BOX, 2, 5));
+	EXPECT_GT(DrawList::MakeSortKey(MakeTestPacket(SHAPE_CYLINDER, 0, 0)), base);
+	EXPECT_GT(DrawList::MakeSortKey(MakeTestPacket(SHAPE_BOX, 3, 0)), base);
+	EXPECT_GT(DrawList::MakeSortKey(MakeTestPacket(SHAPE_BOX, 2, 6)), base);
+	EXPECT_EQ(DrawList::MakeSortKey(MakeTestPacket(SHAPE_BOX, 2, 5)), base);
+}
@@ -0,0 +1,65 @@
+///////////////////////////////////////////////////////////////////////////////
+// framearenatests.cpp
+// ============
+// alignment, reset and overflow of the frame arena
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameArena.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+
+TEST(FrameArenaTests, AllocationsAreAlignedAndDisjoint)
+{
+	FrameArena arena(64 * 1024);
+	unsigned char* pPrevious = NULL;
+	size_t previousSize = 0;
+	const size_t alignments[] = { 1, 4, 16, 64, 256 };
+	for (int i = 0; i < 50; i++)
+	{
+		size_t alignment = alignments[i % 5];
+		size_t size = 1 + (size_t)i * 13;
+		unsigned char* pMemory = static_cast<unsigned char*>(arena.Allocate(size, alignment));
+		ASSERT_NE(pMemory, (unsigned char*)NULL);
+		EXPECT_EQ(reinterpret_cast<uintptr_t>(pMemory) % alignment, 0u);
+		if (NULL != pPrevious)
+		{
+			EXPECT_GE(pMemory, pPrevious + previousSize);
+		}
+		memset(pMemory, 0xAB, size);
+		pPrevious = pMemory;
+		previousSize = size;
+	}
+}
+
+TEST(FrameArenaTests, ResetReusesTheBlock)
+{
+	FrameArena arena(4096);
+	void* pFirst = arena.Allocate(100, 16);
+	EXPECT_GT(arena.GetUsed(), 0u);
+	arena.Reset();
+	EXPECT_EQ(arena.GetUsed(), 0u);
+	EXPECT_EQ(arena.Allocate(100, 16), pFirst);
+}
+
+TEST(FrameArenaTests, OverflowStillHandsOutAlignedMemory)
+{
+	FrameArena arena(1024);
+	arena.Allocate(1000, 8);
+	double* pValues = arena.AllocateArray<double>(1000);
+	ASSERT_NE(pValues, (double*)NULL);
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(pValues) % alignof(double), 0u);
+	for (int i = 0; i < 1000; i++)
+	{
+		pValues[i] = (double)i;
+	}
+	EXPECT_EQ(pValues[999], 999.0);
+	// the borrowed blocks go back at the reset
+	arena.Reset();
+	EXPECT_EQ(arena.GetUsed(), 0u);
+}
@@ -0,0 +1,72 @@
+///////////////////////////////////////////////////////////////////////////////
+// jobsystemtests.cpp
+// ============
+// coverage of the job system's parallel ranges
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "JobSystem.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+
+TEST(JobSystemTests, ParallelForRunsEveryIndexOnce)
+{
+	JobSystem jobs(4);
+	const int chunkSizes[] = { 1, 3, 64, 1000 };
+	for (int c = 0; c < 4; c++)
+	{
+		const int count = 997;
+		std::unique_ptr<std::atomic<int>[]> visits(new std::atomic<int>[count]);
+		for (int i = 0; i < count; i++)
+		{
+			visits[i] = 0;
+		}
+		std::atomic<bool> bBadWorker(false);
+		jobs.ParallelFor(count, chunkSizes[c], [&](int first, int last, int worker)
+			{
+				if ((worker < 0) || (worker >= jobs.GetWorkerCount()))
+				{
+					bBadWorker = true;
+				}
+				for (int i = first; i < last; i++)
+				{
+					visits[i]++;
+				}
+			});
+		EXPECT_FALSE(bBadWorker);
+		for (int i = 0; i < count; i++)
+		{
+			ASSERT_EQ(visits[i].load(), 1) << "index " << i << " chunk size " << chunkSizes[c];
+		}
+	}
+}
+
+TEST(JobSystemTests, EmptyRangeRunsNothing)
+{
+	JobSystem jobs(2);
+	std::atomic<int> calls(0);
+	jobs.ParallelFor(0, 16, [&](int, int, int) { calls++; });
+	EXPECT_EQ(calls.load(), 0);
+}
+
+TEST(JobSystemTests, RangesCanRunBackToBack)
+{
+	JobSystem jobs;
+	std::atomic<long long> total(0);
+	for (int run = 0; run < 100; run++)
+	{
+		jobs.ParallelFor(100, 7, [&](int first, int last, int)
+			{
+				for (int i = first; i < last; i++)
+				{
+					total += i;
+				}
+			});
+	}
+	EXPECT_EQ(total.load(), 100LL * 4950LL);
+}
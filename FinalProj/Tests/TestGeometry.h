@@ -0,0 +1,99 @@
+///////////////////////////////////////////////////////////////////////////////
+// testgeometry.h
+// ============
+// meshes and packets built in code for the tests and benchmarks
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "CompactMeshes.h"
+#include "DrawList.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  MakeTestSphere()
+ *
+ *  This function builds a welded UV sphere of unit radius,
+ *  its triangles in row order like the shape meshes emit
+ *  them, which is a poor order for the vertex cache.
+ ***********************************************************/
+inline void MakeTestSphere(int slices, int stacks,
+	std::vector<CompactMeshes::CAPTURED_VERTEX>& vertices,
+	std::vector<uint32_t>& indices)
+{
+	const float PI = 3.14159265f;
+	vertices.clear();
+	indices.clear();
+	for (int stack = 0; stack <= stacks; stack++)
+	{
+		float phi = PI * (float)stack / (float)stacks;
+		for (int slice = 0; slice <= slices; slice++)
+		{
+			float theta = 2.0f * PI * (float)slice / (float)slices;
+			CompactMeshes::CAPTURED_VERTEX vertex;
+			vertex.position = glm::vec3(std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta));
+			vertex.normal = vertex.position;
+			vertex.texCoord = glm::vec2((float)slice / (float)slices, 1.0f - (float)stack / (float)stacks);
+			vertices.push_back(vertex);
+		}
+	}
+	for (int stack = 0; stack < stacks; stack++)
+	{
+		for (int slice = 0; slice < slices; slice++)
+		{
+			uint32_t a = (uint32_t)(stack * (slices + 1) + slice);
+			uint32_t b = a + (uint32_t)slices + 1;
+			// the poles would give degenerate triangles
+			if (stack != 0)
+			{
+				indices.push_back(a);
+				indices.push_back(b);
+				indices.push_back(a + 1);
+			}
+			if (stack != stacks - 1)
+			{
+				indices.push_back(a + 1);
+				indices.push_back(b);
+				indices.push_back(b + 1);
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  MakeTestPacket()
+ *
+ *  This function fills a draw packet with the state the
+ *  sort key is built from and neutral values elsewhere.
+ ***********************************************************/
+inline DRAW_PACKET MakeTestPacket(SHAPE_MESH mesh, int textureSlot, int materialIndex)
+{
+	DRAW_PACKET packet = DRAW_PACKET();
+	packet.mesh = mesh;
+	packet.model = glm::mat4(1.0f);
+	packet.meltGroup = glm::mat4(1.0f);
+	packet.meltParams = glm::vec4(0.0f);
+	packet.bounds = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	packet.color = glm::vec4(1.0f);
+	packet.opacity = 1.0f;
+	packet.uvScale = glm::vec2(1.0f);
+	packet.uvOffset = glm::vec2(0.0f);
+	packet.uvScale2 = glm::vec2(1.0f);
+	packet.uvOffset2 = glm::vec2(0.0f);
+	packet.textureSlot = textureSlot;
+	packet.textureSlot2 = -1;
+	packet.proceduralTexture = -1;
+	packet.bDistanceField2 = false;
+	packet.materialIndex = materialIndex;
+	packet.reflectivity = 0.0f;
+	packet.cascadeMask = 0;
+	packet.bVisible = true;
+	packet.bReflected = false;
+	return(packet);
+}
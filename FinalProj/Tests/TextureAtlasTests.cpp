@@ -0,0 +1,115 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureatlastests.cpp
+// ============
+// placement of the images packed into atlas pages
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureAtlas.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace
+{
+	const int PAGE_SIZE = 256;
+	const int GUTTER = 4;
+
+	// an image filled with one RGBA value
+	std::vector<unsigned char> MakeImage(int width, int height, unsigned char value)
+	{
+		return(std::vector<unsigned char>((size_t)width * height * 4, value));
+	}
+
+	// texel rectangle of an entry on its page
+	struct TEXEL_RECT
+	{
+		int x;
+		int y;
+		int width;
+		int height;
+	};
+	TEXEL_RECT ToTexels(const TextureAtlas::ATLAS_ENTRY& entry)
+	{
+		TEXEL_RECT rect;
+		rect.x = (int)(entry.uvOffset.x * PAGE_SIZE + 0.5f);
+		rect.y = (int)(entry.uvOffset.y * PAGE_SIZE + 0.5f);
+		rect.width = (int)(entry.uvScale.x * PAGE_SIZE + 0.5f);
+		rect.height = (int)(entry.uvScale.y * PAGE_SIZE + 0.5f);
+		return(rect);
+	}
+}
+
+TEST(TextureAtlasTests, PackedImagesStayOnTheirPageApart)
+{
+	TextureAtlas atlas(PAGE_SIZE, GUTTER);
+	const int sizes[][2] = { { 100, 60 }, { 30, 30 }, { 64, 120 }, { 17, 9 }, { 200, 40 }, { 50, 50 }, { 128, 128 }, { 8, 200 } };
+	const int imageCount = sizeof(sizes) / sizeof(sizes[0]);
+	for (int i = 0; i < imageCount; i++)
+	{
+		std::vector<unsigned char> image = MakeImage(sizes[i][0], sizes[i][1], (unsigned char)(i + 1));
+		ASSERT_EQ(atlas.AddPixels(&image[0], sizes[i][0], sizes[i][1]), i);
+	}
+	atlas.Build();
+	ASSERT_GE(atlas.GetPageCount(), 1);
+
+	for (int i = 0; i < imageCount; i++)
+	{
+		const TextureAtlas::ATLAS_ENTRY& entry = atlas.GetEntry(i);
+		ASSERT_GE(entry.page, 0);
+		ASSERT_LT(entry.page, atlas.GetPageCount());
+		TEXEL_RECT rect = ToTexels(entry);
+		EXPECT_EQ(rect.width, sizes[i][0]);
+		EXPECT_EQ(rect.height, sizes[i][1]);
+		// the gutter stays inside the page on every side
+		EXPECT_GE(rect.x, GUTTER);
+		EXPECT_GE(rect.y, GUTTER);
+		EXPECT_LE(rect.x + rect.width + GUTTER, PAGE_SIZE);
+		EXPECT_LE(rect.y + rect.height + GUTTER, PAGE_SIZE);
+
+		// the page holds the image's own texels where the entry says
+		const TextureAtlas::ATLAS_PAGE& page = atlas.GetPage(entry.page);
+		size_t corner = ((size_t)(rect.y + rect.height - 1) * page.width + (rect.x + rect.width - 1)) * 4;
+		EXPECT_EQ(page.pixels[((size_t)rect.y * page.width + rect.x) * 4], (unsigned char)(i + 1));
+		EXPECT_EQ(page.pixels[corner], (unsigned char)(i + 1));
+
+		for (int j = 0; j < i; j++)
+		{
+			const TextureAtlas::ATLAS_ENTRY& other = atlas.GetEntry(j);
+			if (other.page != entry.page)
+			{
+				continue;
+			}
+			TEXEL_RECT otherRect = ToTexels(other);
+			bool bApart = (rect.x + rect.width + GUTTER <= otherRect.x) ||
+				(otherRect.x + otherRect.width + GUTTER <= rect.x) ||
+				(rect.y + rect.height + GUTTER <= otherRect.y) ||
+				(otherRect.y + otherRect.height + GUTTER <= rect.y);
+			EXPECT_TRUE(bApart) << "images " << i << " and " << j << " overlap";
+		}
+	}
+}
+
+TEST(TextureAtlasTests, FullPageStartsANewOne)
+{
+	TextureAtlas atlas(PAGE_SIZE, GUTTER);
+	std::vector<unsigned char> image = MakeImage(200, 200, 7);
+	for (int i = 0; i < 3; i++)
+	{
+		atlas.AddPixels(&image[0], 200, 200);
+	}
+	atlas.Build();
+	EXPECT_EQ(atlas.GetPageCount(), 3);
+	EXPECT_EQ(atlas.GetEntry(2).page, 2);
+}
+
+TEST(TextureAtlasTests, ImageLargerThanAPageIsRejected)
+{
+	TextureAtlas atlas(PAGE_SIZE, GUTTER);
+	std::vector<unsigned char> image = MakeImage(PAGE_SIZE, 16, 1);
+	EXPECT_EQ(atlas.AddPixels(&image[0], PAGE_SIZE, 16), -1);
+	EXPECT_EQ(atlas.AddPixels(&image[0], 0, 16), -1);
+}
@@ -0,0 +1,463 @@
+///////////////////////////////////////////////////////////////////////////////
+// dialsdf.cpp
+// ============
+// offline generator of the multi-channel distance field of the clock dial
+//
+//  AUTHOR: Amauri Hopewell
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+// Builds the numerals, tick marks and rim of the clock face from simple shapes
+// and writes their signed distance field to textures/clockdial_sdf.tga, laid out
+// like the clockface.png it replaces. Run it from the project folder:
+//
+//     DialSdf [output file]
+//
+// Each channel holds the distance to a subset of the shape edges. The tick marks
+// are boxes whose neighbouring edges never share all their channels, so the median
+// of the three channels keeps their corners sharp where a single distance would
+// round them off. The numerals are round-capped strokes, all three channels hold
+// their plain distance. fragment.glsl rebuilds the edges with DISTANCE_RANGE.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+	const int TEXTURE_SIZE = 256;
+	// texels the encoded distances span, distanceFieldRange in fragment.glsl
+	const float DISTANCE_RANGE = 6.0f;
+	const char* DEFAULT_OUTPUT = "textures/clockdial_sdf.tga";
+	const float PI = 3.14159265f;
+
+	// dial layout in texture coordinates, the center is at (0.5, 0.5)
+	const float NUMERAL_RADIUS = 0.31f;
+	const float NUMERAL_HEIGHT = 0.11f;
+	const float STROKE_RADIUS = 0.07f;   // share of the numeral height
+	const float DIGIT_WIDTH = 0.6f;      // share of the numeral height
+	const float DIGIT_ADVANCE = 0.66f;
+	const float HOUR_TICK_INNER = 0.41f;
+	const float MINUTE_TICK_INNER = 0.425f;
+	const float TICK_OUTER = 0.455f;
+	const float HOUR_TICK_WIDTH = 0.016f;
+	const float MINUTE_TICK_WIDTH = 0.008f;
+	const float RIM_INNER = 0.465f;
+	const float RIM_OUTER = 0.495f;
+
+	struct VEC2
+	{
+		float x;
+		float y;
+	};
+
+	VEC2 MakeVec2(float x, float y)
+	{
+		VEC2 v;
+		v.x = x;
+		v.y = y;
+		return(v);
+	}
+
+	float Dot(VEC2 a, VEC2 b) { return(a.x * b.x + a.y * b.y); }
+	float Length(VEC2 v) { return(std::sqrt(Dot(v, v))); }
+	VEC2 Subtract(VEC2 a, VEC2 b) { return(MakeVec2(a.x - b.x, a.y - b.y)); }
+
+	// signed distances of one point to a shape, positive inside the ink
+	struct CHANNELS
+	{
+		float r;
+		float g;
+		float b;
+	};
+
+	enum SHAPE_TYPE
+	{
+		SHAPE_CAPSULE,  // stroke from a to b with round caps
+		SHAPE_BOX,      // rectangle around center, extents along axis and across
+		SHAPE_RING      // annulus around center
+	};
+
+	struct SHAPE
+	{
+		SHAPE_TYPE type;
+		VEC2 a;
+		VEC2 b;
+		VEC2 center;
+		VEC2 axis;
+		float halfLength;
+		float halfWidth;
+		float radius;
+		float innerRadius;
+		float outerRadius;
+	};
+
+	float SegmentDistance(VEC2 p, VEC2 a, VEC2 b)
+	{
+		VEC2 ab = Subtract(b, a);
+		VEC2 ap = Subtract(p, a);
+		float t = std::max(0.0f, std::min(1.0f, Dot(ap, ab) / std::max(Dot(ab, ab), 1e-12f)));
+		return(Length(MakeVec2(ap.x - ab.x * t, ap.y - ab.y * t)));
+	}
+
+	/***********************************************************
+	 *  EvaluateBox()
+	 *
+	 *  The edges around the box alternate between magenta
+	 *  (red and blue) and yellow (red and green). Every channel
+	 *  takes the pseudo-distance, the distance to the edge's
+	 *  whole line, of its nearest edge.
+	 ***********************************************************/
+	float EvaluateBox(const SHAPE& box, VEC2 p, CHANNELS& channels)
+	{
+		VEC2 across = MakeVec2(-box.axis.y, box.axis.x);
+		VEC2 offset = Subtract(p, box.center);
+		float x = Dot(offset, box.axis);
+		float y = Dot(offset, across);
+		float hx = box.halfLength;
+		float hy = box.halfWidth;
+
+		// edges +x, +y, -x, -y in box space
+		const float pseudoDistances[4] = { hx - x, hy - y, hx + x, hy + y };
+		const VEC2 local = MakeVec2(x, y);
+		const float distances[4] = {
+			SegmentDistance(local, MakeVec2(hx, -hy), MakeVec2(hx, hy)),
+			SegmentDistance(local, MakeVec2(-hx, hy), MakeVec2(hx, hy)),
+			SegmentDistance(local, MakeVec2(-hx, -hy), MakeVec2(-hx, hy)),
+			SegmentDistance(local, MakeVec2(-hx, -hy), MakeVec2(hx, -hy)) };
+
+		int nearest = 0;
+		for (int edge = 1; edge < 4; edge++)
+		{
+			if (distances[edge] < distances[nearest])
+			{
+				nearest = edge;
+			}
+		}
+		int nearestMagenta = (distances[0] <= distances[2]) ? 0 : 2;
+		int nearestYellow = (distances[1] <= distances[3]) ? 1 : 3;
+		channels.r = pseudoDistances[nearest];
+		channels.g = pseudoDistances[nearestYellow];
+		channels.b = pseudoDistances[nearestMagenta];
+
+		float outsideX = std::max(std::fabs(x) - hx, 0.0f);
+		float outsideY = std::max(std::fabs(y) - hy, 0.0f);
+		float inside = std::min(hx - std::fabs(x), hy - std::fabs(y));
+		return((inside > 0.0f) ? inside : -Length(MakeVec2(outsideX, outsideY)));
+	}
+
+	// true signed distance of a shape, with its channels
+	float EvaluateShape(const SHAPE& shape, VEC2 p, CHANNELS& channels)
+	{
+		float distance = 0.0f;
+		switch (shape.type)
+		{
+		case SHAPE_CAPSULE:
+			distance = shape.radius - SegmentDistance(p, shape.a, shape.b);
+			break;
+		case SHAPE_RING:
+		{
+			float fromCenter = Length(Subtract(p, shape.center));
+			distance = std::min(fromCenter - shape.innerRadius, shape.outerRadius - fromCenter);
+			break;
+		}
+		case SHAPE_BOX:
+			return(EvaluateBox(shape, p, channels));
+		}
+		channels.r = distance;
+		channels.g = distance;
+		channels.b = distance;
+		return(distance);
+	}
+
+	void AddCapsule(std::vector<SHAPE>& shapes, VEC2 a, VEC2 b, float radius)
+	{
+		SHAPE shape = SHAPE();
+		shape.type = SHAPE_CAPSULE;
+		shape.a = a;
+		shape.b = b;
+		shape.radius = radius;
+		shapes.push_back(shape);
+	}
+
+	// radial tick from inner to outer radius at the angle
+	void AddTick(std::vector<SHAPE>& shapes, float angle, float innerRadius, float outerRadius, float width)
+	{
+		SHAPE shape = SHAPE();
+		shape.type = SHAPE_BOX;
+		shape.axis = MakeVec2(std::cos(angle), std::sin(angle));
+		float middle = 0.5f * (innerRadius + outerRadius);
+		shape.center = MakeVec2(0.5f + shape.axis.x * middle, 0.5f + shape.axis.y * middle);
+		shape.halfLength = 0.5f * (outerRadius - innerRadius);
+		shape.halfWidth = 0.5f * width;
+		shapes.push_back(shape);
+	}
+
+	// points along an elliptical arc, angles in degrees
+	void AddArc(std::vector<VEC2>& points, VEC2 center, float radiusX, float radiusY, float startDegrees, float endDegrees)
+	{
+		int steps = std::max(2, (int)(std::fabs(endDegrees - startDegrees) / 10.0f));
+		for (int i = 0; i <= steps; i++)
+		{
+			float angle = (startDegrees + (endDegrees - startDegrees) * i / steps) * PI / 180.0f;
+			points.push_back(MakeVec2(center.x + radiusX * std::cos(angle), center.y + radiusY * std::sin(angle)));
+		}
+	}
+
+	/***********************************************************
+	 *  GetDigitStrokes()
+	 *
+	 *  This function returns the center lines of a digit as
+	 *  polylines in a cell DIGIT_WIDTH wide and 1 high.
+	 ***********************************************************/
+	std::vector<std::vector<VEC2>> GetDigitStrokes(int digit)
+	{
+		std::vector<std::vector<VEC2>> strokes(1);
+		std::vector<VEC2>& line = strokes[0];
+		switch (digit)
+		{
+		case 0:
+			AddArc(line, MakeVec2(0.3f, 0.5f), 0.24f, 0.46f, 0.0f, 360.0f);
+			break;
+		case 1:
+			line.push_back(MakeVec2(0.14f, 0.8f));
+			line.push_back(MakeVec2(0.34f, 1.0f));
+			line.push_back(MakeVec2(0.34f, 0.0f));
+			break;
+		case 2:
+			AddArc(line, MakeVec2(0.3f, 0.72f), 0.24f, 0.26f, 160.0f, -20.0f);
+			line.push_back(MakeVec2(0.06f, 0.0f));
+			line.push_back(MakeVec2(0.56f, 0.0f));
+			break;
+		case 3:
+			AddArc(line, MakeVec2(0.3f, 0.75f), 0.22f, 0.22f, 150.0f, -90.0f);
+			AddArc(line, MakeVec2(0.3f, 0.27f), 0.25f, 0.27f, 90.0f, -150.0f);
+			break;
+		case 4:
+			line.push_back(MakeVec2(0.42f, 0.0f));
+			line.push_back(MakeVec2(0.42f, 1.0f));
+			line.push_back(MakeVec2(0.04f, 0.32f));
+			line.push_back(MakeVec2(0.58f, 0.32f));
+			break;
+		case 5:
+			line.push_back(MakeVec2(0.52f, 1.0f));
+			line.push_back(MakeVec2(0.12f, 1.0f));
+			line.push_back(MakeVec2(0.1f, 0.55f));
+			AddArc(line, MakeVec2(0.3f, 0.32f), 0.25f, 0.3f, 140.0f, -150.0f);
+			break;
+		case 6:
+		case 9:
+			AddArc(line, MakeVec2(0.3f, 0.3f), 0.24f, 0.3f, 0.0f, 360.0f);
+			strokes.push_back(std::vector<VEC2>());
+			AddArc(strokes[1], MakeVec2(0.56f, 0.32f), 0.5f, 0.66f, 180.0f, 100.0f);
+			if (digit == 9)
+			{
+				// a 6 turned half way round
+				for (size_t s = 0; s < strokes.size(); s++)
+				{
+					for (size_t i = 0; i < strokes[s].size(); i++)
+					{
+						strokes[s][i] = MakeVec2(DIGIT_WIDTH - strokes[s][i].x, 1.0f - strokes[s][i].y);
+					}
+				}
+			}
+			break;
+		case 7:
+			line.push_back(MakeVec2(0.04f, 1.0f));
+			line.push_back(MakeVec2(0.56f, 1.0f));
+			line.push_back(MakeVec2(0.2f, 0.0f));
+			break;
+		case 8:
+			AddArc(line, MakeVec2(0.3f, 0.76f), 0.19f, 0.22f, 0.0f, 360.0f);
+			strokes.push_back(std::vector<VEC2>());
+			AddArc(strokes[1], MakeVec2(0.3f, 0.27f), 0.24f, 0.27f, 0.0f, 360.0f);
+			break;
+		}
+		return(strokes);
+	}
+
+	// the hour's numeral centered on a point of the dial
+	void AddNumeral(std::vector<SHAPE>& shapes, int hour, VEC2 center)
+	{
+		int digits[2] = { hour / 10, hour % 10 };
+		int firstDigit = (hour < 10) ? 1 : 0;
+		int digitCount = 2 - firstDigit;
+		float width = NUMERAL_HEIGHT * (DIGIT_WIDTH + DIGIT_ADVANCE * (digitCount - 1));
+		VEC2 origin = MakeVec2(center.x - 0.5f * width, center.y - 0.5f * NUMERAL_HEIGHT);
+
+		for (int d = firstDigit; d < 2; d++)
+		{
+			std::vector<std::vector<VEC2>> strokes = GetDigitStrokes(digits[d]);
+			for (size_t s = 0; s < strokes.size(); s++)
+			{
+				for (size_t i = 0; i + 1 < strokes[s].size(); i++)
+				{
+					VEC2 a = MakeVec2(origin.x + strokes[s][i].x * NUMERAL_HEIGHT, origin.y + strokes[s][i].y * NUMERAL_HEIGHT);
+					VEC2 b = MakeVec2(origin.x + strokes[s][i + 1].x * NUMERAL_HEIGHT, origin.y + strokes[s][i + 1].y * NUMERAL_HEIGHT);
+					AddCapsule(shapes, a, b, STROKE_RADIUS * NUMERAL_HEIGHT);
+				}
+			}
+			origin.x += DIGIT_ADVANCE * NUMERAL_HEIGHT;
+		}
+	}
+
+	std::vector<SHAPE> BuildDial()
+	{
+		std::vector<SHAPE> shapes;
+
+		SHAPE rim = SHAPE();
+		rim.type = SHAPE_RING;
+		rim.center = MakeVec2(0.5f, 0.5f);
+		rim.innerRadius = RIM_INNER;
+		rim.outerRadius = RIM_OUTER;
+		shapes.push_back(rim);
+
+		for (int minute = 0; minute < 60; minute++)
+		{
+			float angle = PI * 0.5f - minute * PI / 30.0f;
+			if ((minute % 5) == 0)
+			{
+				AddTick(shapes, angle, HOUR_TICK_INNER, TICK_OUTER, HOUR_TICK_WIDTH);
+			}
+			else
+			{
+				AddTick(shapes, angle, MINUTE_TICK_INNER, TICK_OUTER, MINUTE_TICK_WIDTH);
+			}
+		}
+
+		for (int hour = 1; hour <= 12; hour++)
+		{
+			float angle = PI * 0.5f - hour * PI / 6.0f;
+			AddNumeral(shapes, hour, MakeVec2(
+				0.5f + NUMERAL_RADIUS * std::cos(angle),
+				0.5f + NUMERAL_RADIUS * std::sin(angle)));
+		}
+		return(shapes);
+	}
+
+	unsigned char Encode(float distance)
+	{
+		float texels = distance * TEXTURE_SIZE;
+		float value = texels / DISTANCE_RANGE + 0.5f;
+		return((unsigned char)std::max(0.0f, std::min(255.0f, value * 255.0f + 0.5f)));
+	}
+
+	/***********************************************************
+	 *  WriteTga()
+	 *
+	 *  This function writes 24-bit run length encoded TGA,
+	 *  which stb_image reads, bottom row first. The runs never
+	 *  cross a row.
+	 ***********************************************************/
+	bool WriteTga(const char* filename, const std::vector<unsigned char>& rgb, int width, int height)
+	{
+		FILE* file = std::fopen(filename, "wb");
+		if (NULL == file)
+		{
+			return(false);
+		}
+
+		unsigned char header[18] = { 0 };
+		header[2] = 10;  // run length encoded true color
+		header[12] = (unsigned char)(width & 0xFF);
+		header[13] = (unsigned char)(width >> 8);
+		header[14] = (unsigned char)(height & 0xFF);
+		header[15] = (unsigned char)(height >> 8);
+		header[16] = 24;
+		std::fwrite(header, 1, sizeof(header), file);
+
+		for (int y = 0; y < height; y++)
+		{
+			const unsigned char* row = &rgb[(size_t)y * width * 3];
+			int x = 0;
+			while (x < width)
+			{
+				// repeated pixels go in a run packet, others in a raw packet
+				int run = 1;
+				while ((x + run < width) && (run < 128) &&
+					(row[(x + run) * 3] == row[x * 3]) &&
+					(row[(x + run) * 3 + 1] == row[x * 3 + 1]) &&
+					(row[(x + run) * 3 + 2] == row[x * 3 + 2]))
+				{
+					run++;
+				}
+				if (run > 1)
+				{
+					const unsigned char packet[4] = {
+						(unsigned char)(0x80 | (run - 1)), row[x * 3 + 2], row[x * 3 + 1], row[x * 3] };
+					std::fwrite(packet, 1, sizeof(packet), file);
+					x += run;
+					continue;
+				}
+
+				int count = 1;
+				while ((x + count < width) && (count < 128) &&
+					!((x + count + 1 < width) &&
+						(row[(x + count) * 3] == row[(x + count + 1) * 3]) &&
+						(row[(x + count) * 3 + 1] == row[(x + count + 1) * 3 + 1]) &&
+						(row[(x + count) * 3 + 2] == row[(x + count + 1) * 3 + 2])))
+				{
+					count++;
+				}
+				std::fputc(count - 1, file);
+				for (int i = 0; i < count; i++)
+				{
+					const unsigned char bgr[3] = { row[(x + i) * 3 + 2], row[(x + i) * 3 + 1], row[(x + i) * 3] };
+					std::fwrite(bgr, 1, sizeof(bgr), file);
+				}
+				x += count;
+			}
+		}
+
+		bool bWritten = (std::ferror(file) == 0);
+		std::fclose(file);
+		return(bWritten);
+	}
+}
+
+/***********************************************************
+ *  main()
+ *
+ *  Every texel takes the channels of the shape it is most
+ *  inside of, or nearest to, which unites the shapes.
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	const char* output = (argc > 1) ? argv[1] : DEFAULT_OUTPUT;
+	std::vector<SHAPE> shapes = BuildDial();
+
+	std::vector<unsigned char> rgb((size_t)TEXTURE_SIZE * TEXTURE_SIZE * 3);
+	for (int y = 0; y < TEXTURE_SIZE; y++)
+	{
+		for (int x = 0; x < TEXTURE_SIZE; x++)
+		{
+			VEC2 p = MakeVec2((x + 0.5f) / TEXTURE_SIZE, (y + 0.5f) / TEXTURE_SIZE);
+			float bestDistance = -1e9f;
+			CHANNELS best = { bestDistance, bestDistance, bestDistance };
+			for (size_t i = 0; i < shapes.size(); i++)
+			{
+				CHANNELS channels;
+				float distance = EvaluateShape(shapes[i], p, channels);
+				if (distance > bestDistance)
+				{
+					bestDistance = distance;
+					best = channels;
+				}
+			}
+
+			unsigned char* texel = &rgb[((size_t)y * TEXTURE_SIZE + x) * 3];
+			texel[0] = Encode(best.r);
+			texel[1] = Encode(best.g);
+			texel[2] = Encode(best.b);
+		}
+	}
+
+	if (!WriteTga(output, rgb, TEXTURE_SIZE, TEXTURE_SIZE))
+	{
+		std::printf("ERROR: could not write %s\n", output);
+		return(1);
+	}
+	std::printf("INFO: wrote %d shapes to %s\n", (int)shapes.size(), output);
+	return(0);
+}
@@ -0,0 +1,30 @@
+###############################################################################
+# RecordBaselines.cmake
+# ============
+# records the regression baselines of one case with the headless build, run
+# by ctest before the case's regression test and by the record_baselines
+# target
+#
+#   HEADLESS      path of FinalProjectHeadless
+#   BASELINE_DIR  folder of the case's baselines
+#   ARGS          the case's command line options, separated by spaces
+#   FORCE         record even when the folder already has baselines
+#
+#  AUTHOR: Amauri Hopewell
+#	Created for CS-330-Computational Graphics and Visualization
+###############################################################################
+
+file(GLOB recordedStats "${BASELINE_DIR}/*.txt")
+if(recordedStats AND NOT FORCE)
+	message(STATUS "Baselines of ${BASELINE_DIR} are already recorded")
+	return()
+endif()
+
+file(MAKE_DIRECTORY "${BASELINE_DIR}")
+separate_arguments(caseArguments UNIX_COMMAND "${ARGS}")
+execute_process(
+	COMMAND "${HEADLESS}" --regression "${BASELINE_DIR}" --record-baselines ${caseArguments}
+	RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+	message(FATAL_ERROR "Recording the baselines of ${BASELINE_DIR} failed")
+endif()
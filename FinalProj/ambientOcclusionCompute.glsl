@@ -0,0 +1,91 @@
+#version 430 core
+
+// Screen space ambient occlusion at reduced resolution (AmbientOcclusion.h). Each
+// work group rebuilds the view space positions of its 16x16 tile and an apron of
+// APRON texels around it into shared memory, once per texel, and every pixel then
+// takes all its samples from there. The sampling radius is a world space size, in
+// texels it is clamped to the apron, so close up surfaces cost no more than far ones.
+
+#define TILE_SIZE 16      // AmbientOcclusion.cpp TILE_SIZE
+#define APRON 8
+#define TILE_DIM (TILE_SIZE + 2 * APRON)
+#define SAMPLE_COUNT 8
+
+layout (local_size_x = TILE_SIZE, local_size_y = TILE_SIZE) in;
+
+layout (binding = 12) uniform sampler2D depthTexture;  // full resolution scene depth
+layout (rg16f, binding = 0) uniform writeonly image2D occlusionImage;  // r occlusion, g view depth
+
+uniform ivec2 sourceSize;       // rendered part of the depth texture
+uniform ivec2 targetSize;       // occlusion texels covering it
+uniform int divisor;            // scene pixels per occlusion texel, per axis
+uniform mat4 inverseProjection;
+uniform float projectionScale;  // occlusion texels per world unit at view depth 1
+uniform float radius;           // world space reach of the occlusion
+uniform float intensity;
+uniform float depthBias;        // ignores samples this close to the tangent plane, per unit of depth
+
+// view space position (xyz) and depth buffer value (w) of the tile and its apron
+shared vec4 tilePositions[TILE_DIM][TILE_DIM];
+
+vec4 LoadPosition(ivec2 texel)
+{
+    ivec2 pixel = clamp(texel * divisor + divisor / 2, ivec2(0), sourceSize - 1);
+    float depth = texelFetch(depthTexture, pixel, 0).r;
+    vec2 ndc = (vec2(pixel) + 0.5) / vec2(sourceSize) * 2.0 - 1.0;
+    vec4 position = inverseProjection * vec4(ndc, depth * 2.0 - 1.0, 1.0);
+    return vec4(position.xyz / position.w, depth);
+}
+
+void main()
+{
+    ivec2 tileOrigin = ivec2(gl_WorkGroupID.xy) * TILE_SIZE - APRON;
+    for (uint i = gl_LocalInvocationIndex; i < uint(TILE_DIM * TILE_DIM); i += uint(TILE_SIZE * TILE_SIZE)) {
+        ivec2 tileTexel = ivec2(int(i) % TILE_DIM, int(i) / TILE_DIM);
+        tilePositions[tileTexel.y][tileTexel.x] = LoadPosition(tileOrigin + tileTexel);
+    }
+    barrier();
+
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(texel, targetSize)))
+        return;
+
+    ivec2 center = ivec2(gl_LocalInvocationID.xy) + APRON;
+    vec4 centerSample = tilePositions[center.y][center.x];
+    vec3 position = centerSample.xyz;
+    if (centerSample.w >= 1.0) {
+        imageStore(occlusionImage, texel, vec4(1.0, -position.z, 0.0, 0.0));
+        return;
+    }
+
+    // normal from the neighbours, the smaller difference on each axis
+    // keeps it from bending over depth edges
+    vec3 left = position - tilePositions[center.y][center.x - 1].xyz;
+    vec3 right = tilePositions[center.y][center.x + 1].xyz - position;
+    vec3 down = position - tilePositions[center.y - 1][center.x].xyz;
+    vec3 up = tilePositions[center.y + 1][center.x].xyz - position;
+    vec3 dx = (dot(left, left) < dot(right, right)) ? left : right;
+    vec3 dy = (dot(down, down) < dot(up, up)) ? down : up;
+    vec3 normal = normalize(cross(dx, dy));
+
+    float texelRadius = clamp(radius * projectionScale / -position.z, 1.0, float(APRON));
+    // interleaved gradient noise turns the pattern per texel, the upsample
+    // blurs the remaining noise away
+    float noise = fract(52.9829189 * fract(dot(vec2(texel), vec2(0.06711056, 0.00583715))));
+    float radiusSquared = radius * radius;
+
+    float occlusion = 0.0;
+    for (int i = 0; i < SAMPLE_COUNT; i++) {
+        float angle = (float(i) + noise) * 2.39996323;  // golden angle
+        float distance = texelRadius * (float(i) + 0.5 + noise * 0.5) / float(SAMPLE_COUNT);
+        ivec2 offset = ivec2(round(vec2(cos(angle), sin(angle)) * distance));
+        vec3 toSample = tilePositions[center.y + offset.y][center.x + offset.x].xyz - position;
+
+        float lengthSquared = dot(toSample, toSample);
+        float falloff = max(1.0 - lengthSquared / radiusSquared, 0.0);
+        occlusion += falloff * max(dot(toSample, normal) + position.z * depthBias, 0.0) / (lengthSquared + 0.01);
+    }
+    occlusion = clamp(1.0 - 2.0 * intensity * occlusion / float(SAMPLE_COUNT), 0.0, 1.0);
+
+    imageStore(occlusionImage, texel, vec4(occlusion, -position.z, 0.0, 0.0));
+}
@@ -0,0 +1,48 @@
+#version 430 core
+
+// Depth aware upsample of the ambient occlusion (AmbientOcclusion.h), drawn with
+// glBlendFunc(GL_ZERO, GL_SRC_COLOR) so it darkens the lit scene. Each pixel mixes
+// the four occlusion texels around it bilinearly, but a texel whose depth differs
+// from the pixel's loses its weight, so the occlusion does not bleed over edges.
+
+layout (binding = 12) uniform sampler2D depthTexture;      // full resolution scene depth
+layout (binding = 13) uniform sampler2D occlusionTexture;  // r occlusion, g view depth
+
+uniform ivec2 targetSize;  // occlusion texels in use
+uniform int divisor;       // scene pixels per occlusion texel, per axis
+uniform mat4 inverseProjection;
+uniform float sharpness;   // how quickly a depth difference drops a texel's weight
+
+out vec4 FragColor;
+
+void main() {
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(depthTexture, pixel, 0).r;
+    if (depth >= 1.0)
+        discard;  // background
+
+    // the view depth only depends on the depth value, perspective or not
+    vec4 viewPosition = inverseProjection * vec4(0.0, 0.0, depth * 2.0 - 1.0, 1.0);
+    float viewDepth = -viewPosition.z / viewPosition.w;
+
+    // texel t was computed at pixel t * divisor + divisor / 2
+    vec2 position = (vec2(pixel) - float(divisor / 2)) / float(divisor);
+    ivec2 base = ivec2(floor(position));
+    vec2 fraction = position - vec2(base);
+
+    float occlusion = 0.0;
+    float totalWeight = 0.0;
+    for (int i = 0; i < 4; i++) {
+        ivec2 corner = ivec2(i & 1, i >> 1);
+        ivec2 texel = clamp(base + corner, ivec2(0), targetSize - 1);
+        vec2 texelSample = texelFetch(occlusionTexture, texel, 0).rg;
+
+        vec2 bilinear = mix(1.0 - fraction, fraction, vec2(corner));
+        float similarity = exp(-abs(texelSample.g - viewDepth) * sharpness / viewDepth);
+        float weight = bilinear.x * bilinear.y * similarity + 0.0001;
+        occlusion += texelSample.r * weight;
+        totalWeight += weight;
+    }
+
+    FragColor = vec4(vec3(occlusion / totalWeight), 1.0);
+}
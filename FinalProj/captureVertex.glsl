@@ -0,0 +1,18 @@
+#version 330 core
+
+// Passes the mesh attributes straight through so transform feedback can
+// capture every drawn triangle (see CompactMeshes.cpp)
+layout (location = 0) in vec3 aPosition;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+
+out vec3 capturedPosition;
+out vec3 capturedNormal;
+out vec2 capturedTexCoord;
+
+void main() {
+    capturedPosition = aPosition;
+    capturedNormal = aNormal;
+    capturedTexCoord = aTexCoord;
+    gl_Position = vec4(aPosition, 1.0);
+}
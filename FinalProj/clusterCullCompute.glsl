@@ -0,0 +1,84 @@
+#version 430 core
+
+// One work group per draw. Each thread tests meshlets of the draw's mesh
+// and copies the indices of the visible ones into the draw's part of the
+// culled index buffer (see ClusterCuller.h).
+layout (local_size_x = 64) in;
+
+struct Meshlet {
+    vec4 sphere;   // object space center and radius
+    vec4 cone;     // normal cone axis and cutoff, 1 never culls
+    uvec4 range;   // x: first index, y: index count
+};
+
+struct Draw {
+    mat4 model;
+    uvec4 meshlets;  // x: first meshlet, y: meshlet count
+};
+
+struct DrawCommand {
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    uint baseVertex;
+    uint baseInstance;
+};
+
+layout (std430, binding = 3) readonly buffer Meshlets { Meshlet meshlets[]; };
+layout (std430, binding = 4) readonly buffer SourceIndices { uint sourceIndices[]; };
+layout (std430, binding = 5) readonly buffer Draws { Draw draws[]; };
+layout (std430, binding = 6) buffer Commands { DrawCommand commands[]; };
+layout (std430, binding = 7) writeonly buffer CulledIndices { uint culledIndices[]; };
+
+uniform vec4 frustumPlanes[6];  // world space, normalized
+uniform vec3 viewPosition;
+uniform uint drawCount;  // the groups are laid out in 2D past 65535 draws
+
+shared vec3 objectViewPosition;
+shared float maxScale;
+
+void main() {
+    uint drawIndex = gl_WorkGroupID.y * gl_NumWorkGroups.x + gl_WorkGroupID.x;
+    // no early return, barrier() is not allowed after one
+    bool bValidDraw = (drawIndex < drawCount);
+    drawIndex = min(drawIndex, drawCount - 1u);
+    mat4 model = draws[drawIndex].model;
+    uint meshletCount = bValidDraw ? draws[drawIndex].meshlets.y : 0u;
+    uint firstMeshlet = draws[drawIndex].meshlets.x;
+
+    // facing is the same in object space for any affine model matrix, so the
+    // cone test uses the camera moved into the mesh's space
+    if (gl_LocalInvocationIndex == 0u) {
+        objectViewPosition = vec3(inverse(model) * vec4(viewPosition, 1.0));
+        maxScale = max(length(model[0].xyz), max(length(model[1].xyz), length(model[2].xyz)));
+    }
+    barrier();
+
+    for (uint m = gl_LocalInvocationIndex; m < meshletCount; m += gl_WorkGroupSize.x) {
+        Meshlet meshlet = meshlets[firstMeshlet + m];
+
+        // every triangle faces away when the view direction is inside the widened normal cone
+        vec3 toCenter = meshlet.sphere.xyz - objectViewPosition;
+        if (dot(toCenter, meshlet.cone.xyz) >= meshlet.cone.w * length(toCenter) + meshlet.sphere.w) {
+            continue;
+        }
+
+        vec3 center = vec3(model * vec4(meshlet.sphere.xyz, 1.0));
+        float radius = meshlet.sphere.w * maxScale;
+        bool bInside = true;
+        for (int i = 0; i < 6; i++) {
+            if (dot(frustumPlanes[i].xyz, center) + frustumPlanes[i].w < -radius) {
+                bInside = false;
+            }
+        }
+        if (!bInside) {
+            continue;
+        }
+
+        uint offset = atomicAdd(commands[drawIndex].count, meshlet.range.y);
+        uint destination = commands[drawIndex].firstIndex + offset;
+        for (uint i = 0u; i < meshlet.range.y; i++) {
+            culledIndices[destination + i] = sourceIndices[meshlet.range.x + i];
+        }
+    }
+}
@@ -0,0 +1,169 @@
+#version 430 core
+
+// Lighting pass of the deferred path (DeferredShading.h). Each work group lights one
+// 16x16 tile of the G-buffer: it finds the nearest depth of the tile and returns when
+// the tile only sees the background, and loads the lights into shared memory once.
+// Each pixel rebuilds its world position from the depth and the inverse view
+// projection of its view, then lights its albedo with the material from the table
+// the same way fragment.glsl lights a fragment.
+
+#define TILE_SIZE 16       // DeferredShading.cpp TILE_SIZE
+#define MAX_LIGHTS 4       // DeferredShading::MAX_LIGHTS
+#define MAX_CASCADES 4
+#define MAX_MATERIALS 256  // MaterialTable::MAX_MATERIALS
+#define MAX_VIEWS 3        // MAX_FRAME_VIEWS
+
+layout (local_size_x = TILE_SIZE, local_size_y = TILE_SIZE) in;
+
+layout (binding = 8) uniform sampler2D albedoTexture;
+layout (binding = 9) uniform sampler2D normalTexture;     // octahedral encoded
+layout (binding = 10) uniform usampler2D materialTexture;
+layout (binding = 11) uniform sampler2D depthTexture;
+layout (binding = 15) uniform sampler2DArrayShadow shadowMap;
+layout (rgba16f, binding = 0) uniform writeonly image2D sceneColor;
+
+// every defined material, one array per property (MaterialTable.h)
+layout (std140) uniform MaterialTable {
+    vec4 materialAmbient[MAX_MATERIALS];   // rgb color, a strength
+    vec4 materialDiffuse[MAX_MATERIALS];   // rgb color, a shininess
+    vec4 materialSpecular[MAX_MATERIALS];  // rgb color
+};
+
+uniform ivec2 imageSize;  // rendered part of the targets
+
+// views of the frame, one covering the whole frame unless it is split
+uniform int viewCount;
+uniform mat4 inverseViewProjections[MAX_VIEWS];
+uniform vec4 viewRectangles[MAX_VIEWS];  // x, y, width, height as fractions of the frame
+uniform vec3 viewPositions[MAX_VIEWS];
+uniform mat4 view;  // camera view, picks the shadow cascade
+
+// lights that add any color, keyLight is the one casting the shadows or -1
+uniform int lightCount;
+uniform int keyLight;
+uniform vec3 lightPositions[MAX_LIGHTS];
+uniform vec3 lightAmbientColors[MAX_LIGHTS];
+uniform vec3 lightDiffuseColors[MAX_LIGHTS];
+uniform vec3 lightSpecularColors[MAX_LIGHTS];
+uniform float lightSpecularIntensities[MAX_LIGHTS];
+
+// cascaded shadow map of the key light
+uniform bool bUseShadows;
+uniform mat4 lightSpaceMatrices[MAX_CASCADES];
+uniform float cascadeSplits[MAX_CASCADES];  // far view depth of each cascade
+uniform int cascadeCount;
+
+// depth bits of the nearest pixel, non-negative floats order like their bits
+shared uint tileMinDepth;
+shared vec3 tileLightPositions[MAX_LIGHTS];
+shared vec3 tileLightAmbientColors[MAX_LIGHTS];
+shared vec3 tileLightDiffuseColors[MAX_LIGHTS];
+shared vec3 tileLightSpecularColors[MAX_LIGHTS];
+
+vec3 DecodeNormal(vec2 encoded)
+{
+    vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    if (normal.z < 0.0) {
+        normal.xy = (1.0 - abs(normal.yx)) * vec2(normal.x >= 0.0 ? 1.0 : -1.0, normal.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(normal);
+}
+
+// fraction of the key light reaching the position, 3x3 PCF in the cascade
+// that covers its view depth, as in fragment.glsl
+float CalculateShadow(vec3 position, vec3 normal)
+{
+    float viewDepth = -(view * vec4(position, 1.0)).z;
+    if (viewDepth > cascadeSplits[cascadeCount - 1])
+        return 1.0;
+
+    int cascade = cascadeCount - 1;
+    for (int i = 0; i < cascadeCount; i++) {
+        if (viewDepth < cascadeSplits[i]) {
+            cascade = i;
+            break;
+        }
+    }
+
+    vec4 lightPosition = lightSpaceMatrices[cascade] * vec4(position + normal * 0.02, 1.0);
+    vec3 coords = lightPosition.xyz * 0.5 + 0.5;
+    vec2 texelSize = 1.0 / vec2(textureSize(shadowMap, 0).xy);
+
+    float lit = 0.0;
+    for (int x = -1; x <= 1; x++) {
+        for (int y = -1; y <= 1; y++) {
+            lit += texture(shadowMap, vec4(coords.xy + vec2(x, y) * texelSize, float(cascade), coords.z));
+        }
+    }
+    return lit / 9.0;
+}
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+    bool bInside = all(lessThan(pixel, imageSize));
+    float depth = bInside ? texelFetch(depthTexture, pixel, 0).r : 1.0;
+
+    uint localIndex = gl_LocalInvocationIndex;
+    if (localIndex == 0u) {
+        tileMinDepth = floatBitsToUint(1.0);
+    }
+    if (localIndex < uint(lightCount)) {
+        tileLightPositions[localIndex] = lightPositions[localIndex];
+        tileLightAmbientColors[localIndex] = lightAmbientColors[localIndex];
+        tileLightDiffuseColors[localIndex] = lightDiffuseColors[localIndex];
+        tileLightSpecularColors[localIndex] = lightSpecularColors[localIndex] * lightSpecularIntensities[localIndex];
+    }
+    barrier();
+    atomicMin(tileMinDepth, floatBitsToUint(depth));
+    barrier();
+
+    // the whole tile sees the background, which keeps the clear color
+    if (tileMinDepth == floatBitsToUint(1.0))
+        return;
+    if (depth >= 1.0)
+        return;
+
+    // the view whose rectangle holds the pixel
+    vec2 uv = (vec2(pixel) + 0.5) / vec2(imageSize);
+    int viewIndex = 0;
+    for (int i = 1; i < viewCount; i++) {
+        vec4 rectangle = viewRectangles[i];
+        if (all(greaterThanEqual(uv, rectangle.xy)) && all(lessThan(uv, rectangle.xy + rectangle.zw)))
+            viewIndex = i;
+    }
+    vec4 rectangle = viewRectangles[viewIndex];
+    vec2 ndc = (uv - rectangle.xy) / rectangle.zw * 2.0 - 1.0;
+    vec4 world = inverseViewProjections[viewIndex] * vec4(ndc, depth * 2.0 - 1.0, 1.0);
+    vec3 position = world.xyz / world.w;
+
+    vec4 albedo = texelFetch(albedoTexture, pixel, 0);
+    vec3 normal = DecodeNormal(texelFetch(normalTexture, pixel, 0).xy);
+    int material = int(texelFetch(materialTexture, pixel, 0).r);
+
+    vec3 ambientColor = materialAmbient[material].rgb * materialAmbient[material].a;
+    vec3 diffuseColor = materialDiffuse[material].rgb;
+    float shininess = max(materialDiffuse[material].a, 1.0);
+    vec3 specularColor = materialSpecular[material].rgb;
+
+    vec3 viewDirection = normalize(viewPositions[viewIndex] - position);
+    float keyShadow = (bUseShadows && (keyLight >= 0)) ? CalculateShadow(position, normal) : 1.0;
+
+    vec3 phongResult = vec3(0.0);
+    for (int i = 0; i < lightCount; i++) {
+        vec3 lightDirection = normalize(tileLightPositions[i] - position);
+        vec3 ambient = tileLightAmbientColors[i] * ambientColor;
+
+        float impact = max(dot(normal, lightDirection), 0.0);
+        vec3 diffuse = impact * tileLightDiffuseColors[i] * diffuseColor;
+
+        vec3 reflectDirection = reflect(-lightDirection, normal);
+        float specularComponent = pow(max(dot(viewDirection, reflectDirection), 0.0), shininess);
+        vec3 specular = specularComponent * tileLightSpecularColors[i] * specularColor;
+
+        float shadow = (i == keyLight) ? keyShadow : 1.0;
+        phongResult += ambient + shadow * (diffuse + specular);
+    }
+
+    imageStore(sceneColor, pixel, vec4(albedo.rgb * phongResult, albedo.a));
+}
@@ -1,33 +1,348 @@
 #version 330 core
 
+struct Material {
+    vec3 ambientColor;
+    float ambientStrength;
+    vec3 diffuseColor;
+    vec3 specularColor;
+    float shininess;
+};
+
+struct LightSource {
+    vec3 position;
+    vec3 ambientColor;
+    vec3 diffuseColor;
+    vec3 specularColor;
+    float focalStrength;
+    float specularIntensity;
+};
+
+#define TOTAL_LIGHTS 4
+#define MAX_CASCADES 4
+#define MAX_MATERIALS 256  // MaterialTable::MAX_MATERIALS
+#define MAX_VIEWS 3  // MAX_FRAME_VIEWS
+
+in vec3 FragPos;   // World position from vertex shader
+in vec3 Normal;    // World normal from vertex shader
 in vec2 TexCoord;  // Interpolated UV from vertex shader
+flat in int ViewIndex;  // view of a split frame, see vertex.glsl
 
-uniform vec4 objectColor;          // Solid color (from SetShaderColor)
+uniform vec4 objectColor;          // Solid color of the draw packet
+uniform float objectOpacity = 1.0; // below 1 for see-through objects, whatever their color source
 uniform sampler2D objectTexture;   // First texture (e.g., "clockface" for bottom)
 uniform sampler2D objectTexture2;  // Second texture (e.g., "knobTexture" for top)
 uniform int bUseTexture;           // Flag: 1 = use texture, 0 = use color
 uniform int bUseTwoTextures;       // Flag: 1 = split with two textures
+uniform bool bUseLighting;         // Flag: light with the scene light sources
+uniform vec2 UVscale = vec2(1.0, 1.0);
+uniform vec2 UVoffset = vec2(0.0, 0.0);   // place of objectTexture in its atlas page
+uniform vec2 UVscale2 = vec2(1.0, 1.0);   // same two for objectTexture2
+uniform vec2 UVoffset2 = vec2(0.0, 0.0);
+uniform vec3 viewPosition;
+uniform int viewCount = 0;  // views of a split frame, 0 for the one camera
+uniform vec3 viewPositions[MAX_VIEWS];
+uniform int materialIndex;         // entry of the material table
+uniform LightSource lightSources[TOTAL_LIGHTS];
+
+// cascaded shadow map of the key light (lightSources[0])
+uniform bool bUseShadows;
+uniform sampler2DArrayShadow shadowMap;
+uniform mat4 lightSpaceMatrices[MAX_CASCADES];
+uniform float cascadeSplits[MAX_CASCADES];  // far view depth of each cascade
+uniform int cascadeCount;
+uniform mat4 view;
+
+// every defined material, one array per property (MaterialTable.h)
+layout (std140) uniform MaterialTable {
+    vec4 materialAmbient[MAX_MATERIALS];   // rgb color, a strength
+    vec4 materialDiffuse[MAX_MATERIALS];   // rgb color, a shininess
+    vec4 materialSpecular[MAX_MATERIALS];  // rgb color
+};
+
+// Transparent draws with bWeightedTransparency set go into the accumulation and
+// revealage targets of WeightedTransparency instead of the scene color. The weight
+// favours nearer surfaces so they dominate the average where several overlap.
+uniform bool bWeightedTransparency;
+// Opaque draws with bDeferredGeometry set fill the G-buffer of DeferredShading with
+// their unlit color, normal and material, deferredLightingCompute.glsl lights them.
+uniform bool bDeferredGeometry;
+
+// Planar reflection of the scene in the floor (PlanarReflection.h), drawn from the
+// mirrored camera at reduced resolution. Rougher materials read a blurrier mip level.
+uniform bool bUseReflection;
+uniform float reflectivity;        // share of the reflection seen head-on, 0 for most objects
+uniform sampler2D reflectionTexture;
+uniform vec2 reflectionUVScale;    // gl_FragCoord to reflection texture coordinates
+uniform vec2 reflectionMaxUV;      // last texel center of the rendered part
+uniform float reflectionMaxLod;    // level of the roughest material
+
+// Procedural textures (ProceduralTexture.h) take the place of objectTexture. The
+// pattern is evaluated from the texture coordinates and a few values, so it needs
+// no image and stays sharp however close the camera gets.
+#define PATTERN_NONE 0
+#define PATTERN_SCRATCHES 1
+uniform int proceduralPattern = PATTERN_NONE;
+uniform vec4 proceduralBaseColor;
+uniform vec4 proceduralDetailColor;
+uniform vec4 proceduralParams;     // xy repeats across the texture, z seed
+
+// objectTexture2 may be a multi-channel signed distance field of a clock dial's
+// ink (Tools/DialSdf.cpp). The median of its channels is the distance to the edge
+// of the numerals and ticks, which gives sharp edges at any distance from a small
+// texture; the ground of the dial is generated below them.
+uniform bool bDistanceField2;
+uniform float distanceFieldRange = 6.0;  // texels the distances span, DialSdf DISTANCE_RANGE
+
+// Without the HDR target the scene is drawn straight into the back buffer. A fixed
+// exposure then rolls the lit color off below 1 in place of the tone mapping, and
+// the color is gamma encoded here unless the back buffer is sRGB and does it.
+uniform float directExposure = 0.0;  // 0 while the HDR target tone maps
+uniform bool bDirectGamma;
+
+layout (location = 0) out vec4 FragColor;    // Final pixel color, the weighted accumulation or the albedo
+layout (location = 1) out vec4 FragData;     // (1 - alpha) revealage, or the encoded normal
+layout (location = 2) out uint FragMaterial; // material index, G-buffer only
+
+// octahedral encoding of a unit normal into two signed components
+vec2 EncodeNormal(vec3 normal)
+{
+    normal /= abs(normal.x) + abs(normal.y) + abs(normal.z);
+    if (normal.z < 0.0) {
+        return (1.0 - abs(normal.yx)) * vec2(normal.x >= 0.0 ? 1.0 : -1.0, normal.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return normal.xy;
+}
+
+float Hash(vec2 p)
+{
+    vec3 p3 = fract(vec3(p.xyx) * 0.1031);
+    p3 += dot(p3, p3.yzx + 33.33);
+    return fract((p3.x + p3.y) * p3.z);
+}
+
+// smoothly interpolated random values on the integer grid, 0-1
+float ValueNoise(vec2 p)
+{
+    vec2 cell = floor(p);
+    vec2 f = fract(p);
+    vec2 s = f * f * (3.0 - 2.0 * f);
+    return mix(mix(Hash(cell), Hash(cell + vec2(1.0, 0.0)), s.x),
+               mix(Hash(cell + vec2(0.0, 1.0)), Hash(cell + vec2(1.0, 1.0)), s.x), s.y);
+}
+
+// four octaves of value noise, 0-1
+float FractalNoise(vec2 p)
+{
+    float sum = 0.0;
+    float amplitude = 0.5;
+    for (int i = 0; i < 4; i++) {
+        sum += amplitude * ValueNoise(p);
+        p = p * 2.03 + 17.0;
+        amplitude *= 0.5;
+    }
+    return sum / 0.9375;
+}
+
+// one line segment in most cells of three rotated grids, and bright specks,
+// over a mottled dark ground; footprint is the size of the pixel in pattern
+// units, the lines are a fixed width in pattern units and thinner than a
+// pixel they only add their coverage instead of flickering
+vec3 ScratchesPattern(vec2 p, vec2 footprint)
+{
+    float seed = proceduralParams.z;
+    float pixelSize = max(footprint.x, footprint.y);
+    float scratch = 0.0;
+    for (int layer = 0; layer < 3; layer++) {
+        float angle = seed + float(layer) * 2.1;
+        float layerScale = 1.0 + float(layer) * 0.7;
+        vec2 q = mat2(cos(angle), sin(angle), -sin(angle), cos(angle)) * p * layerScale;
+        vec2 cell = floor(q) + float(layer) * 19.0;
+        if (Hash(cell) > 0.7)
+            continue;
+
+        // centered in its cell and short enough to stay inside it
+        float direction = Hash(cell + 11.3) * 6.2831853;
+        vec2 axis = vec2(cos(direction), sin(direction));
+        float halfLength = 0.15 + 0.3 * Hash(cell + 5.9);
+        vec2 fromCenter = fract(q) - 0.5;
+        float distance = length(fromCenter - axis * clamp(dot(fromCenter, axis), -halfLength, halfLength));
+
+        float lineWidth = 0.008 + 0.008 * Hash(cell + 2.7);
+        float blur = max(pixelSize * layerScale, lineWidth);
+        scratch = max(scratch, (1.0 - smoothstep(0.0, blur, distance)) * lineWidth / blur);
+    }
+
+    vec2 speckCell = floor(p * 24.0);
+    float speckSize = 0.15;
+    float speckBlur = max(pixelSize * 24.0, speckSize);
+    float speck = step(0.985, Hash(speckCell + seed)) *
+        (1.0 - smoothstep(0.0, speckBlur, length(fract(p * 24.0) - 0.5))) * speckSize / speckBlur;
+
+    vec3 ground = proceduralBaseColor.rgb * (0.6 + 0.8 * FractalNoise(p * 3.0 + seed));
+    return mix(ground, proceduralDetailColor.rgb, clamp(scratch + speck, 0.0, 1.0));
+}
+
+float Median(vec3 v)
+{
+    return max(min(v.r, v.g), min(max(v.r, v.g), v.b));
+}
+
+// the dial's ink over worn off-white enamel with rust stains, like the
+// clockface.png the distance field replaces; the colors are linear
+vec4 SampleDial(vec2 uv, vec2 footprint)
+{
+    float distance = Median(texture(objectTexture2, uv).rgb) - 0.5;
+    // screen pixels covered by the encoded distance range, at least one
+    // so far away dials fade instead of aliasing
+    vec2 texelsPerPixel = footprint * vec2(textureSize(objectTexture2, 0));
+    float pixelRange = max(distanceFieldRange / max(0.5 * (texelsPerPixel.x + texelsPerPixel.y), 0.0001), 1.0);
+    float ink = clamp(distance * pixelRange + 0.5, 0.0, 1.0);
+
+    float stain = smoothstep(0.55, 0.8, FractalNoise(uv * 7.0));
+    vec3 enamel = mix(vec3(0.70, 0.62, 0.48), vec3(0.30, 0.12, 0.04), stain * 0.7);
+    enamel *= 0.85 + 0.3 * mix(ValueNoise(uv * 60.0), 0.5, clamp(max(footprint.x, footprint.y) * 60.0, 0.0, 1.0));
+    return vec4(mix(enamel, vec3(0.01), ink), 1.0);
+}
+
+// objectTexture, or the procedural texture drawn in its place
+vec4 SampleObjectTexture(vec2 uv, vec2 footprint)
+{
+    if (proceduralPattern == PATTERN_SCRATCHES)
+        return vec4(ScratchesPattern(uv * proceduralParams.xy, footprint), 1.0);
+    return texture(objectTexture, uv);
+}
+
+// shadow scales the direct (diffuse and specular) part of the light
+vec3 CalculateLightSource(LightSource light, Material material, vec3 normal, vec3 viewDirection, float shadow)
+{
+    vec3 lightDirection = normalize(light.position - FragPos);
+
+    vec3 ambient = light.ambientColor * material.ambientColor * material.ambientStrength;
 
-out vec4 FragColor;  // Final pixel color
+    float impact = max(dot(normal, lightDirection), 0.0);
+    vec3 diffuse = impact * light.diffuseColor * material.diffuseColor;
+
+    vec3 reflectDirection = reflect(-lightDirection, normal);
+    float specularComponent = pow(max(dot(viewDirection, reflectDirection), 0.0), max(material.shininess, 1.0));
+    vec3 specular = light.specularIntensity * specularComponent * light.specularColor * material.specularColor;
+
+    return ambient + shadow * (diffuse + specular);
+}
+
+// fraction of the key light reaching this fragment, 3x3 PCF in the cascade
+// that covers the fragment's view depth
+float CalculateShadow(vec3 normal)
+{
+    float viewDepth = -(view * vec4(FragPos, 1.0)).z;
+    if (viewDepth > cascadeSplits[cascadeCount - 1])
+        return 1.0;
+
+    int cascade = cascadeCount - 1;
+    for (int i = 0; i < cascadeCount; i++) {
+        if (viewDepth < cascadeSplits[i]) {
+            cascade = i;
+            break;
+        }
+    }
+
+    // small offset along the normal against acne on grazing surfaces
+    vec4 lightPosition = lightSpaceMatrices[cascade] * vec4(FragPos + normal * 0.02, 1.0);
+    vec3 coords = lightPosition.xyz * 0.5 + 0.5;
+    vec2 texelSize = 1.0 / vec2(textureSize(shadowMap, 0).xy);
+
+    float lit = 0.0;
+    for (int x = -1; x <= 1; x++) {
+        for (int y = -1; y <= 1; y++) {
+            lit += texture(shadowMap, vec4(coords.xy + vec2(x, y) * texelSize, float(cascade), coords.z));
+        }
+    }
+    return lit / 9.0;
+}
 
 void main() {
+    // material of the current draw, read from the table
+    Material material;
+    material.ambientColor = materialAmbient[materialIndex].rgb;
+    material.ambientStrength = materialAmbient[materialIndex].a;
+    material.diffuseColor = materialDiffuse[materialIndex].rgb;
+    material.shininess = materialDiffuse[materialIndex].a;
+    material.specularColor = materialSpecular[materialIndex].rgb;
+
     vec4 color;
-    
+    vec2 uv = TexCoord * UVscale + UVoffset;
+    // derivatives are only defined outside the texture branches
+    vec2 proceduralFootprint = fwidth(uv * proceduralParams.xy);
+    vec2 uv2 = TexCoord * UVscale2 + UVoffset2;
+    vec2 dialFootprint = fwidth(uv2);
+
     if (bUseTwoTextures == 1) {
         // Split at v=0.5: bottom half (v <= 0.5) uses objectTexture ("clockface")
         // Top half (v > 0.5) uses objectTexture2 ("knobTexture")
         if (TexCoord.y > 0.5) {
-            color = texture(objectTexture2, TexCoord);
+            color = bDistanceField2 ? SampleDial(uv2, dialFootprint) : texture(objectTexture2, uv2);
         } else {
-            color = texture(objectTexture, TexCoord);
+            color = SampleObjectTexture(uv, proceduralFootprint);
         }
     } else if (bUseTexture == 1) {
         // Single texture mode
-        color = texture(objectTexture, TexCoord);
+        color = SampleObjectTexture(uv, proceduralFootprint);
     } else {
         // Solid color mode
         color = objectColor;
     }
-    
-    FragColor = color;  // Output (could multiply by lighting if added later)
-}
\ No newline at end of file
+
+    if (bDeferredGeometry) {
+        FragColor = color;
+        FragData = vec4(EncodeNormal(normalize(Normal)), 0.0, 0.0);
+        FragMaterial = uint(materialIndex);
+        return;
+    }
+
+    if (bUseLighting) {
+        vec3 normal = normalize(Normal);
+        vec3 eyePosition = (viewCount > 0) ? viewPositions[ViewIndex] : viewPosition;
+        vec3 viewDirection = normalize(eyePosition - FragPos);
+        vec3 phongResult = vec3(0.0);
+
+        // only the key light casts shadows
+        float keyShadow = bUseShadows ? CalculateShadow(normal) : 1.0;
+
+        for (int i = 0; i < TOTAL_LIGHTS; i++) {
+            phongResult += CalculateLightSource(lightSources[i], material, normal, viewDirection, (i == 0) ? keyShadow : 1.0);
+        }
+        color.rgb *= phongResult;
+    }
+
+    if (bUseReflection && (reflectivity > 0.0)) {
+        // Phong exponent to roughness, which picks the blur level
+        float roughness = sqrt(2.0 / (material.shininess + 2.0));
+        vec2 reflectionUV = min(gl_FragCoord.xy * reflectionUVScale, reflectionMaxUV);
+        vec3 reflection = textureLod(reflectionTexture, reflectionUV, roughness * reflectionMaxLod).rgb;
+
+        // Schlick's approximation, grazing views see more of the reflection
+        vec3 eyePosition = (viewCount > 0) ? viewPositions[ViewIndex] : viewPosition;
+        float facing = max(dot(normalize(Normal), normalize(eyePosition - FragPos)), 0.0);
+        float fresnel = reflectivity + (1.0 - reflectivity) * pow(1.0 - facing, 5.0);
+        color.rgb = mix(color.rgb, reflection, fresnel);
+    }
+    color.a *= objectOpacity;
+
+    if (bWeightedTransparency) {
+        float weight = clamp(color.a * max(0.01, 3000.0 * pow(1.0 - gl_FragCoord.z, 3.0)), 0.01, 3000.0);
+        FragColor = vec4(color.rgb * color.a, color.a) * weight;
+        FragData = vec4(color.a);
+        FragMaterial = 0u;
+        return;
+    }
+
+    if (directExposure > 0.0) {
+        color.rgb = 1.0 - exp(-color.rgb * directExposure);
+        if (bDirectGamma) {
+            color.rgb = pow(color.rgb, vec3(1.0 / 2.2));
+        }
+    }
+
+    FragColor = color;
+    FragData = vec4(0.0);
+    FragMaterial = 0u;
+}
@@ -0,0 +1,54 @@
+#version 430 core
+
+// Reduces the luminance histogram to the average log luminance with a single
+// 256 thread work group, eases the adapted luminance towards it and clears
+// the histogram for the next frame.
+
+#define HISTOGRAM_BINS 256
+
+layout (local_size_x = HISTOGRAM_BINS) in;
+
+layout (std430, binding = 0) buffer LuminanceHistogram {
+    uint histogram[HISTOGRAM_BINS];
+};
+
+layout (std430, binding = 1) buffer Exposure {
+    float adaptedLuminance;
+    float exposure;
+};
+
+uniform uint pixelCount;
+uniform float minLogLuminance;
+uniform float logLuminanceRange;
+uniform float adaptation;  // 0-1, how far to move towards this frame's luminance
+uniform float keyValue;    // middle grey the average luminance is mapped to
+
+shared float weightedBins[HISTOGRAM_BINS];
+
+void main() {
+    uint bin = gl_LocalInvocationIndex;
+    uint count = histogram[bin];
+    weightedBins[bin] = float(count) * float(bin);
+    histogram[bin] = 0u;
+    barrier();
+
+    for (uint stride = HISTOGRAM_BINS / 2u; stride > 0u; stride >>= 1u) {
+        if (bin < stride)
+            weightedBins[bin] += weightedBins[bin + stride];
+        barrier();
+    }
+
+    if (bin == 0u) {
+        // the black pixels of bin 0 are left out of the average
+        float litPixels = max(float(pixelCount) - float(count), 1.0);
+        float averageBin = weightedBins[0] / litPixels - 1.0;
+        float averageLogLuminance = (averageBin / 254.0) * logLuminanceRange + minLogLuminance;
+        float frameLuminance = exp2(averageLogLuminance);
+
+        float previous = adaptedLuminance;
+        if (!(previous > 0.0))
+            previous = frameLuminance;
+        adaptedLuminance = previous + (frameLuminance - previous) * adaptation;
+        exposure = keyValue / max(adaptedLuminance, 0.0001);
+    }
+}
@@ -0,0 +1,48 @@
+#version 430 core
+
+// Builds the log luminance histogram of the HDR frame in one dispatch. Each
+// work group counts its 16x16 tile in shared memory and then adds its 256 bins
+// to the global histogram, so the global atomics are per bin, not per pixel.
+
+#define HISTOGRAM_BINS 256
+
+layout (local_size_x = 16, local_size_y = 16) in;
+
+layout (binding = 14) uniform sampler2D hdrTexture;
+
+layout (std430, binding = 0) buffer LuminanceHistogram {
+    uint histogram[HISTOGRAM_BINS];
+};
+
+uniform ivec2 imageSize;          // size of the rendered region
+uniform float minLogLuminance;    // log2 luminance of bin 1
+uniform float inverseLogLuminanceRange;
+
+shared uint tileHistogram[HISTOGRAM_BINS];
+
+// bin 0 is kept for (near) black pixels so they do not pull the exposure up
+uint LuminanceToBin(vec3 color)
+{
+    float luminance = dot(color, vec3(0.2126, 0.7152, 0.0722));
+    if (luminance < 0.0001)
+        return 0u;
+
+    float logLuminance = clamp((log2(luminance) - minLogLuminance) * inverseLogLuminanceRange, 0.0, 1.0);
+    return uint(logLuminance * 254.0 + 1.0);
+}
+
+void main() {
+    tileHistogram[gl_LocalInvocationIndex] = 0u;
+    barrier();
+
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+    if (pixel.x < imageSize.x && pixel.y < imageSize.y) {
+        vec3 color = texelFetch(hdrTexture, pixel, 0).rgb;
+        atomicAdd(tileHistogram[LuminanceToBin(color)], 1u);
+    }
+    barrier();
+
+    uint count = tileHistogram[gl_LocalInvocationIndex];
+    if (count > 0u)
+        atomicAdd(histogram[gl_LocalInvocationIndex], count);
+}
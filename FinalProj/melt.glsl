@@ -0,0 +1,37 @@
+// Melting clock deformation, included by vertex.glsl and shadowVertex.glsl so
+// melted clocks cast melted shadows. When bUseMelt is set, "model" places the
+// part inside its clock and "meltGroup" places the whole clock in the world, so
+// every part of one clock bends over the same edge. meltGroup and meltParams are
+// the only per-clock values; Melt() takes the parameters it bends with, so they
+// can come from these uniforms or from a per-draw table.
+uniform bool bUseMelt;
+uniform mat4 meltGroup;
+uniform vec4 meltParams;  // x: edge height, y: edge radius, z: drape amount (0-1), w: side sag
+
+// Drape everything below the edge over a horizontal edge that runs along X
+// behind the clock face. The part past the edge curls around the edge radius and
+// then hangs straight down. The edge rises with the side sag away from the middle,
+// so the sides start draping higher and hang further than the middle, and the
+// mesh stays joined where the draping starts.
+void Melt(inout vec3 position, inout vec3 normal, vec4 params)
+{
+    float edge = params.x + params.w * position.x * position.x;
+    float below = edge - position.y;
+    if (below <= 0.0)
+        return;
+
+    float radius = max(params.y, 0.001);
+    float arc = radius * params.z * 1.5707963;
+    float angle = min(below, arc) / radius;
+    float straight = max(below - arc, 0.0);
+
+    float s = sin(angle);
+    float c = cos(angle);
+    mat3 bend = mat3(1.0, 0.0, 0.0,
+                     0.0, c,   s,
+                     0.0, -s,  c);
+
+    vec3 axis = vec3(0.0, edge, -radius);
+    position = axis + bend * vec3(position.x, -straight, radius + position.z);
+    normal = bend * normal;
+}
@@ -0,0 +1,5 @@
+#version 430 core
+
+// depth only, the fixed function depth write is all that is needed
+void main() {
+}
@@ -0,0 +1,23 @@
+#version 430 core
+
+#define MAX_CASCADES 4
+
+// one invocation per cascade, each writes the triangle to its own layer
+layout (triangles, invocations = MAX_CASCADES) in;
+layout (triangle_strip, max_vertices = 3) out;
+
+uniform mat4 lightSpaceMatrices[MAX_CASCADES];
+uniform int cascadeCount;
+uniform int cascadeMask;  // cascades this caster's bounding sphere touches
+
+void main() {
+    if (gl_InvocationID >= cascadeCount || (cascadeMask & (1 << gl_InvocationID)) == 0)
+        return;
+
+    for (int i = 0; i < 3; i++) {
+        gl_Layer = gl_InvocationID;
+        gl_Position = lightSpaceMatrices[gl_InvocationID] * gl_in[i].gl_Position;
+        EmitVertex();
+    }
+    EndPrimitive();
+}
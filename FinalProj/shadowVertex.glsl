@@ -0,0 +1,24 @@
+#version 430 core
+
+layout (location = 0) in vec3 aPosition;  // Vertex position from mesh
+layout (location = 1) in vec3 aNormal;    // Vertex normal from mesh
+layout (location = 3) in vec4 aDecodeScale;  // compact mesh decoding, see vertex.glsl
+layout (location = 4) in vec3 aDecodeBias;
+
+uniform mat4 model;
+
+#include "melt.glsl"
+
+void main() {
+    vec3 position = aPosition * aDecodeScale.xyz + aDecodeBias;
+
+    // world space position, the geometry shader projects it once per cascade
+    if (bUseMelt) {
+        vec3 groupPosition = vec3(model * vec4(position, 1.0));
+        vec3 groupNormal = vec3(0.0, 0.0, 1.0);  // the shadow only needs the position
+        Melt(groupPosition, groupNormal, meltParams);
+        gl_Position = meltGroup * vec4(groupPosition, 1.0);
+    } else {
+        gl_Position = model * vec4(position, 1.0);
+    }
+}
@@ -0,0 +1,35 @@
+#version 430 core
+
+in vec2 TexCoord;
+
+layout (binding = 14) uniform sampler2D hdrTexture;
+
+// the scene may only cover a corner of the HDR target
+uniform vec2 sourceScale;
+uniform vec2 maxTexCoord;
+
+layout (std430, binding = 1) buffer Exposure {
+    float adaptedLuminance;
+    float exposure;
+};
+
+out vec4 FragColor;
+
+// ACES filmic curve fit (Narkowicz)
+vec3 ToneMapACES(vec3 color)
+{
+    const float a = 2.51;
+    const float b = 0.03;
+    const float c = 2.43;
+    const float d = 0.59;
+    const float e = 0.14;
+    return clamp((color * (a * color + b)) / (color * (c * color + d) + e), 0.0, 1.0);
+}
+
+void main() {
+    vec2 sourceCoord = min(TexCoord * sourceScale, maxTexCoord);
+    vec3 hdrColor = texture(hdrTexture, sourceCoord).rgb;
+    vec3 mapped = ToneMapACES(hdrColor * exposure);
+    // back to display gamma, the scene is lit in linear space
+    FragColor = vec4(pow(mapped, vec3(1.0 / 2.2)), 1.0);
+}
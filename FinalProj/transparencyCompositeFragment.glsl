@@ -0,0 +1,23 @@
+#version 430 core
+
+// weighted blended transparency (WeightedTransparency.h), drawn with
+// glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA) over the lit scene
+layout (binding = 12) uniform sampler2D accumulation;  // weighted premultiplied rgb, weighted alpha
+layout (binding = 13) uniform sampler2D revealage;     // product of (1 - alpha)
+
+out vec4 FragColor;
+
+void main() {
+    ivec2 texel = ivec2(gl_FragCoord.xy);
+    float revealed = texelFetch(revealage, texel, 0).r;
+    if (revealed >= 1.0)
+        discard;  // no transparent surface here
+
+    // many bright surfaces on one pixel can overflow the half floats
+    vec4 accumulated = texelFetch(accumulation, texel, 0);
+    if (isinf(max(max(abs(accumulated.r), abs(accumulated.g)), abs(accumulated.b))))
+        accumulated.rgb = vec3(accumulated.a);
+
+    vec3 averageColor = accumulated.rgb / max(accumulated.a, 0.00001);
+    FragColor = vec4(averageColor, 1.0 - revealed);
+}
@@ -1,15 +1,123 @@
 #version 330 core
 
 layout (location = 0) in vec3 aPosition;  // Vertex position from mesh
-layout (location = 1) in vec2 aTexCoord;  // UV texture coordinates from mesh (u horizontal, v vertical)
+layout (location = 1) in vec3 aNormal;    // Vertex normal from mesh
+layout (location = 2) in vec2 aTexCoord;  // UV texture coordinates from mesh (u horizontal, v vertical)
 
-uniform mat4 model;       // Model matrix (from C++ SetTransformations)
+// Compact meshes (CompactMeshes.h) store the position as fractions of the mesh
+// bounds and the normal octahedral encoded in xy. These two are constant per mesh;
+// float meshes get a scale of 1, a bias of 0 and w = 0.
+layout (location = 3) in vec4 aDecodeScale;  // xyz: position scale, w: 1 for octahedral normals
+layout (location = 4) in vec3 aDecodeBias;   // position of the mesh bounds' minimum
+
+uniform mat4 model;       // Model matrix of the draw packet
 uniform mat4 view;        // View matrix (camera)
 uniform mat4 projection;  // Projection matrix
 
+// Split frames (FrameState.h) draw every object once per view in a single draw,
+// one instance per view. Each view's clip space is squeezed into its rectangle of
+// the frame and the clip distances cut off what falls outside of it. A viewCount
+// of 0 draws the one camera through view and projection. Draws that cannot be
+// instanced are repeated with firstView set to each view instead.
+#define MAX_VIEWS 3  // MAX_FRAME_VIEWS
+uniform int viewCount = 0;
+uniform int firstView = 0;
+uniform mat4 viewProjections[MAX_VIEWS];
+uniform vec4 viewRectangles[MAX_VIEWS];  // x, y, width, height as fractions of the frame
+
+#include "melt.glsl"
+
+#ifdef VERTEX_PULLING
+// Multi-draw batches (MultiDraw.h) read the compact meshes' vertices straight from
+// the shared vertex buffer through gl_VertexID, which includes each command's base
+// vertex, and the values that differ between the draws of a batch from a table.
+// aDrawIndex steps once per draw: its divisor is the view count and each command's
+// base instance is the draw's entry in the table.
+struct CompactVertex
+{
+    uint positionXY;  // 16 bit fractions of the mesh bounds
+    uint positionZ;
+    uint normal;      // 2 x 16 bit octahedral
+    uint texCoord;    // 2 half floats
+};
+struct DrawData
+{
+    mat4 model;
+    mat4 meltGroup;
+    vec4 meltParams;
+    vec4 decodeScale;
+    vec4 decodeBias;
+};
+layout (std430, binding = 8) readonly buffer CompactVertices { CompactVertex compactVertices[]; };
+layout (std430, binding = 9) readonly buffer DrawTable { DrawData drawTable[]; };
+layout (location = 5) in uint aDrawIndex;
+uniform bool bPullVertices;
+#endif
+
+out vec3 FragPos;   // World position for lighting
+out vec3 Normal;    // World normal for lighting
 out vec2 TexCoord;  // Passed to fragment shader
+flat out int ViewIndex;  // view of a split frame this vertex is drawn for
+
+vec3 OctDecode(vec2 encoded)
+{
+    vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    if (normal.z < 0.0) {
+        normal.xy = (1.0 - abs(normal.yx)) * vec2(normal.x >= 0.0 ? 1.0 : -1.0, normal.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(normal);
+}
 
 void main() {
-    gl_Position = projection * view * model * vec4(aPosition, 1.0);
-    TexCoord = aTexCoord;  // Forward UVs (v=0.0 at bottom, v=1.0 at top for standard sphere)
-}
\ No newline at end of file
+    vec4 worldPosition;
+    vec3 position = aPosition * aDecodeScale.xyz + aDecodeBias;
+    vec3 normal = (aDecodeScale.w > 0.5) ? OctDecode(aNormal.xy) : aNormal;
+    vec2 texCoord = aTexCoord;
+    mat4 drawModel = model;
+    mat4 drawMeltGroup = meltGroup;
+    vec4 drawMeltParams = meltParams;
+    bool bDrawMelt = bUseMelt;
+
+#ifdef VERTEX_PULLING
+    if (bPullVertices) {
+        CompactVertex vertex = compactVertices[gl_VertexID];
+        DrawData draw = drawTable[aDrawIndex];
+        vec3 fractions = vec3(unpackUnorm2x16(vertex.positionXY), unpackUnorm2x16(vertex.positionZ).x);
+        position = fractions * draw.decodeScale.xyz + draw.decodeBias.xyz;
+        normal = OctDecode(unpackSnorm2x16(vertex.normal));
+        texCoord = unpackHalf2x16(vertex.texCoord);
+        drawModel = draw.model;
+        drawMeltGroup = draw.meltGroup;
+        drawMeltParams = draw.meltParams;
+        bDrawMelt = (draw.meltParams.z > 0.0);
+    }
+#endif
+
+    if (bDrawMelt) {
+        vec3 groupPosition = vec3(drawModel * vec4(position, 1.0));
+        vec3 groupNormal = mat3(transpose(inverse(drawModel))) * normal;
+        Melt(groupPosition, groupNormal, drawMeltParams);
+        worldPosition = drawMeltGroup * vec4(groupPosition, 1.0);
+        Normal = mat3(transpose(inverse(drawMeltGroup))) * groupNormal;
+    } else {
+        worldPosition = drawModel * vec4(position, 1.0);
+        Normal = mat3(transpose(inverse(drawModel))) * normal;
+    }
+
+    FragPos = vec3(worldPosition);
+    if (viewCount > 0) {
+        ViewIndex = min(firstView + gl_InstanceID, viewCount - 1);
+        vec4 clip = viewProjections[ViewIndex] * worldPosition;
+        vec4 rectangle = viewRectangles[ViewIndex];
+        vec2 offset = rectangle.xy * 2.0 + rectangle.zw - 1.0;
+        gl_Position = vec4(clip.xy * rectangle.zw + offset * clip.w, clip.zw);
+        gl_ClipDistance[0] = clip.w + clip.x;
+        gl_ClipDistance[1] = clip.w - clip.x;
+        gl_ClipDistance[2] = clip.w + clip.y;
+        gl_ClipDistance[3] = clip.w - clip.y;
+    } else {
+        ViewIndex = 0;
+        gl_Position = projection * view * worldPosition;
+    }
+    TexCoord = texCoord;  // Forward UVs (v=0.0 at bottom, v=1.0 at top for standard sphere)
+}
@@ -0,0 +1,7 @@
+#version 430 core
+
+// The scene vertex shader of vertex.glsl, reading the compact meshes from storage
+// buffers when bPullVertices is set so a multi-draw can mix any of them. The scene
+// program is built from this file where GL 4.3 is available.
+#define VERTEX_PULLING
+#include "vertex.glsl"